@@ -0,0 +1,1050 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  jt808_bench.cc
+// @Version :  1.0
+// @Time    :  2026/10/16 18:40:12
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+// Parser/packager micro-benchmarks.
+// Every case prints one JSON object per line on stdout, so results can be collected and compared between commits:
+//     {"name":"parse/0x0200/basic","bytes":62,"iterations":...,"ns_per_op":...,"ops_per_sec":...,...}
+// The first line holds the run context (compiler, optimization, timing options).
+// Usage:
+//     jt808_bench [--filter=SUBSTRING] [--min-time=MS] [--repetitions=N] [--list]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "jt808/area_rule.h"
+#include "jt808/bcd.h"
+#include "jt808/bcd_time.h"
+#include "jt808/geofence.h"
+#include "jt808/packager.h"
+#include "jt808/parameter_push.h"
+#include "jt808/parser.h"
+#include "jt808/terminal_parameter_store.h"
+#include "jt808/timing_wheel.h"
+#include "jt808/util.h"
+
+//
+// Allocation counting, the benchmark is single threaded.
+//
+namespace {
+
+uint64_t g_alloc_count = 0;
+uint64_t g_alloc_bytes = 0;
+
+void* CountedAlloc(size_t size) {
+    ++g_alloc_count;
+    g_alloc_bytes += size;
+    void* ptr = malloc(size ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    return CountedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+namespace {
+
+using libjt808::ProtocolParameter;
+
+// Keep the compiler from optimizing away a result.
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+// A benchmark case, run() executes the operation the given number of times.
+struct BenchCase {
+    std::string                         name;
+    size_t                              bytes; // Bytes processed per operation, 0 if not applicable.
+    std::function<void(uint64_t const&)> run;
+};
+
+struct BenchOptions {
+    std::string filter;
+    double      min_time_ms = 200;
+    int         repetitions = 5;
+    bool        list        = false;
+};
+
+double ElapsedNs(std::chrono::steady_clock::time_point const& begin) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void RunCase(BenchCase const& bench, BenchOptions const& options) {
+    // Calibrate the iteration count to about min_time per repetition.
+    uint64_t iterations = 1;
+    while (1) {
+        auto begin = std::chrono::steady_clock::now();
+        bench.run(iterations);
+        double ns = ElapsedNs(begin);
+        if (ns >= options.min_time_ms * 1e6 / 10 || iterations >= (1ull << 40)) {
+            double target = options.min_time_ms * 1e6 / std::max(ns / iterations, 0.1);
+            iterations    = std::max<uint64_t>(1, static_cast<uint64_t>(target));
+            break;
+        }
+        iterations *= 10;
+    }
+    std::vector<double> samples;
+    uint64_t            allocs = 0;
+    uint64_t            alloc_bytes = 0;
+    for (int i = 0; i < options.repetitions; ++i) {
+        uint64_t count_before = g_alloc_count;
+        uint64_t bytes_before = g_alloc_bytes;
+        auto     begin        = std::chrono::steady_clock::now();
+        bench.run(iterations);
+        samples.push_back(ElapsedNs(begin) / iterations);
+        allocs      = g_alloc_count - count_before;
+        alloc_bytes = g_alloc_bytes - bytes_before;
+    }
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2];
+    printf("{\"name\":\"%s\",\"bytes\":%zu,\"iterations\":%llu,\"repetitions\":%d,\"ns_per_op\":%.2f,"
+           "\"ns_per_op_min\":%.2f,\"ns_per_op_max\":%.2f,\"ops_per_sec\":%.0f,\"mb_per_sec\":%.2f,"
+           "\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.1f}\n",
+           bench.name.c_str(), bench.bytes, static_cast<unsigned long long>(iterations), options.repetitions,
+           median, samples.front(), samples.back(), 1e9 / median, bench.bytes ? bench.bytes * 1e3 / median : 0.0,
+           static_cast<double>(allocs) / iterations, static_cast<double>(alloc_bytes) / iterations);
+    fflush(stdout);
+}
+
+void PrintError(std::string const& name, char const* error) {
+    printf("{\"name\":\"%s\",\"error\":\"%s\"}\n", name.c_str(), error);
+}
+
+std::string HexId(uint16_t const& msg_id) {
+    char id[8];
+    snprintf(id, sizeof(id), "0x%04X", msg_id);
+    return id;
+}
+
+//
+// Corpora.
+//
+// A parameter set filled for every message the packager knows, with typical field sizes.
+void FillTypicalParameter(ProtocolParameter* para) {
+    para->msg_head.msgbody_attr.u16val = 0;
+    para->msg_head.phone_num           = "13395279527";
+    para->msg_head.msg_flow_num        = 1;
+    para->msg_head.total_packet        = 0;
+    para->msg_head.packet_seq          = 0;
+    para->respone_result               = 0;
+    para->respone_msg_id               = libjt808::kLocationReport;
+    para->respone_flow_num             = 1;
+    para->parse.msg_head               = para->msg_head;
+    para->parse.msg_head.msg_id        = libjt808::kLocationReport;
+    para->parse.respone_result         = 0;
+
+    auto& register_info       = para->register_info;
+    register_info.province_id = 0x002c;
+    register_info.city_id     = 0x012c;
+    register_info.manufacturer_id.assign({'S', 'K', 'O', 'E', 'M'});
+    register_info.terminal_model.assign({'S', 'K', '9', '1', '5', '1'});
+    register_info.terminal_id.assign({'0', '0', '0', '0', '0', '0', '1'});
+    register_info.car_plate_color = libjt808::kBlue;
+    register_info.car_plate_num   = "\xD4\xC1\x42\x31\x32\x33\x34\x35";
+    para->authentication_code.assign({'1', '9', '2', '6', '0', '8', '1', '7'});
+    para->parse.authentication_code = para->authentication_code;
+
+    para->terminal_parameters.clear();
+    para->terminal_parameter_store.Clear();
+    para->terminal_parameters[0x0001] = {0x00, 0x00, 0x00, 0x1E};
+    para->terminal_parameters[0x0013] = {'1', '2', '7', '.', '0', '.', '0', '.', '1'};
+    para->terminal_parameters[0x0018] = {0x00, 0x00, 0x22, 0xB8};
+    para->terminal_parameters[0x0029] = {0x00, 0x00, 0x00, 0x0A};
+    para->terminal_parameters[0x0055] = {0x00, 0x00, 0x00, 0x78};
+    para->terminal_parameters[0x0083] = {0xD4, 0xC1, 0x42, 0x31, 0x32, 0x33, 0x34, 0x35};
+    para->terminal_parameter_ids      = {0x0001, 0x0013, 0x0029};
+
+    auto& location             = para->location_info;
+    location.alarm.value       = 0;
+    location.status.value      = 0;
+    location.status.bit.positioning = 1;
+    location.latitude          = 22512345;
+    location.longitude         = 113912345;
+    location.altitude          = 54;
+    location.speed             = 600;
+    location.bearing           = 90;
+    location.time              = "261016184012";
+    para->location_extension.clear();
+    para->location_extension[libjt808::kMileage]          = {0x00, 0x01, 0x86, 0xA0};
+    para->location_extension[libjt808::kOilMass]          = {0x01, 0xF4};
+    para->location_extension[libjt808::kTachographSpeed]  = {0x02, 0x58};
+    para->location_extension[libjt808::kNetworkQuantity]  = {0x1F};
+    para->location_extension[libjt808::kGnssSatellites]   = {0x0C};
+
+    para->location_tracking_control.interval      = 10;
+    para->location_tracking_control.tracking_time = 3600;
+
+    auto& polygon_area                = para->polygon_area;
+    polygon_area.area_id              = 1;
+    polygon_area.area_attribute.value = 0;
+    polygon_area.area_attribute.bit.speed_limit = 1;
+    polygon_area.max_speed            = 60;
+    polygon_area.overspeed_time       = 10;
+    polygon_area.vertices.clear();
+    for (int i = 0; i < 8; ++i) {
+        libjt808::LocationPoint vertex;
+        vertex.latitude  = 22.5 + 0.01 * (i % 4);
+        vertex.longitude = 113.9 + 0.01 * (i / 4);
+        polygon_area.vertices.push_back(vertex);
+    }
+    para->polygon_area_id = {1, 2, 3};
+
+    para->area_setting_type = libjt808::kAreaAppend;
+    para->circular_areas.assign(4, libjt808::CircularArea {});
+    para->rectangle_areas.assign(4, libjt808::RectangleArea {});
+    for (uint32_t i = 0; i < 4; ++i) {
+        auto& circle                           = para->circular_areas[i];
+        circle.area_id                         = i + 1;
+        circle.area_attribute.bit.speed_limit  = 1;
+        circle.center                          = {113.9 + 0.01 * i, 22.5, 0.0f};
+        circle.radius                          = 500;
+        circle.max_speed                       = 60;
+        circle.overspeed_time                  = 10;
+        auto& rectangle                        = para->rectangle_areas[i];
+        rectangle.area_id                      = i + 1;
+        rectangle.area_attribute.bit.by_time   = 1;
+        rectangle.upper_left                   = {113.9 + 0.01 * i, 22.51, 0.0f};
+        rectangle.lower_right                  = {113.91 + 0.01 * i, 22.5, 0.0f};
+        rectangle.start_time                   = "261016000000";
+        rectangle.stop_time                    = "261016235959";
+    }
+    para->circular_area_id  = {1, 2, 3};
+    para->rectangle_area_id = {1, 2, 3};
+    auto& route             = para->route;
+    route.route_id          = 1;
+    route.route_attribute.value = 0;
+    route.turning_points.assign(16, libjt808::RouteTurningPoint {});
+    for (uint32_t i = 0; i < route.turning_points.size(); ++i) {
+        auto& point                                  = route.turning_points[i];
+        point.turning_point_id                       = i + 1;
+        point.road_section_id                        = i + 1;
+        point.point                                  = {113.9 + 0.005 * i, 22.5 + 0.002 * (i % 3), 0.0f};
+        point.road_width                             = 30;
+        point.road_section_attribute.bit.speed_limit = 1;
+        point.max_speed                              = 80;
+        point.overspeed_time                         = 10;
+    }
+    para->route_id = {1};
+
+    auto& upgrade_info          = para->upgrade_info;
+    upgrade_info.upgrade_type   = libjt808::kTerminal;
+    upgrade_info.upgrade_result = libjt808::kTerminalUpgradeSuccess;
+    upgrade_info.manufacturer_id.assign({'S', 'K', 'O', 'E', 'M'});
+    upgrade_info.version_id = "1.0.1";
+    upgrade_info.upgrade_data.resize(512);
+    for (size_t i = 0; i < upgrade_info.upgrade_data.size(); ++i)
+        upgrade_info.upgrade_data[i] = static_cast<uint8_t>(i * 7);
+    upgrade_info.upgrade_data_total_len = 512;
+
+    para->fill_packet.first_packet_msg_flow_num = 1;
+    para->fill_packet.packet_id                 = {2, 5, 7};
+
+    auto& media        = para->multimedia_upload;
+    media.media_id     = 1;
+    media.media_type   = 0;
+    media.media_format = 0;
+    media.media_event  = 1;
+    media.channel_id   = 1;
+    media.loaction_report_body.assign(28, 0x20);
+    media.media_data.resize(512);
+    for (size_t i = 0; i < media.media_data.size(); ++i)
+        media.media_data[i] = static_cast<uint8_t>(i * 13);
+    para->multimedia_upload_response.media_id = 1;
+    para->multimedia_upload_response.reload_packet_ids.clear();
+
+    auto& batch_loc     = para->batch_loc;
+    batch_loc.data_type = 0;
+    batch_loc.loc_info.assign(5, location);
+    batch_loc.loc_ext.assign(5, para->location_extension);
+}
+
+// Location with most of the standard extensions plus custom ones, close to the 1023 byte body limit.
+void FillLargeExtensions(ProtocolParameter* para) {
+    auto& ext = para->location_extension;
+    ext[libjt808::kAlarmCount]           = {0x00, 0x03};
+    ext[libjt808::kOverSpeedAlarm]       = {0x01, 0x00, 0x00, 0x00, 0x07};
+    ext[libjt808::kAccessAreaAlarm]      = {0x01, 0x00, 0x00, 0x00, 0x07, 0x00};
+    ext[libjt808::kDrivingTimeAlarm]     = {0x00, 0x00, 0x00, 0x02, 0x01, 0x2C, 0x01};
+    ext[libjt808::kVehicleSignalStatus]  = {0x00, 0x00, 0x00, 0x41};
+    ext[libjt808::kIoStatus]             = {0x00, 0x01};
+    ext[libjt808::kAnalogQuantity]       = {0x01, 0x02, 0x03, 0x04};
+    for (uint8_t id = 0xE1; id < 0xEA; ++id)
+        ext[id].assign(48, id);
+    ext[libjt808::kBasicDataFlow].assign(96, 0x11);
+    ext[libjt808::kPositioningStatus].assign(24, 0x22);
+}
+
+// Values dense in 0x7E/0x7D, every one of them doubles in size when escaped.
+void FillEscapeHeavy(ProtocolParameter* para) {
+    auto& location     = para->location_info;
+    location.latitude  = 0x7E7D7E7D;
+    location.longitude = 0x7D7E7D7E;
+    location.altitude  = 0x7E7D;
+    location.speed     = 0x7D7E;
+    location.bearing   = 0x7E;
+    for (auto& item : para->location_extension)
+        std::fill(item.second.begin(), item.second.end(), 0x7E);
+    auto& media = para->multimedia_upload.media_data;
+    media.resize(987);
+    for (size_t i = 0; i < media.size(); ++i)
+        media[i] = (i & 1) ? 0x7D : 0x7E;
+}
+
+struct FrameCorpus {
+    std::string       variant;
+    ProtocolParameter para;
+};
+
+// One corpus per registered message ID, plus the variants stressing specific code paths.
+std::vector<FrameCorpus> BuildFrameCorpora(libjt808::Packager const& packager) {
+    std::vector<FrameCorpus> corpora;
+    for (auto const& item : packager) {
+        FrameCorpus corpus;
+        corpus.variant = HexId(item.first) + "/basic";
+        FillTypicalParameter(&corpus.para);
+        corpus.para.msg_head.msg_id = item.first;
+        corpora.push_back(corpus);
+    }
+    FrameCorpus corpus;
+    FillTypicalParameter(&corpus.para);
+    corpus.para.msg_head.msg_id = libjt808::kLocationReport;
+    FillLargeExtensions(&corpus.para);
+    corpus.variant = "0x0200/large_extensions";
+    corpora.push_back(corpus);
+
+    FillTypicalParameter(&corpus.para);
+    corpus.para.msg_head.msg_id = libjt808::kLocationReport;
+    FillEscapeHeavy(&corpus.para);
+    corpus.variant = "0x0200/escape_heavy";
+    corpora.push_back(corpus);
+
+    FillTypicalParameter(&corpus.para);
+    corpus.para.msg_head.msg_id = libjt808::kMultimediaDataUpload;
+    FillEscapeHeavy(&corpus.para);
+    corpus.variant = "0x0801/escape_heavy";
+    corpora.push_back(corpus);
+
+    // Middle packet of a segmented upload, the header carries the packet fields.
+    FillTypicalParameter(&corpus.para);
+    corpus.para.msg_head.msg_id                  = libjt808::kMultimediaDataUpload;
+    corpus.para.msg_head.msgbody_attr.bit.packet = 1;
+    corpus.para.msg_head.total_packet            = 16;
+    corpus.para.msg_head.packet_seq              = 3;
+    corpus.para.multimedia_upload.media_data.assign(987, 0x55);
+    corpus.variant = "0x0801/segmented";
+    corpora.push_back(corpus);
+
+    FillTypicalParameter(&corpus.para);
+    corpus.para.msg_head.msg_id = libjt808::kBatchLocationReport;
+    corpus.para.batch_loc.loc_info.assign(34, corpus.para.location_info);
+    corpus.para.batch_loc.loc_ext.clear();
+    corpus.variant = "0x0704/full_batch";
+    corpora.push_back(corpus);
+
+    FillTypicalParameter(&corpus.para);
+    corpus.para.msg_head.msg_id = libjt808::kSetTerminalParameters;
+    for (uint32_t id = 0x0010; id < 0x0060; ++id)
+        corpus.para.terminal_parameters[id] = {0x00, 0x00, 0x00, static_cast<uint8_t>(id)};
+    corpus.variant = "0x8103/many_parameters";
+    corpora.push_back(corpus);
+
+    corpus.para.terminal_parameter_store.Import(corpus.para.terminal_parameters);
+    corpus.variant = "0x8103/many_parameters_store";
+    corpora.push_back(corpus);
+
+    corpus.para.msg_head.msg_id = libjt808::kGetTerminalParametersResponse;
+    corpus.para.terminal_parameter_ids.clear();
+    corpus.variant = "0x0104/many_parameters_store";
+    corpora.push_back(corpus);
+    return corpora;
+}
+
+// Buffer of the given size with roughly one escaped byte every escape_every bytes, 0 for none.
+std::vector<uint8_t> MakeBuffer(size_t const& size, size_t const& escape_every) {
+    std::vector<uint8_t> buffer(size);
+    uint32_t             seed = 12345;
+    for (size_t i = 0; i < size; ++i) {
+        seed      = seed * 1103515245 + 12345;
+        uint8_t v = static_cast<uint8_t>(seed >> 16);
+        if (v == 0x7E || v == 0x7D)
+            v = 0x20;
+        if (escape_every && i % escape_every == 0)
+            v = (i / escape_every) & 1 ? 0x7D : 0x7E;
+        buffer[i] = v;
+    }
+    return buffer;
+}
+
+//
+// Cases.
+//
+void AddFrameCases(std::vector<BenchCase>* cases) {
+    static libjt808::Packager packager;
+    static libjt808::Parser   parser;
+    libjt808::JT808FramePackagerInit(&packager);
+    libjt808::JT808FrameParserInit(&parser);
+    for (auto const& corpus : BuildFrameCorpora(packager)) {
+        auto                 para = std::make_shared<ProtocolParameter>(corpus.para);
+        auto                 frame = std::make_shared<std::vector<uint8_t>>();
+        std::string          package_name = "package/" + corpus.variant;
+        std::string          parse_name   = "parse/" + corpus.variant;
+        if (libjt808::JT808FramePackage(packager, *para, *frame) < 0) {
+            cases->push_back({package_name, 0, nullptr});
+            continue;
+        }
+        cases->push_back({package_name, frame->size(), [para](uint64_t const& iterations) {
+                              std::vector<uint8_t> out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::JT808FramePackage(packager, *para, out);
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        if (parser.find(para->msg_head.msg_id) == parser.end())
+            continue;
+        ProtocolParameter parsed;
+        if (libjt808::JT808FrameParse(parser, *frame, &parsed)) {
+            cases->push_back({parse_name, 0, nullptr});
+            continue;
+        }
+        cases->push_back({parse_name, frame->size(), [frame](uint64_t const& iterations) {
+                              ProtocolParameter out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  auto error = libjt808::JT808FrameParse(parser, *frame, &out);
+                                  DoNotOptimize(error);
+                              }
+                          }});
+    }
+    // A multimedia upload of 16 packets through the reassembly stage, per upload.
+    static libjt808::SegmentedParser segmented_parser;
+    libjt808::JT808SegmentedParserInit(&segmented_parser);
+    auto   frames = std::make_shared<std::vector<std::vector<uint8_t>>>(16);
+    size_t bytes  = 0;
+    {
+        ProtocolParameter para;
+        FillTypicalParameter(&para);
+        para.msg_head.msg_id                  = libjt808::kMultimediaDataUpload;
+        para.msg_head.msgbody_attr.bit.packet = 1;
+        para.msg_head.total_packet            = 16;
+        for (uint16_t seq = 1; seq <= 16; ++seq) {
+            para.msg_head.packet_seq   = seq;
+            para.msg_head.msg_flow_num = seq;
+            para.multimedia_upload.media_data.assign(987, static_cast<uint8_t>(seq));
+            libjt808::JT808FramePackage(packager, para, (*frames)[seq - 1]);
+            bytes += (*frames)[seq - 1].size();
+        }
+    }
+    cases->push_back({"reassemble/0x0801/16_packets", bytes, [frames](uint64_t const& iterations) {
+                          ProtocolParameter out;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::Reassembler reassembler;
+                              for (auto const& frame : *frames) {
+                                  auto error = libjt808::JT808FrameParse(parser, segmented_parser, &reassembler,
+                                                                         frame, 0, &out);
+                                  DoNotOptimize(error);
+                              }
+                          }
+                      }});
+    // The same upload packaged as sub-packets into one buffer, per upload.
+    auto upload = std::make_shared<ProtocolParameter>();
+    FillTypicalParameter(upload.get());
+    upload->msg_head.msg_id = libjt808::kMultimediaDataUpload;
+    upload->multimedia_upload.media_data.assign(16 * 987, 0x5A);
+    cases->push_back({"segmented_package/0x0801/16_packets", bytes, [upload](uint64_t const& iterations) {
+                          libjt808::SegmentedFrames out;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::JT808SegmentedPackage(packager, *upload, libjt808::kMaxMsgBodyLength, &out);
+                              DoNotOptimize(out);
+                          }
+                      }});
+}
+
+void AddUtilCases(std::vector<BenchCase>* cases) {
+    struct BufferCorpus {
+        char const* variant;
+        size_t      size;
+        size_t      escape_every;
+    };
+    BufferCorpus const corpora[] = {
+        {"64b", 64, 0},
+        {"1k", 1024, 0},
+        {"1k_escape_heavy", 1024, 2},
+    };
+    for (auto const& corpus : corpora) {
+        auto raw     = std::make_shared<std::vector<uint8_t>>(MakeBuffer(corpus.size, corpus.escape_every));
+        auto escaped = std::make_shared<std::vector<uint8_t>>();
+        libjt808::Escape(*raw, *escaped);
+        cases->push_back({std::string("escape/") + corpus.variant, raw->size(), [raw](uint64_t const& iterations) {
+                              std::vector<uint8_t> out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::Escape(*raw, out);
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        cases->push_back({std::string("reverse_escape/") + corpus.variant, escaped->size(),
+                          [escaped](uint64_t const& iterations) {
+                              std::vector<uint8_t> out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::ReverseEscape(*escaped, out);
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        cases->push_back({std::string("bcc_checksum/") + corpus.variant, raw->size(),
+                          [raw](uint64_t const& iterations) {
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  auto sum = libjt808::BccCheckSum(raw->data(), raw->size());
+                                  DoNotOptimize(sum);
+                              }
+                          }});
+    }
+    // Stream of back to back location reports, as read from a socket.
+    auto stream = std::make_shared<std::vector<uint8_t>>();
+    {
+        libjt808::Packager packager;
+        libjt808::JT808FramePackagerInit(&packager);
+        ProtocolParameter para;
+        FillTypicalParameter(&para);
+        para.msg_head.msg_id = libjt808::kLocationReport;
+        std::vector<uint8_t> frame;
+        libjt808::JT808FramePackage(packager, para, frame);
+        while (stream->size() < 64 * 1024)
+            stream->insert(stream->end(), frame.begin(), frame.end());
+    }
+    cases->push_back({"find_frame/64k_stream", stream->size(), [stream](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              size_t offset = 0;
+                              size_t begin  = 0;
+                              size_t end    = 0;
+                              while (libjt808::FindFrame(stream->data() + offset, stream->size() - offset, &begin,
+                                                         &end) == 0)
+                                  offset += end;
+                              DoNotOptimize(offset);
+                          }
+                      }});
+    // Idle timers of 1M connections on a 10 ms wheel, deadlines spread over 180 s and re-armed on expiry, as by
+    // connections sending their heartbeats.
+    struct TimerFixture {
+        libjt808::TimingWheel                       wheel{10};
+        std::vector<libjt808::TimingWheel::TimerId> ids;
+        int64_t                                     now_ms = 0;
+
+        void Arm(size_t const& i, uint32_t const& delay_ms) {
+            ids[i] = wheel.Add(delay_ms, [this, i] { Arm(i, 180000); });
+        }
+    };
+    auto timers = std::make_shared<TimerFixture>();
+    timers->wheel.Start(0);
+    timers->ids.resize(1000000);
+    for (size_t i = 0; i < timers->ids.size(); ++i)
+        timers->Arm(i, static_cast<uint32_t>(i % 180000));
+    cases->push_back({"timing_wheel/reset/1M_timers", 0, [timers](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              int ret = timers->wheel.Reset(timers->ids[i % timers->ids.size()], 180000);
+                              DoNotOptimize(ret);
+                          }
+                      }});
+    cases->push_back({"timing_wheel/add_cancel/1M_timers", 0, [timers](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              auto id = timers->wheel.Add(static_cast<uint32_t>(i % 600000), [] {});
+                              timers->wheel.Cancel(id);
+                          }
+                      }});
+    // One 10 ms tick, firing and re-arming about 56 timers.
+    cases->push_back({"timing_wheel/advance_tick/1M_timers", 0, [timers](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              timers->now_ms += 10;
+                              auto fired = timers->wheel.Advance(timers->now_ms);
+                              DoNotOptimize(fired);
+                          }
+                      }});
+}
+
+void AddBcdCases(std::vector<BenchCase>* cases) {
+    cases->push_back({"bcd/hex_to_bcd/256", 256, [](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              for (int v = 0; v < 256; ++v) {
+                                  auto bcd = libjt808::HexToBcd(static_cast<uint8_t>(v % 100));
+                                  DoNotOptimize(bcd);
+                              }
+                          }
+                      }});
+    cases->push_back({"bcd/bcd_to_hex/256", 256, [](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              for (int v = 0; v < 256; ++v) {
+                                  auto hex = libjt808::BcdToHex(static_cast<uint8_t>(v));
+                                  DoNotOptimize(hex);
+                              }
+                          }
+                      }});
+    struct StringCorpus {
+        char const* variant;
+        char const* digits;
+    };
+    StringCorpus const corpora[] = {
+        {"phone", "013395279527"},
+        {"time", "261016184012"},
+        {"long", "20261016184012000000000000000000"},
+    };
+    for (auto const& corpus : corpora) {
+        std::string digits(corpus.digits);
+        auto        bcd = std::make_shared<std::vector<uint8_t>>();
+        libjt808::StringToBcd(digits, bcd.get());
+        cases->push_back({std::string("bcd/string_to_bcd/") + corpus.variant, digits.size(),
+                          [digits](uint64_t const& iterations) {
+                              std::vector<uint8_t> out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::StringToBcd(digits, &out);
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        cases->push_back({std::string("bcd/bcd_to_string/") + corpus.variant, bcd->size(),
+                          [bcd](uint64_t const& iterations) {
+                              std::string out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::BcdToString(*bcd, &out);
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        cases->push_back({std::string("bcd/bcd_to_string_fill_zero/") + corpus.variant, bcd->size(),
+                          [bcd](uint64_t const& iterations) {
+                              std::string out;
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::BcdToStringFillZero(*bcd, &out);
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        cases->push_back({std::string("bcd/string_to_bcd_compress/") + corpus.variant, digits.size(),
+                          [digits](uint64_t const& iterations) {
+                              uint8_t out[32];
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::StringToBcdCompress(reinterpret_cast<uint8_t const*>(digits.data()), out,
+                                                                static_cast<int>(digits.size()));
+                                  DoNotOptimize(out);
+                              }
+                          }});
+        cases->push_back({std::string("bcd/bcd_to_string_compress/") + corpus.variant, bcd->size(),
+                          [bcd](uint64_t const& iterations) {
+                              uint8_t out[72];
+                              for (uint64_t i = 0; i < iterations; ++i) {
+                                  libjt808::BcdToStringCompress(bcd->data(), out, static_cast<int>(bcd->size()));
+                                  DoNotOptimize(out);
+                              }
+                          }});
+    }
+    // Fixed size fields of the header and the location report, into caller buffers.
+    std::string const phone("13395279527");
+    uint8_t           phone_bcd[libjt808::kBcdPhoneSize];
+    libjt808::PhoneToBcd(phone, phone_bcd);
+    std::vector<uint8_t> const phone_field(phone_bcd, phone_bcd + libjt808::kBcdPhoneSize);
+    std::vector<uint8_t> const time_field = {0x26, 0x10, 0x16, 0x18, 0x40, 0x12};
+    cases->push_back({"bcd/phone_to_bcd/phone", phone.size(), [phone](uint64_t const& iterations) {
+                          uint8_t out[libjt808::kBcdPhoneSize];
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::PhoneToBcd(phone, out);
+                              DoNotOptimize(out);
+                          }
+                      }});
+    cases->push_back({"bcd/bcd_to_phone/phone", phone_field.size(), [phone_field](uint64_t const& iterations) {
+                          char out[2 * libjt808::kBcdPhoneSize];
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::BcdToPhone(phone_field.data(), out);
+                              DoNotOptimize(out);
+                          }
+                      }});
+    cases->push_back({"bcd/bcd_to_digits/time", time_field.size(), [time_field](uint64_t const& iterations) {
+                          char out[2 * libjt808::kBcdTimeSize];
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::BcdToDigits(time_field.data(), time_field.size(), out);
+                              DoNotOptimize(out);
+                          }
+                      }});
+    cases->push_back({"bcd/bcd_to_time/time", time_field.size(), [time_field](uint64_t const& iterations) {
+                          libjt808::BcdTime out;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::BcdToTime(time_field.data(), &out);
+                              DoNotOptimize(out);
+                          }
+                      }});
+    // 1 Hz reports of a terminal: the seconds change, the date does not.
+    auto reports = std::make_shared<std::vector<std::array<uint8_t, libjt808::kBcdTimeSize>>>();
+    for (int second = 0; second < 60; ++second) {
+        reports->push_back({{0x26, 0x10, 0x16, 0x18, 0x40,
+                             static_cast<uint8_t>(((second / 10) << 4) | (second % 10))}});
+    }
+    cases->push_back({"bcd/bcd_time_to_epoch/uncached", reports->size() * libjt808::kBcdTimeSize,
+                      [reports](uint64_t const& iterations) {
+                          int64_t epoch = 0;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              for (auto const& report : *reports) {
+                                  libjt808::BcdTimeToEpoch(report.data(), &epoch);
+                                  DoNotOptimize(epoch);
+                              }
+                          }
+                      }});
+    cases->push_back({"bcd/bcd_time_to_epoch/cached", reports->size() * libjt808::kBcdTimeSize,
+                      [reports](uint64_t const& iterations) {
+                          libjt808::BcdTimeCache cache;
+                          int64_t                epoch = 0;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              for (auto const& report : *reports) {
+                                  cache.ToEpoch(report.data(), &epoch);
+                                  DoNotOptimize(epoch);
+                              }
+                          }
+                      }});
+}
+
+// Reading and copying the parameters of a terminal, map against store, and planning a parameter push to a fleet.
+void AddTerminalParameterCases(std::vector<BenchCase>* cases) {
+    // Copy of the parameters of a terminal, as cached per terminal from 0x0104.
+    auto map = std::make_shared<libjt808::TerminalParameters>();
+    {
+        ProtocolParameter para;
+        FillTypicalParameter(&para);
+        *map = para.terminal_parameters;
+        for (uint32_t id = 0x0010; id < 0x0060; ++id)
+            (*map)[id] = {0x00, 0x00, 0x00, static_cast<uint8_t>(id)};
+    }
+    auto store = std::make_shared<libjt808::TerminalParameterStore>();
+    store->Import(*map);
+    cases->push_back({"terminal_parameters/copy/map", 0, [map](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::TerminalParameters copy(*map);
+                              DoNotOptimize(copy);
+                          }
+                      }});
+    cases->push_back({"terminal_parameters/copy/store", 0, [store](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              libjt808::TerminalParameterStore copy(*store);
+                              DoNotOptimize(copy);
+                          }
+                      }});
+    cases->push_back({"terminal_parameters/get/map", 0, [map](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              uint32_t interval = 0;
+                              libjt808::GetTerminalParameter(*map, libjt808::kTerminalHeartBeatInterval, &interval);
+                              DoNotOptimize(interval);
+                          }
+                      }});
+    cases->push_back({"terminal_parameters/get/store", 0, [store](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              uint32_t interval = 0;
+                              store->Get<libjt808::kTerminalHeartBeatInterval>(&interval);
+                              DoNotOptimize(interval);
+                          }
+                      }});
+    // Planning a fleet push: a third of the terminals unknown, a third one parameter off, a third up to date.
+    auto snapshots = std::make_shared<std::vector<libjt808::TerminalParameterStore>>(3, *store);
+    (*snapshots)[0].Clear();
+    (*snapshots)[1].Set(libjt808::kTerminalHeartBeatInterval, static_cast<uint32_t>(60));
+    auto names = std::make_shared<std::vector<std::string>>();
+    for (int i = 0; i < 3000; ++i)
+        names->push_back(std::to_string(13300000000LL + i));
+    auto add_terminals = [store, snapshots, names](uint64_t const& iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) {
+            libjt808::ParameterPush push(*store);
+            for (size_t j = 0; j < names->size(); ++j)
+                push.AddTerminal((*names)[j], (*snapshots)[j % 3]);
+            DoNotOptimize(push);
+        }
+    };
+    cases->push_back({"parameter_push/add_terminal/3000_terminals", 0, add_terminals});
+}
+
+// Fences scattered over a 2 x 2 degree city, star shaped polygons of 3 to 62 vertices and up to 11 km across.
+void AddGeofenceCases(std::vector<BenchCase>* cases) {
+    constexpr uint32_t kAreaCount  = 5000;
+    constexpr size_t   kPointCount = 4096;
+    std::mt19937                           random(808);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto areas  = std::make_shared<libjt808::PolygonAreaSet>();
+    auto points = std::make_shared<std::vector<libjt808::GeoPoint>>();
+    for (uint32_t id = 1; id <= kAreaCount; ++id) {
+        double center_latitude  = 22.0 + unit(random) * 2.0;
+        double center_longitude = 113.0 + unit(random) * 2.0;
+        double radius           = 0.005 + unit(random) * 0.05;
+        int    vertex_count     = 3 + random() % 60;
+        auto&  area             = (*areas)[id];
+        area.area_id            = id;
+        for (int i = 0; i < vertex_count; ++i) {
+            double angle = 2 * M_PI * i / vertex_count;
+            double r     = radius * (0.3 + 0.7 * unit(random));
+            area.vertices.push_back({center_longitude + r * cos(angle), center_latitude + r * sin(angle), 0.0f});
+        }
+    }
+    for (size_t i = 0; i < kPointCount; ++i) {
+        points->push_back({libjt808::DegreesToGeo(22.0 + unit(random) * 2.0),
+                           libjt808::DegreesToGeo(113.0 + unit(random) * 2.0)});
+    }
+    auto engine = std::make_shared<libjt808::GeofenceEngine>();
+    engine->AddPolygonAreas(*areas);
+    cases->push_back({"geofence/locate/5000_areas", 0, [engine, points](uint64_t const& iterations) {
+                          std::vector<libjt808::GeofenceHit> hits;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              engine->Locate((*points)[i % kPointCount], &hits);
+                              DoNotOptimize(hits);
+                          }
+                      }});
+    cases->push_back({"geofence/update/5000_areas", 0, [engine, points](uint64_t const& iterations) {
+                          std::vector<libjt808::GeofenceEvent> events;
+                          std::string const terminals[] = {"013300000001", "013300000002", "013300000003"};
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              events.clear();
+                              engine->Update(terminals[i % 3], (*points)[i % kPointCount], &events);
+                              DoNotOptimize(events);
+                          }
+                      }});
+    // The same polygons with circles, rectangles and routes of 40 turning points over the same region.
+    auto mixed = std::make_shared<libjt808::GeofenceEngine>();
+    mixed->AddPolygonAreas(*areas);
+    for (uint32_t id = 1; id <= 2000; ++id) {
+        libjt808::CircularArea circle {};
+        circle.area_id = id;
+        circle.center  = {113.0 + unit(random) * 2.0, 22.0 + unit(random) * 2.0, 0.0f};
+        circle.radius  = 500 + random() % 5000;
+        mixed->AddCircularArea(circle);
+        libjt808::RectangleArea rectangle {};
+        rectangle.area_id     = id;
+        rectangle.upper_left  = {113.0 + unit(random) * 2.0, 22.0 + unit(random) * 2.0, 0.0f};
+        rectangle.lower_right = {rectangle.upper_left.longitude + unit(random) * 0.05,
+                                 rectangle.upper_left.latitude - unit(random) * 0.05, 0.0f};
+        mixed->AddRectangleArea(rectangle);
+    }
+    for (uint32_t id = 1; id <= 100; ++id) {
+        libjt808::Route route {};
+        route.route_id = id;
+        libjt808::LocationPoint point = {113.0 + unit(random) * 2.0, 22.0 + unit(random) * 2.0, 0.0f};
+        for (uint32_t i = 0; i < 40; ++i) {
+            libjt808::RouteTurningPoint turning_point {};
+            turning_point.road_section_id = i;
+            turning_point.point           = point;
+            turning_point.road_width      = 50;
+            route.turning_points.push_back(turning_point);
+            point.longitude += (unit(random) - 0.5) * 0.05;
+            point.latitude += (unit(random) - 0.5) * 0.05;
+        }
+        mixed->AddRoute(route);
+    }
+    cases->push_back({"geofence/locate/mixed_9100_areas", 0, [mixed, points](uint64_t const& iterations) {
+                          std::vector<libjt808::GeofenceHit> hits;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              mixed->Locate((*points)[i % kPointCount], &hits);
+                              DoNotOptimize(hits);
+                          }
+                      }});
+    // Rule evaluation over the same polygons with speed limits and in/out alarms, fixes round robin over 30000
+    // terminals.
+    auto rules = std::make_shared<libjt808::AreaRuleEngine>();
+    for (auto item : *areas) {
+        auto& attribute               = item.second.area_attribute.bit;
+        attribute.speed_limit         = 1;
+        attribute.in_alarm_to_server  = 1;
+        attribute.out_alarm_to_server = 1;
+        item.second.max_speed         = 60;
+        item.second.overspeed_time    = 10;
+        rules->AddPolygonArea(item.second);
+    }
+    auto terminals = std::make_shared<std::vector<std::string>>();
+    for (int i = 0; i < 30000; ++i)
+        terminals->push_back(std::to_string(13300000000ull + i));
+    cases->push_back({"area_rule/process/30000_terminals", 0, [rules, points, terminals](uint64_t const& iterations) {
+                          std::vector<libjt808::AreaAlarm> alarms;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              alarms.clear();
+                              rules->Process((*terminals)[i % terminals->size()], (*points)[i % kPointCount],
+                                             static_cast<int64_t>(i), static_cast<uint16_t>(400 + i % 400), &alarms);
+                              DoNotOptimize(alarms);
+                          }
+                      }});
+    // The ray casting of examples/jt808_in_out_polygon_area_report.cc against every area, for comparison.
+    cases->push_back({"geofence/linear_scan/5000_areas", 0, [areas, points](uint64_t const& iterations) {
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              auto const& point     = (*points)[i % kPointCount];
+                              double      latitude  = point.latitude * 1e-6;
+                              double      longitude = point.longitude * 1e-6;
+                              size_t      hits      = 0;
+                              for (auto const& item : *areas) {
+                                  auto const& vertices = item.second.vertices;
+                                  bool        inside   = false;
+                                  for (size_t j = 0, k = vertices.size() - 1; j < vertices.size(); k = j++) {
+                                      auto const& a = vertices[j];
+                                      auto const& b = vertices[k];
+                                      if ((a.latitude > latitude) != (b.latitude > latitude) &&
+                                          longitude < a.longitude + (b.longitude - a.longitude) *
+                                                                        (latitude - a.latitude) /
+                                                                        (b.latitude - a.latitude)) {
+                                          inside = !inside;
+                                      }
+                                  }
+                                  hits += inside;
+                              }
+                              DoNotOptimize(hits);
+                          }
+                      }});
+    // A blind zone backlog: a track of close points against one 60 vertex area, per operation one point.
+    auto polygon = std::make_shared<libjt808::PreparedPolygon>();
+    auto track   = std::make_shared<libjt808::GeoPointBatch>();
+    {
+        libjt808::PolygonArea area;
+        for (int i = 0; i < 60; ++i) {
+            double angle = 2 * M_PI * i / 60;
+            double r     = 0.05 * (0.6 + 0.4 * unit(random));
+            area.vertices.push_back({113.0 + r * cos(angle), 22.0 + r * sin(angle), 0.0f});
+        }
+        polygon->Init(area);
+        libjt808::GeoPoint point = {libjt808::DegreesToGeo(21.94), libjt808::DegreesToGeo(112.94)};
+        for (size_t i = 0; i < kPointCount; ++i) {
+            point.latitude += static_cast<int32_t>(random() % 61) - 15;
+            point.longitude += static_cast<int32_t>(random() % 61) - 15;
+            track->Append(point);
+        }
+    }
+    cases->push_back({"geofence/contains/track", 0, [polygon, track](uint64_t const& iterations) {
+                          size_t hits = 0;
+                          for (uint64_t i = 0; i < iterations; ++i) {
+                              size_t j = i % kPointCount;
+                              hits += polygon->Contains({track->latitudes[j], track->longitudes[j]});
+                          }
+                          DoNotOptimize(hits);
+                      }});
+    for (int simd = 0; simd < 2; ++simd) {
+        if (simd && !libjt808::GeofenceSimdSupported())
+            break;
+        std::string name = simd ? "geofence/contains_batch/track/avx2" : "geofence/contains_batch/track/scalar";
+        cases->push_back({name, 0, [polygon, track, simd](uint64_t const& iterations) {
+                              std::vector<uint8_t> inside(track->size());
+                              for (uint64_t i = 0; i < iterations; i += track->size()) {
+                                  size_t count = static_cast<size_t>(std::min<uint64_t>(track->size(), iterations - i));
+                                  polygon->ContainsBatch(track->latitudes.data(), track->longitudes.data(), count,
+                                                         inside.data(), simd != 0);
+                                  DoNotOptimize(inside);
+                              }
+                          }});
+    }
+}
+
+int ParseOptions(int argc, char** argv, BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--filter=", 9) == 0) {
+            options->filter = argv[i] + 9;
+        }
+        else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+            options->min_time_ms = atof(argv[i] + 11);
+        }
+        else if (strncmp(argv[i], "--repetitions=", 14) == 0) {
+            options->repetitions = std::max(1, atoi(argv[i] + 14));
+        }
+        else if (strcmp(argv[i], "--list") == 0) {
+            options->list = true;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--filter=SUBSTRING] [--min-time=MS] [--repetitions=N] [--list]\n", argv[0]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (ParseOptions(argc, argv, &options) < 0)
+        return -1;
+#if !defined(__OPTIMIZE__)
+    fprintf(stderr, "Warning: benchmark built without optimization, configure with -DCMAKE_BUILD_TYPE=Release\n");
+#endif
+    // Run context first, results are only comparable between runs with the same context.
+#if defined(__VERSION__)
+    char const* compiler = __VERSION__;
+#else
+    char const* compiler = "unknown";
+#endif
+#if defined(__OPTIMIZE__)
+    bool optimized = true;
+#else
+    bool optimized = false;
+#endif
+    if (!options.list) {
+        printf("{\"context\":{\"compiler\":\"%s\",\"optimized\":%s,\"min_time_ms\":%.0f,\"repetitions\":%d}}\n",
+               compiler, optimized ? "true" : "false", options.min_time_ms, options.repetitions);
+    }
+    std::vector<BenchCase> cases;
+    AddFrameCases(&cases);
+    AddUtilCases(&cases);
+    AddBcdCases(&cases);
+    AddTerminalParameterCases(&cases);
+    AddGeofenceCases(&cases);
+    for (auto const& bench : cases) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos)
+            continue;
+        if (options.list) {
+            printf("%s\n", bench.name.c_str());
+            continue;
+        }
+        if (!bench.run) {
+            PrintError(bench.name, "corpus frame failed to package or parse");
+            continue;
+        }
+        RunCase(bench, options);
+    }
+    return 0;
+}
@@ -0,0 +1,326 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  jt808_server_bench.cc
+// @Version :  1.0
+// @Time    :  2026/10/16 20:05:47
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+// End-to-end server benchmark over loopback.
+// For each connection count, starts a JT808Server in-process, connects that many simulated terminals reporting
+// 0x0200 at a fixed rate, and measures the sustained acknowledged message rate, the ack latency percentiles, the
+// server CPU time per 10k messages and the resident memory per connection.
+// One JSON object per connection count is printed on stdout:
+//     {"connections":1000,"online":1000,"msgs_per_sec":...,"rtt_p50_us":...,"server_cpu_ms_per_10k_msgs":...,...}
+// Usage:
+//     jt808_server_bench [--connections=1000,10000,100000] [--duration=SEC] [--warmup-timeout=SEC]
+//                        [--report-interval=MS] [--threads=N] [--connect-rate=N] [--port=PORT]
+//
+// Each connection count runs in its own child process. Server CPU time is the process CPU time minus the time of the simulator threads ("jt808-sim"). Resident memory is
+// measured for the whole process, so the per connection figure includes the simulated terminal side.
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jt808/server.h"
+#include "jt808/simulator.h"
+
+namespace {
+
+// Terminals per loopback source address, below the default ephemeral port range.
+constexpr uint32_t kTerminalsPerSourceIp = 20000;
+
+struct BenchOptions {
+    std::vector<uint32_t> connections     = {1000, 10000, 100000};
+    uint32_t              duration        = 10;   // Measuring time in seconds.
+    uint32_t              warmup_timeout  = 120;  // Time allowed to connect all terminals, in seconds.
+    uint32_t              report_interval = 1000; // 0x0200 interval per terminal in milliseconds.
+    int                   threads         = 1;    // Simulator worker threads.
+    uint32_t              connect_rate    = 5000; // New connections per second.
+    int                   port            = 18808;
+};
+
+// CPU time of the process and of the simulator threads, in milliseconds.
+void GetCpuTime(double* process_ms, double* simulator_ms) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    *process_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+                  (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+    *simulator_ms = 0;
+    double tick_ms = 1e3 / sysconf(_SC_CLK_TCK);
+    DIR*   dir     = opendir("/proc/self/task");
+    if (dir == nullptr)
+        return;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.')
+            continue;
+        std::string path = std::string("/proc/self/task/") + entry->d_name + "/stat";
+        FILE*       file = fopen(path.c_str(), "r");
+        if (file == nullptr)
+            continue;
+        char buffer[512] = {0};
+        auto len         = fread(buffer, 1, sizeof(buffer) - 1, file);
+        fclose(file);
+        buffer[len] = 0;
+        // "tid (comm) state ...", utime and stime are the 14th and 15th fields.
+        char* name_begin = strchr(buffer, '(');
+        char* name_end   = strrchr(buffer, ')');
+        if (name_begin == nullptr || name_end == nullptr)
+            continue;
+        if (std::string(name_begin + 1, name_end) != "jt808-sim")
+            continue;
+        unsigned long utime = 0;
+        unsigned long stime = 0;
+        if (sscanf(name_end + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) == 2)
+            *simulator_ms += (utime + stime) * tick_ms;
+    }
+    closedir(dir);
+}
+
+// Resident set size of the process in kilobytes.
+uint64_t GetRssKb(void) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file == nullptr)
+        return 0;
+    char     line[256];
+    uint64_t rss = 0;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            rss = strtoull(line + 6, nullptr, 10);
+            break;
+        }
+    }
+    fclose(file);
+    return rss;
+}
+
+void PrintError(FILE* out, uint32_t const& connections, char const* error) {
+    fprintf(out, "{\"connections\":%u,\"error\":\"%s\"}\n", connections, error);
+    fflush(out);
+}
+
+// Run one connection count and write its result line to out.
+void RunStep(uint32_t const& connections, int const& port, BenchOptions const& options, FILE* out) {
+    // Both ends of every connection live in this process.
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < 2ull * connections + 64) {
+        PrintError(out, connections, "RLIMIT_NOFILE below two descriptors per connection");
+        return;
+    }
+    uint64_t              rss_before = GetRssKb();
+    libjt808::JT808Server server;
+    server.Init();
+    server.set_message_display(false);
+    server.SetServerAccessPoint("127.0.0.1", port);
+    if (server.InitServer() < 0) {
+        PrintError(out, connections, "server init failed");
+        return;
+    }
+    server.Run();
+
+    libjt808::SimulatorOptions sim_options;
+    sim_options.server_ip          = "127.0.0.1";
+    sim_options.server_port        = port;
+    sim_options.terminal_count     = connections;
+    sim_options.thread_count       = options.threads;
+    sim_options.connect_rate       = options.connect_rate;
+    sim_options.report_interval    = options.report_interval;
+    sim_options.heartbeat_interval = 0;
+    sim_options.response_timeout   = 30000;
+    sim_options.reconnect_delay    = 0;
+    // The whole 127.0.0.0/8 block is local on Linux, spread the terminals to have enough ephemeral ports.
+    for (uint32_t i = 0; i * kTerminalsPerSourceIp < connections; ++i)
+        sim_options.source_ips.push_back("127.0.0." + std::to_string(i + 1));
+
+    libjt808::TerminalSimulator   simulator;
+    libjt808::SimulatorStatistics stats;
+    if (simulator.Init(sim_options) < 0 || simulator.Run() < 0) {
+        PrintError(out, connections, "simulator start failed");
+        server.Stop();
+        return;
+    }
+    // Warm up until every terminal is online, or no progress is possible anymore.
+    auto begin = std::chrono::steady_clock::now();
+    while (1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        simulator.GetStatistics(&stats, false);
+        auto finished = stats.online + stats.connect_failures + stats.auth_failures;
+        if (finished >= connections ||
+            std::chrono::steady_clock::now() - begin >= std::chrono::seconds(options.warmup_timeout))
+            break;
+    }
+    double   connect_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    uint64_t rss_online  = GetRssKb();
+
+    // Measure.
+    libjt808::SimulatorStatistics start;
+    double                        process_ms_begin   = 0;
+    double                        simulator_ms_begin = 0;
+    simulator.GetStatistics(&start, true);
+    GetCpuTime(&process_ms_begin, &simulator_ms_begin);
+    auto measure_begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(options.duration));
+    simulator.GetStatistics(&stats, true);
+    double process_ms_end   = 0;
+    double simulator_ms_end = 0;
+    GetCpuTime(&process_ms_end, &simulator_ms_end);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - measure_begin).count();
+
+    simulator.Stop();
+    server.Stop();
+
+    auto   acked         = stats.received_messages - start.received_messages;
+    auto   sent          = stats.sent_messages - start.sent_messages;
+    double server_cpu_ms = (process_ms_end - process_ms_begin) - (simulator_ms_end - simulator_ms_begin);
+    double online        = static_cast<double>(start.online ? start.online : 1);
+    fprintf(out, "{\"connections\":%u,\"online\":%llu,\"connect_failures\":%llu,\"auth_failures\":%llu,"
+           "\"connect_sec\":%.2f,\"duration_sec\":%.2f,\"offered_msgs_per_sec\":%.0f,\"msgs_per_sec\":%.0f,"
+           "\"timeouts\":%llu,\"disconnects\":%llu,\"rtt_p50_us\":%llu,\"rtt_p99_us\":%llu,\"rtt_p999_us\":%llu,"
+           "\"rtt_max_us\":%llu,\"server_cpu_percent\":%.1f,\"server_cpu_ms_per_10k_msgs\":%.2f,"
+           "\"simulator_cpu_percent\":%.1f,\"rss_kb_per_connection\":%.2f}\n",
+           connections, static_cast<unsigned long long>(start.online),
+           static_cast<unsigned long long>(start.connect_failures),
+           static_cast<unsigned long long>(start.auth_failures), connect_sec, elapsed, sent / elapsed,
+           acked / elapsed, static_cast<unsigned long long>(stats.timeouts - start.timeouts),
+           static_cast<unsigned long long>(stats.disconnects - start.disconnects),
+           static_cast<unsigned long long>(stats.rtt.Percentile(50)),
+           static_cast<unsigned long long>(stats.rtt.Percentile(99)),
+           static_cast<unsigned long long>(stats.rtt.Percentile(99.9)),
+           static_cast<unsigned long long>(stats.rtt.max()), server_cpu_ms / elapsed / 10,
+           acked ? server_cpu_ms * 1e4 / acked : 0.0,
+           (simulator_ms_end - simulator_ms_begin) / elapsed / 10,
+           rss_online > rss_before ? (rss_online - rss_before) / online : 0.0);
+    fflush(out);
+}
+
+int ParseOptions(int argc, char** argv, BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        char const* arg = argv[i];
+        if (strncmp(arg, "--connections=", 14) == 0) {
+            options->connections.clear();
+            char* end = nullptr;
+            for (char const* pos = arg + 14; *pos; pos = (*end == ',') ? end + 1 : end) {
+                auto value = strtoul(pos, &end, 10);
+                if (end == pos)
+                    return -1;
+                options->connections.push_back(static_cast<uint32_t>(value));
+            }
+        }
+        else if (strncmp(arg, "--duration=", 11) == 0) {
+            options->duration = strtoul(arg + 11, nullptr, 10);
+        }
+        else if (strncmp(arg, "--warmup-timeout=", 17) == 0) {
+            options->warmup_timeout = strtoul(arg + 17, nullptr, 10);
+        }
+        else if (strncmp(arg, "--report-interval=", 18) == 0) {
+            options->report_interval = strtoul(arg + 18, nullptr, 10);
+        }
+        else if (strncmp(arg, "--threads=", 10) == 0) {
+            options->threads = atoi(arg + 10);
+        }
+        else if (strncmp(arg, "--connect-rate=", 15) == 0) {
+            options->connect_rate = strtoul(arg + 15, nullptr, 10);
+        }
+        else if (strncmp(arg, "--port=", 7) == 0) {
+            options->port = atoi(arg + 7);
+        }
+        else {
+            return -1;
+        }
+    }
+    return options->connections.empty() || options->threads <= 0 ? -1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (ParseOptions(argc, argv, &options) < 0) {
+        fprintf(stderr,
+                "Usage: %s [--connections=1000,10000,100000] [--duration=SEC] [--warmup-timeout=SEC]\n"
+                "       [--report-interval=MS] [--threads=N] [--connect-rate=N] [--port=PORT]\n",
+                argv[0]);
+        return -1;
+    }
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    signal(SIGPIPE, SIG_IGN);
+    printf("{\"context\":{\"duration_sec\":%u,\"report_interval_ms\":%u,\"simulator_threads\":%d,"
+           "\"connect_rate\":%u,\"cpus\":%u}}\n",
+           options.duration, options.report_interval, options.threads, options.connect_rate,
+           std::thread::hardware_concurrency());
+    fflush(stdout);
+    // Every step runs in a child process, so it starts from a fresh server and its memory and CPU usage are not
+    // mixed with the previous steps. The server logs go to stderr, the result comes back through a pipe.
+    // A fresh port per step, the previous server may still hold its port in TIME_WAIT.
+    int port = options.port;
+    for (auto const& connections : options.connections) {
+        int fds[2];
+        if (pipe(fds) < 0)
+            return -1;
+        pid_t pid = fork();
+        if (pid < 0)
+            return -1;
+        if (pid == 0) {
+            close(fds[0]);
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+            FILE* out = fdopen(fds[1], "w");
+            RunStep(connections, port, options, out);
+            fclose(out);
+            _exit(0);
+        }
+        close(fds[1]);
+        std::string result;
+        char        buffer[1024];
+        ssize_t     len = 0;
+        while ((len = read(fds[0], buffer, sizeof(buffer))) > 0)
+            result.append(buffer, len);
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (result.empty())
+            PrintError(stdout, connections, "benchmark process terminated abnormally");
+        else
+            fputs(result.c_str(), stdout);
+        fflush(stdout);
+        ++port;
+    }
+    return 0;
+}
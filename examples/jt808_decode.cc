@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  jt808_decode.cc
+// @Version :  1.0
+// @Time    :  2026/11/06 15:02:19
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include <getopt.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "jt808/capture_decoder.h"
+#include "jt808/track_store.h"
+
+namespace {
+
+void Usage(char const* name) {
+    printf("Usage: %s [options] CAPTURE...\n"
+           "Decode captures on all cores, e.g. of jt808_load_generator -e -C PATH.\n"
+           "  -t, --threads N               decoding threads, default one per core\n"
+           "  -c, --chunk MB                megabytes of a capture decoded as a chunk, default 8\n"
+           "  -o, --tracks DIR              rebuild the location history of the terminals in the track store at DIR\n"
+           "  -h, --help                    show this help\n",
+           name);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string             tracks_dir;
+    libjt808::DecodeOptions options;
+    struct option const     long_options[] = {
+        {"threads", required_argument, nullptr, 't'},
+        {"chunk", required_argument, nullptr, 'c'},
+        {"tracks", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt = 0;
+    while ((opt = getopt_long(argc, argv, "t:c:o:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 't': options.threads = atoi(optarg); break;
+            case 'c': options.chunk_bytes = static_cast<size_t>(atof(optarg) * (1 << 20)); break;
+            case 'o': tracks_dir = optarg; break;
+            case 'h':
+            default: Usage(argv[0]); return opt == 'h' ? 0 : -1;
+        }
+    }
+    if (optind >= argc) {
+        Usage(argv[0]);
+        return -1;
+    }
+    std::vector<std::string> paths(argv + optind, argv + argc);
+
+    libjt808::TrackStore tracks;
+    if (!tracks_dir.empty() && tracks.Open(tracks_dir) < 0) {
+        printf("Open track store %s failed!!!\n", tracks_dir.c_str());
+        return -1;
+    }
+    // Called on the decoding threads, the track store is thread safe.
+    auto const sink = [&tracks](libjt808::DecodedChunk const& chunk) {
+        if (!tracks.is_open())
+            return;
+        auto const& messages  = chunk.messages;
+        auto const& locations = chunk.locations;
+        for (size_t i = 0; i < locations.size(); ++i) {
+            libjt808::TrackPoint point;
+            point.timestamp = locations.timestamp[i];
+            point.latitude  = locations.latitude[i];
+            point.longitude = locations.longitude[i];
+            point.altitude  = locations.altitude[i];
+            point.speed     = locations.speed[i];
+            point.bearing   = locations.bearing[i];
+            point.alarm     = locations.alarm[i];
+            point.status    = locations.status[i];
+            tracks.Append(messages.phones[messages.phone[locations.message[i]]], point);
+        }
+    };
+    libjt808::DecodeStats stats;
+    int                   ret = libjt808::DecodeCaptures(paths, options, sink, &stats);
+    tracks.Close();
+    if (ret < 0) {
+        printf("Decode failed!!!\n");
+        return -1;
+    }
+    printf("frames=%llu messages=%llu pending=%llu errors=%llu locations=%llu chunks=%llu steals=%llu\n",
+           static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.messages),
+           static_cast<unsigned long long>(stats.pending), static_cast<unsigned long long>(stats.errors),
+           static_cast<unsigned long long>(stats.locations), static_cast<unsigned long long>(stats.chunks),
+           static_cast<unsigned long long>(stats.steals));
+    printf("%.3f s, %.0f frames/s, %.2f MB/s\n", stats.seconds, stats.seconds > 0 ? stats.frames / stats.seconds : 0,
+           stats.seconds > 0 ? stats.bytes / stats.seconds / 1e6 : 0);
+    return 0;
+}
@@ -0,0 +1,278 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  jt808_load_generator.cc
+// @Version :  1.0
+// @Time    :  2026/10/16 17:02:31
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include <getopt.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#include "jt808/server.h"
+#include "jt808/simulator.h"
+
+namespace {
+
+std::atomic_bool g_quit(false);
+
+void SignalHandler(int) {
+    g_quit.store(true);
+}
+
+void Usage(char const* name) {
+    printf("Usage: %s [options]\n"
+           "  -s, --server IP:PORT          platform address, default 127.0.0.1:8888\n"
+           "  -n, --terminals N             number of virtual terminals, default 1\n"
+           "  -t, --threads N               worker threads, default 1\n"
+           "  -p, --phone-start NUM         phone number of the first terminal, default 13300000000\n"
+           "  -b, --source-ips IP[,IP...]   local addresses to bind, round robin\n"
+           "  -c, --connect-rate N          new connections per second, 0 is unlimited, default 1000\n"
+           "  -r, --report-interval MS      0x0200 interval, 0 disables, default 1000\n"
+           "  -H, --heartbeat-interval MS   0x0002 interval, 0 disables, default 30000\n"
+           "  -B, --batch-interval MS       0x0704 interval, 0 disables, default 0\n"
+           "  -S, --batch-size N            locations per 0x0704, default 10\n"
+           "  -m, --media-interval MS       0x0801 upload interval, 0 disables, default 0\n"
+           "  -M, --media-size BYTES        bytes per multimedia upload, default 16384\n"
+           "  -d, --duration SEC            run time, 0 runs until interrupted, default 0\n"
+           "  -e, --embedded-server         start a JT808Server in this process\n"
+           "  -P, --metrics-port PORT       serve the embedded server metrics over HTTP on 127.0.0.1:PORT\n"
+           "  -R, --session-store PATH      keep the embedded server terminal sessions in PATH across runs\n"
+           "  -w, --server-processes N      embedded server processes sharing the port with SO_REUSEPORT, default 1\n"
+           "  -C, --capture PATH            capture the frames received by the embedded server to PATH\n"
+           "  -h, --help                    show this help\n",
+           name);
+}
+
+void PrintRtt(char const* title, libjt808::LatencyHistogram const& rtt) {
+    printf("%s rtt(us) n=%llu p50=%llu p99=%llu p999=%llu max=%llu\n", title,
+           static_cast<unsigned long long>(rtt.count()), static_cast<unsigned long long>(rtt.Percentile(50)),
+           static_cast<unsigned long long>(rtt.Percentile(99)), static_cast<unsigned long long>(rtt.Percentile(99.9)),
+           static_cast<unsigned long long>(rtt.max()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    libjt808::SimulatorOptions options;
+    uint32_t                   duration        = 0;
+    bool                       embedded_server = false;
+    int                        metrics_port    = 0;
+    std::string                session_store;
+    std::string                capture;
+    int                        server_processes = 1;
+    struct option const        long_options[]  = {
+        {"server", required_argument, nullptr, 's'},
+        {"terminals", required_argument, nullptr, 'n'},
+        {"threads", required_argument, nullptr, 't'},
+        {"phone-start", required_argument, nullptr, 'p'},
+        {"source-ips", required_argument, nullptr, 'b'},
+        {"connect-rate", required_argument, nullptr, 'c'},
+        {"report-interval", required_argument, nullptr, 'r'},
+        {"heartbeat-interval", required_argument, nullptr, 'H'},
+        {"batch-interval", required_argument, nullptr, 'B'},
+        {"batch-size", required_argument, nullptr, 'S'},
+        {"media-interval", required_argument, nullptr, 'm'},
+        {"media-size", required_argument, nullptr, 'M'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"embedded-server", no_argument, nullptr, 'e'},
+        {"metrics-port", required_argument, nullptr, 'P'},
+        {"session-store", required_argument, nullptr, 'R'},
+        {"server-processes", required_argument, nullptr, 'w'},
+        {"capture", required_argument, nullptr, 'C'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt = 0;
+    while ((opt = getopt_long(argc, argv, "s:n:t:p:b:c:r:H:B:S:m:M:d:eP:R:w:C:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 's': {
+                std::string address(optarg);
+                auto        pos = address.find(':');
+                options.server_ip = address.substr(0, pos);
+                if (pos != std::string::npos)
+                    options.server_port = atoi(address.c_str() + pos + 1);
+                break;
+            }
+            case 'n': options.terminal_count = strtoul(optarg, nullptr, 10); break;
+            case 't': options.thread_count = atoi(optarg); break;
+            case 'p': options.first_phone_num = strtoull(optarg, nullptr, 10); break;
+            case 'b': {
+                std::stringstream ss(optarg);
+                std::string       ip;
+                while (std::getline(ss, ip, ','))
+                    if (!ip.empty())
+                        options.source_ips.push_back(ip);
+                break;
+            }
+            case 'c': options.connect_rate = strtoul(optarg, nullptr, 10); break;
+            case 'r': options.report_interval = strtoul(optarg, nullptr, 10); break;
+            case 'H': options.heartbeat_interval = strtoul(optarg, nullptr, 10); break;
+            case 'B': options.batch_interval = strtoul(optarg, nullptr, 10); break;
+            case 'S': options.batch_size = static_cast<uint16_t>(strtoul(optarg, nullptr, 10)); break;
+            case 'm': options.multimedia_interval = strtoul(optarg, nullptr, 10); break;
+            case 'M': options.multimedia_size = strtoul(optarg, nullptr, 10); break;
+            case 'd': duration = strtoul(optarg, nullptr, 10); break;
+            case 'e': embedded_server = true; break;
+            case 'P': metrics_port = atoi(optarg); break;
+            case 'R': session_store = optarg; break;
+            case 'C': capture = optarg; break;
+            case 'w': server_processes = atoi(optarg); break;
+            case 'h':
+            default: Usage(argv[0]); return opt == 'h' ? 0 : -1;
+        }
+    }
+    // One descriptor per terminal, plus the platform side when embedded.
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    signal(SIGINT, SignalHandler);
+    signal(SIGTERM, SignalHandler);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (server_processes > 1 && (!embedded_server || !session_store.empty())) {
+        printf("Server processes need an embedded server without a session store!!!\n");
+        return -1;
+    }
+    // Further embedded servers run in child processes forked before any thread starts, the kernel spreads the
+    // connections over their listening sockets and the session directory tells them apart.
+    std::string const directory = "/tmp/jt808_load_generator." + std::to_string(getpid()) + ".dir";
+    std::vector<pid_t> children;
+    for (int i = 1; i < server_processes; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            libjt808::JT808Server child;
+            child.Init();
+            child.set_message_display(false);
+            child.set_reuse_port(true);
+            child.SetServerAccessPoint(options.server_ip, options.server_port);
+            if (child.OpenSessionDirectory(directory) < 0 || child.InitServer() < 0)
+                _exit(1);
+            child.Run();
+            while (!g_quit.load())
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            child.Stop();
+            _exit(0);
+        }
+        if (pid > 0)
+            children.push_back(pid);
+    }
+
+    libjt808::JT808Server         server;
+    libjt808::MetricsHttpExporter exporter;
+    if (embedded_server) {
+        server.Init();
+        server.set_message_display(false);
+        server.SetServerAccessPoint(options.server_ip, options.server_port);
+        if (server_processes > 1) {
+            server.set_reuse_port(true);
+            if (server.OpenSessionDirectory(directory) < 0) {
+                printf("Open session directory failed!!!\n");
+                return -1;
+            }
+        }
+        if (!session_store.empty() && server.OpenSessionStore(session_store) < 0) {
+            printf("Open session store failed!!!\n");
+            return -1;
+        }
+        if (!capture.empty() && server.OpenCapture(capture) < 0) {
+            printf("Open capture failed!!!\n");
+            return -1;
+        }
+        if (server.InitServer() < 0) {
+            printf("Start embedded server failed!!!\n");
+            return -1;
+        }
+        server.Run();
+        if (metrics_port > 0 && exporter.Start(&server.metrics(), "127.0.0.1", metrics_port) < 0) {
+            printf("Start metrics exporter failed!!!\n");
+            return -1;
+        }
+    }
+    libjt808::TerminalSimulator simulator;
+    if (simulator.Init(options) < 0 || simulator.Run() < 0) {
+        printf("Start simulator failed!!!\n");
+        return -1;
+    }
+    printf("%u terminals, %d threads, %s:%d\n", options.terminal_count, options.thread_count,
+           options.server_ip.c_str(), options.server_port);
+    libjt808::SimulatorStatistics last = {};
+    libjt808::SimulatorStatistics stats;
+    libjt808::LatencyHistogram    total_rtt;
+    auto                          begin = std::chrono::steady_clock::now();
+    uint32_t                      elapsed = 0;
+    while (!g_quit.load() && (duration == 0 || elapsed < duration)) {
+        std::this_thread::sleep_until(begin + std::chrono::seconds(elapsed + 1));
+        ++elapsed;
+        simulator.GetStatistics(&stats, true);
+        total_rtt.Merge(stats.rtt);
+        printf("[%4us] online=%llu connects=%llu/s tx=%llu msg/s rx=%llu msg/s tx=%.2f MB/s loc=%llu/s batch=%llu/s "
+               "media=%llu/s fail=%llu/%llu resume=%llu drop=%llu timeout=%llu | ",
+               elapsed, static_cast<unsigned long long>(stats.online),
+               static_cast<unsigned long long>(stats.connects - last.connects),
+               static_cast<unsigned long long>(stats.sent_messages - last.sent_messages),
+               static_cast<unsigned long long>(stats.received_messages - last.received_messages),
+               (stats.sent_bytes - last.sent_bytes) / 1e6,
+               static_cast<unsigned long long>(stats.location_reports - last.location_reports),
+               static_cast<unsigned long long>(stats.batch_reports - last.batch_reports),
+               static_cast<unsigned long long>(stats.multimedia_uploads - last.multimedia_uploads),
+               static_cast<unsigned long long>(stats.connect_failures),
+               static_cast<unsigned long long>(stats.auth_failures),
+               static_cast<unsigned long long>(stats.resumes), static_cast<unsigned long long>(stats.disconnects),
+               static_cast<unsigned long long>(stats.timeouts));
+        PrintRtt("interval", stats.rtt);
+        fflush(stdout);
+        last = stats;
+    }
+    simulator.Stop();
+    exporter.Stop();
+    if (embedded_server)
+        server.Stop();
+    for (auto const& pid : children) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    if (!children.empty())
+        unlink(directory.c_str());
+    printf("total: sent=%llu received=%llu loc=%llu batch=%llu media=%llu timeout=%llu\n",
+           static_cast<unsigned long long>(last.sent_messages),
+           static_cast<unsigned long long>(last.received_messages),
+           static_cast<unsigned long long>(last.location_reports),
+           static_cast<unsigned long long>(last.batch_reports),
+           static_cast<unsigned long long>(last.multimedia_uploads), static_cast<unsigned long long>(last.timeouts));
+    PrintRtt("total", total_rtt);
+    return 0;
+}
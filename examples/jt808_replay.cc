@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  jt808_replay.cc
+// @Version :  1.0
+// @Time    :  2026/11/03 16:40:12
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include <getopt.h>
+#include <signal.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "jt808/capture.h"
+
+namespace {
+
+void Usage(char const* name) {
+    printf("Usage: %s -f PATH [options]\n"
+           "Parse the frames of a capture, or send them to a server with -s.\n"
+           "  -f, --file PATH               capture, e.g. of jt808_load_generator -e -C PATH\n"
+           "  -s, --server IP:PORT          replay to the server at IP:PORT instead of parsing\n"
+           "  -t, --threads N               replay threads, each with its share of the connections, default 1\n"
+           "  -x, --speed N                 1 replays in real time, N N times faster, 0 as fast as possible,\n"
+           "                                default 0\n"
+           "  -h, --help                    show this help\n",
+           name);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string             path;
+    std::string             server_ip;
+    int                     server_port = 0;
+    libjt808::ReplayOptions options;
+    struct option const     long_options[] = {
+        {"file", required_argument, nullptr, 'f'},
+        {"server", required_argument, nullptr, 's'},
+        {"threads", required_argument, nullptr, 't'},
+        {"speed", required_argument, nullptr, 'x'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt = 0;
+    while ((opt = getopt_long(argc, argv, "f:s:t:x:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'f': path = optarg; break;
+            case 's': {
+                std::string address(optarg);
+                auto        pos = address.find(':');
+                server_ip       = address.substr(0, pos);
+                if (pos != std::string::npos)
+                    server_port = atoi(address.c_str() + pos + 1);
+                break;
+            }
+            case 't': options.threads = atoi(optarg); break;
+            case 'x': options.speed = atof(optarg); break;
+            case 'h':
+            default: Usage(argv[0]); return opt == 'h' ? 0 : -1;
+        }
+    }
+    if (path.empty()) {
+        Usage(argv[0]);
+        return -1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    libjt808::CaptureReader capture;
+    if (capture.Open(path) < 0) {
+        printf("Open capture %s failed!!!\n", path.c_str());
+        return -1;
+    }
+    libjt808::ReplayStats stats;
+    int ret = server_ip.empty() ? libjt808::ReplayParse(capture, options, &stats)
+                                : libjt808::ReplayToServer(capture, server_ip, server_port, options, &stats);
+    if (ret < 0) {
+        printf("Replay failed!!!\n");
+        return -1;
+    }
+    printf("connections=%u frames=%llu messages=%llu pending=%llu errors=%llu responses=%llu\n", stats.connections,
+           static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.messages),
+           static_cast<unsigned long long>(stats.pending), static_cast<unsigned long long>(stats.errors),
+           static_cast<unsigned long long>(stats.responses));
+    printf("%.3f s, %.0f frames/s, %.2f MB/s\n", stats.seconds, stats.seconds > 0 ? stats.frames / stats.seconds : 0,
+           stats.seconds > 0 ? stats.bytes / stats.seconds / 1e6 : 0);
+    return 0;
+}
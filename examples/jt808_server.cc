@@ -30,6 +30,7 @@
 #include <iostream>
 #include <thread>
 
+#include "jt808/logger.h"
 #include "jt808/server.h"
 
 namespace {
@@ -42,11 +43,23 @@ int main(int argc, char** argv) {
     libjt808::JT808Server server;
     server.Init();
     server.SetServerAccessPoint("127.0.0.1", 8888);
-    if (server.InitServer() == 0) {
+    // Dump the received location reports and terminal parameters.
+    server.set_message_display(true);
+    libjt808::Logger::Instance().set_level(libjt808::kLogDebug);
+    // With a handoff path, e.g. ./jt808_server /tmp/jt808_handoff.sock, starting the server again with the same path
+    // takes over the connections of the running one, which then exits. Commands are not read in this mode.
+    char const* handoff_path = argc > 1 ? argv[1] : nullptr;
+    if ((handoff_path != nullptr && server.TakeOverServer(handoff_path) == 0) || server.InitServer() == 0) {
+        if (handoff_path != nullptr)
+            server.ServeHandoff(handoff_path);
         server.Run();
         std::string cmd;
         std::this_thread::sleep_for(std::chrono::seconds(1));
         while (server.service_is_running()) {
+            if (handoff_path != nullptr) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                continue;
+            }
             // std::this_thread::sleep_for(std::chrono::seconds(1));
             std::cin >> cmd;
             printf("cmd: %s\n", cmd.c_str());
@@ -40,6 +40,7 @@
 #include "jt808/packager.h"
 #include "jt808/parser.h"
 #include "jt808/terminal_parameter.h"
+#include "jt808/terminal_parameter_store.h"
 
 using std::cin;
 using std::cout;
@@ -121,6 +122,18 @@ inline int ParseTerminalParameterNtripCors(libjt808::TerminalParameters const& i
     return (ret > 0 ? 0 : -1);
 }
 
+// Parse Ntrip CORS differential station configuration from a compact store, as parsed from 0x8103/0x0104.
+// Args, returns:
+//    As above.
+inline int ParseTerminalParameterNtripCors(libjt808::TerminalParameterStore const& items, std::string* ip,
+                                           uint16_t* port, std::string* user, std::string* pwd, std::string* mp,
+                                           uint8_t* intv, uint8_t* startup) {
+    int ret = !items.Get(kNtripCorsIP, ip) && !items.Get(kNtripCorsPort, port) && !items.Get(kNtripCorsUser, user) &&
+              !items.Get(kNtripCorsPasswd, pwd) && !items.Get(kNtripCorsMountPoint, mp) &&
+              !items.Get(kNtripCorsGGAReportInterval, intv) && !items.Get(kNtripCorsStartup, startup);
+    return (ret > 0 ? 0 : -1);
+}
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -173,9 +186,7 @@ int main(int argc, char** argv) {
         return -1;
     }
     // Copy terminal parameters.
-    for (auto const& it : cli_para.parse.terminal_parameters) {
-        cli_para.terminal_parameters.insert(it);
-    }
+    cli_para.parse.terminal_parameter_store.Export(&cli_para.terminal_parameters);
     // Terminal generates a general response.
     cli_para.msg_head.msg_id = libjt808::kTerminalGeneralResponse;
     cli_para.respone_result  = libjt808::kSuccess;
@@ -218,7 +229,7 @@ int main(int argc, char** argv) {
         return -1;
     }
     // Output the parsed terminal parameters.
-    if (ParseTerminalParameterNtripCors(svr_para.parse.terminal_parameters, &ip, &port, &usr, &pwd, &mp, &intv,
+    if (ParseTerminalParameterNtripCors(svr_para.parse.terminal_parameter_store, &ip, &port, &usr, &pwd, &mp, &intv,
                                         &start_up) == 0) {
         cout << "Get all para: " << ip << ", " << port << ", " << usr << ", " << pwd << ", " << mp << ", "
              << std::to_string(intv) << ", " << std::to_string(start_up) << "\n";
@@ -262,13 +273,13 @@ int main(int argc, char** argv) {
     // for (auto const& uch : out) printf("%02X ", uch);
     // printf("\n");
     // Platform parses the response for querying terminal parameters.
-    svr_para.parse.terminal_parameters.clear();
+    svr_para.parse.terminal_parameter_store.Clear();
     if (libjt808::JT808FrameParse(jt808_parser, out, &svr_para)) {
         printf("Parse message failed\n");
         return -1;
     }
     // Output the parsed terminal parameters.
-    if (ParseTerminalParameterNtripCors(svr_para.parse.terminal_parameters, &ip, &port, &usr, &pwd, &mp, &intv,
+    if (ParseTerminalParameterNtripCors(svr_para.parse.terminal_parameter_store, &ip, &port, &usr, &pwd, &mp, &intv,
                                         &start_up) == 0) {
         cout << "Get special para: " << ip << ", " << port << ", " << usr << ", " << pwd << ", " << mp << ", "
              << std::to_string(intv) << ", " << std::to_string(start_up) << "\n";
@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  area_rule.h
+// @Version :  1.0
+// @Time    :  2026/10/19 09:26:47
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_AREA_RULE_H_
+#define JT808_AREA_RULE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "area_route.h"
+#include "geofence.h"
+#include "location_report.h"
+
+namespace libjt808 {
+
+// Convert a "YYMMDDhhmmss" time to seconds since 1970-01-01 00:00:00 of the same time zone, years are 20YY.
+// Returns 0 on success, -1 for a malformed time.
+int AreaTimeToSeconds(std::string const& time, int64_t* seconds);
+
+enum AreaAlarmKind {
+    kAreaAlarmAccess = 0x0, // Entered or left an area or route, see SetAccessAreaAlarmBody().
+    kAreaAlarmOverSpeed,    // Overspeed in an area or on a road section began, see SetOverSpeedAlarmBody().
+    kAreaAlarmOverSpeedEnd, // Overspeed of a previous kAreaAlarmOverSpeed ended.
+};
+
+// Alarm raised by the rule engine, the fields map onto the location additional information items.
+struct AreaAlarm {
+    AreaAlarmKind kind;
+    // kAccessAreaAlarmLocationType for access alarms, kOverSpeedAlarmLocationType for overspeed alarms.
+    uint8_t  location_type;
+    // Area or route ID, the road section ID for overspeed on a road section.
+    uint32_t area_route_id;
+    // Access alarms only, kAccessAreaAlarmDirectionType.
+    uint8_t  direction;
+    // The alarm is configured to be reported to the driver and/or the platform.
+    bool     to_driver;
+    bool     to_server;
+};
+
+// Encode the alarm as the body of its location additional information item, kAccessAreaAlarm or kOverSpeedAlarm.
+// Returns 0 on success, -1 on failure.
+int AreaAlarmBody(AreaAlarm const& alarm, uint8_t* item_id, std::vector<uint8_t>* out);
+
+// Area rule engine.
+// Evaluates the time windows, speed limits and in/out alarm flags of areas and routes against location fixes.
+// Time windows are parsed once into seconds when an area is added, a window whose date is "000000" repeats daily.
+// An area counts as holding a terminal only while its window is open. Per terminal the engine keeps the areas
+// holding it with the time its overspeed began, so a fix costs a lookup in the geofence engine plus a merge with the
+// previous state, independent of the number of areas.
+// Overspeed: the speed exceeds the limit of the area or road section for its overspeed time. Alarms are raised for
+// access only if the area has an in/out alarm flag set, overspeed alarms whenever a speed limit is set.
+// Not thread safe.
+//
+// Example:
+//     AreaRuleEngine engine;
+//     engine.AddPolygonAreas(polygon_area_set);
+//     std::vector<AreaAlarm> alarms;
+//     engine.Process(para.parse.msg_head.phone_num, para.parse.location_info, &alarms);
+//     for (auto const& alarm : alarms) ...
+class AreaRuleEngine {
+public:
+    // Args:
+    //     cell_degrees:  Grid cell size of the geofence engine in degrees.
+    explicit AreaRuleEngine(double const& cell_degrees = 0.05) : geofence_(cell_degrees) {
+    }
+
+    // Add or replace an area or route.
+    // Returns 0 on success, -1 for a malformed time window or geometry.
+    int AddPolygonArea(PolygonArea const& area);
+    int AddCircularArea(CircularArea const& area);
+    int AddRectangleArea(RectangleArea const& area);
+    int AddRoute(Route const& route);
+    // Returns 0 if every area was added, -1 otherwise.
+    int AddPolygonAreas(PolygonAreaSet const& areas);
+    int AddCircularAreas(CircularAreaSet const& areas);
+    int AddRectangleAreas(RectangleAreaSet const& areas);
+    int AddRoutes(RouteSet const& routes);
+    // No leave alarm is raised for terminals inside a removed area. Returns 0 on success, -1 if it does not exist.
+    int RemoveArea(uint8_t const& type, uint32_t const& area_id);
+    // Remove all areas and terminal states.
+    void Clear(void);
+
+    size_t area_count(void) const {
+        return rules_.size();
+    }
+
+    // Evaluate a fix and append the alarms it raises.
+    // Args:
+    //     time:  Seconds of the fix, as AreaTimeToSeconds().
+    //     speed:  1/10 km/h, as in the location report.
+    void Process(std::string const& terminal, GeoPoint const& point, int64_t const& time, uint16_t const& speed,
+                 std::vector<AreaAlarm>* alarms);
+    // Evaluate a parsed location report. Returns 0 on success, -1 if the parser found the time malformed.
+    int Process(std::string const& terminal, LocationBasicInformation const& location, std::vector<AreaAlarm>* alarms);
+    // Forget the state of a terminal, e.g. on disconnection.
+    void RemoveTerminal(std::string const& terminal);
+
+private:
+    // Time window and alarm flags of an area.
+    struct Rule {
+        bool    by_time;
+        bool    daily;         // Window of seconds within a day, may wrap past midnight.
+        int64_t start;         // Seconds, as AreaTimeToSeconds(), or seconds of the day if daily.
+        int64_t stop;
+        bool    in_to_driver;
+        bool    in_to_server;
+        bool    out_to_driver;
+        bool    out_to_server;
+    };
+
+    // Area holding a terminal.
+    struct State {
+        uint64_t key;             // Type and ID, as GeofenceEngine.
+        uint32_t road_section_id; // Road section of the overspeed, routes only.
+        int64_t  overspeed_since; // Time the overspeed began, -1 if not over the limit.
+        bool     overspeed_alarm; // kAreaAlarmOverSpeed raised and not yet ended.
+    };
+
+    static uint64_t Key(uint8_t const& type, uint32_t const& area_id) {
+        return (static_cast<uint64_t>(type) << 32) | area_id;
+    }
+
+    // Attribute is AreaAttribute or RouteAttribute bits, they name the time and alarm bits alike.
+    template <typename Attribute>
+    static int  MakeRule(Attribute const& attribute, std::string const& start_time, std::string const& stop_time,
+                         Rule* rule);
+    static bool IsOpen(Rule const& rule, int64_t const& time);
+
+    void Access(uint64_t const& key, Rule const& rule, bool const& entered, std::vector<AreaAlarm>* alarms) const;
+    void OverSpeedEnd(State const& state, std::vector<AreaAlarm>* alarms) const;
+
+    GeofenceEngine                                      geofence_;
+    std::unordered_map<uint64_t, Rule>                  rules_;
+    std::unordered_map<std::string, std::vector<State>> terminals_; // States ascending by key.
+    std::vector<GeofenceHit>                            hits_;
+    std::vector<State>                                  scratch_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_AREA_RULE_H_
@@ -30,6 +30,7 @@
 #ifndef JT808_BCD_H_
 #define JT808_BCD_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <string>
@@ -46,6 +47,46 @@ int      StringToBcd(std::string const& in, std::vector<uint8_t>* out);
 int      BcdToString(std::vector<uint8_t> const& in, std::string* out);
 int      BcdToStringFillZero(std::vector<uint8_t> const& in, std::string* out);
 
+// Fixed size BCD fields: the terminal phone number of the message header and the YYMMDDhhmmss times, BCD[6] each.
+// The codecs below are table driven, write into caller buffers and do not allocate.
+constexpr size_t kBcdPhoneSize = 6;
+constexpr size_t kBcdTimeSize  = 6;
+
+// Two decimal digits of each of size BCD bytes, 2 * size chars, not terminated.
+// Nibbles above 9 come out as the chars after '9'.
+void BcdToDigits(uint8_t const* bcd, size_t const& size, char* digits);
+// As above, returns 0 on success, -1 if a nibble is not decimal; the check is made once for the whole field.
+int  BcdToDigitsChecked(uint8_t const* bcd, size_t const& size, char* digits);
+// Pack len digits right aligned into size BCD bytes, leading nibbles are zero.
+// Returns 0 on success, -1 if len exceeds 2 * size or a char is not a digit.
+int  DigitsToBcd(char const* digits, size_t const& len, uint8_t* bcd, size_t const& size);
+// Values 0-99 of size BCD bytes. Returns 0 on success, -1 if a nibble is not decimal.
+int  BcdToValues(uint8_t const* bcd, size_t const& size, uint8_t* values);
+
+// Terminal phone number BCD[6] to 12 digits, not terminated. Returns 0 on success, -1 for a non decimal nibble.
+inline int BcdToPhone(uint8_t const* bcd, char* digits) {
+    return BcdToDigitsChecked(bcd, kBcdPhoneSize, digits);
+}
+// Up to 12 digits to the terminal phone number BCD[6]. Returns 0 on success, -1 on failure.
+inline int PhoneToBcd(std::string const& phone, uint8_t* bcd) {
+    return DigitsToBcd(phone.data(), phone.size(), bcd, kBcdPhoneSize);
+}
+
+// Fields of a YYMMDDhhmmss time, as in the location report. The year is that of the century.
+struct BcdTime {
+    uint8_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+};
+
+// Returns 0 on success, -1 for a non decimal nibble. Ranges are not checked.
+int BcdToTime(uint8_t const* bcd, BcdTime* time);
+// Returns 0 on success, -1 for a field above 99.
+int TimeToBcd(BcdTime const& time, uint8_t* bcd);
+
 } // namespace libjt808
 
 #endif // JT808_BCD_H_
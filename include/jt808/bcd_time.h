@@ -0,0 +1,73 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  bcd_time.h
+// @Version :  1.0
+// @Time    :  2026/10/21 09:05:18
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_BCD_TIME_H_
+#define JT808_BCD_TIME_H_
+
+#include <stdint.h>
+
+#include "jt808/bcd.h"
+
+namespace libjt808 {
+
+constexpr int64_t kSecondsPerDay = 86400;
+// Times of the protocol are GMT+8.
+constexpr int64_t kJT808TimeZoneOffset = 8 * 3600;
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar.
+int64_t DaysFromCivil(int64_t year, int64_t const& month, int64_t const& day);
+
+// Convert a GMT+8 YYMMDDhhmmss BCD[6] time to seconds since 1970-01-01 00:00:00 UTC, years are 20YY.
+// Calendar arithmetic only, no mktime() nor time zone lookups.
+// Returns 0 on success, -1 for a non decimal nibble or a field out of range, e.g. the zero time of a terminal
+// without a fix.
+int BcdTimeToEpoch(uint8_t const* bcd, int64_t* epoch);
+
+// BcdTimeToEpoch() remembering the epoch of the last date.
+// Reports of a terminal mostly share their date, for those only hh:mm:ss is decoded. Keep one per session, e.g. in
+// the parse fields of its ProtocolParameter, the parser uses it for the location reports.
+//
+// Example:
+//     BcdTimeCache cache;
+//     int64_t epoch;
+//     cache.ToEpoch(&frame[pos + 22], &epoch);
+class BcdTimeCache {
+public:
+    int ToEpoch(uint8_t const* bcd, int64_t* epoch);
+
+private:
+    // BCD date of day_, 0xFF matches no valid date.
+    uint8_t date_[3] = {0xFF, 0xFF, 0xFF};
+    // Epoch of 00:00:00 GMT+8 of date_.
+    int64_t day_     = 0;
+};
+
+} // namespace libjt808
+
+#endif // JT808_BCD_TIME_H_
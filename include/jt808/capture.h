@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  capture.h
+// @Version :  1.0
+// @Time    :  2026/11/03 14:26:51
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_CAPTURE_H_
+#define JT808_CAPTURE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+namespace libjt808 {
+
+// A frame of a capture.
+struct CaptureRecord {
+    int64_t        timestamp_us = 0;       // Receive time, microseconds since the Unix epoch.
+    uint32_t       connection   = 0;       // Connection the frame was received on, unique within the capture.
+    uint8_t const* data         = nullptr; // Escaped frame as received, 0x7E to 0x7E.
+    size_t         size         = 0;
+};
+
+// Writer of a capture, the frames received by a server as they came off the wire.
+// A capture is a file of length prefixed records, each a frame with its receive time and connection. Records are
+// buffered in memory and written in large chunks, so capturing costs a copy of each frame. Not thread safe.
+//
+// Example:
+//     CaptureWriter capture;
+//     capture.Open("./jt808.cap");
+//     capture.Write(connection, timestamp_us, frame.data(), frame.size());
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+    CaptureWriter(CaptureWriter const&)            = delete;
+    CaptureWriter& operator=(CaptureWriter const&) = delete;
+
+    // Create the capture at path, replacing an existing file. Returns 0 on success, -1 on failure.
+    int Open(std::string const& path);
+    // Write the buffered records and close the file.
+    void Close(void);
+    bool is_open(void) const {
+        return file_ != nullptr;
+    }
+
+    // Append a frame. Returns 0 on success, -1 if the capture is not open or the buffer could not be written.
+    int Write(uint32_t const& connection, int64_t const& timestamp_us, uint8_t const* data, size_t const& size);
+    // Write the buffered records to the file. Returns 0 on success, -1 on failure.
+    int Flush(void);
+
+private:
+    FILE*                file_ = nullptr;
+    std::vector<uint8_t> buffer_;
+};
+
+// Reader of a capture, mapped in memory on Linux and read into memory elsewhere.
+//
+// Example:
+//     CaptureReader capture;
+//     capture.Open("./jt808.cap");
+//     CaptureRecord record;
+//     for (size_t offset = 0; capture.Next(&offset, &record) == 0;) ...
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+    CaptureReader(CaptureReader const&)            = delete;
+    CaptureReader& operator=(CaptureReader const&) = delete;
+
+    // Returns 0 on success, -1 if the file cannot be read or is not a capture.
+    int  Open(std::string const& path);
+    void Close(void);
+
+    // Read the record at offset, 0 for the first one, and move offset to the next. The record points into the
+    // capture. Thread safe. Returns 0 on success, -1 at the end of the capture or at a record torn by a crash.
+    int Next(size_t* offset, CaptureRecord* record) const;
+    // Offset of the first record at or after offset, e.g. to split the capture for threads, size() if there is none.
+    // A record is told by its frame, 0x7E to 0x7E, and by those of the records following it. Thread safe.
+    size_t Seek(size_t const& offset) const;
+
+    // The whole capture.
+    uint8_t const* data(void) const {
+        return data_;
+    }
+    size_t size(void) const {
+        return size_;
+    }
+
+private:
+    uint8_t const*       data_   = nullptr;
+    size_t               size_   = 0;
+    bool                 mapped_ = false;
+    std::vector<uint8_t> buffer_; // Contents of the file if not mapped.
+};
+
+struct ReplayOptions {
+    int    threads = 1; // Connections are spread over the threads, the frames of each stay in order.
+    double speed   = 0; // 1 replays in real time, N N times faster, 0 as fast as possible.
+};
+
+struct ReplayStats {
+    uint64_t frames      = 0; // Frames replayed.
+    uint64_t bytes       = 0;
+    uint64_t messages    = 0; // Messages parsed, segmented ones once complete.
+    uint64_t pending     = 0; // Packets of segmented messages stored.
+    uint64_t errors      = 0; // Frames failing to parse, or connections failing for ReplayToServer().
+    uint64_t responses   = 0; // Frames received from the server.
+    uint32_t connections = 0;
+    double   seconds     = 0; // Wall time of the replay.
+};
+
+// Parse the frames of a capture with JT808FrameParse() as the server does, with a ProtocolParameter per connection
+// and a Reassembler per thread. Reassembly runs on the capture time. Returns 0 on success, -1 for invalid options.
+int ReplayParse(CaptureReader const& capture, ReplayOptions const& options, ReplayStats* stats);
+
+// Send the frames of a capture to a server at ip:port, a TCP connection per captured connection.
+// A captured registration (0x0100) waits for its response, the following authentication (0x0102) is sent with the
+// authentication code issued by the server and waits for its response too, the other frames are sent as captured.
+// The responses of the server are read and counted. Linux only.
+// Returns 0 on success, -1 for invalid options or on other platforms.
+int ReplayToServer(CaptureReader const& capture, std::string const& ip, int const& port, ReplayOptions const& options,
+                   ReplayStats* stats);
+
+} // namespace libjt808
+
+#endif // JT808_CAPTURE_H_
@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  capture_decoder.h
+// @Version :  1.0
+// @Time    :  2026/11/06 10:17:43
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_CAPTURE_DECODER_H_
+#define JT808_CAPTURE_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace libjt808 {
+
+// Messages decoded from captured frames, as columns of a row per frame.
+struct DecodedMessages {
+    static constexpr uint32_t kNoPhone = UINT32_MAX;
+
+    std::vector<int64_t>     timestamp_us; // Receive time of the frame.
+    std::vector<uint32_t>    connection;
+    std::vector<uint16_t>    msg_id;
+    std::vector<uint16_t>    flow_num;
+    std::vector<uint32_t>    phone; // Index in phones, kNoPhone if the message header could not be parsed.
+    std::vector<int32_t>     error; // ParserError, Ok once parsed, PacketPending for a packet stored.
+    std::vector<std::string> phones; // Phone numbers of the rows, each once.
+
+    size_t size(void) const {
+        return msg_id.size();
+    }
+};
+
+// Locations of the messages decoded, as columns of a row per location: one for 0x0200 and 0x0201, one per location
+// of 0x0704.
+struct DecodedLocations {
+    std::vector<uint32_t> message;   // Row of its message.
+    std::vector<int64_t>  timestamp; // Seconds since 1970-01-01 00:00:00 UTC, -1 if malformed.
+    std::vector<uint32_t> latitude;
+    std::vector<uint32_t> longitude;
+    std::vector<uint16_t> altitude;
+    std::vector<uint16_t> speed;
+    std::vector<uint16_t> bearing;
+    std::vector<uint32_t> alarm;
+    std::vector<uint32_t> status;
+
+    size_t size(void) const {
+        return message.size();
+    }
+};
+
+// Rows decoded from a chunk of a capture.
+struct DecodedChunk {
+    size_t           file  = 0; // Index of the capture in the paths decoded.
+    size_t           index = 0; // Order of the chunk among those of all the captures.
+    size_t           begin = 0; // Offsets in the capture of the records decoded, 0 for segmented messages.
+    size_t           end   = 0;
+    DecodedMessages  messages;
+    DecodedLocations locations;
+};
+
+struct DecodeOptions {
+    int    threads     = 0;       // Decoding threads, 0 for one per core.
+    size_t chunk_bytes = 8 << 20; // Bytes of a capture decoded as a chunk.
+};
+
+struct DecodeStats {
+    uint64_t bytes     = 0; // Of the captures.
+    uint64_t frames    = 0;
+    uint64_t messages  = 0; // Messages parsed, segmented ones once complete.
+    uint64_t pending   = 0; // Packets of segmented messages stored.
+    uint64_t errors    = 0; // Frames failing to parse.
+    uint64_t locations = 0;
+    uint64_t chunks    = 0;
+    uint64_t steals    = 0; // Chunks decoded by another thread than the one they were handed to.
+    double   seconds   = 0; // Wall time of the decoding.
+};
+
+// Called with the rows of each chunk decoded, on the decoding threads, concurrently and in no particular order.
+using DecodeSink = std::function<void(DecodedChunk const& chunk)>;
+
+// Decode the frames of captures in parallel, e.g. to reprocess days of captured traffic after a parser fix.
+// The captures are mapped in memory and cut into chunks of about chunk_bytes at record boundaries (see
+// CaptureReader::Seek()). The chunks are dealt out to the threads in runs of consecutive chunks, so each reads its
+// part of a capture sequentially, a thread out of chunks steals the last ones of another. Frames are decoded with
+// JT808FrameParse() and handed to sink as columns, a chunk at a time. The frames of segmented message IDs, e.g.
+// 0x0801, are set aside and reassembled once all chunks are decoded, with the terminals spread over the threads,
+// their rows come in chunks of their own after the others.
+// Returns 0 on success, -1 if a capture cannot be read, a chunk does not end where the next one starts, or for
+// invalid options.
+int DecodeCaptures(std::vector<std::string> const& paths, DecodeOptions const& options, DecodeSink const& sink,
+                   DecodeStats* stats);
+
+} // namespace libjt808
+
+#endif // JT808_CAPTURE_DECODER_H_
@@ -40,12 +40,16 @@
 #endif
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <string>
 #include <thread>
-#include <list>
 #include <mutex>
 
+#include "jt808/event_loop.h"
 #include "jt808/packager.h"
 #include "jt808/parser.h"
 #include "jt808/protocol_parameter.h"
@@ -56,6 +60,8 @@ namespace libjt808 {
 // JT808 terminal.
 // Implemented terminal registration, terminal authentication, heartbeat packet, and location information reporting
 // functions.
+// The service runs a single event loop thread, which only wakes up on socket readiness, on heartbeat/report timer
+// expiry, or when another thread queues an outbound message.
 //
 // Example:
 //     JT808Client client;
@@ -98,8 +104,19 @@ public:
     // Connect to the remote server.
     int ConnectRemote(void);
     // JT808 connection authentication.
+    // With an authentication code from an earlier authentication the terminal authenticates straight away, and
+    // registers again if the platform rejects the code.
     int JT808ConnectionAuthentication(void);
 
+    // Authentication code of the last successful authentication, empty before.
+    // Persist it to authenticate without registering after a restart of the terminal.
+    std::vector<uint8_t> const& authentication_code(void) const {
+        return parameter_.authentication_code;
+    }
+    void set_authentication_code(std::vector<uint8_t> const& code) {
+        parameter_.authentication_code = code;
+    }
+
     //
     // Terminal registration.
     //
@@ -217,7 +234,7 @@ public:
     //     None.
     void SetInOutAreaAlarmBit(uint8_t const& in) {
         parameter_.location_info.alarm.bit.in_out_area = in;
-        location_report_immediately_flag_ |= kAlarmOccurred;
+        RequestImmediateReport(kAlarmOccurred);
     }
 
     // Set the in/out area alarm location extension item.
@@ -238,7 +255,7 @@ public:
     // Set status bit.
     void SetStatusBit(uint32_t const& status) {
         parameter_.location_info.status.value = status;
-        location_report_immediately_flag_ |= kStateChanged;
+        RequestImmediateReport(kStateChanged);
     }
 
     // Get status bit.
@@ -311,6 +328,7 @@ public:
 
     // Immediately generate a location reporting message.
     // Only called when external control of location reporting is enabled.
+    // Thread safe, the message is queued and the service thread is woken up to send it.
     void GenerateLocationReportMsgNow(void);
 
     //
@@ -516,6 +534,29 @@ public:
         polygon_area_callback_ = callback;
     }
 
+    // Get the current circular area information set.
+    CircularAreaSet const& circular_areas(void) const {
+        return circular_areas_;
+    }
+
+    // Get the current rectangle area information set.
+    RectangleAreaSet const& rectangle_areas(void) const {
+        return rectangle_areas_;
+    }
+
+    // Get the current route information set.
+    RouteSet const& routes(void) const {
+        return routes_;
+    }
+
+    // Area route callback function, msg_id is the set or delete command that modified the areas or routes.
+    using AreaRouteCallback = std::function<void(uint16_t const& msg_id)>;
+
+    // Set the callback function when the platform configuration modifies circular areas, rectangle areas or routes.
+    void OnAreaRouteUpdated(AreaRouteCallback const& callback) {
+        area_route_callback_ = callback;
+    }
+
     //
     // Multimedia data upload.
     //
@@ -545,16 +586,29 @@ public:
 private:
     // Generate a message.
     int PackagingMessage(uint32_t const& msg_id, std::vector<uint8_t>* out);
-    // Generate a message and store it in the general message list.
+    // Generate a message and store it in the general message queue.
     int PackagingGeneralMessage(uint32_t const& msg_id);
+    // Push a message into the outbound queue and wake up the service thread.
+    void EnqueueMessage(std::vector<uint8_t>&& msg, bool const& location_report);
     // Send a message.
     int SendMessage(std::vector<uint8_t> const& msg);
-    // Main thread handler function.
+    // Main thread handler function, runs the event loop.
     void ThreadHandler(void);
-    // Thread handler function for sending messages to the server.
-    void SendHandler(std::atomic_bool* const running);
-    // Thread handler function for receiving messages from the server.
-    void ReceiveHandler(std::atomic_bool* const running);
+    // Socket readiness handler.
+    void OnSocketEvent(int const& events);
+    // Heartbeat timer handler, sends a heartbeat if nothing was sent during the heartbeat interval.
+    void OnHeartbeatTimer(void);
+    // Location report timer handler.
+    void OnReportTimer(void);
+    // Handle a message parsed from the server.
+    void HandleMessage(void);
+    // Write queued messages to the socket until drained or the socket would block.
+    // Returns 0 on success, -1 on failure.
+    int FlushMessages(void);
+    // Flag an immediate location report and wake up the service thread.
+    void RequestImmediateReport(uint16_t const& flag);
+    // Suspend/resume socket handling in the service thread for blocking send/receive sequences.
+    void PauseServiceIo(bool const& pause);
 
     std::atomic_bool          manual_deal_;        // Manual processing flag.
     std::mutex                msg_generate_mutex_; // Message generation mutex to ensure unique message serial numbers.
@@ -564,7 +618,7 @@ private:
     std::string               ip_;                 // Server IP address.
     int                       port_;               // Server port.
     uint8_t                   location_report_inteval_;          // Location information reporting interval.
-    uint16_t                  location_report_immediately_flag_; // Immediate location reporting flag.
+    std::atomic<uint16_t>     location_report_immediately_flag_; // Immediate location reporting flag.
     std::atomic_bool
                 location_report_msg_generate_outside_; // External control to generate location reporting information.
     std::thread service_thread_;                       // Service thread.
@@ -574,12 +628,31 @@ private:
     TerminalParameterCallback terminal_parameter_callback_; // Callback function for modifying terminal parameters.
     UpgradeCallback           upgrade_callback_;            // Callback function for issuing terminal upgrade packages.
     PolygonAreaCallback       polygon_area_callback_;       // Callback function for modifying polygon area information.
+    AreaRouteCallback         area_route_callback_;         // Callback function for modifying other areas and routes.
     Packager                  packager_;                    // General JT808 protocol packager.
     Parser                    parser_;                      // General JT808 protocol parser.
-    std::list<std::vector<uint8_t>> location_report_msg_;   // Location reporting message list.
-    std::list<std::vector<uint8_t>> general_msg_;           // Message list excluding location reporting messages.
-    PolygonAreaSet                  polygon_areas_;         // Polygon area information set.
-    ProtocolParameter               parameter_;             // JT808 protocol parameters.
+    SegmentedParser           segmented_parser_;            // Parser of reassembled segmented messages.
+    Reassembler               reassembler_;                 // Segmented messages from the server, e.g. 0x8108.
+    EventLoop                 loop_;                        // Service event loop.
+    EventLoop::TimerId        heartbeat_timer_;             // Heartbeat timer.
+    EventLoop::TimerId        report_timer_;                // Location report timer.
+    uint32_t                  heartbeat_inteval_;           // Heartbeat interval in milliseconds.
+    bool                      first_report_;                // Waiting for the first positioned location report.
+    std::chrono::steady_clock::time_point last_send_tp_;    // Time of the last message sent.
+    std::mutex                msg_queue_mutex_;             // Protects the outbound message queues.
+    std::condition_variable   msg_queue_cv_;                // Signaled when the outbound queues are drained.
+    bool                      send_pending_;                // Messages taken from the queues but not fully written.
+    std::deque<std::vector<uint8_t>> location_report_msg_;  // Location reporting message queue.
+    std::deque<std::vector<uint8_t>> general_msg_;          // Message queue excluding location reporting messages.
+    std::deque<std::vector<uint8_t>> sending_msg_;          // Messages being written, owned by the service thread.
+    size_t                           sending_offset_;       // Bytes of the front sending message already written.
+    bool                             wait_writable_;        // Socket writable interest is enabled.
+    std::vector<uint8_t>             recv_buffer_;          // Received bytes not yet assembled into a frame.
+    PolygonAreaSet                   polygon_areas_;        // Polygon area information set.
+    CircularAreaSet                  circular_areas_;       // Circular area information set.
+    RectangleAreaSet                 rectangle_areas_;      // Rectangle area information set.
+    RouteSet                         routes_;               // Route information set.
+    ProtocolParameter                parameter_;            // JT808 protocol parameters.
 
     friend class JT808CustomClient; // Allow the custom server to access private members.
 };
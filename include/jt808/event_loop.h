@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  event_loop.h
+// @Version :  1.0
+// @Time    :  2026/10/16 09:12:40
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_EVENT_LOOP_H_
+#define JT808_EVENT_LOOP_H_
+
+#if defined(__linux__)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <winsock2.h>
+#include <windows.h>
+#endif
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libjt808 {
+
+// Single threaded I/O event loop.
+// The loop thread only wakes up on socket readiness, timer expiry or an explicit wakeup from another thread.
+// On Linux it is built on epoll, a single timerfd armed to the nearest timer deadline, and an eventfd for
+// cross-thread wakeups. Other platforms fall back to select() with the same timer queue.
+//
+// All fd and timer operations must be called from the loop thread, or while the loop is not running.
+// QueueInLoop(), Wakeup() and Quit() may be called from any thread.
+//
+// Example:
+//     EventLoop loop;
+//     loop.Init();
+//     loop.AddTimer(1000, 1000, [] { printf("tick\n"); });
+//     loop.Run();
+class EventLoop {
+public:
+    using Handle        = decltype(socket(0, 0, 0));
+    using Clock         = std::chrono::steady_clock;
+    using TimerId       = uint64_t;
+    using EventCallback = std::function<void(int const& events)>;
+    using TimerCallback = std::function<void(void)>;
+    using Task          = std::function<void(void)>;
+
+    // I/O events.
+    enum IoEvent {
+        kReadable = 0x1,
+        kWritable = 0x2,
+        kError    = 0x4, // Error or hang up, reported regardless of the registered interest.
+    };
+
+    EventLoop();
+    ~EventLoop();
+
+    // Create the poller, timer and wakeup descriptors.
+    // Returns 0 on success, -1 on failure.
+    int Init(void);
+
+    //
+    // I/O readiness.
+    //
+    // Register a handle with the given interest (kReadable | kWritable).
+    // Returns 0 on success, -1 on failure.
+    int AddHandle(Handle const& handle, int const& events, EventCallback const& callback);
+    // Change the interest of a registered handle.
+    int ModifyHandle(Handle const& handle, int const& events);
+    // Unregister a handle, the handle itself is not closed.
+    int RemoveHandle(Handle const& handle);
+
+    //
+    // Timers.
+    //
+    // Add a timer firing after delay_ms, then every interval_ms if interval_ms is non-zero.
+    // Returns the timer ID, 0 on failure.
+    TimerId AddTimer(uint32_t const& delay_ms, uint32_t const& interval_ms, TimerCallback const& callback);
+    // Re-arm an existing timer. Returns 0 on success, -1 if the timer does not exist.
+    int ResetTimer(TimerId const& id, uint32_t const& delay_ms, uint32_t const& interval_ms);
+    // Cancel a timer. Cancelling an expired one-shot timer is a no-op.
+    void CancelTimer(TimerId const& id);
+
+    //
+    // Loop control.
+    //
+    // Run the loop in the calling thread until Quit() is called.
+    void Run(void);
+    // Wait for events at most timeout_ms (-1 blocks) and dispatch them once.
+    int RunOnce(int const& timeout_ms);
+    // Make the current, or the next, Run() return. Thread safe.
+    void Quit(void);
+    // Queue a task to run in the loop thread. Thread safe.
+    void QueueInLoop(Task const& task);
+    // Run the task now when called from the loop thread, otherwise queue it.
+    void RunInLoop(Task const& task);
+    // Wake up the loop thread. Thread safe.
+    void Wakeup(void);
+
+    // Whether the calling thread is the one running the loop.
+    bool IsInLoopThread(void) const {
+        return loop_thread_id_ == std::this_thread::get_id();
+    }
+
+    bool is_running(void) const {
+        return is_running_.load();
+    }
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        uint32_t          interval_ms;
+        TimerCallback     callback;
+    };
+
+    // Arm the timer descriptor to the nearest deadline.
+    void ArmTimer(void);
+    // Wait time in milliseconds until the nearest deadline, -1 if no timer is pending.
+    int NextTimeout(void) const;
+    // Dispatch expired timers.
+    void HandleTimers(void);
+    // Run queued cross-thread tasks.
+    void HandleTasks(void);
+    // Dispatch ready handles, backend specific.
+    int Poll(int const& timeout_ms);
+
+    Handle            poller_;         // epoll descriptor, unused on other platforms.
+    Handle            timer_fd_;       // timerfd, unused on other platforms.
+    Handle            wakeup_fd_;      // eventfd, unused on other platforms.
+    std::atomic_bool  quit_;           // Quit request flag.
+    std::atomic_bool  is_running_;     // Loop running flag.
+    std::atomic_bool  is_notified_;    // A wakeup is already pending, avoids redundant eventfd writes.
+    std::thread::id   loop_thread_id_; // Thread currently running the loop.
+    TimerId           next_timer_id_;  // Next timer ID to hand out.
+    Clock::time_point armed_deadline_; // Deadline the timer descriptor is armed to.
+    std::unordered_map<Handle, std::pair<int, EventCallback>> handles_;   // Handle - (interest, callback).
+    std::unordered_map<TimerId, Timer>                        timers_;    // Timer ID - timer.
+    std::set<std::pair<Clock::time_point, TimerId>>           deadlines_; // Timers ordered by deadline.
+    std::mutex                                                tasks_mutex_;
+    std::vector<Task>                                         tasks_; // Tasks queued from other threads.
+};
+
+} // namespace libjt808
+
+#endif // JT808_EVENT_LOOP_H_
@@ -0,0 +1,354 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  geofence.h
+// @Version :  1.0
+// @Time    :  2026/10/18 10:05:22
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_GEOFENCE_H_
+#define JT808_GEOFENCE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "area_route.h"
+#include "location_report.h"
+
+namespace libjt808 {
+
+// Geographic point in millionths of a degree, the unit of the protocol. South latitudes and west longitudes are
+// negative.
+struct GeoPoint {
+    int32_t latitude;
+    int32_t longitude;
+};
+
+// Axis aligned bounding box, inclusive.
+struct GeoBox {
+    int32_t min_latitude;
+    int32_t min_longitude;
+    int32_t max_latitude;
+    int32_t max_longitude;
+
+    bool Contains(GeoPoint const& point) const {
+        return point.latitude >= min_latitude && point.latitude <= max_latitude && point.longitude >= min_longitude &&
+               point.longitude <= max_longitude;
+    }
+};
+
+// Points as a structure of arrays, the layout of the batch containment tests.
+struct GeoPointBatch {
+    std::vector<int32_t> latitudes;
+    std::vector<int32_t> longitudes;
+
+    void Clear(void) {
+        latitudes.clear();
+        longitudes.clear();
+    }
+
+    void Append(GeoPoint const& point) {
+        latitudes.push_back(point.latitude);
+        longitudes.push_back(point.longitude);
+    }
+
+    // Append the positions of location reports, e.g. a 0x0704 batch.
+    void Append(std::vector<LocationBasicInformation> const& locations);
+
+    size_t size(void) const {
+        return latitudes.size();
+    }
+};
+
+// Area or route holding a point.
+struct GeofenceHit {
+    uint8_t  type; // kAccessAreaAlarmLocationType, as reported in the 0x12 location extension.
+    uint32_t area_id;
+    uint32_t road_section_id; // Routes only, the road section holding the point.
+    uint16_t max_speed;       // km/h, 0 if the area or road section has no speed limit.
+    uint8_t  overspeed_time;  // Seconds.
+};
+
+// Area or route entered or left by a terminal, leaving a route is a route deviation.
+struct GeofenceEvent {
+    uint8_t  type; // kAccessAreaAlarmLocationType.
+    uint32_t area_id;
+    bool     entered; // true: entered the area; false: left the area.
+};
+
+// Convert degrees to millionths of a degree.
+int32_t DegreesToGeo(double const& degrees);
+
+// Position of a location report, signed by the hemisphere status bits.
+GeoPoint LocationToGeoPoint(LocationBasicInformation const& location);
+
+// Whether the batch containment tests run on AVX2, detected at run time.
+bool GeofenceSimdSupported(void);
+
+// Polygon prepared for repeated point tests.
+// The bounding box is split into horizontal bands of equal height, each band holds the edges crossing it. A point
+// test picks its band directly and only counts crossings of those edges, instead of walking every edge.
+class PreparedPolygon {
+public:
+    PreparedPolygon() : band_height_(1) {
+    }
+
+    // Prepare from vertices in order, the polygon is closed implicitly.
+    // Returns 0 on success, -1 for fewer than 3 vertices.
+    int Init(std::vector<GeoPoint> const& vertices);
+    // Prepare a polygon area, vertex signs follow the area attribute hemisphere bits.
+    int Init(PolygonArea const& area);
+
+    // Points on the boundary may be reported either way.
+    bool Contains(GeoPoint const& point) const;
+
+    // Test many points at once, inside[i] is set to 1 if point i is inside and 0 otherwise. Same results as Contains().
+    // Points are taken eight at a time: the edges overlapping the latitudes of the eight are evaluated against all of
+    // them with AVX2 when the CPU has it. Close points, such as a track, share most edges.
+    // Args:
+    //     use_simd:  false forces the scalar path.
+    void ContainsBatch(int32_t const* latitudes, int32_t const* longitudes, size_t const& count, uint8_t* inside,
+                       bool const& use_simd = true) const;
+
+    void ContainsBatch(GeoPointBatch const& points, std::vector<uint8_t>* inside, bool const& use_simd = true) const {
+        inside->resize(points.size());
+        ContainsBatch(points.latitudes.data(), points.longitudes.data(), points.size(), inside->data(), use_simd);
+    }
+
+    GeoBox const& box(void) const {
+        return box_;
+    }
+
+    size_t vertex_count(void) const {
+        return vertex_count_;
+    }
+
+private:
+    // Edge with latitude0 < latitude1, covering [latitude0, latitude1).
+    struct Edge {
+        int32_t latitude0;
+        int32_t longitude0;
+        int32_t latitude1;
+        int32_t longitude1;
+    };
+
+    GeoBox                box_          = {};
+    size_t                vertex_count_ = 0;
+    int64_t               band_height_;
+    std::vector<uint32_t> band_offsets_; // Band i holds band_edges_[band_offsets_[i], band_offsets_[i + 1]).
+    std::vector<Edge>     band_edges_;
+    std::vector<Edge>     edges_; // Every edge once, ascending latitude0, for the batch tests.
+};
+
+// Circle prepared for repeated point tests.
+// Distances are measured on a local equirectangular projection at the center, accurate for areas up to a few
+// hundred kilometers away from the poles.
+class PreparedCircle {
+public:
+    // Returns 0 on success.
+    int Init(GeoPoint const& center, uint32_t const& radius);
+    // Prepare a circular area, the center sign follows the area attribute hemisphere bits.
+    int Init(CircularArea const& area);
+
+    bool Contains(GeoPoint const& point) const;
+
+    GeoBox const& box(void) const {
+        return box_;
+    }
+
+private:
+    GeoBox   box_             = {};
+    GeoPoint center_          = {};
+    double   longitude_scale_ = 0; // Meters per millionth of a degree of longitude at the center.
+    double   radius_sq_       = 0; // Square meters.
+};
+
+// Route prepared for repeated point tests.
+// Each road section runs from its turning point to the next one and holds the points within half the road width of
+// it, measured as for PreparedCircle. Sections are indexed by their own bounding boxes, so a long route costs no more
+// per point than a small area.
+class PreparedRoute {
+public:
+    // Road section from one turning point to the next.
+    struct Section {
+        GeoPoint start;
+        double   longitude_scale; // Meters per millionth of a degree of longitude at the start.
+        double   dx;              // End minus start, meters.
+        double   dy;
+        double   inverse_length_sq; // 0 for a section of zero length.
+        double   half_width_sq;     // Square meters.
+        uint32_t road_section_id;
+        uint16_t max_speed; // km/h, 0 if not limited.
+        uint8_t  overspeed_time;
+    };
+
+    // Prepare a route, turning point signs follow the road section attribute hemisphere bits.
+    // Returns 0 on success, -1 for fewer than 2 turning points.
+    int Init(Route const& route);
+
+    // Whether the point is on road section i.
+    bool SectionContains(size_t const& i, GeoPoint const& point) const;
+    // Index of the first road section holding the point, -1 if it is off the route.
+    int Match(GeoPoint const& point) const;
+
+    size_t section_count(void) const {
+        return sections_.size();
+    }
+
+    Section const& section(size_t const& i) const {
+        return sections_[i];
+    }
+
+    GeoBox const& section_box(size_t const& i) const {
+        return section_boxes_[i];
+    }
+
+    GeoBox const& box(void) const {
+        return box_;
+    }
+
+private:
+    GeoBox               box_ = {};
+    std::vector<Section> sections_;
+    std::vector<GeoBox>  section_boxes_;
+};
+
+// Bounding box of a rectangle area, signs follow the area attribute hemisphere bits.
+GeoBox RectangleToGeoBox(RectangleArea const& area);
+
+// Test many points against one polygon area, see PreparedPolygon::ContainsBatch().
+// Returns 0 on success, -1 for an area of fewer than 3 vertices.
+int ContainsBatch(PolygonArea const& area, GeoPointBatch const& points, std::vector<uint8_t>* inside);
+
+// Geofence engine over many areas and routes.
+// Areas are kept in a uniform grid keyed by their bounding boxes, a point is only tested against the areas whose
+// cell it falls into and whose bounding box holds it. Routes are put into the grid section by section. Areas spanning
+// too many cells are kept aside and filtered by bounding box alone. Per terminal, Update() reports the areas and
+// routes entered and left since the previous position.
+// Areas of different types are told apart by their type, kAccessAreaAlarmLocationType, as their IDs are assigned
+// independently by the platform.
+// Not thread safe, concurrent Locate() and Contains() calls are safe while no area or terminal is modified.
+//
+// Example:
+//     GeofenceEngine engine;
+//     engine.AddPolygonAreas(polygon_area_set);
+//     engine.AddRoutes(route_set);
+//     std::vector<GeofenceEvent> events;
+//     engine.Update(para.parse.msg_head.phone_num, LocationToGeoPoint(para.parse.location_info), &events);
+//     for (auto const& event : events) ...
+class GeofenceEngine {
+public:
+    // Args:
+    //     cell_degrees:  Grid cell size in degrees, about the size of a typical area.
+    explicit GeofenceEngine(double const& cell_degrees = 0.05);
+
+    // Add or replace an area, signs follow the hemisphere bits of the area.
+    // Returns 0 on success, -1 for a polygon of fewer than 3 vertices or a route of fewer than 2 turning points.
+    int AddPolygonArea(PolygonArea const& area);
+    int AddCircularArea(CircularArea const& area);
+    int AddRectangleArea(RectangleArea const& area);
+    int AddRoute(Route const& route);
+    // Returns 0 if every area was added, -1 otherwise.
+    int AddPolygonAreas(PolygonAreaSet const& areas);
+    int AddCircularAreas(CircularAreaSet const& areas);
+    int AddRectangleAreas(RectangleAreaSet const& areas);
+    int AddRoutes(RouteSet const& routes);
+    // Returns 0 on success, -1 if the area does not exist.
+    int RemoveArea(uint8_t const& type, uint32_t const& area_id);
+    // Remove all areas and terminal states.
+    void Clear(void);
+
+    size_t area_count(void) const {
+        return area_index_.size();
+    }
+
+    // Areas and routes holding the point, ascending by type and ID.
+    void Locate(GeoPoint const& point, std::vector<GeofenceHit>* hits) const;
+    // Whether an area or route holds the point, false if it does not exist.
+    bool Contains(uint8_t const& type, uint32_t const& area_id, GeoPoint const& point) const;
+
+    // Locate a terminal and append the areas it entered or left since its previous update. The first update of a
+    // terminal reports an entered event for each area holding it. Removed areas are reported as left.
+    // Args:
+    //     hits:  Optional, the areas holding the point, e.g. for speed limit checks.
+    void Update(std::string const& terminal, GeoPoint const& point, std::vector<GeofenceEvent>* events,
+                std::vector<GeofenceHit>* hits = nullptr);
+    // Forget the state of a terminal, e.g. on disconnection.
+    void RemoveTerminal(std::string const& terminal);
+
+private:
+    // Areas spanning more cells than this are not put into the grid.
+    static constexpr int64_t kMaxCellsPerArea = 1024;
+
+    struct Area {
+        uint8_t         type;
+        uint32_t        area_id;
+        uint16_t        max_speed; // km/h, 0 if not limited.
+        uint8_t         overspeed_time;
+        GeoBox          box;       // Whole area, the rectangle itself for rectangle areas.
+        PreparedPolygon polygon;
+        PreparedCircle  circle;
+        PreparedRoute   route;
+    };
+
+    // Bounding box copied next to the slot, so that the prefilter reads one contiguous list.
+    struct Candidate {
+        GeoBox   box;
+        uint32_t index;
+        uint32_t section; // Road section of a route, 0 for areas.
+    };
+
+    static uint64_t Key(uint8_t const& type, uint32_t const& area_id) {
+        return (static_cast<uint64_t>(type) << 32) | area_id;
+    }
+
+    int64_t  CellOf(int32_t const& value) const;
+    uint64_t CellKey(int64_t const& latitude_cell, int64_t const& longitude_cell) const;
+    int      Add(Area&& area);
+    void     Insert(uint32_t const& index);
+    void     InsertBox(GeoBox const& box, Candidate const& candidate);
+    void     Erase(uint32_t const& index);
+    void     EraseBox(GeoBox const& box, uint32_t const& index);
+    bool     Test(Candidate const& candidate, GeoPoint const& point, std::vector<GeofenceHit>* hits) const;
+
+    int64_t                                              cell_size_; // Millionths of a degree.
+    std::vector<Area>                                    areas_;     // Indexed by slot, removed slots are reused.
+    std::vector<uint32_t>                                free_slots_;
+    std::map<uint64_t, uint32_t>                         area_index_;  // Key() - slot.
+    std::unordered_map<uint64_t, std::vector<Candidate>> grid_;        // Cell - areas overlapping it.
+    std::vector<Candidate>                               large_areas_; // Areas not in the grid.
+    // Terminal - Key() of the areas holding it at the previous update, ascending.
+    std::unordered_map<std::string, std::vector<uint64_t>> terminals_;
+    std::vector<GeofenceHit>                               scratch_hits_;
+    std::vector<uint64_t>                                  scratch_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_GEOFENCE_H_
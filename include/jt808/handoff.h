@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  handoff.h
+// @Version :  1.0
+// @Time    :  2026/10/24 14:05:19
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_HANDOFF_H_
+#define JT808_HANDOFF_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "jt808/terminal_parameter_store.h"
+
+namespace libjt808 {
+
+// Connection of an authenticated terminal handed over between server processes.
+struct HandoffSession {
+    int                    socket = -1;
+    std::string            phone_num;
+    std::vector<uint8_t>   authentication_code;
+    uint16_t               platform_flow_num = 0; // Next message flow number of the platform to the terminal.
+    uint16_t               terminal_flow_num = 0; // Last message flow number received from the terminal.
+    std::vector<uint8_t>   receive_buffer;        // Received bytes not yet assembled into a frame.
+    TerminalParameterStore parameters;            // Last known terminal parameters.
+};
+
+// Everything a server process hands over to the process taking over from it.
+struct HandoffState {
+    int                         listen_socket = -1;
+    std::vector<HandoffSession> sessions;
+    std::vector<uint8_t>        reassembly; // Segmented messages being reassembled, see Reassembler::Save().
+};
+
+// Listening socket and connection handoff between server processes over a Unix domain socket.
+// The sockets travel as SCM_RIGHTS ancillary data, so the kernel keeps the connections and their unread bytes while
+// they change hands, and the session state is serialized alongside. The sender keeps its copies of the sockets until
+// the receiver acknowledged the whole state, so a failed handoff leaves the old process serving.
+// Linux only, the functions fail on other platforms.
+//
+// Example, in the old process:
+//     int channel = Accept(HandoffListen(path), nullptr, nullptr);
+//     if (SendHandoffState(channel, state, 5000) == 0) ... close the sockets and exit ...
+// and in the new process:
+//     int channel = HandoffConnect(path);
+//     ReceiveHandoffState(channel, 5000, &state);
+
+// Create a listening Unix domain socket at path, replacing a stale one.
+// Returns the socket on success, -1 on failure.
+int HandoffListen(std::string const& path);
+// Connect to the listening socket at path. Returns the socket on success, -1 on failure.
+int HandoffConnect(std::string const& path);
+
+// Send the state and wait for the acknowledgement of the receiver.
+// Returns 0 once acknowledged, -1 on failure or timeout, the sockets of the state then still belong to the sender.
+int SendHandoffState(int const& channel, HandoffState const& state, int const& timeout_ms);
+// Receive a state and acknowledge it, the received sockets belong to the caller.
+// Returns 0 on success, -1 on failure or timeout, any sockets received are closed.
+int ReceiveHandoffState(int const& channel, int const& timeout_ms, HandoffState* state);
+
+} // namespace libjt808
+
+#endif // JT808_HANDOFF_H_
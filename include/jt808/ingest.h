@@ -0,0 +1,243 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  ingest.h
+// @Version :  1.0
+// @Time    :  2026/10/27 16:05:12
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_INGEST_H_
+#define JT808_INGEST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "jt808/location_report.h"
+#include "jt808/multimedia_upload.h"
+#include "jt808/terminal_parameter_store.h"
+
+namespace libjt808 {
+
+// A message received from a terminal, as handed to application threads.
+// The messages the main service thread decodes for itself come with the fields it decoded:
+//     0x0001:  respone_flow_num, respone_msg_id and respone_result.
+//     0x0104:  respone_flow_num and parameters.
+//     0x0200:  locations and extensions, one each.
+//     0x0201:  respone_flow_num, locations and extensions, one each.
+//     0x0704:  locations and extensions, the batch.
+//     0x0801:  media.
+// Other messages only have their header parsed and come with their body, decode it with the schemas of
+// message_bodies.h, e.g. UpgradeResultBody::Read().
+struct IngestRecord {
+    std::string                           phone_num;
+    uint16_t                              msg_id           = 0;
+    uint16_t                              flow_num         = 0; // Message flow number, of the last packet if segmented.
+    int64_t                               receive_ms       = 0; // Receive time, milliseconds since the Unix epoch.
+    uint16_t                              respone_flow_num = 0; // Flow number of the platform message answered.
+    uint16_t                              respone_msg_id   = 0; // ID of the platform message answered.
+    uint8_t                               respone_result   = 0;
+    std::vector<LocationBasicInformation> locations;
+    std::vector<LocationExtensions>       extensions;
+    TerminalParameterStore                parameters;
+    MultiMediaDataUpload                  media;
+    std::vector<uint8_t>                  body; // Body of other messages, reassembled from its packets if segmented.
+};
+
+// What a producer does when the ring to a worker is full.
+enum IngestOverflow {
+    kIngestDrop = 0x0, // Drop the record and count it, the producer never waits.
+    kIngestBlock,      // Wait for the worker to make room, slowing down the producer and its connections.
+};
+
+struct IngestPoolOptions {
+    int            threads   = 1;           // Worker threads.
+    size_t         capacity  = 4096;        // Records per ring, rounded up to a power of two.
+    IngestOverflow overflow  = kIngestDrop; // Policy of a full ring.
+    size_t         max_batch = 256;         // Records per handler call at most.
+};
+
+// Handler of the records of a worker pool, called on a worker thread with a batch of records. The records of a
+// terminal arrive in order at one worker, and may be moved from.
+using IngestHandler = std::function<void(IngestRecord* records, size_t const& count)>;
+
+// Bounded single producer, single consumer ring. Push and pop take no lock, the indices are on separate cache lines.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t const& capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    // Producer side. Returns false if the ring is full, value is left untouched.
+    bool TryPush(T&& value) {
+        size_t const tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_)
+                return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Move up to max values to the end of out. Returns their number.
+    size_t PopBatch(std::vector<T>* out, size_t const& max) {
+        size_t const head = head_.load(std::memory_order_relaxed);
+        if (tail_cache_ == head)
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+        size_t const count = std::min(tail_cache_ - head, max);
+        for (size_t i = 0; i < count; ++i)
+            out->push_back(std::move(slots_[(head + i) & mask_]));
+        if (count > 0)
+            head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Either side, exact on the consumer side.
+    bool empty(void) const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity(void) const {
+        return mask_ + 1;
+    }
+
+private:
+    std::vector<T>      slots_;
+    size_t              mask_ = 0;
+    char                pad0_[64];
+    std::atomic<size_t> head_{0};   // Next slot to pop, written by the consumer.
+    size_t              tail_cache_ = 0;
+    char                pad1_[64];
+    std::atomic<size_t> tail_{0};   // Next slot to push, written by the producer.
+    size_t              head_cache_ = 0;
+    char                pad2_[64];
+};
+
+// Ingest pipeline between the I/O threads decoding messages and the application threads handling them, so a slow
+// handler does not hold up the connections.
+// Messages are routed by ID to worker pools. Each producing thread gets a Producer with one ring per worker, each
+// worker drains its rings in batches and calls the handler of its pool, the records of a terminal always go to the
+// same worker. Rings are bounded, a full one drops or blocks per the policy of the pool. Workers with nothing to do
+// sleep until a producer wakes them.
+// Set up pools, routes and producers before Start().
+//
+// Example:
+//     IngestPipeline ingest;
+//     int pool = ingest.AddPool(options, [](IngestRecord* records, size_t const& count) { ... });
+//     ingest.Route(kLocationReport, pool);
+//     server.SetIngest(&ingest);
+//     ingest.Start();
+class IngestPipeline {
+public:
+    class Producer {
+    public:
+        // Hand a record over to the pool of its message ID. Not thread safe, one thread per producer.
+        // Returns 0 on success, -1 if the message ID is not routed or the record is dropped.
+        int Push(IngestRecord&& record);
+
+    private:
+        friend class IngestPipeline;
+
+        IngestPipeline*                                     pipeline_ = nullptr;
+        std::vector<std::vector<SpscRing<IngestRecord>*>> rings_; // By pool and worker.
+    };
+
+    IngestPipeline() = default;
+    ~IngestPipeline();
+    IngestPipeline(IngestPipeline const&)            = delete;
+    IngestPipeline& operator=(IngestPipeline const&) = delete;
+
+    // Add a worker pool. Returns the pool, -1 once started or for invalid options.
+    int AddPool(IngestPoolOptions const& options, IngestHandler const& handler);
+    // Route a message ID to a pool. Returns 0 on success, -1 once started or if the pool does not exist.
+    int Route(uint16_t const& msg_id, int const& pool);
+    // Create a producer for a thread, owned by the pipeline. Returns nullptr once started.
+    Producer* CreateProducer(void);
+
+    // Start the workers. Returns 0 on success, -1 if already started.
+    int Start(void);
+    // Stop the workers once they handled the records pushed so far.
+    void Stop(void);
+
+    // Whether a message ID is routed to a pool.
+    bool Routes(uint16_t const& msg_id) const {
+        return routes_.find(msg_id) != routes_.end();
+    }
+    // Records handed over to and dropped by a pool.
+    uint64_t pushed(int const& pool) const;
+    uint64_t dropped(int const& pool) const;
+
+private:
+    struct Worker {
+        std::vector<std::unique_ptr<SpscRing<IngestRecord>>> rings; // By producer.
+        std::thread                                          thread;
+        std::atomic_bool                                     sleeping{false};
+        std::mutex                                           mutex;
+        std::condition_variable                              cv;
+    };
+
+    struct Pool {
+        IngestPoolOptions                    options;
+        IngestHandler                        handler;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<uint64_t>                pushed{0};
+        std::atomic<uint64_t>                dropped{0};
+    };
+
+    void WorkerHandler(Pool* pool, Worker* worker);
+    // Wake a worker waiting for records.
+    static void Wakeup(Worker* worker);
+
+    // Give a producer a ring to each worker of a pool.
+    static void Connect(Producer* producer, Pool* pool);
+
+    std::vector<std::unique_ptr<Pool>>     pools_;
+    std::unordered_map<uint16_t, int>      routes_; // Message ID - pool.
+    std::vector<std::unique_ptr<Producer>> producers_;
+    bool                                   started_ = false;
+    std::atomic_bool                       running_{false};
+    std::atomic_bool                       stop_{false};
+};
+
+} // namespace libjt808
+
+#endif // JT808_INGEST_H_
@@ -167,6 +167,8 @@ struct LocationBasicInformation {
     uint16_t bearing;
     // Time, "YYMMDDhhmmss" (GMT+8 time, all times in this standard use this time zone).
     std::string time;
+    // Seconds since 1970-01-01 00:00:00 UTC of time, set by the parser, -1 if time is malformed.
+    int64_t timestamp;
 };
 
 // Extended vehicle signal status bits
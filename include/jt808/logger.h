@@ -0,0 +1,311 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  logger.h
+// @Version :  1.0
+// @Time    :  2026/10/17 14:12:40
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_LOGGER_H_
+#define JT808_LOGGER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#define JT808_LOG_LEVEL_DEBUG 0
+#define JT808_LOG_LEVEL_INFO  1
+#define JT808_LOG_LEVEL_WARN  2
+#define JT808_LOG_LEVEL_ERROR 3
+#define JT808_LOG_LEVEL_OFF   4
+
+// Records below this level are compiled out, their arguments are not evaluated.
+#ifndef JT808_LOG_LEVEL
+#define JT808_LOG_LEVEL JT808_LOG_LEVEL_DEBUG
+#endif
+
+// printf style logging, the format must be a string literal. Formatting happens on the logger thread.
+#define JT808_LOG(level, ...)                                                                                          \
+    do {                                                                                                               \
+        if (static_cast<int>(level) >= JT808_LOG_LEVEL && ::libjt808::Logger::IsEnabled(level))                        \
+            ::libjt808::Logger::Instance().Log(level, __VA_ARGS__);                                                    \
+    } while (0)
+
+#define JT808_LOG_DEBUG(...) JT808_LOG(::libjt808::kLogDebug, __VA_ARGS__)
+#define JT808_LOG_INFO(...)  JT808_LOG(::libjt808::kLogInfo, __VA_ARGS__)
+#define JT808_LOG_WARN(...)  JT808_LOG(::libjt808::kLogWarn, __VA_ARGS__)
+#define JT808_LOG_ERROR(...) JT808_LOG(::libjt808::kLogError, __VA_ARGS__)
+
+namespace libjt808 {
+
+enum LogLevel {
+    kLogDebug = JT808_LOG_LEVEL_DEBUG,
+    kLogInfo  = JT808_LOG_LEVEL_INFO,
+    kLogWarn  = JT808_LOG_LEVEL_WARN,
+    kLogError = JT808_LOG_LEVEL_ERROR,
+    kLogOff   = JT808_LOG_LEVEL_OFF,
+};
+
+// A formatted log record handed to the sinks.
+struct LogRecord {
+    LogLevel                              level;
+    std::chrono::system_clock::time_point time;
+    uint32_t                              thread; // Small per process thread number, in order of first log.
+    char const*                           text;   // Formatted message, without line break.
+    size_t                                size;
+};
+
+// Log destination. Write() and Flush() are only called from the logger thread.
+class LogSink {
+public:
+    virtual ~LogSink() {
+    }
+
+    virtual void Write(LogRecord const& record) = 0;
+
+    virtual void Flush(void) {
+    }
+};
+
+// Writes "2026-10-17 14:12:40.123 I [1] message" lines to a stdio stream, stdout by default.
+class ConsoleLogSink : public LogSink {
+public:
+    explicit ConsoleLogSink(FILE* stream = stdout) : stream_(stream) {
+    }
+
+    void Write(LogRecord const& record) override;
+    void Flush(void) override;
+
+private:
+    FILE* stream_;
+};
+
+// Appends the console format to a file.
+class FileLogSink : public LogSink {
+public:
+    FileLogSink() : file_(nullptr) {
+    }
+
+    ~FileLogSink();
+
+    // Returns 0 on success, -1 on failure.
+    int Open(std::string const& path);
+    void Write(LogRecord const& record) override;
+    void Flush(void) override;
+
+private:
+    FILE* file_;
+};
+
+// Logged as the hex dump of the bytes where the format has %s.
+struct LogHex {
+    LogHex(void const* data, size_t const& size) : data(data), size(size) {
+    }
+
+    template <typename T>
+    explicit LogHex(std::vector<T> const& bytes) : data(bytes.data()), size(bytes.size() * sizeof(T)) {
+    }
+
+    void const* data;
+    size_t      size;
+};
+
+// Asynchronous logger.
+// Log() copies the format pointer and the arguments into a slot of a lock-free bounded ring, a background thread
+// formats them and passes the text to the sinks. A full ring drops the record rather than blocking the caller, the
+// number of dropped records is reported by the next record written.
+//
+// Example:
+//     Logger::Instance().set_level(kLogDebug);
+//     Logger::Instance().AddSink(std::make_shared<FileLogSink>(...));
+//     JT808_LOG_INFO("[%s:%d] TCP connected.", ip.c_str(), port);
+class Logger {
+public:
+    static constexpr size_t kSlotCount = 4096; // Ring capacity, power of two.
+    static constexpr size_t kArgsSize  = 224;  // Encoded argument bytes per record, long strings are truncated.
+
+    static Logger& Instance(void);
+
+    // Runtime level filter, kLogInfo by default.
+    static bool IsEnabled(LogLevel const& level) {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    void set_level(LogLevel const& level) {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel level(void) const {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    // Sinks receive every record not filtered out. A console sink is installed by default.
+    void AddSink(std::shared_ptr<LogSink> const& sink);
+    void ClearSinks(void);
+
+    template <typename... Args>
+    void Log(LogLevel const& level, char const* format, Args const&... args) {
+        Slot* slot = Acquire();
+        if (slot == nullptr)
+            return;
+        slot->level    = level;
+        slot->format   = format;
+        slot->time     = std::chrono::system_clock::now();
+        slot->thread   = ThreadNumber();
+        slot->args_len = 0;
+        Encode(slot, args...);
+        Publish(slot);
+    }
+
+    // Wait until the records logged so far are written and the sinks flushed.
+    void Flush(void);
+
+    // Records dropped for a full ring since start.
+    uint64_t dropped(void) const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum ArgType : uint8_t {
+        kArgSigned = 0,
+        kArgUnsigned,
+        kArgDouble,
+        kArgString,
+        kArgPointer,
+        kArgHex,
+    };
+
+    struct Slot {
+        std::atomic<size_t>                   sequence; // Ring position + 1 once published.
+        size_t                                position;
+        LogLevel                              level;
+        char const*                           format;
+        uint32_t                              thread;
+        uint16_t                              args_len;
+        std::chrono::system_clock::time_point time;
+        uint8_t                               args[kArgsSize];
+    };
+
+    Logger();
+    ~Logger();
+
+    Logger(Logger const&)            = delete;
+    Logger& operator=(Logger const&) = delete;
+
+    Slot* Acquire(void);
+    void  Publish(Slot* slot);
+    void  Start(void);
+    void  ThreadHandler(void);
+    void  Format(Slot const& slot, std::string* text) const;
+
+    static uint32_t ThreadNumber(void);
+
+    // Keep the logger usable in a forked child, which has no logger thread.
+    static void BeforeFork(void);
+    static void AfterForkParent(void);
+    static void AfterForkChild(void);
+
+    static void Append(Slot* slot, ArgType const& type, void const* data, size_t const& size);
+
+    static void Encode(Slot*) {
+    }
+
+    template <typename T, typename... Args>
+    static void Encode(Slot* slot, T const& value, Args const&... args) {
+        EncodeOne(slot, value);
+        Encode(slot, args...);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type EncodeOne(
+        Slot* slot, T const& value) {
+        int64_t v = value;
+        Append(slot, kArgSigned, &v, sizeof(v));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type EncodeOne(
+        Slot* slot, T const& value) {
+        uint64_t v = value;
+        Append(slot, kArgUnsigned, &v, sizeof(v));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type EncodeOne(Slot* slot, T const& value) {
+        int64_t v = static_cast<int64_t>(value);
+        Append(slot, kArgSigned, &v, sizeof(v));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type EncodeOne(Slot* slot, T const& value) {
+        double v = value;
+        Append(slot, kArgDouble, &v, sizeof(v));
+    }
+
+    static void EncodeOne(Slot* slot, char const* value) {
+        value = value ? value : "(null)";
+        Append(slot, kArgString, value, strlen(value));
+    }
+
+    static void EncodeOne(Slot* slot, std::string const& value) {
+        Append(slot, kArgString, value.data(), value.size());
+    }
+
+    static void EncodeOne(Slot* slot, void const* value) {
+        Append(slot, kArgPointer, &value, sizeof(value));
+    }
+
+    static void EncodeOne(Slot* slot, LogHex const& value) {
+        Append(slot, kArgHex, value.data, value.size);
+    }
+
+    static std::atomic<LogLevel> level_;
+
+    std::unique_ptr<Slot[]>               slots_;
+    std::atomic<size_t>                   enqueue_pos_;
+    size_t                                dequeue_pos_; // Logger thread only.
+    std::atomic<size_t>                   written_;     // Ring position written and flushed by the sinks.
+    std::atomic<uint64_t>                 dropped_;
+    uint64_t                              reported_drops_; // Logger thread only.
+    std::atomic_bool                      is_running_;
+    std::atomic_bool                      is_waiting_; // Logger thread sleeping on an empty ring.
+    std::unique_ptr<std::thread>          thread_;
+    std::mutex                            mutex_; // Guards the thread start, the sinks and the wake up.
+    std::condition_variable               cond_;
+    std::vector<std::shared_ptr<LogSink>> sinks_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_LOGGER_H_
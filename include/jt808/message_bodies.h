@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  message_bodies.h
+// @Version :  1.0
+// @Time    :  2026/10/21 14:32:06
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_MESSAGE_BODIES_H_
+#define JT808_MESSAGE_BODIES_H_
+
+#include "jt808/message_schema.h"
+#include "jt808/protocol_parameter.h"
+
+namespace libjt808 {
+
+// Schemas of the message bodies shared by the parser and the packager.
+
+// Parse fields of ProtocolParameter.
+using ParseFields = decltype(ProtocolParameter::parse);
+
+// 0x0001/0x8001, the response to a message. Packaging answers the parsed message header instead.
+using GeneralResponseBody =
+    schema::Message<JT808_SCHEMA_FIELD(ParseFields, respone_flow_num, schema::Word),
+                    JT808_SCHEMA_FIELD(ParseFields, respone_msg_id, schema::Word),
+                    JT808_SCHEMA_FIELD(ParseFields, respone_result, schema::Byte)>;
+
+// 0x8003.
+using FillPacketBody =
+    schema::Message<JT808_SCHEMA_FIELD(FillPacket, first_packet_msg_flow_num, schema::Word),
+                    JT808_SCHEMA_FIELD(FillPacket, packet_id, schema::List<schema::Byte, schema::Word>)>;
+
+// 0x0100, the license plate takes the rest of the body, the VIN if the plate color is kVin.
+using RegisterBody = schema::Message<JT808_SCHEMA_FIELD(RegisterInfo, province_id, schema::Word),
+                                     JT808_SCHEMA_FIELD(RegisterInfo, city_id, schema::Word),
+                                     JT808_SCHEMA_FIELD(RegisterInfo, manufacturer_id, schema::Bytes<5>),
+                                     JT808_SCHEMA_FIELD(RegisterInfo, terminal_model, schema::String<20>),
+                                     JT808_SCHEMA_FIELD(RegisterInfo, terminal_id, schema::String<7>),
+                                     JT808_SCHEMA_FIELD(RegisterInfo, car_plate_color, schema::Byte),
+                                     JT808_SCHEMA_FIELD(RegisterInfo, car_plate_num, schema::Rest)>;
+
+// 0x8100, the authentication code takes the rest of the body, present if the result is 0 (success).
+using RegisterResponseBody =
+    schema::Message<JT808_SCHEMA_FIELD(ParseFields, respone_flow_num, schema::Word),
+                    JT808_SCHEMA_FIELD(ParseFields, respone_result, schema::Byte),
+                    JT808_SCHEMA_FIELD(ParseFields, authentication_code, schema::Rest)>;
+
+// 0x0102.
+using AuthenticationBody = schema::Rest;
+
+// 0x8106.
+using TerminalParameterIdsBody = schema::List<schema::Byte, schema::Dword>;
+
+// 0x8108.
+using UpgradeBody = schema::Message<JT808_SCHEMA_FIELD(UpgradeInfo, upgrade_type, schema::Byte),
+                                    JT808_SCHEMA_FIELD(UpgradeInfo, manufacturer_id, schema::Bytes<5>),
+                                    JT808_SCHEMA_FIELD(UpgradeInfo, version_id, schema::Prefixed<schema::Byte>),
+                                    JT808_SCHEMA_FIELD(UpgradeInfo, upgrade_data_total_len, schema::Dword),
+                                    JT808_SCHEMA_FIELD(UpgradeInfo, upgrade_data, schema::Rest)>;
+
+// 0x0108.
+using UpgradeResultBody = schema::Message<JT808_SCHEMA_FIELD(UpgradeInfo, upgrade_type, schema::Byte),
+                                          JT808_SCHEMA_FIELD(UpgradeInfo, upgrade_result, schema::Byte)>;
+
+// Basic location information of 0x0200, 0x0201, 0x0704 and 0x0801, followed by the additional information items.
+using LocationBasicBody = schema::Message<JT808_SCHEMA_FIELD(LocationBasicInformation, alarm, schema::Dword),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, status, schema::Dword),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, latitude, schema::Dword),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, longitude, schema::Dword),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, altitude, schema::Word),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, speed, schema::Word),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, bearing, schema::Word),
+                                          JT808_SCHEMA_FIELD(LocationBasicInformation, time, schema::Bcd<6>)>;
+using LocationExtensionsBody = schema::Tlv<schema::Byte, schema::Byte>;
+
+// 0x8202.
+using LocationTrackingControlBody =
+    schema::Message<JT808_SCHEMA_FIELD(LocationTrackingControl, interval, schema::Word),
+                    JT808_SCHEMA_FIELD(LocationTrackingControl, tracking_time, schema::Dword)>;
+
+// Point of an area or route, the altitude is not used.
+using AreaPointBody = schema::Message<JT808_SCHEMA_FIELD(LocationPoint, latitude, schema::Coordinate),
+                                      JT808_SCHEMA_FIELD(LocationPoint, longitude, schema::Coordinate)>;
+
+// An area of 0x8600, the optional time and speed limit follow.
+using CircularAreaHeadBody = schema::Message<JT808_SCHEMA_FIELD(CircularArea, area_id, schema::Dword),
+                                             JT808_SCHEMA_FIELD(CircularArea, area_attribute, schema::Word),
+                                             JT808_SCHEMA_FIELD(CircularArea, center, AreaPointBody),
+                                             JT808_SCHEMA_FIELD(CircularArea, radius, schema::Dword)>;
+
+// An area of 0x8602, the optional time and speed limit follow.
+using RectangleAreaHeadBody = schema::Message<JT808_SCHEMA_FIELD(RectangleArea, area_id, schema::Dword),
+                                              JT808_SCHEMA_FIELD(RectangleArea, area_attribute, schema::Word),
+                                              JT808_SCHEMA_FIELD(RectangleArea, upper_left, AreaPointBody),
+                                              JT808_SCHEMA_FIELD(RectangleArea, lower_right, AreaPointBody)>;
+
+// 0x8604 up to the optional time and speed limit, the vertices follow.
+using PolygonAreaHeadBody = schema::Message<JT808_SCHEMA_FIELD(PolygonArea, area_id, schema::Dword),
+                                            JT808_SCHEMA_FIELD(PolygonArea, area_attribute, schema::Word)>;
+using PolygonVerticesBody = schema::List<schema::Word, AreaPointBody>;
+
+// 0x8606 up to the optional time, the number of turning points and the turning points follow.
+using RouteHeadBody = schema::Message<JT808_SCHEMA_FIELD(Route, route_id, schema::Dword),
+                                      JT808_SCHEMA_FIELD(Route, route_attribute, schema::Word)>;
+
+// A turning point of 0x8606, the optional driving time thresholds and speed limit follow.
+using TurningPointHeadBody =
+    schema::Message<JT808_SCHEMA_FIELD(RouteTurningPoint, turning_point_id, schema::Dword),
+                    JT808_SCHEMA_FIELD(RouteTurningPoint, road_section_id, schema::Dword),
+                    JT808_SCHEMA_FIELD(RouteTurningPoint, point, AreaPointBody),
+                    JT808_SCHEMA_FIELD(RouteTurningPoint, road_width, schema::Byte),
+                    JT808_SCHEMA_FIELD(RouteTurningPoint, road_section_attribute, schema::Byte)>;
+using TurningPointDrivingTimeBody =
+    schema::Message<JT808_SCHEMA_FIELD(RouteTurningPoint, max_driving_time, schema::Word),
+                    JT808_SCHEMA_FIELD(RouteTurningPoint, min_driving_time, schema::Word)>;
+using TurningPointSpeedLimitBody =
+    schema::Message<JT808_SCHEMA_FIELD(RouteTurningPoint, max_speed, schema::Word),
+                    JT808_SCHEMA_FIELD(RouteTurningPoint, overspeed_time, schema::Byte)>;
+
+// 0x8601, 0x8603, 0x8605 and 0x8607, no IDs means all.
+using AreaIdsBody = schema::List<schema::Byte, schema::Dword>;
+
+// 0x0801.
+using MultimediaUploadBody =
+    schema::Message<JT808_SCHEMA_FIELD(MultiMediaDataUpload, media_id, schema::Dword),
+                    JT808_SCHEMA_FIELD(MultiMediaDataUpload, media_type, schema::Byte),
+                    JT808_SCHEMA_FIELD(MultiMediaDataUpload, media_format, schema::Byte),
+                    JT808_SCHEMA_FIELD(MultiMediaDataUpload, media_event, schema::Byte),
+                    JT808_SCHEMA_FIELD(MultiMediaDataUpload, channel_id, schema::Byte),
+                    JT808_SCHEMA_FIELD(MultiMediaDataUpload, loaction_report_body, schema::Bytes<28>),
+                    JT808_SCHEMA_FIELD(MultiMediaDataUpload, media_data, schema::Rest)>;
+
+// 0x8800, the retransmission list is left out once every packet was received.
+using MultimediaUploadResponseBody = schema::Message<
+    JT808_SCHEMA_FIELD(MultiMediaDataUploadResponse, media_id, schema::Dword),
+    JT808_SCHEMA_FIELD(MultiMediaDataUploadResponse, reload_packet_ids,
+                       schema::Optional<schema::List<schema::Byte, schema::Word>>)>;
+
+} // namespace libjt808
+
+#endif // JT808_MESSAGE_BODIES_H_
@@ -0,0 +1,509 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  message_schema.h
+// @Version :  1.0
+// @Time    :  2026/10/21 14:32:06
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_MESSAGE_SCHEMA_H_
+#define JT808_MESSAGE_SCHEMA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+#include <vector>
+
+#include "jt808/bcd.h"
+
+namespace libjt808 {
+
+// Message body schemas.
+// A schema lists the fields of a body in wire order, each a codec bound to a member of a struct, and generates both
+// the parsing and the packaging of the body:
+//
+//     using FillPacketSchema = schema::Message<
+//         JT808_SCHEMA_FIELD(FillPacket, first_packet_msg_flow_num, schema::Word),
+//         JT808_SCHEMA_FIELD(FillPacket, packet_id, schema::List<schema::Byte, schema::Word>)>;
+//
+//     FillPacketSchema::Read(body, body_size, &fill_packet);  // Bytes consumed, -1 if the body is too short.
+//     FillPacketSchema::Write(fill_packet, &out);             // Bytes appended, -1 if a value does not fit.
+//
+// Consecutive fixed size fields form a run: parsing checks the bytes left once per run and packaging grows the
+// output once per run, the fields of a run then read and write in place. Codecs also work alone on a value, e.g.
+// schema::List<schema::Byte, schema::Dword>::Read(body, size, &ids).
+//
+// Fixed size codecs define kFixed = true, kSize and
+//     static void Read(uint8_t const* data, T* value);
+//     static void Write(T const& value, uint8_t* data);
+// variable size codecs define kFixed = false and
+//     static int Read(uint8_t const* data, size_t const& size, T* value);  // Bytes consumed or -1.
+//     static int Write(T const& value, std::vector<uint8_t>* out);        // Bytes appended or -1.
+namespace schema {
+
+namespace internal {
+
+// Wire value of an integer, or of a bit union of the protocol through its value member.
+template <typename T>
+auto ToWire(T const& value, int) -> decltype(value.value) {
+    return value.value;
+}
+template <typename T>
+T const& ToWire(T const& value, long) {
+    return value;
+}
+template <typename T, typename W>
+auto FromWire(T* value, W const& wire, int) -> decltype(void(value->value = wire)) {
+    value->value = wire;
+}
+template <typename T, typename W>
+void FromWire(T* value, W const& wire, long) {
+    *value = static_cast<T>(wire);
+}
+
+// Big endian unsigned integer of N bytes.
+template <size_t N>
+struct BigEndian {
+    static constexpr bool   kFixed = true;
+    static constexpr size_t kSize  = N;
+    static constexpr size_t kMax   = (static_cast<uint64_t>(1) << (N * 8 - 1) << 1) - 1; // N < 8.
+
+    template <typename T>
+    static void Read(uint8_t const* data, T* value) {
+        uint64_t wire = 0;
+        for (size_t i = 0; i < N; ++i)
+            wire = (wire << 8) | data[i];
+        FromWire(value, wire, 0);
+    }
+    template <typename T>
+    static void Write(T const& value, uint8_t* data) {
+        uint64_t wire = static_cast<uint64_t>(ToWire(value, 0));
+        for (size_t i = 0; i < N; ++i)
+            data[i] = static_cast<uint8_t>(wire >> (N - 1 - i) * 8);
+    }
+};
+
+// Sum of the sizes of the leading fixed size codecs.
+template <typename... Codecs>
+struct FixedRun {
+    static constexpr size_t value = 0;
+};
+template <typename Codec, typename... Rest>
+struct FixedRun<Codec, Rest...> {
+    static constexpr size_t value = Codec::kFixed ? Codec::kSize + FixedRun<Rest...>::value : 0;
+};
+
+template <typename... Codecs>
+struct AllFixed {
+    static constexpr bool value = true;
+};
+template <typename Codec, typename... Rest>
+struct AllFixed<Codec, Rest...> {
+    static constexpr bool value = Codec::kFixed && AllFixed<Rest...>::value;
+};
+
+using FixedTag    = std::true_type;
+using VariableTag = std::false_type;
+
+// Fields of a message in wire order.
+template <typename Object, typename... Fields>
+struct Sequence {
+    static int Read(uint8_t const*, size_t const&, size_t const&, Object*) {
+        return 0;
+    }
+    static int Write(Object const&, std::vector<uint8_t>*, size_t const&) {
+        return 0;
+    }
+    static void ReadFixed(uint8_t const*, Object*) {
+    }
+    static void WriteFixed(Object const&, uint8_t*) {
+    }
+};
+
+template <typename Object, typename Field, typename... Rest>
+struct Sequence<Object, Field, Rest...> {
+    using Next = Sequence<Object, Rest...>;
+
+    // checked: Bytes from data known to be within size, what remains of the current run.
+    static int Read(uint8_t const* data, size_t const& size, size_t checked, Object* object) {
+        return Read(data, size, checked, object, std::integral_constant<bool, Field::kFixed>());
+    }
+    // reserved: Bytes at the end of out grown for the current run and not yet written.
+    static int Write(Object const& object, std::vector<uint8_t>* out, size_t reserved) {
+        return Write(object, out, reserved, std::integral_constant<bool, Field::kFixed>());
+    }
+    // All fields fixed size, the bounds are the caller's.
+    static void ReadFixed(uint8_t const* data, Object* object) {
+        Field::Read(data, object);
+        Next::ReadFixed(data + Field::kSize, object);
+    }
+    static void WriteFixed(Object const& object, uint8_t* data) {
+        Field::Write(object, data);
+        Next::WriteFixed(object, data + Field::kSize);
+    }
+
+private:
+    static int Read(uint8_t const* data, size_t const& size, size_t checked, Object* object, FixedTag) {
+        if (checked < Field::kSize) { // First field of a run.
+            checked = FixedRun<Field, Rest...>::value;
+            if (size < checked)
+                return -1;
+        }
+        Field::Read(data, object);
+        int rest = Next::Read(data + Field::kSize, size - Field::kSize, checked - Field::kSize, object);
+        return rest < 0 ? -1 : static_cast<int>(Field::kSize) + rest;
+    }
+    static int Read(uint8_t const* data, size_t const& size, size_t const&, Object* object, VariableTag) {
+        int used = Field::Read(data, size, object);
+        if (used < 0)
+            return -1;
+        int rest = Next::Read(data + used, size - used, 0, object);
+        return rest < 0 ? -1 : used + rest;
+    }
+    static int Write(Object const& object, std::vector<uint8_t>* out, size_t reserved, FixedTag) {
+        if (reserved < Field::kSize) { // First field of a run.
+            reserved = FixedRun<Field, Rest...>::value;
+            out->resize(out->size() + reserved);
+        }
+        Field::Write(object, out->data() + out->size() - reserved);
+        int rest = Next::Write(object, out, reserved - Field::kSize);
+        return rest < 0 ? -1 : static_cast<int>(Field::kSize) + rest;
+    }
+    static int Write(Object const& object, std::vector<uint8_t>* out, size_t const&, VariableTag) {
+        int used = Field::Write(object, out);
+        if (used < 0)
+            return -1;
+        int rest = Next::Write(object, out, 0);
+        return rest < 0 ? -1 : used + rest;
+    }
+};
+
+} // namespace internal
+
+// BYTE, WORD and DWORD, of integer members or of bit unions with a value member.
+using Byte  = internal::BigEndian<1>;
+using Word  = internal::BigEndian<2>;
+using Dword = internal::BigEndian<4>;
+
+// DWORD of millionths of a degree, of a double of degrees.
+struct Coordinate {
+    static constexpr bool   kFixed = true;
+    static constexpr size_t kSize  = Dword::kSize;
+
+    static void Read(uint8_t const* data, double* value) {
+        uint32_t wire = 0;
+        Dword::Read(data, &wire);
+        *value = wire * 1e-6;
+    }
+    static void Write(double const& value, uint8_t* data) {
+        Dword::Write(static_cast<uint32_t>(value * 1e6 + 0.5), data);
+    }
+};
+
+// BCD[N] of a std::string of up to 2 * N digits, right aligned; malformed digits package as zeros.
+template <size_t N>
+struct Bcd {
+    static constexpr bool   kFixed = true;
+    static constexpr size_t kSize  = N;
+
+    static void Read(uint8_t const* data, std::string* value) {
+        char digits[2 * N];
+        BcdToDigits(data, N, digits);
+        value->assign(digits, sizeof(digits));
+    }
+    static void Write(std::string const& value, uint8_t* data) {
+        if (DigitsToBcd(value.data(), value.size(), data, N) != 0)
+            memset(data, 0, N);
+    }
+};
+
+// BYTE[N] of a std::string or std::vector<uint8_t>, packaged truncated or padded with 0x00.
+// Parsing keeps all N bytes, String parsing stops at the first 0x00.
+template <size_t N, bool kStopAtZero = false>
+struct Bytes {
+    static constexpr bool   kFixed = true;
+    static constexpr size_t kSize  = N;
+
+    template <typename T>
+    static void Read(uint8_t const* data, T* value) {
+        size_t size = N;
+        if (kStopAtZero) {
+            auto zero = static_cast<uint8_t const*>(memchr(data, 0, N));
+            if (zero != nullptr)
+                size = zero - data;
+        }
+        value->assign(data, data + size);
+    }
+    template <typename T>
+    static void Write(T const& value, uint8_t* data) {
+        size_t size = value.size() < N ? value.size() : N;
+        if (size > 0)
+            memcpy(data, &value[0], size);
+        memset(data + size, 0, N - size);
+    }
+};
+template <size_t N>
+using String = Bytes<N, true>;
+
+// The rest of the body as a std::string or std::vector<uint8_t>.
+struct Rest {
+    static constexpr bool   kFixed = false;
+    static constexpr size_t kSize  = 0;
+
+    template <typename T>
+    static int Read(uint8_t const* data, size_t const& size, T* value) {
+        value->assign(data, data + size);
+        return static_cast<int>(size);
+    }
+    template <typename T>
+    static int Write(T const& value, std::vector<uint8_t>* out) {
+        out->insert(out->end(), value.begin(), value.end());
+        return static_cast<int>(value.size());
+    }
+};
+
+// Bytes of a std::string or std::vector<uint8_t> prefixed with their number, Length is Byte or Word.
+template <typename Length>
+struct Prefixed {
+    static constexpr bool   kFixed = false;
+    static constexpr size_t kSize  = 0;
+
+    template <typename T>
+    static int Read(uint8_t const* data, size_t const& size, T* value) {
+        size_t length = 0;
+        if (size < Length::kSize)
+            return -1;
+        Length::Read(data, &length);
+        if (size - Length::kSize < length)
+            return -1;
+        value->assign(data + Length::kSize, data + Length::kSize + length);
+        return static_cast<int>(Length::kSize + length);
+    }
+    template <typename T>
+    static int Write(T const& value, std::vector<uint8_t>* out) {
+        if (value.size() > Length::kMax)
+            return -1;
+        out->resize(out->size() + Length::kSize);
+        Length::Write(value.size(), out->data() + out->size() - Length::kSize);
+        out->insert(out->end(), value.begin(), value.end());
+        return static_cast<int>(Length::kSize + value.size());
+    }
+};
+
+// std::vector of elements prefixed with their number, Count is Byte or Word and Element any codec.
+// The bounds of fixed size elements are checked once for the whole list.
+template <typename Count, typename Element>
+struct List {
+    static constexpr bool   kFixed = false;
+    static constexpr size_t kSize  = 0;
+
+    template <typename T>
+    static int Read(uint8_t const* data, size_t const& size, std::vector<T>* value) {
+        size_t count = 0;
+        if (size < Count::kSize)
+            return -1;
+        Count::Read(data, &count);
+        int used = Read(data + Count::kSize, size - Count::kSize, count, value,
+                        std::integral_constant<bool, Element::kFixed>());
+        return used < 0 ? -1 : static_cast<int>(Count::kSize) + used;
+    }
+    template <typename T>
+    static int Write(std::vector<T> const& value, std::vector<uint8_t>* out) {
+        if (value.size() > Count::kMax)
+            return -1;
+        out->resize(out->size() + Count::kSize);
+        Count::Write(value.size(), out->data() + out->size() - Count::kSize);
+        int used = Write(value, out, std::integral_constant<bool, Element::kFixed>());
+        return used < 0 ? -1 : static_cast<int>(Count::kSize) + used;
+    }
+
+private:
+    template <typename T>
+    static int Read(uint8_t const* data, size_t const& size, size_t const& count, std::vector<T>* value,
+                    internal::FixedTag) {
+        if (size / Element::kSize < count)
+            return -1;
+        value->resize(count);
+        for (size_t i = 0; i < count; ++i)
+            Element::Read(data + i * Element::kSize, &(*value)[i]);
+        return static_cast<int>(count * Element::kSize);
+    }
+    template <typename T>
+    static int Read(uint8_t const* data, size_t const& size, size_t const& count, std::vector<T>* value,
+                    internal::VariableTag) {
+        value->resize(count);
+        size_t pos = 0;
+        for (size_t i = 0; i < count; ++i) {
+            int used = Element::Read(data + pos, size - pos, &(*value)[i]);
+            if (used < 0)
+                return -1;
+            pos += used;
+        }
+        return static_cast<int>(pos);
+    }
+    template <typename T>
+    static int Write(std::vector<T> const& value, std::vector<uint8_t>* out, internal::FixedTag) {
+        size_t begin = out->size();
+        out->resize(begin + value.size() * Element::kSize);
+        for (size_t i = 0; i < value.size(); ++i)
+            Element::Write(value[i], out->data() + begin + i * Element::kSize);
+        return static_cast<int>(value.size() * Element::kSize);
+    }
+    template <typename T>
+    static int Write(std::vector<T> const& value, std::vector<uint8_t>* out, internal::VariableTag) {
+        int total = 0;
+        for (auto const& element : value) {
+            int used = Element::Write(element, out);
+            if (used < 0)
+                return -1;
+            total += used;
+        }
+        return total;
+    }
+};
+
+// Items of an ID and a length up to the end of the body, into a map of ID to bytes, e.g. the location additional
+// information. A trailing partial item header is ignored.
+template <typename Id, typename Length>
+struct Tlv {
+    static constexpr bool   kFixed = false;
+    static constexpr size_t kSize  = 0;
+
+    template <typename Map>
+    static int Read(uint8_t const* data, size_t const& size, Map* value) {
+        value->clear();
+        size_t pos = 0;
+        while (size - pos >= Id::kSize + Length::kSize) {
+            typename Map::key_type id;
+            size_t                 length = 0;
+            Id::Read(data + pos, &id);
+            Length::Read(data + pos + Id::kSize, &length);
+            pos += Id::kSize + Length::kSize;
+            if (size - pos < length)
+                return -1;
+            (*value)[id].assign(data + pos, data + pos + length);
+            pos += length;
+        }
+        return static_cast<int>(size);
+    }
+    template <typename Map>
+    static int Write(Map const& value, std::vector<uint8_t>* out) {
+        int total = 0;
+        for (auto const& item : value) {
+            if (item.second.size() > Length::kMax)
+                return -1;
+            size_t begin = out->size();
+            out->resize(begin + Id::kSize + Length::kSize);
+            Id::Write(item.first, out->data() + begin);
+            Length::Write(item.second.size(), out->data() + begin + Id::kSize);
+            out->insert(out->end(), item.second.begin(), item.second.end());
+            total += static_cast<int>(Id::kSize + Length::kSize + item.second.size());
+        }
+        return total;
+    }
+};
+
+// A trailing container field that is left out when empty, e.g. the retransmission list of 0x8800.
+template <typename Codec>
+struct Optional {
+    static constexpr bool   kFixed = false;
+    static constexpr size_t kSize  = 0;
+
+    template <typename T>
+    static int Read(uint8_t const* data, size_t const& size, T* value) {
+        if (size == 0) {
+            value->clear();
+            return 0;
+        }
+        return Codec::Read(data, size, value);
+    }
+    template <typename T>
+    static int Write(T const& value, std::vector<uint8_t>* out) {
+        return value.empty() ? 0 : Codec::Write(value, out);
+    }
+};
+
+// Codec bound to a member, use JT808_SCHEMA_FIELD().
+template <typename Codec, typename Member, Member kMember>
+struct Field;
+template <typename Codec, typename Class, typename T, T Class::*kMember>
+struct Field<Codec, T Class::*, kMember> {
+    using Object                   = Class;
+    static constexpr bool   kFixed = Codec::kFixed;
+    static constexpr size_t kSize  = Codec::kSize;
+
+    static void Read(uint8_t const* data, Object* object) {
+        Codec::Read(data, &(object->*kMember));
+    }
+    static void Write(Object const& object, uint8_t* data) {
+        Codec::Write(object.*kMember, data);
+    }
+    static int Read(uint8_t const* data, size_t const& size, Object* object) {
+        return Codec::Read(data, size, &(object->*kMember));
+    }
+    static int Write(Object const& object, std::vector<uint8_t>* out) {
+        return Codec::Write(object.*kMember, out);
+    }
+};
+
+// Fields of a struct in wire order, a codec itself so messages nest as fields and list elements.
+template <typename First, typename... Fields>
+struct Message {
+    using Object                   = typename First::Object;
+    static constexpr bool   kFixed = internal::AllFixed<First, Fields...>::value;
+    static constexpr size_t kSize  = kFixed ? internal::FixedRun<First, Fields...>::value : 0;
+
+    // Returns the bytes consumed, -1 if size is too short.
+    static int Read(uint8_t const* data, size_t const& size, Object* object) {
+        return Sequence::Read(data, size, 0, object);
+    }
+    // Returns the bytes appended, -1 if a value does not fit its field.
+    static int Write(Object const& object, std::vector<uint8_t>* out) {
+        return Sequence::Write(object, out, 0);
+    }
+    // Fixed size messages only, the bounds are the caller's.
+    static void Read(uint8_t const* data, Object* object) {
+        static_assert(kFixed, "Variable size message");
+        Sequence::ReadFixed(data, object);
+    }
+    static void Write(Object const& object, uint8_t* data) {
+        static_assert(kFixed, "Variable size message");
+        Sequence::WriteFixed(object, data);
+    }
+
+private:
+    using Sequence = internal::Sequence<Object, First, Fields...>;
+};
+
+} // namespace schema
+
+} // namespace libjt808
+
+// Field of a schema::Message: a codec bound to a member of a struct. The codec comes last, it may contain commas.
+#define JT808_SCHEMA_FIELD(Class, member, ...) \
+    ::libjt808::schema::Field<__VA_ARGS__, decltype(&Class::member), &Class::member>
+
+#endif // JT808_MESSAGE_SCHEMA_H_
@@ -0,0 +1,278 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  metrics.h
+// @Version :  1.0
+// @Time    :  2026/10/17 09:30:15
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_METRICS_H_
+#define JT808_METRICS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libjt808 {
+
+// Latency histogram.
+// Values below kSubBuckets are exact, above that every power of two is split into kSubBuckets linear buckets, so a
+// percentile is within 1/kSubBuckets of the recorded value whatever its magnitude. The unit is up to the caller.
+class LatencyHistogram {
+public:
+    static constexpr int    kSubBucketBits = 4;
+    static constexpr int    kSubBuckets    = 1 << kSubBucketBits;
+    static constexpr size_t kBucketCount   = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram();
+
+    // Record a sample.
+    void Record(uint64_t const& value);
+    // Add all samples of another histogram.
+    void Merge(LatencyHistogram const& other);
+    // Add samples already sorted into buckets, buckets must hold kBucketCount counts.
+    void Merge(uint64_t const* buckets, uint64_t const& sum, uint64_t const& min, uint64_t const& max);
+    // Remove all samples.
+    void Reset(void);
+    // Upper bound of the bucket holding the given percentile (0-100), 0 if empty.
+    uint64_t Percentile(double const& percentile) const;
+
+    // Bucket holding the value.
+    static size_t BucketIndex(uint64_t const& value);
+    // Largest value held by the bucket.
+    static uint64_t BucketUpperBound(size_t const& index);
+
+    uint64_t count(void) const {
+        return count_;
+    }
+
+    uint64_t sum(void) const {
+        return sum_;
+    }
+
+    uint64_t min(void) const {
+        return count_ ? min_ : 0;
+    }
+
+    uint64_t max(void) const {
+        return max_;
+    }
+
+    uint64_t mean(void) const {
+        return count_ ? sum_ / count_ : 0;
+    }
+
+    std::vector<uint64_t> const& buckets(void) const {
+        return buckets_;
+    }
+
+private:
+    std::vector<uint64_t> buckets_;
+    uint64_t              count_;
+    uint64_t              sum_;
+    uint64_t              min_;
+    uint64_t              max_;
+};
+
+// Server counters.
+enum MetricCounter {
+    kBytesIn = 0,            // Bytes received.
+    kBytesOut,               // Bytes sent.
+    kEscapeBytesIn,          // Bytes added by escaping in the received frames.
+    kEscapeBytesOut,         // Bytes added by escaping in the sent frames.
+    kConnectionsAccepted,    // Connections accepted.
+    kHandshakeFailures,      // Connections closed before authentication completed.
+    kDisconnects,            // Authenticated connections closed.
+    kSendFailures,           // Messages failed to be packaged or sent.
+    kReceiveBufferOverflows, // Receive buffers discarded for holding no complete frame.
+    kFillRequests,           // Fill packet requests (0x8003) sent for the missing packets of segmented messages.
+    kReassemblyDrops,        // Segmented messages dropped incomplete.
+    kSessionsRestored,       // Connections authenticated with a stored session, without registration.
+    kSessionsTakenOver,      // Connections taken over from a previous server process.
+    kDownlinksForwarded,     // Messages for terminals held by another server process forwarded to it.
+    kIdleDisconnects,        // Authenticated connections closed for receiving nothing within the idle timeout.
+    kDownlinkRetransmits,    // Packets of messages sent to terminals retransmitted for lack of acknowledgement.
+    kDownlinkTimeouts,       // Messages sent to terminals given up unacknowledged after the last retransmission.
+    kIngestRecords,          // Messages handed over to the ingest pipeline.
+    kIngestDrops,            // Messages dropped by the ingest pipeline for a full ring.
+    kMetricCounterCount,
+};
+
+// Server gauges, current levels.
+enum MetricGauge {
+    kActiveSessions = 0,  // Authenticated connections.
+    kPendingSessions,     // Authenticated connections not yet taken over by the service thread.
+    kReassemblyBuffers,   // Segmented messages being reassembled.
+    kReceiveBufferBytes,  // Bytes waiting for the rest of their frame.
+    kReassemblyBytes,     // Packet bytes of the segmented messages being reassembled.
+    kTimers,              // Timers pending on the main service thread.
+    kMetricGaugeCount,
+};
+
+// Server latency histograms.
+enum MetricHistogram {
+    kHandshakeMicros = 0, // Accept to authentication response, microseconds.
+    kFrameHandleNanos,    // Parse, handle and respond to one received frame, nanoseconds.
+    kMetricHistogramCount,
+};
+
+// Metrics aggregated over all threads.
+struct MetricsSnapshot {
+    uint64_t         counters[kMetricCounterCount];
+    int64_t          gauges[kMetricGaugeCount];
+    LatencyHistogram histograms[kMetricHistogramCount];
+    // Message ID - frames received and sent. Message IDs beyond the per thread table are counted under 0xFFFF.
+    std::map<uint16_t, std::pair<uint64_t, uint64_t>> frames;
+    // ParserError value - received frames failed to parse. Values below ReassemblyError are counted under -9.
+    std::map<int, uint64_t> parse_errors;
+};
+
+// Low overhead metrics.
+// Counters and histograms are written to a shard owned by the writing thread with relaxed atomic stores, so the
+// hot path takes no lock and shares no cache line with other threads. Readers sum the shards on demand.
+// Gauges are levels shared by all threads.
+//
+// Example:
+//     Metrics metrics;
+//     auto shard = metrics.CreateShard();  // Once per thread.
+//     shard->Add(kBytesIn, ret);
+//     shard->FrameIn(msg_id);
+//     MetricsSnapshot snapshot;
+//     metrics.Snapshot(&snapshot);         // Any thread.
+class Metrics {
+public:
+    // Per thread part of the metrics, only the owning thread may write it.
+    class Shard {
+    public:
+        Shard();
+
+        void Add(MetricCounter const& counter, uint64_t const& value) {
+            Increase(&counters_[counter], value);
+        }
+
+        void FrameIn(uint16_t const& msg_id) {
+            Increase(&FrameSlot(msg_id)->in, 1);
+        }
+
+        void FrameOut(uint16_t const& msg_id) {
+            Increase(&FrameSlot(msg_id)->out, 1);
+        }
+
+        // Count a parse failure, error is the ParserError value.
+        void ParseError(int const& error);
+
+        void Record(MetricHistogram const& histogram, uint64_t const& value);
+
+    private:
+        friend class Metrics;
+
+        static constexpr size_t kFrameSlots      = 64; // Distinct message IDs per thread, power of two.
+        static constexpr size_t kParseErrorSlots = 10; // ParserError values are 0 to -8, then one for others.
+
+        struct FrameCounter {
+            std::atomic<uint32_t> key; // Message ID + 1, 0 when the slot is free.
+            std::atomic<uint64_t> in;
+            std::atomic<uint64_t> out;
+        };
+
+        struct Histogram {
+            std::atomic<uint64_t> buckets[LatencyHistogram::kBucketCount];
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> min;
+            std::atomic<uint64_t> max;
+        };
+
+        // Single writer increment, no read-modify-write instruction needed.
+        static void Increase(std::atomic<uint64_t>* value, uint64_t const& delta) {
+            value->store(value->load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+        FrameCounter* FrameSlot(uint16_t const& msg_id);
+
+        std::atomic<uint64_t> counters_[kMetricCounterCount];
+        std::atomic<uint64_t> parse_errors_[kParseErrorSlots];
+        FrameCounter          frames_[kFrameSlots];
+        Histogram             histograms_[kMetricHistogramCount];
+    };
+
+    Metrics();
+    ~Metrics();
+
+    // Create a shard for the calling thread. The shard lives as long as the metrics.
+    Shard* CreateShard(void);
+
+    void SetGauge(MetricGauge const& gauge, int64_t const& value) {
+        gauges_[gauge].store(value, std::memory_order_relaxed);
+    }
+
+    void AddGauge(MetricGauge const& gauge, int64_t const& delta) {
+        gauges_[gauge].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // Sum all shards. Thread safe.
+    void Snapshot(MetricsSnapshot* snapshot) const;
+
+    // Format a snapshot in the Prometheus text exposition format, metric names start with prefix.
+    static std::string FormatPrometheus(MetricsSnapshot const& snapshot, std::string const& prefix = "jt808_");
+
+    // Write the Prometheus text of the current metrics to a file, replaced atomically so that a collector never reads
+    // a partial file.
+    // Returns 0 on success, -1 on failure.
+    int WritePrometheusFile(std::string const& path) const;
+
+private:
+    std::atomic<int64_t>                gauges_[kMetricGaugeCount];
+    mutable std::mutex                  shards_mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+// Serves the Prometheus text of a Metrics over HTTP on a local port, for scraping.
+// Every request gets the current metrics whatever its path, then the connection is closed.
+class MetricsHttpExporter {
+public:
+    MetricsHttpExporter();
+    ~MetricsHttpExporter();
+
+    // Listen on ip:port and serve from a background thread.
+    // Returns 0 on success, -1 on failure.
+    int Start(Metrics const* metrics, std::string const& ip, int const& port);
+    // Stop serving and close the listening socket.
+    void Stop(void);
+
+private:
+    class Impl;
+
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_METRICS_H_
@@ -30,6 +30,7 @@
 #ifndef JT808_PACKAGER_H_
 #define JT808_PACKAGER_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <functional>
@@ -60,8 +61,48 @@ bool JT808FramePackagerOverride(Packager* packager, std::pair<uint16_t, PackageH
 bool JT808FramePackagerOverride(Packager* packager, uint16_t const& msg_id, PackageHandler const& handler);
 
 // Packaging command.
+// Returns 0 on success, -1 on failure, e.g. a message body longer than kMaxMsgBodyLength.
 int JT808FramePackage(Packager const& packager, ProtocolParameter const& para, std::vector<uint8_t> &out);
 
+// Maximum length of the message body of a frame, the 10 bits of the message body length.
+constexpr size_t kMaxMsgBodyLength = 1023;
+
+// Frames of a message packaged as sub-packets.
+// The frames lie back to back in one buffer, ready to be sent with a single write, and are kept to retransmit the
+// packets a 0x8003 fill packet request or a 0x8800 multimedia data upload response asks for.
+struct SegmentedFrames {
+    std::vector<uint8_t> data;    // Escaped frames in the order of their packet sequence number.
+    std::vector<size_t>  offsets; // Offset of each frame in data, followed by the size of data.
+    uint16_t first_flow_num = 0;  // Message flow number of the first packet, the others follow consecutively.
+
+    uint16_t count(void) const {
+        return offsets.empty() ? 0 : static_cast<uint16_t>(offsets.size() - 1);
+    }
+    // Frame of a packet, packet_seq counts from 1.
+    // Returns 0 on success, -1 if the packet does not exist.
+    int Frame(uint16_t const& packet_seq, uint8_t const** frame, size_t* size) const;
+    // Append the frames of packets, e.g. FillPacket::packet_id, to out.
+    // Returns 0 on success, -1 if a packet does not exist.
+    int Retransmit(std::vector<uint16_t> const& packet_seqs, std::vector<uint8_t>* out) const;
+};
+
+// Package a message body of any length as sub-packets of at most max_packet_body bytes of body each, numbered from 1
+// with consecutive message flow numbers from msg_head.msg_flow_num. A body that fits a single packet is packaged as
+// an unsegmented frame. The caller advances its message flow number by the number of packets.
+// Returns the number of packets on success, -1 on failure, e.g. more than 65535 packets.
+//
+// Example:
+//     SegmentedFrames frames;
+//     int count = JT808SegmentedPackage(para.msg_head, body.data(), body.size(), kMaxMsgBodyLength, &frames);
+//     para.msg_head.msg_flow_num += count;
+//     Send(socket, frames.data.data(), frames.data.size(), 0);
+//     ... on 0x8003: frames.Retransmit(para.parse.fill_packet.packet_id, &out);
+int JT808SegmentedPackage(MsgHead const& msg_head, uint8_t const* body, size_t const& size,
+                          size_t const& max_packet_body, SegmentedFrames* frames);
+// As above, with the body generated by the packaging handler of para.msg_head.msg_id.
+int JT808SegmentedPackage(Packager const& packager, ProtocolParameter const& para, size_t const& max_packet_body,
+                          SegmentedFrames* frames);
+
 } // namespace libjt808
 
 #endif // JT808_PACKAGER_H_
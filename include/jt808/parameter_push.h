@@ -0,0 +1,171 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  parameter_push.h
+// @Version :  1.0
+// @Time    :  2026/10/20 10:12:33
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_PARAMETER_PUSH_H_
+#define JT808_PARAMETER_PUSH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "jt808/terminal_parameter_store.h"
+
+namespace libjt808 {
+
+// Parameters of desired that are missing from or differ in snapshot.
+// Returns 0 on success, -1 on failure.
+int TerminalParameterDelta(TerminalParameterStore const& desired, TerminalParameterStore const& snapshot,
+                           TerminalParameterStore* delta);
+
+// Split parameters into as few 0x8103 bodies of at most max_body_size bytes as possible, first fit by decreasing size.
+// Returns 0 on success, -1 if max_body_size cannot hold a single parameter.
+int PackTerminalParameters(TerminalParameterStore const& parameters, size_t const& max_body_size,
+                           std::vector<TerminalParameterStore>* batches);
+
+struct ParameterPushOptions {
+    size_t   max_in_flight  = 512;   // Terminals with an unacknowledged 0x8103 at a time.
+    uint32_t ack_timeout_ms = 10000; // Wait for the terminal general response before retrying.
+    int      max_retries    = 2;     // Retries of a frame after a timeout.
+    size_t   max_body_size  = 1023;  // Body size limit of a 0x8103 frame.
+};
+
+enum ParameterPushStatus {
+    kParameterPushUpToDate = 0x0, // The snapshot already matched, nothing sent.
+    kParameterPushAcked,          // Every frame acknowledged with kSuccess.
+    kParameterPushRejected,       // A frame acknowledged with another result.
+    kParameterPushTimeout,        // A frame was not acknowledged after the retries.
+    kParameterPushDisconnected,   // Disconnected or the send failed before every frame was acknowledged.
+};
+
+struct ParameterPushResult {
+    std::string         terminal;
+    ParameterPushStatus status;
+    uint16_t            frames_acked;
+};
+
+struct ParameterPushProgress {
+    size_t queued;    // Terminals waiting for a slot.
+    size_t in_flight; // Terminals holding a slot.
+    size_t finished;  // Terminals with a result.
+};
+
+// Bulk 0x8103 push of desired parameters to a fleet.
+// Each terminal is sent only the parameters its last known 0x0104 snapshot lacks or differs in, packed into the
+// fewest frames under the body limit. Terminals of a fleet mostly share a snapshot, so packed deltas are cached by
+// their content and shared. At most max_in_flight terminals are in flight, each with a single frame awaiting its
+// terminal general response, so a slow terminal holds one slot and never the fleet.
+// The push is transport independent and single threaded: the owner feeds responses and disconnections and calls
+// Poll() regularly with a send function, JT808Server drives it from its service thread.
+//
+// Example:
+//     ParameterPush push(desired);
+//     push.AddTerminal(phone, snapshot);
+//     while (!push.finished()) {
+//         push.Poll(now_ms, send);
+//         ... push.OnResponse(phone, flow_num, result, &batch);
+//     }
+class ParameterPush {
+public:
+    // Send a 0x8103 frame with the batch, setting flow_num to its message flow number.
+    // Returns 0 on success, -1 if the terminal is gone.
+    using SendFunction =
+        std::function<int(std::string const& terminal, TerminalParameterStore const& batch, uint16_t* flow_num)>;
+
+    explicit ParameterPush(TerminalParameterStore const& desired,
+                           ParameterPushOptions const& options = ParameterPushOptions());
+
+    // Queue a terminal with its last known parameters, empty if unknown.
+    // Returns 0 on success, -1 if it is already queued.
+    int AddTerminal(std::string const& terminal, TerminalParameterStore const& snapshot);
+
+    // Send the next frames within the in flight limit and retry or fail the expired ones.
+    void Poll(int64_t const& now_ms, SendFunction const& send);
+    // Feed a terminal general response. On acknowledging a pending frame returns 0 and sets batch, if not nullptr, to
+    // the parameters the terminal applied. Returns -1 if the response does not match a pending frame.
+    int OnResponse(std::string const& terminal, uint16_t const& flow_num, uint8_t const& result,
+                   TerminalParameterStore const** batch);
+    void OnDisconnected(std::string const& terminal);
+
+    bool finished(void) const {
+        return queue_.empty() && ready_.empty() && in_flight_ == 0;
+    }
+    ParameterPushProgress progress(void) const {
+        return {queue_.size(), in_flight_, results_.size()};
+    }
+    // Distinct packed deltas among the terminals.
+    size_t plan_count(void) const {
+        return plans_.size();
+    }
+    std::vector<ParameterPushResult> const& results(void) const {
+        return results_;
+    }
+
+private:
+    using Plan = std::shared_ptr<std::vector<TerminalParameterStore> const>;
+
+    struct Terminal {
+        Plan     plan;
+        size_t   next;       // Frame of plan to send or awaiting its response.
+        bool     in_flight;  // Holding a slot.
+        bool     pending;    // Frame next sent and awaiting its response.
+        uint16_t flow_num;   // Flow number of the pending frame.
+        int      retries;    // Retries of the pending frame.
+        uint32_t generation; // Sends of the terminal, tells stale timeouts.
+    };
+
+    struct Timeout {
+        int64_t     deadline_ms;
+        std::string terminal;
+        uint32_t    generation;
+    };
+
+    void Send(std::string const& terminal, Terminal* state, int64_t const& now_ms, SendFunction const& send);
+    void Finish(std::string const& terminal, Terminal* state, ParameterPushStatus const& status);
+
+    TerminalParameterStore                    desired_;
+    ParameterPushOptions                      options_;
+    std::unordered_map<std::string, Plan>     plans_; // Encoded delta (key) - packed delta (value).
+    std::unordered_map<std::string, Terminal> terminals_;
+    std::deque<std::string>                   queue_; // Terminals waiting for a slot.
+    std::deque<std::string>                   ready_; // Terminals in flight with an acknowledged frame.
+    std::deque<Timeout>                       timeouts_; // Ascending by deadline, the timeout is the same for all.
+    size_t                                    in_flight_ = 0;
+    std::vector<ParameterPushResult>          results_;
+    std::vector<uint8_t>                      scratch_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_PARAMETER_PUSH_H_
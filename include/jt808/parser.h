@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "jt808/protocol_parameter.h"
+#include "jt808/reassembly.h"
 
 namespace libjt808 {
 
@@ -53,6 +54,8 @@ enum class ParserError
     ChecksumError = -4,
     HeaderParseError = -5,
     UnregisteredMessageParser = -6,
+    PacketPending = -7,
+    ReassemblyError = -8,
 };
 
 class ParserCategory : public std::error_category
@@ -75,6 +78,8 @@ public:
             case ParserError::ChecksumError: return "Checksum verification error";
             case ParserError::HeaderParseError: return "Header Parser Error";
             case ParserError::UnregisteredMessageParser: return "Message-specific parser is not registered";
+            case ParserError::PacketPending: return "Packet stored, the segmented message is incomplete";
+            case ParserError::ReassemblyError: return "Packet rejected by the segmented message reassembly";
         }
         return "Unknown Parser Error";
     }
@@ -135,6 +140,43 @@ bool JT808FrameParserOverride(Parser* parser, uint16_t const& msg_id, ParseHandl
  */
 std::error_code JT808FrameParse(Parser const& parser, InputBuffer in, ProtocolParameter* para);
 
+// Parsing function of a message body reassembled from its packets.
+// Returns 0 on success, -1 on failure.
+using SegmentedParseHandler = std::function<int(ScatterList const& body, ProtocolParameter* para)>;
+
+// Segmented message parser, map<key, value>, key: message ID, value: reassembled message body parsing handler.
+using SegmentedParser = std::map<uint16_t, SegmentedParseHandler>;
+
+// Whether the body of a message ID is handed out undecoded, see JT808FrameParse().
+using RawBodyPredicate = std::function<bool(uint16_t const& msg_id)>;
+
+// Segmented message parser initialization, provides 0x0801 and 0x8108.
+int JT808SegmentedParserInit(SegmentedParser* parser);
+
+/**
+ * @brief Parses a JT808 frame, reassembling segmented messages.
+ *
+ * Packets go through the reassembler. Until their message is complete they yield ParserError::PacketPending with
+ * para->parse.msg_head set to the packet header, then the reassembled body is parsed with the segmented handler of its
+ * message ID. Message IDs without one have the body copied into an unsegmented frame, the packet bit of
+ * para->parse.msg_head cleared, for their handler in parser, a body longer than 1023 bytes fails with
+ * ParserError::ReassemblyError. Unsegmented frames are parsed as by JT808FrameParse() above.
+ *
+ * @param now_ms Current time in milliseconds, as for Reassembler::Add().
+ * @param body If not nullptr, set to the unescaped message body once a message is parsed, reassembled from its
+ *        packets if segmented, e.g. to hand it to application threads. Cleared otherwise. An unsegmented body reuses
+ *        the buffer of the unpacked frame.
+ * @param raw If set, message IDs for which it returns true only have their header parsed, the body is handed out
+ *        through body without calling their handler, e.g. for application threads that decode it themselves. Such
+ *        messages need no handler, only body not nullptr. Other messages leave body empty.
+ * @return ParserError::Ok once a message is parsed, ParserError::PacketPending for a packet stored or already
+ *         received, an error otherwise.
+ */
+std::error_code JT808FrameParse(Parser const& parser, SegmentedParser const& segmented_parser,
+                                Reassembler* reassembler, InputBuffer in, int64_t const& now_ms,
+                                ProtocolParameter* para, std::vector<uint8_t>* body = nullptr,
+                                RawBodyPredicate const& raw = nullptr);
+
 } // namespace libjt808
 
 #endif // JT808_PARSER_H_
@@ -34,8 +34,10 @@
 #include <vector>
 
 #include "jt808/area_route.h"
+#include "jt808/bcd_time.h"
 #include "jt808/location_report.h"
 #include "jt808/terminal_parameter.h"
+#include "jt808/terminal_parameter_store.h"
 #include "jt808/multimedia_upload.h"
 
 namespace libjt808 {
@@ -64,8 +66,14 @@ enum SupportedCommands {
     kGetLocationInformation         = 0x8201, // Get location information.
     kGetLocationInformationResponse = 0x0201, // Get location information response.
     kLocationTrackingControl        = 0x8202, // Location tracking control.
+    kSetCircularArea                = 0x8600, // Set circular area.
+    kDeleteCircularArea             = 0x8601, // Delete circular area.
+    kSetRectangleArea               = 0x8602, // Set rectangle area.
+    kDeleteRectangleArea            = 0x8603, // Delete rectangle area.
     kSetPolygonArea                 = 0x8604, // Set polygon area.
     kDeletePolygonArea              = 0x8605, // Delete polygon area.
+    kSetRoute                       = 0x8606, // Set route.
+    kDeleteRoute                    = 0x8607, // Delete route.
     kMultimediaDataUpload           = 0x0801, // Multimedia data upload.
     kMultimediaDataUploadResponse   = 0x8800, // Multimedia data upload response.
 
@@ -338,8 +346,11 @@ struct ProtocolParameter {
     RegisterInfo register_info;
     // Authentication code randomly generated by the platform.
     std::vector<uint8_t> authentication_code;
-    // Set terminal parameter items.
+    // Set terminal parameter items, 0x8103/0x0104 encode them imported into a TerminalParameterStore (Import()).
     TerminalParameters terminal_parameters;
+    // Set terminal parameter items, 0x8103/0x0104 encode them as they are. Set either this or terminal_parameters,
+    // packaging fails with both.
+    TerminalParameterStore terminal_parameter_store;
     // List of terminal parameter IDs to query.
     std::vector<uint32_t> terminal_parameter_ids;
     // Basic location information to be filled in when reporting location, mandatory.
@@ -354,6 +365,20 @@ struct ProtocolParameter {
     PolygonArea polygon_area;
     // Set of polygon area IDs to be deleted.
     std::vector<uint32_t> polygon_area_id;
+    // Setting type of circular and rectangle areas, see AreaSettingType.
+    uint8_t area_setting_type;
+    // Circular areas.
+    std::vector<CircularArea> circular_areas;
+    // Set of circular area IDs to be deleted, empty to delete all.
+    std::vector<uint32_t> circular_area_id;
+    // Rectangle areas.
+    std::vector<RectangleArea> rectangle_areas;
+    // Set of rectangle area IDs to be deleted, empty to delete all.
+    std::vector<uint32_t> rectangle_area_id;
+    // Route.
+    Route route;
+    // Set of route IDs to be deleted, empty to delete all.
+    std::vector<uint32_t> route_id;
     // Upgrade information.
     UpgradeInfo upgrade_info;
     // Fill packet information.
@@ -383,13 +408,15 @@ struct ProtocolParameter {
         // Parsed authentication code.
         std::vector<uint8_t> authentication_code;
         // Parsed set terminal parameter items.
-        TerminalParameters terminal_parameters;
+        TerminalParameterStore terminal_parameter_store;
         // Parsed list of terminal parameter IDs to query.
         std::vector<uint32_t> terminal_parameter_ids;
         // Parsed basic location information.
         LocationBasicInformation location_info;
         // Parsed additional location information.
         LocationExtensions location_extension;
+        // Epoch of the date of the last parsed location time of the session.
+        BcdTimeCache location_time_cache;
         // Parsed temporary location tracking control information.
         LocationTrackingControl location_tracking_control;
         // Parsed polygon area set.
@@ -398,6 +425,20 @@ struct ProtocolParameter {
         PolygonArea polygon_area;
         // Parsed set of polygon area IDs to be deleted.
         std::vector<uint32_t> polygon_area_id;
+        // Parsed setting type of circular and rectangle areas.
+        uint8_t area_setting_type;
+        // Parsed circular areas.
+        std::vector<CircularArea> circular_areas;
+        // Parsed set of circular area IDs to be deleted, empty to delete all.
+        std::vector<uint32_t> circular_area_id;
+        // Parsed rectangle areas.
+        std::vector<RectangleArea> rectangle_areas;
+        // Parsed set of rectangle area IDs to be deleted, empty to delete all.
+        std::vector<uint32_t> rectangle_area_id;
+        // Parsed route.
+        Route route;
+        // Parsed set of route IDs to be deleted, empty to delete all.
+        std::vector<uint32_t> route_id;
         // Parsed upgrade information.
         UpgradeInfo upgrade_info;
         // Parsed fill packet information.
@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  reassembly.h
+// @Version :  1.0
+// @Time    :  2026/10/22 09:48:15
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_REASSEMBLY_H_
+#define JT808_REASSEMBLY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "jt808/protocol_parameter.h"
+
+namespace libjt808 {
+
+// Body of a packet of a reassembled message.
+struct ScatterSegment {
+    uint8_t const* data;
+    size_t         size;
+};
+
+// Body of a message reassembled from its packets, the packet bodies in packet order as they were received.
+struct ScatterList {
+    std::vector<ScatterSegment> segments;
+    size_t                      size = 0; // Bytes of all segments.
+
+    // Copy len bytes at offset of the body to out.
+    // Returns 0 on success, -1 if they exceed the body.
+    int Read(size_t const& offset, size_t const& len, uint8_t* out) const;
+    // Append the bytes from offset to the end of the body to out.
+    void Append(size_t const& offset, std::vector<uint8_t>* out) const;
+};
+
+struct ReassemblyOptions {
+    size_t   max_messages      = 1024;     // Messages being reassembled at a time.
+    size_t   max_bytes         = 64 << 20; // Packet bodies held at a time.
+    uint32_t fill_timeout_ms   = 5000;     // Wait for a missing packet before requesting it with 0x8003.
+    int      max_fill_requests = 2;        // 0x8003 requests for a message before it is dropped.
+};
+
+enum ReassemblyStatus {
+    kReassemblyPending = 0x0, // Packet stored, the message lacks packets.
+    kReassemblyComplete,      // The last missing packet, the message is complete.
+    kReassemblyDuplicate,     // Packet already received, ignored.
+    kReassemblyRejected,      // Packet numbering inconsistent, or the packet does not fit the memory limit.
+};
+
+// 0x8003 request for the missing packets of a message.
+struct FillRequest {
+    std::string phone_num;
+    uint16_t    msg_id;
+    FillPacket  fill_packet;
+};
+
+// Sub-packet reassembly of segmented messages.
+// Packets are keyed by the terminal phone number, the message ID and the flow number of the first packet, terminals
+// number the packets of a message with consecutive flow numbers and keep them when retransmitting on 0x8003. The
+// bodies of the packets of a message are copied once into one buffer, the complete message is handed out as a
+// scatter list over it. Messages wait fill_timeout_ms for their next packet, or not at all once their last packet
+// arrived with gaps, before the missing packets are requested; after max_fill_requests requests a message is dropped.
+// Over max_messages or max_bytes the least recently active messages are dropped.
+// Transport independent and not thread safe, JT808Server drives it from its service thread.
+//
+// Example:
+//     Reassembler reassembler;
+//     ScatterList body;
+//     if (reassembler.Add(msg_head, data, size, now_ms, &body) == kReassemblyComplete)
+//         ... parse body ...
+//     reassembler.Poll(now_ms, &requests);
+class Reassembler {
+public:
+    explicit Reassembler(ReassemblyOptions const& options = ReassemblyOptions()) : options_(options) {
+    }
+
+    // Add a packet of a segmented message, its body is copied.
+    // On kReassemblyComplete sets message to the body of the message, valid until the next call of Add(), Poll(),
+    // RemoveTerminal() or Clear().
+    ReassemblyStatus Add(MsgHead const& msg_head, uint8_t const* body, size_t const& size, int64_t const& now_ms,
+                         ScatterList* message);
+    // Append the 0x8003 requests due and drop the messages that stayed incomplete.
+    void Poll(int64_t const& now_ms, std::vector<FillRequest>* requests);
+    // Drop the messages of a terminal, e.g. on disconnection.
+    void RemoveTerminal(std::string const& phone_num);
+    void Clear(void);
+
+    // Append the messages being reassembled to out, e.g. to hand them over to another process.
+    void Save(std::vector<uint8_t>* out) const;
+    // Add the messages saved by Save(), timestamps of the same steady clock.
+    // Returns 0 on success, -1 for malformed data, the messages before it are kept.
+    int Load(uint8_t const* data, size_t const& size);
+
+    // Messages being reassembled.
+    size_t size(void) const {
+        return index_.size();
+    }
+    // Bytes of packet bodies held.
+    size_t bytes(void) const {
+        return bytes_;
+    }
+    // Messages dropped incomplete since construction.
+    uint64_t dropped(void) const {
+        return dropped_;
+    }
+
+private:
+    static constexpr uint32_t kMissing        = UINT32_MAX;
+    static constexpr size_t   kRecentMessages = 64;
+    static constexpr size_t   kReserveLimit   = 1 << 20; // Bytes reserved for a message on its first packet.
+
+    struct Message {
+        std::string           key;
+        std::string           phone_num;
+        uint16_t              msg_id;
+        uint16_t              first_flow_num;
+        uint16_t              received;      // Distinct packets received.
+        std::vector<uint8_t>  data;          // Packet bodies in arrival order.
+        std::vector<uint32_t> offsets;       // Offset in data by packet sequence number - 1, kMissing if missing.
+        std::vector<uint16_t> sizes;         // Body size by packet sequence number - 1.
+        int64_t               last_ms;       // Last packet received or fill request.
+        int                   fill_requests; // 0x8003 requests sent.
+    };
+    using Messages = std::list<Message>;
+
+    static void MakeKey(std::string const& phone_num, uint16_t const& msg_id, uint16_t const& first_flow_num,
+                        std::string* key);
+    bool IsRecent(std::string const& key) const;
+    // Drop the least recently active messages other than keep until count more bytes fit.
+    bool MakeRoom(size_t const& count, Message const* keep);
+    void Drop(Messages::iterator it);
+    void RequestFill(Messages::iterator it, int64_t const& now_ms, std::vector<FillRequest>* requests);
+
+    ReassemblyOptions                                   options_;
+    Messages                                            messages_; // Ascending by last_ms.
+    std::unordered_map<std::string, Messages::iterator> index_;
+    Messages                                            done_;   // The message last completed, until the next call.
+    std::deque<std::string>                             recent_; // Keys of the messages last completed.
+    std::vector<std::string>                            due_;    // Keys of messages whose last packet left gaps.
+    std::string                                         key_;
+    size_t                                              bytes_   = 0;
+    uint64_t                                            dropped_ = 0;
+};
+
+} // namespace libjt808
+
+#endif // JT808_REASSEMBLY_H_
@@ -40,16 +40,30 @@
 #endif
 
 #include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <string>
 #include <thread>
 #include <vector>
 #include <map>
-
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "capture.h"
+#include "handoff.h"
+#include "ingest.h"
+#include "metrics.h"
 #include "packager.h"
+#include "parameter_push.h"
 #include "parser.h"
 #include "protocol_parameter.h"
+#include "reassembly.h"
+#include "session_directory.h"
+#include "session_store.h"
 #include "terminal_parameter.h"
+#include "timing_wheel.h"
+#include "track_store.h"
 
 namespace libjt808 {
 
@@ -77,7 +91,9 @@ namespace libjt808 {
 
 class JT808Server {
 public:
-    JT808Server() {
+    JT808Server()
+        : wait_metrics_(metrics_.CreateShard()), service_metrics_(metrics_.CreateShard()),
+          external_metrics_(metrics_.CreateShard()) {
     }
 
     ~JT808Server() {
@@ -95,6 +111,22 @@ public:
     // Initialize server.
     int InitServer(void);
 
+    //
+    // Zero-downtime upgrade of the platform process.
+    // The running process serves handoffs at a Unix domain socket path. A new process started with the same path
+    // takes over the listening socket and the connections of the authenticated terminals, with their flow numbers,
+    // authentication codes, terminal parameters, unparsed received bytes and segmented messages being reassembled,
+    // then the old process stops without closing them. The terminals see no disconnection. Linux only.
+    //
+    // In the old process, after InitServer() or TakeOverServer() and before Run(): accept takeovers at path.
+    // A takeover waits for running upgrades and parameter pushes to finish, and for the messages of SendToTerminal()
+    // to be sent and acknowledged or given up. Returns 0 on success, -1 on failure.
+    int ServeHandoff(std::string const& path);
+    // In the new process, in place of InitServer(): take over from the process serving handoffs at path.
+    // Open the session store and the track store after the takeover, the old process closes its track store before
+    // handing over. Returns 0 on success, -1 on failure, the old process keeps serving.
+    int TakeOverServer(std::string const& path);
+
     //
     // Service thread run and stop.
     //
@@ -184,13 +216,87 @@ public:
      */
     int UpgradeRequestByPhoneNumber(std::string const& phone, int const& upgrade_type,
                                     std::vector<uint8_t> const& manufacturer_id, std::string const& version_id,
-                                    char const* path) {
-        for (auto const& item : clients_) {
-            if (item.second.msg_head.phone_num == phone) {
-                return UpgradeRequest(item.first, upgrade_type, manufacturer_id, version_id, path);
-            }
-        }
-        return -1;
+                                    char const* path);
+
+    //
+    // Several server processes on one host.
+    // Each process listens on the same address with SO_REUSEPORT and the kernel spreads the connections over them.
+    // The processes share a session directory, so a message for a terminal reaches the process holding it.
+    //
+    // Listen with SO_REUSEPORT, call before InitServer(). Linux only.
+    void set_reuse_port(bool const& enable) {
+        reuse_port_ = enable;
+    }
+    // Enter the terminals of this process in the directory at path, and take the messages the other processes
+    // forward to them. Call before Run(). Linux only. Returns 0 on success, -1 on failure.
+    int OpenSessionDirectory(std::string const& path);
+    // Send a message with the given body to a terminal, from any thread. The main service thread of the process
+    // holding the terminal packages it with the message flow numbers of the session, segmented if the body is long.
+    // Returns 0 once queued or forwarded, -1 if no process holds the terminal per the directory, if one is open, or
+    // once this process handed its terminals over to a new one.
+    int SendToTerminal(std::string const& phone, uint16_t const& msg_id, std::vector<uint8_t> const& body);
+
+    //
+    // Timeouts of the main service thread, kept on a timing wheel. Call before Run().
+    //
+    // Close authenticated connections receiving nothing for timeout_ms, 0 disables. A terminal sends at least a
+    // heartbeat (0x0002) every heartbeat interval, by default the connection survives three lost heartbeats of 60 s,
+    // or of the interval in the cached terminal parameters if longer.
+    void set_idle_timeout(uint32_t const& timeout_ms) {
+        idle_timeout_ms_ = timeout_ms;
+    }
+    // Retransmit the packets of a message of SendToTerminal() the terminal has not acknowledged within timeout_ms,
+    // then within the previous timeout times the retransmissions so far plus one, at most retries times, as specified
+    // by JT808. 0 retries disables the retransmission.
+    void set_downlink_retransmission(uint32_t const& timeout_ms, int const& retries) {
+        downlink_timeout_ms_ = timeout_ms;
+        downlink_retries_    = retries;
+    }
+
+    // Keep the sessions of registered terminals in a log at path and load those of previous runs, so the terminals
+    // authenticate (0x0102) after a restart of the platform without registering (0x0100) again. Call before Run().
+    // Returns 0 on success, -1 if the log cannot be opened.
+    int OpenSessionStore(std::string const& path) {
+        return session_store_.Open(path);
+    }
+
+    // Keep the locations reported by the terminals (0x0200, 0x0201 and 0x0704) in a track store in directory dir,
+    // see track_store(). The blocks older than options.max_block_age_ms are written out every second, all of them
+    // on Stop(). Call before Run(). Returns 0 on success, -1 if the store cannot be opened.
+    int OpenTrackStore(std::string const& dir, TrackStoreOptions const& options = TrackStoreOptions()) {
+        track_dir_     = dir;
+        track_options_ = options;
+        return track_store_.Open(dir, options);
+    }
+    // Location history of the terminals, thread safe.
+    TrackStore& track_store(void) {
+        return track_store_;
+    }
+
+    // Write the frames received from the terminals to a capture at path, handshakes included, e.g. to reproduce an
+    // issue with ReplayParse() or ReplayToServer(). Call before Run(). Returns 0 on success, -1 if the file cannot
+    // be created.
+    int OpenCapture(std::string const& path) {
+        return capture_.Open(path);
+    }
+
+    // Enable or disable dumping received location reports and terminal parameters as debug log records, disabled by
+    // default. The records are only written when the logger level is kLogDebug.
+    void set_message_display(bool const& enable) {
+        message_display_ = enable;
+    }
+
+    // Server metrics: traffic, frames per message ID, parse errors, handshake and frame handling latency, sessions.
+    // Snapshot() may be called from any thread, e.g.
+    //     MetricsSnapshot snapshot;
+    //     server.metrics().Snapshot(&snapshot);
+    //     server.metrics().WritePrometheusFile("/var/lib/node_exporter/jt808.prom");
+    Metrics& metrics(void) {
+        return metrics_;
+    }
+
+    Metrics const& metrics(void) const {
+        return metrics_;
     }
 
     //
@@ -202,6 +308,29 @@ public:
         multimedia_data_upload_callback_ = callback;
     }
 
+    //
+    // Ingest pipeline.
+    //
+    // Hand the messages routed by the pipeline over to its worker pools instead of handling them on the main service
+    // thread: routed messages are not displayed, their locations are not appended to the track store and a routed
+    // 0x0801 upload goes there in place of the multimedia callback. The main service thread still sends the platform
+    // responses and keeps its own state, it decodes only the messages it needs, see IngestRecord. Call before Run()
+    // and before the Start() of the pipeline, which must outlive the server. Returns 0 on success, -1 if the pipeline
+    // already started.
+    int SetIngest(IngestPipeline* pipeline);
+
+    //
+    // Bulk terminal parameter push.
+    //
+    using ParameterPushCallback = std::function<void(std::vector<ParameterPushResult> const&)>;
+
+    // Push the desired parameters to every connected terminal with 0x8103, each sent only the parameters that differ
+    // from its last 0x0104 response, see ParameterPush. Acknowledged parameters update the cached response.
+    // The push runs on the main service thread, which calls the callback once every terminal has a result.
+    // May be called from any thread. Returns 0 on success, -1 if a push is already running.
+    int PushTerminalParameters(TerminalParameters const& desired, ParameterPushOptions const& options,
+                               ParameterPushCallback const& callback);
+
     // General message packaging and sending function.
     // Args:
     //     socket:  Client's socket.
@@ -224,16 +353,67 @@ public:
     int ReceiveAndParseMessage(decltype(socket(0, 0, 0)) const& socket, int const& timeout, ProtocolParameter* para);
 
 private:
+    // PackagingAndSendMessage() and ReceiveAndParseMessage() counting into the metrics shard of the calling thread.
+    int PackagingAndSendMessage(decltype(socket(0, 0, 0)) const& socket, uint32_t const& msg_id,
+                                ProtocolParameter* para, Metrics::Shard* shard);
+    int ReceiveAndParseMessage(decltype(socket(0, 0, 0)) const& socket, int const& timeout, ProtocolParameter* para,
+                               Metrics::Shard* shard);
+
+    // Restore the session of a terminal authenticating without registration, on a matching authentication code.
+    // Returns 0 on success, -1 if the terminal has no session or the code does not match.
+    int RestoreSession(ProtocolParameter* para);
+    // Store the session of a terminal, if the session store is open.
+    void SaveSession(ProtocolParameter const& para);
+
+    // Send the frames of a segmented message with a single write and wait for the terminal general responses to all
+    // packets, the responses may arrive in any order and coalesced. Not on the main service thread.
+    // Returns 0 once every packet is acknowledged with kSuccess, -1 on failure or timeout.
+    int SendSegmentedAndWait(decltype(socket(0, 0, 0)) const& socket, SegmentedFrames const& frames,
+                             int const& timeout, ProtocolParameter* para);
+
     // Wait for client connection thread handler.
     void WaitHandler(void);
     // Main service thread handler.
     void ServiceHandler(void);
+    // Start a requested parameter push and advance the running one, on the main service thread.
+    void RunParameterPush(void);
+    // Send the due 0x8003 requests for the missing packets of segmented messages, then again on a timer of the main
+    // service thread.
+    void RequestMissingPackets(void);
+    // Send the messages of SendToTerminal() queued in this process or forwarded by others, on the main service thread.
+    void SendDownlinks(void);
+    // Package the upgrades requested by UpgradeRequest() and release the clients of the finished ones, on the main
+    // service thread.
+    void PrepareUpgrades(void);
+    // Count the acknowledgement of a packet of a message of SendToTerminal() waiting for it.
+    void AcknowledgeDownlink(decltype(socket(0, 0, 0)) const& socket, std::string const& phone_num,
+                             uint16_t const& flow_num);
+    // Retransmit the packets of a message of SendToTerminal() not acknowledged in time, or give it up.
+    void RetransmitDownlink(uint64_t const& id);
+    // Arm the idle timer of a connection taken over by the main service thread.
+    void ArmIdleTimer(decltype(socket(0, 0, 0)) const& socket, ProtocolParameter const& para);
+    // Close an authenticated connection and drop its state, on the main service thread.
+    void CloseClient(decltype(socket(0, 0, 0)) const& socket);
+    // Give a connection accepted a new ID in the capture, its socket may have been used by a closed connection.
+    void CaptureConnection(decltype(socket(0, 0, 0)) const& socket);
+    // Append a frame received on a connection to the capture.
+    void CaptureFrame(decltype(socket(0, 0, 0)) const& socket, std::vector<uint8_t> const& frame);
+    // Write the capture buffer out every second, on the main service thread.
+    void FlushCapture(void);
+    // Write the aged blocks of the track store out every second, on the main service thread.
+    void FlushTrackStore(void);
+    // Accept a takeover request and wait for the main service thread to hand over, on the waiting thread.
+    // Returns 0 once handed over, -1 if the old process keeps serving.
+    int AcceptTakeover(void);
+    // Hand the connections over on a pending takeover request, on the main service thread.
+    void HandOver(void);
 
     decltype(socket(0, 0, 0))    listen_;   // Listening socket.
     std::atomic_bool             is_ready_; // Server socket status.
     std::string                  ip_;       // Server IP address.
     int                          port_;     // Server port.
     int                          max_connection_num_;
+    std::atomic_bool             message_display_; // Dump received location reports and terminal parameters.
     MultimediaDataUploadCallback multimedia_data_upload_callback_;
     std::thread                  waiting_thread_;     // Wait for client connection thread.
     std::atomic_bool             waiting_is_running_; // Wait for client connection thread running flag.
@@ -241,11 +421,125 @@ private:
     std::atomic_bool             service_is_running_; // Main service thread running flag.
     Packager                     packager_;           // General JT808 protocol packager.
     Parser                       parser_;             // General JT808 protocol parser.
+    SegmentedParser              segmented_parser_;   // General JT808 segmented message parser.
 
     // Client's socket (key) - Client's protocol parameters (value).
+    // Only accessed by the main service thread once the service is running.
     std::map<decltype(socket(0, 0, 0)), ProtocolParameter> clients_;
+    // Phone number (key) - Client's socket of clients_ (value), the latest connection of a terminal.
+    std::unordered_map<std::string, decltype(socket(0, 0, 0))> client_sockets_;
+    // Client's socket (key) - Received bytes not yet assembled into a frame (value).
+    std::map<decltype(socket(0, 0, 0)), std::vector<uint8_t>> receive_buffers_;
+    // Segmented messages being reassembled and the 0x8003 requests due.
+    // Only accessed by the main service thread once the service is running.
+    Reassembler              reassembler_;
+    std::vector<FillRequest> fill_requests_;
+    uint64_t                 reassembly_dropped_ = 0; // Drops of reassembler_ counted into the metrics.
+    // Messages handed over to application threads, see SetIngest().
+    IngestPipeline*           ingest_          = nullptr;
+    IngestPipeline::Producer* ingest_producer_ = nullptr;
+    RawBodyPredicate          ingest_raw_; // Routed messages left undecoded, see IngestRecord.
+    std::vector<uint8_t>      ingest_body_;
+    // Timers of the main service thread: idle connections, retransmission of downlinks and reassembly timeouts.
+    TimingWheel timers_;
+    uint32_t    idle_timeout_ms_     = 180000;
+    uint32_t    downlink_timeout_ms_ = 10000;
+    int         downlink_retries_    = 3;
+    // Client's socket (key) - Idle timer and its timeout (value).
+    std::unordered_map<decltype(socket(0, 0, 0)), std::pair<TimingWheel::TimerId, uint32_t>> idle_timers_;
+    // Messages of SendToTerminal() sent and waiting for the terminal to acknowledge every packet.
+    struct UnackedDownlink {
+        decltype(socket(0, 0, 0)) client; // Client's socket.
+        std::string               phone_num;
+        SegmentedFrames           frames;
+        std::vector<bool>         acked; // By packet sequence number - 1.
+        uint16_t                  unacked;
+        int                       retransmissions;
+        uint32_t                  timeout_ms;
+        TimingWheel::TimerId      timer;
+    };
+    std::unordered_map<uint64_t, UnackedDownlink> unacked_downlinks_; // By ID.
+    std::unordered_map<uint64_t, uint64_t>        downlink_acks_;     // Socket and packet flow number - ID.
+    uint64_t                                      next_downlink_id_ = 0;
+    // Sessions of registered terminals, kept across restarts if opened.
+    SessionStore      session_store_;
+    TrackStore        track_store_;
+    std::string       track_dir_; // Of OpenTrackStore(), to reopen the track store if a handoff fails.
+    TrackStoreOptions track_options_;
+    // Terminals of the server processes of the host, see OpenSessionDirectory().
+    bool             reuse_port_ = false;
+    SessionDirectory directory_;
+    std::string      directory_path_;
+    uint32_t         process_id_      = 0;
+    int              downlink_socket_ = -1; // Unix datagram socket at the directory path and the process ID.
+    int              forward_socket_  = -1; // Unix datagram socket sending to the other processes.
+    // Messages of SendToTerminal() for the terminals of this process.
+    struct Downlink {
+        std::string          phone_num;
+        uint16_t             msg_id;
+        std::vector<uint8_t> body;
+    };
+    std::vector<Downlink> downlinks_;           // Under downlink_mutex_.
+    bool                  handed_over_ = false; // The sessions went to a new process, under downlink_mutex_.
+    std::mutex            downlink_mutex_;
+    std::vector<uint8_t>  downlink_buffer_;
+    // Takeover requests of a new process, see ServeHandoff(). The waiting thread accepts a request and hands the
+    // channel over to the main service thread, which sends the state and reports the result.
+    int                     handoff_listen_ = -1;
+    std::string             handoff_path_;
+    int                     handoff_channel_ = -1; // Under handoff_mutex_.
+    int                     handoff_result_  = 0;  // 1 handed over, -1 failed, 0 pending. Under handoff_mutex_.
+    std::atomic_bool        handoff_requested_{false};
+    std::mutex              handoff_mutex_;
+    std::condition_variable handoff_cv_;
+    // Authenticated clients handed over from the waiting thread to the main service thread.
+    std::vector<std::pair<decltype(socket(0, 0, 0)), ProtocolParameter>> pending_clients_;
+    std::mutex                                                             pending_clients_mutex_;
     // Clients in upgrade status.
     std::map<decltype(socket(0, 0, 0)), int> is_upgrading_clients_;
+    // Upgrades requested by UpgradeRequest(). The main service thread resolves the client, takes it off the receive
+    // loop and packages the upgrade with its flow numbers, the requesting thread sends it and waits for the
+    // responses, then the main service thread returns the client to the receive loop.
+    struct UpgradeJob {
+        decltype(socket(0, 0, 0)) client   = 0;
+        bool                      by_phone = false; // The client is resolved from phone_num.
+        std::string               phone_num;
+        ProtocolParameter         para; // The upgrade info, then a copy of the client to send with.
+        SegmentedFrames           frames;
+        int                       state = 0; // 0 requested, 1 packaged, 2 sent, -1 failed. Under upgrade_mutex_.
+    };
+    // Queue an upgrade for the main service thread, then send it. Returns 0 on success, -1 on failure.
+    int RunUpgrade(std::shared_ptr<UpgradeJob> const& job, int const& upgrade_type,
+                   std::vector<uint8_t> const& manufacturer_id, std::string const& version_id, char const* path);
+    std::vector<std::shared_ptr<UpgradeJob>> upgrade_jobs_; // Under upgrade_mutex_.
+    std::mutex                               upgrade_mutex_;
+    std::condition_variable                  upgrade_cv_;
+    // Parameter push requested by PushTerminalParameters() and handed over to the main service thread.
+    struct ParameterPushRequest {
+        TerminalParameterStore desired;
+        ParameterPushOptions   options;
+        ParameterPushCallback  callback;
+    };
+    std::unique_ptr<ParameterPushRequest> push_request_;
+    bool                                  push_running_ = false; // Under push_request_mutex_.
+    std::mutex                            push_request_mutex_;
+    // Running parameter push, its callback and the sockets of its terminals, by phone number.
+    // Only accessed by the main service thread.
+    std::unique_ptr<ParameterPush>                             push_;
+    ParameterPushCallback                                      push_callback_;
+    std::unordered_map<std::string, decltype(socket(0, 0, 0))> push_sockets_;
+
+    // Frames received, written by the waiting and the main service threads under capture_mutex_.
+    CaptureWriter                                           capture_;
+    std::unordered_map<decltype(socket(0, 0, 0)), uint32_t> capture_connections_; // Socket - connection in capture_.
+    uint32_t                                                capture_connection_count_ = 0;
+    std::mutex                                              capture_mutex_;
+
+    Metrics         metrics_;
+    Metrics::Shard* wait_metrics_;     // Written by the waiting thread only.
+    Metrics::Shard* service_metrics_;  // Written by the main service thread only.
+    Metrics::Shard* external_metrics_; // Written by the calls from other threads, under external_metrics_mutex_.
+    std::mutex      external_metrics_mutex_;
 
     friend class JT808CustomServer; // Allow the custom server to access private members.
 };
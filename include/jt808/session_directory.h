@@ -0,0 +1,102 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  session_directory.h
+// @Version :  1.0
+// @Time    :  2026/10/25 10:37:52
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_SESSION_DIRECTORY_H_
+#define JT808_SESSION_DIRECTORY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+
+namespace libjt808 {
+
+// Directory of the terminals connected to the server processes of a host, shared by the processes.
+// Maps the phone number of a terminal to the owner, the ID of the process holding its connection, so a command for
+// the terminal is handed to that process. The directory is a fixed size open addressing hash table in a file mapped
+// by every process, changes are serialized by a file lock and lookups take the lock shared, no copy is kept in memory.
+// The first process to open the file sets its capacity. Stale entries of a process that crashed are left behind,
+// the users check that an owner is still alive. Thread safe, Linux only, Open() fails on other platforms.
+//
+// Example:
+//     SessionDirectory directory;
+//     directory.Open("/dev/shm/jt808_sessions");
+//     directory.Put(phone, getpid());
+//     uint32_t owner;
+//     if (directory.Find(phone, &owner) == 0 && owner != getpid()) ... forward to owner ...
+class SessionDirectory {
+public:
+    SessionDirectory() = default;
+    ~SessionDirectory();
+    SessionDirectory(SessionDirectory const&)            = delete;
+    SessionDirectory& operator=(SessionDirectory const&) = delete;
+
+    // Map the directory at path, creating it with room for capacity terminals if it does not exist.
+    // Returns 0 on success, -1 on failure or if the file is not a directory.
+    int  Open(std::string const& path, size_t const& capacity = 1 << 16);
+    void Close(void);
+    bool is_open(void) const;
+
+    // Returns 0 on success, -1 if the terminal is not in the directory.
+    int Find(std::string const& phone_num, uint32_t* owner) const;
+    // Add or replace the owner of a terminal. Returns 0 on success, -1 if the directory is full.
+    int Put(std::string const& phone_num, uint32_t const& owner);
+    // Remove a terminal if it still belongs to owner, a process taking over the terminal may have replaced it.
+    // Returns 0 on success, -1 if it does not exist or has another owner.
+    int Erase(std::string const& phone_num, uint32_t const& owner);
+    // Remove the terminals of an owner. Returns their number.
+    size_t EraseOwner(uint32_t const& owner);
+
+    // Terminals in the directory.
+    size_t size(void) const;
+    size_t capacity(void) const;
+
+private:
+    struct Header;
+    struct Slot;
+
+    // Slot of a terminal, nullptr if it does not exist. Under the file lock.
+    Slot* Lookup(std::string const& phone_num) const;
+    // Reinsert the terminals to drop the tombstones of removed ones. Under the exclusive file lock.
+    void Rehash(void);
+    void Lock(bool const& exclusive) const;
+    void Unlock(void) const;
+
+    mutable std::mutex mutex_;
+    int                fd_     = -1;
+    void*              map_    = nullptr;
+    size_t             length_ = 0;
+    Header*            header_ = nullptr;
+    Slot*              slots_  = nullptr;
+};
+
+} // namespace libjt808
+
+#endif // JT808_SESSION_DIRECTORY_H_
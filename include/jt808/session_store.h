@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  session_store.h
+// @Version :  1.0
+// @Time    :  2026/10/21 09:48:05
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_SESSION_STORE_H_
+#define JT808_SESSION_STORE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "jt808/terminal_parameter_store.h"
+
+namespace libjt808 {
+
+// State of a registered terminal worth keeping across restarts of the platform.
+struct TerminalSession {
+    std::vector<uint8_t>   authentication_code;
+    uint16_t               platform_flow_num = 0; // Next message flow number of the platform to the terminal.
+    uint16_t               terminal_flow_num = 0; // Last message flow number received from the terminal.
+    TerminalParameterStore parameters;            // Last known terminal parameters.
+};
+
+// Persistent store of terminal sessions, keyed by phone number.
+// Sessions are kept in memory and every change is appended as a record to a log file, so a change costs one write
+// and a crash loses at most the record being written. Open() replays the log, a torn record at its end is dropped.
+// The log is rewritten with only the current sessions once superseded records make up most of it.
+// With the sessions of a restarted platform, registered terminals authenticate (0x0102) straight away instead of
+// registering (0x0100) again. Thread safe.
+//
+// Example:
+//     SessionStore store;
+//     store.Open("./jt808_sessions.log");
+//     TerminalSession session;
+//     if (store.Find(phone, &session) == 0 && session.authentication_code == para.parse.authentication_code) ...
+//     store.Put(phone, session);
+class SessionStore {
+public:
+    SessionStore() = default;
+    ~SessionStore();
+    SessionStore(SessionStore const&)            = delete;
+    SessionStore& operator=(SessionStore const&) = delete;
+
+    // Open the log at path, creating it if it does not exist, and load its sessions in place of the current ones.
+    // Returns 0 on success, -1 if the file cannot be opened or is not a session log.
+    int  Open(std::string const& path);
+    void Close(void);
+    bool is_open(void) const;
+
+    // Returns 0 on success, -1 if the terminal has no session.
+    int Find(std::string const& phone_num, TerminalSession* session) const;
+    // Add or replace the session of a terminal.
+    // Returns 0 on success, -1 if the record could not be written, the session is kept in memory regardless.
+    int Put(std::string const& phone_num, TerminalSession const& session);
+    // Remove the session of a terminal, e.g. on logout (0x0003).
+    // Returns 0 on success, -1 if it does not exist or the record could not be written.
+    int Erase(std::string const& phone_num);
+    // Rewrite the log with only the current sessions. Returns 0 on success, -1 on failure.
+    int Compact(void);
+
+    size_t size(void) const;
+
+private:
+    struct Entry {
+        TerminalSession session;
+        size_t          record_size; // Bytes of its record in the log.
+    };
+
+    // Append the record of a session, or of its removal if session is nullptr, to out.
+    static void EncodeRecord(std::string const& phone_num, TerminalSession const* session, std::vector<uint8_t>* out);
+    // Apply the records of a log. Returns the bytes of the complete records.
+    size_t Replay(std::vector<uint8_t> const& log);
+    int    Append(std::vector<uint8_t> const& record);
+    int    CompactLocked(void);
+
+    mutable std::mutex                     mutex_;
+    std::string                            path_;
+    FILE*                                  file_ = nullptr;
+    std::unordered_map<std::string, Entry> sessions_;
+    size_t                                 file_bytes_ = 0; // Bytes of the log.
+    size_t                                 live_bytes_ = 0; // Bytes of the records of the current sessions.
+    std::vector<uint8_t>                   scratch_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_SESSION_STORE_H_
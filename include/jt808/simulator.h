@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  simulator.h
+// @Version :  1.0
+// @Time    :  2026/10/16 15:20:08
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_SIMULATOR_H_
+#define JT808_SIMULATOR_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jt808/metrics.h"
+
+namespace libjt808 {
+
+// Simulator settings.
+struct SimulatorOptions {
+    std::string server_ip   = "127.0.0.1"; // Platform IP address.
+    int         server_port = 8888;        // Platform port.
+    // Local addresses the terminals bind to, used round robin, empty uses the default route.
+    // Each address provides about 28k ephemeral ports to one platform address.
+    std::vector<std::string> source_ips;
+    // Phone number of the first terminal, increased by one per terminal.
+    uint64_t first_phone_num     = 13300000000;
+    uint32_t terminal_count      = 1;         // Number of virtual terminals.
+    int      thread_count        = 1;         // Worker threads, each running one event loop.
+    uint32_t connect_rate        = 1000;      // New connections per second over all workers, 0 is unlimited.
+    uint32_t report_interval     = 1000;      // 0x0200 location report interval in milliseconds, 0 disables.
+    uint32_t heartbeat_interval  = 30000;     // 0x0002 heartbeat interval without other traffic, 0 disables.
+    uint32_t batch_interval      = 0;         // 0x0704 batch location upload interval in milliseconds, 0 disables.
+    uint16_t batch_size          = 10;        // Locations per 0x0704 message, at most 34.
+    uint32_t multimedia_interval = 0;         // 0x0801 multimedia upload interval in milliseconds, 0 disables.
+    uint32_t multimedia_size     = 16 * 1024; // Bytes per multimedia upload.
+    uint32_t response_timeout    = 10000;     // Registration/authentication/upload timeout in milliseconds.
+    uint32_t reconnect_delay     = 5000;      // Delay before reconnecting a dropped terminal, 0 disables it.
+};
+
+// Simulator statistics, counters are totals since Run().
+struct SimulatorStatistics {
+    uint64_t         online;             // Terminals currently authenticated.
+    uint64_t         connects;           // TCP connections established.
+    uint64_t         connect_failures;   // TCP connections failed.
+    uint64_t         auth_failures;      // Registrations or authentications rejected or timed out.
+    uint64_t         resumes;            // Authentications with the code of an earlier connection, no registration.
+    uint64_t         disconnects;        // Connections dropped after authentication.
+    uint64_t         timeouts;           // Requests without a platform response.
+    uint64_t         sent_messages;      // Messages sent.
+    uint64_t         received_messages;  // Messages received.
+    uint64_t         sent_bytes;         // Bytes sent.
+    uint64_t         received_bytes;     // Bytes received.
+    uint64_t         location_reports;   // 0x0200 messages sent.
+    uint64_t         batch_reports;      // 0x0704 messages sent.
+    uint64_t         multimedia_uploads; // Multimedia uploads completed.
+    LatencyHistogram rtt;                // Request to platform response round trip time, microseconds.
+};
+
+// Mass JT808 terminal simulator.
+// Drives many virtual terminals per worker thread through registration, authentication, location reports,
+// heartbeats, batch location uploads and multimedia uploads. Each worker owns one event loop and a slice of the
+// terminals, terminals never block each other. On Linux the worker threads are named "jt808-sim".
+//
+// Example:
+//     SimulatorOptions options;
+//     options.terminal_count = 10000;
+//     options.thread_count   = 4;
+//     TerminalSimulator simulator;
+//     if (simulator.Init(options) == 0) {
+//         simulator.Run();
+//         std::this_thread::sleep_for(std::chrono::seconds(60));
+//         SimulatorStatistics stats;
+//         simulator.GetStatistics(&stats, false);
+//         simulator.Stop();
+//     }
+class TerminalSimulator {
+public:
+    TerminalSimulator();
+    ~TerminalSimulator();
+
+    // Check the options and create the workers.
+    // Returns 0 on success, -1 on failure.
+    int Init(SimulatorOptions const& options);
+
+    // Start the worker threads. Terminals connect at the configured rate.
+    // Returns 0 on success, -1 on failure.
+    int Run(void);
+
+    // Stop the worker threads and close all connections.
+    void Stop(void);
+
+    bool is_running(void) const {
+        return is_running_.load();
+    }
+
+    // Get statistics summed over all workers.
+    // Args:
+    //     stats:  Statistics output.
+    //     reset_rtt:  Clear the round trip time histograms after reading, for interval percentiles.
+    void GetStatistics(SimulatorStatistics* stats, bool const& reset_rtt);
+
+private:
+    class Worker;
+
+    SimulatorOptions                     options_;    // Simulator settings.
+    std::vector<std::unique_ptr<Worker>> workers_;    // Workers, terminals are split evenly.
+    std::atomic_bool                     is_running_; // Running flag.
+};
+
+} // namespace libjt808
+
+#endif // JT808_SIMULATOR_H_
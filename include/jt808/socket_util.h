@@ -33,6 +33,9 @@
 #if defined(__linux__)
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <errno.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <unistd.h>
 #elif defined(_WIN32) || defined(__WIN64)
 #include <winsock2.h>
@@ -155,6 +158,115 @@ inline int Close(SOCKET s) {
 }
 #endif
 
+// wait until readable.
+// Returns 1 when readable (or closed/error), 0 on timeout, -1 on failure.
+template<typename T>
+inline int WaitReadable(T s, int timeout_ms) {
+  return -1;
+}
+#if defined(__linux__)
+inline int WaitReadable(int fd, int timeout_ms) {
+  struct pollfd pfd = {fd, POLLIN, 0};
+  int ret = poll(&pfd, 1, timeout_ms);
+  return ret > 0 ? 1 : ret;
+}
+#elif defined(_WIN32)
+template<>
+inline int WaitReadable(SOCKET s, int timeout_ms) {
+  fd_set rfds;
+  FD_ZERO(&rfds);
+  FD_SET(s, &rfds);
+  struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+  int ret = select(0, &rfds, nullptr, nullptr, timeout_ms < 0 ? nullptr : &tv);
+  return ret > 0 ? 1 : ret;
+}
+#endif
+
+// wait until writable.
+// Returns 1 when writable (or closed/error), 0 on timeout, -1 on failure.
+template<typename T>
+inline int WaitWritable(T s, int timeout_ms) {
+  return -1;
+}
+#if defined(__linux__)
+inline int WaitWritable(int fd, int timeout_ms) {
+  struct pollfd pfd = {fd, POLLOUT, 0};
+  int ret = poll(&pfd, 1, timeout_ms);
+  return ret > 0 ? 1 : ret;
+}
+#elif defined(_WIN32)
+template<>
+inline int WaitWritable(SOCKET s, int timeout_ms) {
+  fd_set wfds;
+  FD_ZERO(&wfds);
+  FD_SET(s, &wfds);
+  struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+  int ret = select(0, nullptr, &wfds, nullptr, timeout_ms < 0 ? nullptr : &tv);
+  return ret > 0 ? 1 : ret;
+}
+#endif
+
+// send all of buf on a non-blocking socket, waiting up to timeout_ms each time
+// the send buffer is full.
+// Returns len on success, -1 on failure or timeout.
+template<typename T>
+inline int SendAll(T s, const char* buf, int len, int timeout_ms) {
+  return -1;
+}
+#if defined(__linux__)
+inline int SendAll(int fd, const char* buf, int len, int timeout_ms) {
+  int sent = 0;
+  while (sent < len) {
+    int ret = send(fd, buf + sent, len - sent, 0);
+    if (ret > 0) {
+      sent += ret;
+    } else if (ret < 0 && errno == EINTR) {
+      continue;
+    } else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      if (WaitWritable(fd, timeout_ms) <= 0) return -1;
+    } else {
+      return -1;
+    }
+  }
+  return sent;
+}
+#elif defined(_WIN32)
+template<>
+inline int SendAll(SOCKET s, const char* buf, int len, int timeout_ms) {
+  int sent = 0;
+  while (sent < len) {
+    int ret = send(s, buf + sent, len - sent, 0);
+    if (ret > 0) {
+      sent += ret;
+    } else if (ret == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK) {
+      if (WaitWritable(s, timeout_ms) <= 0) return -1;
+    } else {
+      return -1;
+    }
+  }
+  return sent;
+}
+#endif
+
+// set non-blocking mode.
+template<typename T>
+inline int SetNonBlocking(T s) {
+  return -1;
+}
+#if defined(__linux__)
+inline int SetNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0) return -1;
+  return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+#elif defined(_WIN32)
+template<>
+inline int SetNonBlocking(SOCKET s) {
+  unsigned long ul = 1;
+  return ioctlsocket(s, FIONBIO, &ul) == SOCKET_ERROR ? -1 : 0;
+}
+#endif
+
 }  // namespace libjt808
 
 #endif  // JT808_SOCKET_UTIL_H_
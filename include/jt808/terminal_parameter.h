@@ -57,6 +57,26 @@ enum TerminalParameterID {
   kSMSResponseTimeout = 0x0006,
   // DWORD, SMS消息重传次数.
   kSMSMsgRetransmissionTimes = 0x0007,
+  // STRING, 主服务器APN, 无线通信拨号访问点.
+  kMainServerAPN = 0x0010,
+  // STRING, 主服务器无线通信拨号用户名.
+  kMainServerDialUser = 0x0011,
+  // STRING, 主服务器无线通信拨号密码.
+  kMainServerDialPasswd = 0x0012,
+  // STRING, 主服务器地址, IP或域名.
+  kMainServerAddress = 0x0013,
+  // STRING, 备份服务器APN, 无线通信拨号访问点.
+  kBackupServerAPN = 0x0014,
+  // STRING, 备份服务器无线通信拨号用户名.
+  kBackupServerDialUser = 0x0015,
+  // STRING, 备份服务器无线通信拨号密码.
+  kBackupServerDialPasswd = 0x0016,
+  // STRING, 备份服务器地址, IP或域名.
+  kBackupServerAddress = 0x0017,
+  // DWORD, 服务器TCP端口.
+  kServerTCPPort = 0x0018,
+  // DWORD, 服务器UDP端口.
+  kServerUDPPort = 0x0019,
   // DWORD, 位置汇报策略, 0:定时汇报; 1:定距汇报; 2:定时和定距汇报.
   kLocationReportWay = 0x0020,
   // DWORD, 位置汇报方案, 0:根据 ACC 状态; 1:根据登录状态和ACC
@@ -98,6 +118,10 @@ enum TerminalParameterID {
    kAlarmKeyFlag= 0x0054,
   // DWORD, 最高速度, km/h.
   kMaxSpeed = 0x0055,
+  // STRING, 公安交通管理部门颁发的机动车号牌.
+  kLicensePlateNumber = 0x0083,
+  // BYTE,  车牌颜色, 按照 JT/T 415-2006 的 5.4.12.
+  kLicensePlateColor = 0x0084,
   // BYTE,  GNSS定位模式, 定义如下:
   //        bit0, 0: 禁用GPS定位, 1: 启用GPS定位;
   //        bit1, 0: 禁用北斗定位, 1: 启用北斗定位;
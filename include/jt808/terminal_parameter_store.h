@@ -0,0 +1,254 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  terminal_parameter_store.h
+// @Version :  1.0
+// @Time    :  2026/10/19 15:40:12
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_TERMINAL_PARAMETER_STORE_H_
+#define JT808_TERMINAL_PARAMETER_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "jt808/terminal_parameter.h"
+
+namespace libjt808 {
+
+// Value type of a terminal parameter.
+enum TerminalParameterType {
+    kParameterTypeUnknown = 0x0, // Not in kTerminalParameterTable, raw bytes.
+    kParameterTypeByte,
+    kParameterTypeWord,
+    kParameterTypeDword,
+    kParameterTypeString,
+    kParameterTypeBytes8, // BYTE[8], accessed as a big endian uint64_t.
+};
+
+struct TerminalParameterInfo {
+    uint32_t              id;
+    TerminalParameterType type;
+};
+
+// Types of the TerminalParameterID parameters, ascending by ID.
+constexpr TerminalParameterInfo kTerminalParameterTable[] = {
+    {kTerminalHeartBeatInterval, kParameterTypeDword},
+    {kTCPResponseTimeout, kParameterTypeDword},
+    {kTCPMsgRetransmissionTimes, kParameterTypeDword},
+    {kUDPResponseTimeout, kParameterTypeDword},
+    {kUDPMsgRetransmissionTimes, kParameterTypeDword},
+    {kSMSResponseTimeout, kParameterTypeDword},
+    {kSMSMsgRetransmissionTimes, kParameterTypeDword},
+    {kMainServerAPN, kParameterTypeString},
+    {kMainServerDialUser, kParameterTypeString},
+    {kMainServerDialPasswd, kParameterTypeString},
+    {kMainServerAddress, kParameterTypeString},
+    {kBackupServerAPN, kParameterTypeString},
+    {kBackupServerDialUser, kParameterTypeString},
+    {kBackupServerDialPasswd, kParameterTypeString},
+    {kBackupServerAddress, kParameterTypeString},
+    {kServerTCPPort, kParameterTypeDword},
+    {kServerUDPPort, kParameterTypeDword},
+    {kLocationReportWay, kParameterTypeDword},
+    {kLocationReportPlan, kParameterTypeDword},
+    {kDriverNotLoginReportTimeInterval, kParameterTypeDword},
+    {kSleepingReportTimeInterval, kParameterTypeDword},
+    {kAlarmingReportTimeInterval, kParameterTypeDword},
+    {kDefaultTimeReportTimeInterval, kParameterTypeDword},
+    {kDefaultReportDistanceInterval, kParameterTypeDword},
+    {kDriverNotLoginReportDistanceInterval, kParameterTypeDword},
+    {kSleepingReportDistanceInterval, kParameterTypeDword},
+    {kAlarmingReportDistanceInterval, kParameterTypeDword},
+    {kCornerPointRetransmissionAngle, kParameterTypeDword},
+    {kAlarmShieldWord, kParameterTypeDword},
+    {kAlarmSendSMSText, kParameterTypeDword},
+    {kAlarmShootSwitch, kParameterTypeDword},
+    {kAlarmShootSaveFlag, kParameterTypeDword},
+    {kAlarmKeyFlag, kParameterTypeDword},
+    {kMaxSpeed, kParameterTypeDword},
+    {kLicensePlateNumber, kParameterTypeString},
+    {kLicensePlateColor, kParameterTypeByte},
+    {kGNSSPositionMode, kParameterTypeByte},
+    {kGNSSBaudeRate, kParameterTypeByte},
+    {kGNSSOutputFrequency, kParameterTypeByte},
+    {kGNSSOutputCollectFrequency, kParameterTypeDword},
+    {kGNSSOutputUploadWay, kParameterTypeByte},
+    {kSetGNSSDataUpload, kParameterTypeDword},
+    {kCANBus1CollectInterval, kParameterTypeDword},
+    {kCANBus1UploadInterval, kParameterTypeWord},
+    {kCANBus2CollectInterval, kParameterTypeDword},
+    {kCANBus2UploadInterval, kParameterTypeWord},
+    {kSetCANBusSpecial, kParameterTypeBytes8},
+};
+
+constexpr size_t kTerminalParameterTableSize = sizeof(kTerminalParameterTable) / sizeof(kTerminalParameterTable[0]);
+
+// Type of a parameter, kParameterTypeUnknown if it is not in kTerminalParameterTable.
+constexpr TerminalParameterType TerminalParameterTypeOf(uint32_t const& id, size_t const& index = 0) {
+    return index == kTerminalParameterTableSize        ? kParameterTypeUnknown
+           : kTerminalParameterTable[index].id == id ? kTerminalParameterTable[index].type
+                                                       : TerminalParameterTypeOf(id, index + 1);
+}
+
+// Value size of a parameter type, 0 for variable sizes.
+constexpr size_t TerminalParameterSize(TerminalParameterType const& type) {
+    return type == kParameterTypeByte     ? 1
+           : type == kParameterTypeWord   ? 2
+           : type == kParameterTypeDword  ? 4
+           : type == kParameterTypeBytes8 ? 8
+                                          : 0;
+}
+
+// C++ type of the value of a parameter type.
+template <TerminalParameterType Type>
+struct TerminalParameterValue {};
+template <>
+struct TerminalParameterValue<kParameterTypeByte> {
+    using type = uint8_t;
+};
+template <>
+struct TerminalParameterValue<kParameterTypeWord> {
+    using type = uint16_t;
+};
+template <>
+struct TerminalParameterValue<kParameterTypeDword> {
+    using type = uint32_t;
+};
+template <>
+struct TerminalParameterValue<kParameterTypeString> {
+    using type = std::string;
+};
+template <>
+struct TerminalParameterValue<kParameterTypeBytes8> {
+    using type = uint64_t;
+};
+
+// Compact terminal parameter store.
+// Parameters are kept in a flat array ascending by ID, values of up to 8 bytes inline and longer values, strings
+// mostly, in a shared arena, so a store holds two allocations whatever the number of parameters and copies as cheaply.
+// The body of 0x8103/0x0104 encodes from and decodes into it directly.
+// Values are kept as on the wire, big endian. The typed accessors take the ID as a template argument and the value
+// type from kTerminalParameterTable, an ID outside the table does not compile; the accessors taking the ID as an
+// argument serve any ID and fail if the size of the stored value does not match.
+//
+// Example:
+//     TerminalParameterStore store;
+//     store.Set<kTerminalHeartBeatInterval>(30);
+//     store.Set<kMainServerAddress>("127.0.0.1");
+//     uint32_t interval;
+//     store.Get<kTerminalHeartBeatInterval>(&interval);
+class TerminalParameterStore {
+public:
+    template <uint32_t ID>
+    int Get(typename TerminalParameterValue<TerminalParameterTypeOf(ID)>::type* value) const {
+        return Get(ID, value);
+    }
+    template <uint32_t ID>
+    int Set(typename TerminalParameterValue<TerminalParameterTypeOf(ID)>::type const& value) {
+        return Set(ID, value);
+    }
+
+    // Returns 0 on success, -1 if the parameter does not exist or its size does not match.
+    int Get(uint32_t const& id, uint8_t* value) const;
+    int Get(uint32_t const& id, uint16_t* value) const;
+    int Get(uint32_t const& id, uint32_t* value) const;
+    int Get(uint32_t const& id, uint64_t* value) const;
+    int Get(uint32_t const& id, std::string* value) const;
+    // Add or replace a parameter. Returns 0 on success, -1 for a value of more than 255 bytes.
+    int Set(uint32_t const& id, uint8_t const& value);
+    int Set(uint32_t const& id, uint16_t const& value);
+    int Set(uint32_t const& id, uint32_t const& value);
+    int Set(uint32_t const& id, uint64_t const& value);
+    int Set(uint32_t const& id, std::string const& value);
+    int Set(uint32_t const& id, uint8_t const* data, size_t const& size);
+
+    // Raw value of a parameter, valid until the store is modified.
+    // Returns 0 on success, -1 if the parameter does not exist.
+    int Find(uint32_t const& id, uint8_t const** data, size_t* size) const;
+    bool Contains(uint32_t const& id) const;
+    // Returns 0 on success, -1 if the parameter does not exist.
+    int  Remove(uint32_t const& id);
+    void Clear(void);
+
+    size_t size(void) const {
+        return entries_.size();
+    }
+    bool empty(void) const {
+        return entries_.empty();
+    }
+
+    // Call f(id, data, size) for every parameter, ascending by ID.
+    template <typename Function>
+    void ForEach(Function const& f) const {
+        for (auto const& entry : entries_)
+            f(entry.id, Data(entry), static_cast<size_t>(entry.size));
+    }
+
+    // Copy the parameters of another store or of a map, replacing those with the same ID.
+    void Merge(TerminalParameterStore const& other);
+    void Import(TerminalParameters const& items);
+    // Copy the parameters into a map, replacing those with the same ID.
+    void Export(TerminalParameters* items) const;
+
+    // Append the total number of parameters and the parameter items, as in the body of 0x8103.
+    // Returns the number of bytes appended, -1 for more than 255 parameters.
+    int Encode(std::vector<uint8_t>* out) const;
+    // As above, only the given parameters in the given order, those not found are skipped.
+    int Encode(std::vector<uint32_t> const& ids, std::vector<uint8_t>* out) const;
+    // Replace the parameters with the total number and the parameter items at data, the first of duplicate IDs wins.
+    // Returns the number of bytes consumed, -1 for a truncated body.
+    int Decode(uint8_t const* data, size_t const& size);
+
+private:
+    static constexpr size_t kInlineSize = 8;
+
+    struct Entry {
+        uint32_t id;
+        uint8_t  size;
+        // The value if size <= kInlineSize, otherwise its offset in arena_ as a uint32_t.
+        uint8_t value[kInlineSize];
+    };
+
+    uint8_t const* Data(Entry const& entry) const;
+    // Entry of an ID, nullptr if it does not exist.
+    Entry const* Lookup(uint32_t const& id) const;
+    // Fixed size value in big endian.
+    int GetBigEndian(uint32_t const& id, size_t const& size, uint64_t* value) const;
+    int SetBigEndian(uint32_t const& id, size_t const& size, uint64_t const& value);
+    void Assign(Entry* entry, uint8_t const* data, size_t const& size);
+    // Drop the values of replaced and removed parameters from the arena once they make up most of it.
+    void Compact(void);
+
+    std::vector<Entry>   entries_; // Ascending by ID.
+    std::vector<uint8_t> arena_;
+    size_t               garbage_ = 0; // Bytes of arena_ no longer referenced.
+};
+
+} // namespace libjt808
+
+#endif // JT808_TERMINAL_PARAMETER_STORE_H_
@@ -0,0 +1,125 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  timing_wheel.h
+// @Version :  1.0
+// @Time    :  2026/10/26 14:21:37
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_TIMING_WHEEL_H_
+#define JT808_TIMING_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+namespace libjt808 {
+
+// Hierarchical timing wheel for large numbers of timers, e.g. one idle timer per connection re-armed on every
+// received message. Four wheels of 256 slots each cover 2^32 ticks, a timer sits in the slot of its deadline on the
+// lowest wheel whose range holds it and moves down a wheel each time the wheel above turns, so adding, re-arming and
+// cancelling a timer cost O(1) and advancing the time costs O(1) per tick plus the timers firing or moving down.
+// Timers live in one pool linked through indices, no allocation per timer once the pool has grown.
+// Timers fire no earlier than their deadline and at most one tick after it. Not thread safe, the owner of the wheel,
+// e.g. the service thread of JT808Server, adds timers and advances it.
+//
+// Example:
+//     TimingWheel wheel(10);
+//     wheel.Start(now_ms);
+//     auto id = wheel.Add(180000, [] { ... close the idle connection ... });
+//     wheel.Reset(id, 180000); // On every message received.
+//     wheel.Advance(now_ms);   // In the I/O loop.
+class TimingWheel {
+public:
+    using TimerId  = uint64_t;
+    using Callback = std::function<void(void)>;
+
+    explicit TimingWheel(uint32_t const& tick_ms = 10);
+    TimingWheel(TimingWheel const&)            = delete;
+    TimingWheel& operator=(TimingWheel const&) = delete;
+
+    // Set the current time without firing timers, before adding the first ones.
+    void Start(int64_t const& now_ms);
+    // Add a one-shot timer firing delay_ms after the current time, the time of the last Start() or Advance().
+    // Returns the timer ID, never 0.
+    TimerId Add(uint32_t const& delay_ms, Callback const& callback);
+    // Move the deadline of a pending timer to delay_ms after the current time.
+    // Returns 0 on success, -1 if the timer fired or was cancelled.
+    int Reset(TimerId const& id, uint32_t const& delay_ms);
+    // Cancel a pending timer. Cancelling a timer that fired or was cancelled is a no-op.
+    void Cancel(TimerId const& id);
+    // Move the time to now_ms and run the callbacks of the timers due, which may add, re-arm and cancel timers.
+    // Returns the number of timers fired.
+    size_t Advance(int64_t const& now_ms);
+    // Cancel all timers.
+    void Clear(void);
+
+    // Pending timers.
+    size_t size(void) const {
+        return size_;
+    }
+
+private:
+    static constexpr uint32_t kNil        = UINT32_MAX;
+    static constexpr int      kLevels     = 4;
+    static constexpr int      kSlotBits   = 8;
+    static constexpr uint32_t kSlots      = 1u << kSlotBits;
+    static constexpr uint32_t kSlotMask   = kSlots - 1;
+    static constexpr uint32_t kFiringList = kLevels * kSlots; // Timers taken from a slot to fire.
+
+    struct Node {
+        Callback callback;
+        uint64_t deadline;   // Tick.
+        uint32_t prev;       // Neighbours in the list of the node, kNil terminated.
+        uint32_t next;       // Also the next free node.
+        uint32_t list;       // Slot of the node, kNil if free.
+        uint32_t generation; // Incremented when the node is freed, tells stale IDs apart.
+    };
+
+    // Node of a pending timer, kNil if the ID is stale.
+    uint32_t Find(TimerId const& id) const;
+    // Link a node into the slot of its deadline.
+    void Place(uint32_t const& index);
+    void Link(uint32_t const& index, uint32_t const& list);
+    void Unlink(uint32_t const& index);
+    void Free(uint32_t const& index);
+    // Move the timers of the current slot of a wheel down to the wheels below. Returns the slot.
+    uint32_t Cascade(int const& level);
+    // Tick of a deadline, rounded up.
+    uint64_t DeadlineTick(uint32_t const& delay_ms) const;
+
+    uint32_t              tick_ms_;
+    int64_t               now_ms_  = 0;
+    uint64_t              current_ = 0; // Next tick to process.
+    size_t                size_    = 0;
+    std::vector<Node>     nodes_;
+    std::vector<uint32_t> heads_; // First node by slot, level * kSlots + slot, then the firing list.
+    uint32_t              free_ = kNil;
+};
+
+} // namespace libjt808
+
+#endif // JT808_TIMING_WHEEL_H_
@@ -0,0 +1,188 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  track_store.h
+// @Version :  1.0
+// @Time    :  2026/10/29 10:12:40
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#ifndef JT808_TRACK_STORE_H_
+#define JT808_TRACK_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "jt808/location_report.h"
+
+namespace libjt808 {
+
+// A location of a terminal as kept by the track store, the fields of LocationBasicInformation but the time.
+struct TrackPoint {
+    int64_t  timestamp = 0; // Seconds since 1970-01-01 00:00:00 UTC.
+    uint32_t latitude  = 0;
+    uint32_t longitude = 0;
+    uint16_t altitude  = 0;
+    uint16_t speed     = 0;
+    uint16_t bearing   = 0;
+    uint32_t alarm     = 0;
+    uint32_t status    = 0;
+};
+
+struct TrackStoreOptions {
+    int64_t  partition_s      = 86400; // Seconds of locations per segment file.
+    size_t   block_points     = 1024;  // Locations of a terminal encoded in memory before they are written as a block.
+    uint32_t max_block_age_ms = 60000; // Time a block is encoded in memory at most, see FlushAged(). 0 for no limit.
+};
+
+// Embedded store of the location history of terminals.
+// Locations are kept in one segment file per time partition, a day by default, as blocks of locations of a terminal.
+// A block is columnar, time, latitude and longitude are stored as delta-of-delta, altitude, speed and bearing as
+// delta and the alarm and status bits as XOR with the previous location, each as varints with runs of zeros
+// collapsed, so a terminal reporting steadily costs a few bytes a location. The block of each terminal is encoded
+// in memory as locations arrive and appended to its segment once full, on a change of partition or on Flush(), the
+// files are only ever written sequentially. Open() indexes the blocks of the segments by terminal and time, drops a
+// torn block at the end of a segment, and queries read the blocks from the segments mapped in memory.
+// Locations not written yet are lost on a crash, call FlushAged() periodically to bound them to max_block_age_ms.
+// A store locks its directory, a second store of the same directory fails to open until it is closed.
+// Thread safe, Linux only, Open() fails on other platforms.
+//
+// Example:
+//     TrackStore store;
+//     store.Open("./tracks");
+//     store.Append(phone, para.parse.location_info); // On every 0x0200.
+//     std::vector<TrackPoint> track;
+//     store.Query(phone, from, to, &track);
+class TrackStore {
+public:
+    TrackStore() = default;
+    ~TrackStore();
+    TrackStore(TrackStore const&)            = delete;
+    TrackStore& operator=(TrackStore const&) = delete;
+
+    // Open the store in directory dir, creating it if it does not exist, lock it and index its segments.
+    // Returns 0 on success, -1 on failure, if another store holds the directory, or for invalid options.
+    int Open(std::string const& dir, TrackStoreOptions const& options = TrackStoreOptions());
+    // Write the blocks being filled and close the store.
+    void Close(void);
+    bool is_open(void) const;
+
+    // Add a location of a terminal, from the basic information parsed from 0x0200, 0x0201 or 0x0704.
+    // Returns 0 on success, -1 if the store is not open, the time is malformed or a block could not be written.
+    int Append(std::string const& phone_num, LocationBasicInformation const& info);
+    int Append(std::string const& phone_num, TrackPoint const& point);
+    // Write the blocks being filled to their segments. Returns 0 on success, -1 on failure.
+    int Flush(void);
+    // Write the blocks filled for max_block_age_ms or longer to their segments, then the segments to their files.
+    // Returns 0 on success, -1 on failure.
+    int FlushAged(void);
+
+    // Set points to the locations of a terminal with from_s <= timestamp < to_s, in time order, those not written
+    // yet included. Returns 0 on success, -1 if the store is not open.
+    int Query(std::string const& phone_num, int64_t const& from_s, int64_t const& to_s,
+              std::vector<TrackPoint>* points);
+
+    // Bytes of the segments.
+    uint64_t disk_bytes(void) const;
+
+private:
+    static constexpr size_t kColumns = 8;
+
+    // Column being encoded.
+    struct Column {
+        std::vector<uint8_t> bytes;
+        int64_t              prev       = 0;
+        int64_t              prev_delta = 0;
+        uint32_t             zeros      = 0; // Zeros not encoded yet.
+    };
+
+    // Block of a terminal being encoded.
+    struct ActiveBlock {
+        std::array<Column, kColumns> columns;
+        uint32_t                     count     = 0;
+        int64_t                      partition = 0; // Start of the partition of its locations.
+        int64_t                      min_time  = 0;
+        int64_t                      max_time  = 0;
+        int64_t                      opened_ms = 0; // Steady clock time of its first location.
+    };
+
+    // Block written to a segment.
+    struct BlockRef {
+        uint64_t offset; // Of its payload in the segment.
+        uint32_t size;   // Of its payload.
+        int64_t  min_time;
+        int64_t  max_time;
+    };
+
+    // Segment file of a partition.
+    struct Segment {
+        std::string path;
+        int64_t     start    = 0;         // Of its partition.
+        FILE*       file     = nullptr;   // For appending, opened on the first write.
+        uint64_t    bytes    = 0;         // Of the file, flushed or not.
+        bool        dirty    = false;     // Appended to since the last flush.
+        uint8_t*    map      = nullptr;   // For reading.
+        size_t      map_size = 0;
+        int64_t     min_time = INT64_MAX; // Of its blocks.
+        int64_t     max_time = INT64_MIN;
+        // Phone number - blocks, in write order.
+        std::unordered_map<std::string, std::vector<BlockRef>> blocks;
+    };
+
+    // Index the blocks of a segment file, cutting off a torn block at its end. Returns 0 on success, -1 on failure.
+    int      LoadSegment(std::string const& path);
+    Segment* GetSegment(int64_t const& start);
+    // Append the payload of a block to out.
+    static void EncodeBlock(std::string const& phone_num, ActiveBlock const& block, std::vector<uint8_t>* out);
+    // Write the block of a terminal to its segment and reset it.
+    int            Seal(std::string const& phone_num, ActiveBlock* block);
+    // Map the whole of a segment for reading. Returns nullptr on failure.
+    uint8_t const* MapSegment(Segment* segment);
+    void           CloseLocked(void);
+
+    mutable std::mutex                           mutex_;
+    std::string                                  dir_;
+    TrackStoreOptions                            options_;
+    bool                                         open_ = false;
+    std::map<int64_t, std::unique_ptr<Segment>>  segments_; // Partition start - segment.
+    std::unordered_map<std::string, ActiveBlock> active_;   // Phone number - block being encoded.
+    // Opening time and phone number of the blocks being encoded, oldest first. Blocks written since stay behind.
+    std::deque<std::pair<int64_t, std::string>>  opened_;
+    int                                          lock_fd_ = -1; // Of the directory, holding its lock.
+    std::vector<uint8_t>                         scratch_;
+};
+
+} // namespace libjt808
+
+#endif // JT808_TRACK_STORE_H_
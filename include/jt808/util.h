@@ -73,6 +73,16 @@ constexpr uint32_t EndianSwap32(uint32_t const& u32val) {
           ((u32val&0xFF000000)>>24));
 }
 
+// 以大端字节序追加value的低size字节(1~8).
+void PutBigEndian(uint64_t const& value, size_t const& size,
+                  std::vector<uint8_t>* out);
+
+// 读取data处size字节(1~8)的大端整数.
+uint64_t GetBigEndian(uint8_t const* data, size_t const& size);
+
+// 32位FNV-1a哈希.
+uint32_t Fnv1a(uint8_t const* data, size_t const& size);
+
 // 转义函数.
 int Escape(InputBuffer in,
            std::vector<uint8_t>& out);
@@ -84,6 +94,18 @@ int ReverseEscape(InputBuffer in,
 // 异或校验.
 uint8_t BccCheckSum(const uint8_t *src, const size_t &len);
 
+// 在字节流中查找第一个完整的JT808帧(包含首尾标识位).
+// 用于处理TCP粘包/半包, 连续的两个标识位视为前一帧的结束和后一帧的开始.
+// Args:
+//    data:  字节流起始地址.
+//    len:  字节流长度.
+//    begin:  返回帧起始标识位的位置.
+//    end:  返回帧结束标识位之后的位置, 帧区间为[begin, end).
+// Returns:
+//    找到完整帧返回0, 否则返回-1, 此时begin为尚未完整的帧的起始位置(无起始标识位时为len).
+int FindFrame(const uint8_t *data, const size_t &len,
+              size_t *begin, size_t *end);
+
 }  // namespace libjt808
 
 #endif  // JT808_UTIL_H_
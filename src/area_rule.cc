@@ -0,0 +1,286 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  area_rule.cc
+// @Version :  1.0
+// @Time    :  2026/10/19 09:26:47
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/area_rule.h"
+
+#include "jt808/bcd_time.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Overspeed location type of an access location type: circle, rectangle and polygon shift by one, a route maps to
+// its road section.
+uint8_t OverSpeedLocationType(uint8_t const& type) {
+    return static_cast<uint8_t>(type + 1);
+}
+
+} // namespace
+
+int AreaTimeToSeconds(std::string const& time, int64_t* seconds) {
+    if (seconds == nullptr || time.size() != 12)
+        return -1;
+    int fields[6];
+    for (int i = 0; i < 6; ++i) {
+        char high = time[i * 2];
+        char low  = time[i * 2 + 1];
+        if (high < '0' || high > '9' || low < '0' || low > '9')
+            return -1;
+        fields[i] = (high - '0') * 10 + (low - '0');
+    }
+    if (fields[3] > 23 || fields[4] > 59 || fields[5] > 59)
+        return -1;
+    int64_t time_of_day = fields[3] * 3600 + fields[4] * 60 + fields[5];
+    // A zero date is a time of the day.
+    if (fields[0] == 0 && fields[1] == 0 && fields[2] == 0) {
+        *seconds = time_of_day;
+        return 0;
+    }
+    if (fields[1] < 1 || fields[1] > 12 || fields[2] < 1 || fields[2] > 31)
+        return -1;
+    *seconds = DaysFromCivil(2000 + fields[0], fields[1], fields[2]) * kSecondsPerDay + time_of_day;
+    return 0;
+}
+
+int AreaAlarmBody(AreaAlarm const& alarm, uint8_t* item_id, std::vector<uint8_t>* out) {
+    if (item_id == nullptr || out == nullptr)
+        return -1;
+    if (alarm.kind == kAreaAlarmAccess) {
+        *item_id = kAccessAreaAlarm;
+        return SetAccessAreaAlarmBody(alarm.location_type, alarm.area_route_id, alarm.direction, out);
+    }
+    *item_id = kOverSpeedAlarm;
+    return SetOverSpeedAlarmBody(alarm.location_type, alarm.area_route_id, out);
+}
+
+//
+// AreaRuleEngine.
+//
+template <typename Attribute>
+int AreaRuleEngine::MakeRule(Attribute const& attribute, std::string const& start_time, std::string const& stop_time,
+                             Rule* rule) {
+    *rule               = Rule();
+    rule->by_time       = attribute.by_time;
+    rule->in_to_driver  = attribute.in_alarm_to_dirver;
+    rule->in_to_server  = attribute.in_alarm_to_server;
+    rule->out_to_driver = attribute.out_alarm_to_dirver;
+    rule->out_to_server = attribute.out_alarm_to_server;
+    if (!rule->by_time)
+        return 0;
+    if (AreaTimeToSeconds(start_time, &rule->start) < 0 || AreaTimeToSeconds(stop_time, &rule->stop) < 0)
+        return -1;
+    bool start_daily = start_time.compare(0, 6, "000000") == 0;
+    bool stop_daily  = stop_time.compare(0, 6, "000000") == 0;
+    if (start_daily != stop_daily)
+        return -1;
+    rule->daily = start_daily;
+    return 0;
+}
+
+bool AreaRuleEngine::IsOpen(Rule const& rule, int64_t const& time) {
+    if (!rule.by_time)
+        return true;
+    if (!rule.daily)
+        return time >= rule.start && time <= rule.stop;
+    int64_t time_of_day = ((time % kSecondsPerDay) + kSecondsPerDay) % kSecondsPerDay;
+    if (rule.start <= rule.stop)
+        return time_of_day >= rule.start && time_of_day <= rule.stop;
+    return time_of_day >= rule.start || time_of_day <= rule.stop;
+}
+
+int AreaRuleEngine::AddPolygonArea(PolygonArea const& area) {
+    Rule rule;
+    if (MakeRule(area.area_attribute.bit, area.start_time, area.stop_time, &rule) < 0 ||
+        geofence_.AddPolygonArea(area) < 0) {
+        return -1;
+    }
+    rules_[Key(kAccessAreaAlarmPolygonArea, area.area_id)] = rule;
+    return 0;
+}
+
+int AreaRuleEngine::AddCircularArea(CircularArea const& area) {
+    Rule rule;
+    if (MakeRule(area.area_attribute.bit, area.start_time, area.stop_time, &rule) < 0 ||
+        geofence_.AddCircularArea(area) < 0) {
+        return -1;
+    }
+    rules_[Key(kAccessAreaAlarmCircularArea, area.area_id)] = rule;
+    return 0;
+}
+
+int AreaRuleEngine::AddRectangleArea(RectangleArea const& area) {
+    Rule rule;
+    if (MakeRule(area.area_attribute.bit, area.start_time, area.stop_time, &rule) < 0 ||
+        geofence_.AddRectangleArea(area) < 0) {
+        return -1;
+    }
+    rules_[Key(kAccessAreaAlarmRectangleArea, area.area_id)] = rule;
+    return 0;
+}
+
+int AreaRuleEngine::AddRoute(Route const& route) {
+    Rule rule;
+    if (MakeRule(route.route_attribute.bit, route.start_time, route.stop_time, &rule) < 0 ||
+        geofence_.AddRoute(route) < 0) {
+        return -1;
+    }
+    rules_[Key(kOverSpeedAlarmRoute, route.route_id)] = rule;
+    return 0;
+}
+
+int AreaRuleEngine::AddPolygonAreas(PolygonAreaSet const& areas) {
+    int ret = 0;
+    for (auto const& item : areas) {
+        if (AddPolygonArea(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int AreaRuleEngine::AddCircularAreas(CircularAreaSet const& areas) {
+    int ret = 0;
+    for (auto const& item : areas) {
+        if (AddCircularArea(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int AreaRuleEngine::AddRectangleAreas(RectangleAreaSet const& areas) {
+    int ret = 0;
+    for (auto const& item : areas) {
+        if (AddRectangleArea(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int AreaRuleEngine::AddRoutes(RouteSet const& routes) {
+    int ret = 0;
+    for (auto const& item : routes) {
+        if (AddRoute(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int AreaRuleEngine::RemoveArea(uint8_t const& type, uint32_t const& area_id) {
+    if (geofence_.RemoveArea(type, area_id) < 0)
+        return -1;
+    rules_.erase(Key(type, area_id));
+    return 0;
+}
+
+void AreaRuleEngine::Clear(void) {
+    geofence_.Clear();
+    rules_.clear();
+    terminals_.clear();
+}
+
+void AreaRuleEngine::Access(uint64_t const& key, Rule const& rule, bool const& entered,
+                            std::vector<AreaAlarm>* alarms) const {
+    bool to_driver = entered ? rule.in_to_driver : rule.out_to_driver;
+    bool to_server = entered ? rule.in_to_server : rule.out_to_server;
+    if (!to_driver && !to_server)
+        return;
+    uint8_t direction = entered ? kAccessAreaAlarmInArea : kAccessAreaAlarmOutArea;
+    alarms->push_back({kAreaAlarmAccess, static_cast<uint8_t>(key >> 32), static_cast<uint32_t>(key), direction,
+                       to_driver, to_server});
+}
+
+void AreaRuleEngine::OverSpeedEnd(State const& state, std::vector<AreaAlarm>* alarms) const {
+    uint8_t  type = static_cast<uint8_t>(state.key >> 32);
+    uint32_t id   = type == kOverSpeedAlarmRoute ? state.road_section_id : static_cast<uint32_t>(state.key);
+    alarms->push_back({kAreaAlarmOverSpeedEnd, OverSpeedLocationType(type), id, 0, true, true});
+}
+
+void AreaRuleEngine::Process(std::string const& terminal, GeoPoint const& point, int64_t const& time,
+                             uint16_t const& speed, std::vector<AreaAlarm>* alarms) {
+    geofence_.Locate(point, &hits_);
+    auto& previous = terminals_[terminal];
+    scratch_.clear();
+    // Both the hits and the previous states are ascending by key, merge them. States without a hit were left.
+    size_t i     = 0;
+    auto   leave = [&](State const& state) {
+        if (state.overspeed_alarm)
+            OverSpeedEnd(state, alarms);
+        auto it = rules_.find(state.key);
+        if (it != rules_.end())
+            Access(state.key, it->second, false, alarms);
+    };
+    for (auto const& hit : hits_) {
+        uint64_t key = Key(hit.type, hit.area_id);
+        auto     it  = rules_.find(key);
+        if (it == rules_.end() || !IsOpen(it->second, time))
+            continue;
+        while (i < previous.size() && previous[i].key < key)
+            leave(previous[i++]);
+        State state = {key, 0, -1, false};
+        if (i < previous.size() && previous[i].key == key)
+            state = previous[i++];
+        else
+            Access(key, it->second, true, alarms);
+        // Speed in 1/10 km/h, limits in km/h.
+        if (hit.max_speed != 0 && speed > hit.max_speed * 10) {
+            if (state.overspeed_since < 0)
+                state.overspeed_since = time;
+            if (!state.overspeed_alarm && time - state.overspeed_since >= hit.overspeed_time) {
+                state.overspeed_alarm = true;
+                state.road_section_id = hit.road_section_id;
+                uint32_t id           = hit.type == kOverSpeedAlarmRoute ? hit.road_section_id : hit.area_id;
+                alarms->push_back({kAreaAlarmOverSpeed, OverSpeedLocationType(hit.type), id, 0, true, true});
+            }
+        }
+        else {
+            if (state.overspeed_alarm)
+                OverSpeedEnd(state, alarms);
+            state.overspeed_since = -1;
+            state.overspeed_alarm = false;
+        }
+        scratch_.push_back(state);
+    }
+    while (i < previous.size())
+        leave(previous[i++]);
+    previous.swap(scratch_);
+}
+
+int AreaRuleEngine::Process(std::string const& terminal, LocationBasicInformation const& location,
+                            std::vector<AreaAlarm>* alarms) {
+    // The parsed report keeps the fix as seconds since the epoch, rules take the local time of GMT+8.
+    if (location.timestamp < 0)
+        return -1;
+    Process(terminal, LocationToGeoPoint(location), location.timestamp + kJT808TimeZoneOffset, location.speed, alarms);
+    return 0;
+}
+
+void AreaRuleEngine::RemoveTerminal(std::string const& terminal) {
+    terminals_.erase(terminal);
+}
+
+} // namespace libjt808
@@ -31,6 +31,73 @@
 
 namespace libjt808 {
 
+namespace {
+
+// Value 0-99 of a BCD byte, kInvalidBcd if a nibble is not decimal. Valid values never have the top bit set, so
+// ORing the lookups of a field and testing the top bit once validates the field.
+constexpr uint8_t kInvalidBcd = 0xFF;
+
+#define JT808_BCD_DECODE(v) \
+    static_cast<uint8_t>(((v) >> 4) < 10 && ((v)&0x0F) < 10 ? ((v) >> 4) * 10 + ((v)&0x0F) : kInvalidBcd)
+#define JT808_BCD_DECODE_4(v) \
+    JT808_BCD_DECODE(v), JT808_BCD_DECODE((v) + 1), JT808_BCD_DECODE((v) + 2), JT808_BCD_DECODE((v) + 3)
+#define JT808_BCD_DECODE_16(v) \
+    JT808_BCD_DECODE_4(v), JT808_BCD_DECODE_4((v) + 4), JT808_BCD_DECODE_4((v) + 8), JT808_BCD_DECODE_4((v) + 12)
+#define JT808_BCD_DECODE_64(v)                                                                                 \
+    JT808_BCD_DECODE_16(v), JT808_BCD_DECODE_16((v) + 16), JT808_BCD_DECODE_16((v) + 32),                      \
+        JT808_BCD_DECODE_16((v) + 48)
+
+constexpr uint8_t kBcdDecode[256] = {JT808_BCD_DECODE_64(0), JT808_BCD_DECODE_64(64), JT808_BCD_DECODE_64(128),
+                                     JT808_BCD_DECODE_64(192)};
+
+#undef JT808_BCD_DECODE_64
+#undef JT808_BCD_DECODE_16
+#undef JT808_BCD_DECODE_4
+#undef JT808_BCD_DECODE
+
+// BCD byte of a value 0-99.
+#define JT808_BCD_ENCODE(v) static_cast<uint8_t>((((v) / 10) << 4) | ((v) % 10))
+#define JT808_BCD_ENCODE_10(v)                                                                                 \
+    JT808_BCD_ENCODE(v), JT808_BCD_ENCODE((v) + 1), JT808_BCD_ENCODE((v) + 2), JT808_BCD_ENCODE((v) + 3),      \
+        JT808_BCD_ENCODE((v) + 4), JT808_BCD_ENCODE((v) + 5), JT808_BCD_ENCODE((v) + 6),                       \
+        JT808_BCD_ENCODE((v) + 7), JT808_BCD_ENCODE((v) + 8), JT808_BCD_ENCODE((v) + 9)
+
+constexpr uint8_t kBcdEncode[100] = {JT808_BCD_ENCODE_10(0),  JT808_BCD_ENCODE_10(10), JT808_BCD_ENCODE_10(20),
+                                     JT808_BCD_ENCODE_10(30), JT808_BCD_ENCODE_10(40), JT808_BCD_ENCODE_10(50),
+                                     JT808_BCD_ENCODE_10(60), JT808_BCD_ENCODE_10(70), JT808_BCD_ENCODE_10(80),
+                                     JT808_BCD_ENCODE_10(90)};
+
+#undef JT808_BCD_ENCODE_10
+#undef JT808_BCD_ENCODE
+
+static_assert(kBcdDecode[0x99] == 99 && kBcdDecode[0x0A] == kInvalidBcd && kBcdEncode[47] == 0x47,
+              "Malformed BCD tables");
+
+// Pack len digits right aligned into size BCD bytes, len <= 2 * size.
+// Returns non zero if a char is not a digit: a digit minus '0' is at most 9, so adding 6 stays below 16.
+unsigned PackDigits(char const* digits, size_t const& len, uint8_t* bcd, size_t const& size) {
+    unsigned invalid = 0;
+    size_t   pad     = size * 2 - len; // Leading zero nibbles.
+    size_t   i       = 0;
+    for (; i < pad / 2; ++i)
+        bcd[i] = 0;
+    if (pad % 2 != 0) {
+        unsigned low = static_cast<uint8_t>(digits[0] - '0');
+        invalid |= low + 6;
+        bcd[i++] = static_cast<uint8_t>(low);
+        ++digits;
+    }
+    for (; i < size; ++i, digits += 2) {
+        unsigned high = static_cast<uint8_t>(digits[0] - '0');
+        unsigned low  = static_cast<uint8_t>(digits[1] - '0');
+        invalid |= (high + 6) | (low + 6);
+        bcd[i] = static_cast<uint8_t>((high << 4) | (low & 0x0F));
+    }
+    return invalid & ~0x0Fu;
+}
+
+} // namespace
+
 uint8_t HexToBcd(uint8_t const& src) {
     uint8_t temp;
     temp = ((src / 10) << 4) + (src % 10);
@@ -91,49 +158,87 @@ uint8_t* BcdToStringCompressFillingZero(uint8_t const* src, uint8_t* dst, int co
 int StringToBcd(std::string const& in, std::vector<uint8_t>* out) {
     if (out == nullptr)
         return -1;
-    out->clear();
-    size_t pos = 0;
-    if (in.size() % 2 != 0) {
-        out->push_back(HexToBcd(in[pos] - '0'));
-        ++pos;
-    }
-    uint8_t tmp = 0;
-    for (; pos < in.size();) {
-        tmp = (in[pos] - '0') * 10 + (in[pos + 1] - '0');
-        out->push_back(HexToBcd(tmp));
-        pos += 2;
-    }
+    out->resize((in.size() + 1) / 2);
+    if (!out->empty())
+        PackDigits(in.data(), in.size(), out->data(), out->size());
     return 0;
 }
 
 int BcdToString(std::vector<uint8_t> const& in, std::string* out) {
     if (out == nullptr)
         return -1;
-    out->clear();
-    size_t  pos = 0;
-    uint8_t tmp = BcdToHex(in[pos]);
-    if (tmp / 10 == 0) {
-        out->push_back(tmp % 10 + '0');
-        ++pos;
-    }
-    for (; pos < in.size(); ++pos) {
-        tmp = BcdToHex(in[pos]);
-        out->push_back(tmp / 10 + '0');
-        out->push_back(tmp % 10 + '0');
-    }
+    out->resize(in.size() * 2);
+    if (in.empty())
+        return 0;
+    BcdToDigits(in.data(), in.size(), &(*out)[0]);
+    // A leading zero digit is dropped.
+    if ((*out)[0] == '0')
+        out->erase(0, 1);
     return 0;
 }
 
 int BcdToStringFillZero(std::vector<uint8_t> const& in, std::string* out) {
     if (out == nullptr)
         return -1;
-    out->clear();
-    uint8_t tmp = 0;
-    for (auto& uch : in) {
-        tmp = BcdToHex(uch);
-        out->push_back(tmp / 10 + '0');
-        out->push_back(tmp % 10 + '0');
+    out->resize(in.size() * 2);
+    if (!in.empty())
+        BcdToDigits(in.data(), in.size(), &(*out)[0]);
+    return 0;
+}
+
+void BcdToDigits(uint8_t const* bcd, size_t const& size, char* digits) {
+    for (size_t i = 0; i < size; ++i) {
+        digits[i * 2]     = static_cast<char>('0' + (bcd[i] >> 4));
+        digits[i * 2 + 1] = static_cast<char>('0' + (bcd[i] & 0x0F));
+    }
+}
+
+int BcdToDigitsChecked(uint8_t const* bcd, size_t const& size, char* digits) {
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < size; ++i) {
+        invalid |= kBcdDecode[bcd[i]];
+        digits[i * 2]     = static_cast<char>('0' + (bcd[i] >> 4));
+        digits[i * 2 + 1] = static_cast<char>('0' + (bcd[i] & 0x0F));
+    }
+    return (invalid & 0x80) != 0 ? -1 : 0;
+}
+
+int DigitsToBcd(char const* digits, size_t const& len, uint8_t* bcd, size_t const& size) {
+    if (len > size * 2 || (len > 0 && digits == nullptr) || (size > 0 && bcd == nullptr))
+        return -1;
+    return PackDigits(digits, len, bcd, size) != 0 ? -1 : 0;
+}
+
+int BcdToValues(uint8_t const* bcd, size_t const& size, uint8_t* values) {
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = kBcdDecode[bcd[i]];
+        invalid |= values[i];
+    }
+    return (invalid & 0x80) != 0 ? -1 : 0;
+}
+
+int BcdToTime(uint8_t const* bcd, BcdTime* time) {
+    uint8_t fields[kBcdTimeSize];
+    if (time == nullptr || BcdToValues(bcd, kBcdTimeSize, fields) < 0)
+        return -1;
+    time->year   = fields[0];
+    time->month  = fields[1];
+    time->day    = fields[2];
+    time->hour   = fields[3];
+    time->minute = fields[4];
+    time->second = fields[5];
+    return 0;
+}
+
+int TimeToBcd(BcdTime const& time, uint8_t* bcd) {
+    uint8_t const fields[kBcdTimeSize] = {time.year, time.month, time.day, time.hour, time.minute, time.second};
+    for (size_t i = 0; i < kBcdTimeSize; ++i) {
+        if (fields[i] > 99)
+            return -1;
     }
+    for (size_t i = 0; i < kBcdTimeSize; ++i)
+        bcd[i] = kBcdEncode[fields[i]];
     return 0;
 }
 
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  bcd_time.cc
+// @Version :  1.0
+// @Time    :  2026/10/21 09:05:18
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/bcd_time.h"
+
+#include <string.h>
+
+namespace libjt808 {
+
+namespace {
+
+// Seconds of a BCD[3] hhmmss, -1 if malformed.
+int64_t BcdTimeOfDay(uint8_t const* bcd) {
+    uint8_t fields[3];
+    if (BcdToValues(bcd, 3, fields) < 0 || fields[0] > 23 || fields[1] > 59 || fields[2] > 59)
+        return -1;
+    return fields[0] * 3600 + fields[1] * 60 + fields[2];
+}
+
+// Epoch of 00:00:00 GMT+8 of a BCD[3] YYMMDD date. Returns 0 on success, -1 if malformed.
+int BcdDateToEpoch(uint8_t const* bcd, int64_t* epoch) {
+    static uint8_t const kDaysOfMonth[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    uint8_t              fields[3];
+    if (BcdToValues(bcd, 3, fields) < 0 || fields[1] < 1 || fields[1] > 12 || fields[2] < 1 ||
+        fields[2] > kDaysOfMonth[fields[1] - 1]) {
+        return -1;
+    }
+    // 20YY is a leap year whenever YY is a multiple of 4, 2000 included.
+    if (fields[1] == 2 && fields[2] == 29 && fields[0] % 4 != 0)
+        return -1;
+    *epoch = DaysFromCivil(2000 + fields[0], fields[1], fields[2]) * kSecondsPerDay - kJT808TimeZoneOffset;
+    return 0;
+}
+
+} // namespace
+
+int64_t DaysFromCivil(int64_t year, int64_t const& month, int64_t const& day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+int BcdTimeToEpoch(uint8_t const* bcd, int64_t* epoch) {
+    int64_t day = 0;
+    if (bcd == nullptr || epoch == nullptr || BcdDateToEpoch(bcd, &day) < 0)
+        return -1;
+    int64_t time_of_day = BcdTimeOfDay(bcd + 3);
+    if (time_of_day < 0)
+        return -1;
+    *epoch = day + time_of_day;
+    return 0;
+}
+
+int BcdTimeCache::ToEpoch(uint8_t const* bcd, int64_t* epoch) {
+    if (bcd == nullptr || epoch == nullptr)
+        return -1;
+    if (memcmp(bcd, date_, sizeof(date_)) != 0) {
+        int64_t day = 0;
+        if (BcdDateToEpoch(bcd, &day) < 0)
+            return -1;
+        memcpy(date_, bcd, sizeof(date_));
+        day_ = day;
+    }
+    int64_t time_of_day = BcdTimeOfDay(bcd + 3);
+    if (time_of_day < 0)
+        return -1;
+    *epoch = day_ + time_of_day;
+    return 0;
+}
+
+} // namespace libjt808
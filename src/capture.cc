@@ -0,0 +1,620 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  capture.cc
+// @Version :  1.0
+// @Time    :  2026/11/03 14:26:51
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/capture.h"
+
+#include <string.h>
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+
+#include "jt808/packager.h"
+#include "jt808/parser.h"
+#include "jt808/reassembly.h"
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Capture layout, big endian:
+//     magic[8]
+//     record: frame size (DWORD), receive time in microseconds (8 bytes), connection (DWORD), frame.
+constexpr uint8_t kMagic[8]     = {'J', 'T', '8', '0', '8', 'C', 'P', 0x01};
+constexpr size_t  kRecordHeader = 16;
+// Records following a record found by CaptureReader::Seek() checked along with it.
+constexpr int kSeekRecords = 4;
+// Records are buffered up to this size before they are written.
+constexpr size_t kWriteBufferBytes = 1 << 20;
+// Time a replayed connection waits to be established, or a registration or authentication for its response.
+constexpr int64_t kHandshakeTimeoutMs = 60000;
+// Response awaited by a replayed connection being established.
+constexpr uint16_t kAwaitingConnect = 0xFFFF;
+// Connections of a replay awaiting a handshake response at once. The server accepts and handshakes one connection
+// at a time, connections beyond its listen backlog would only retry their SYNs at growing intervals.
+constexpr size_t kMaxHandshakes = 8;
+
+// Whether a record at pos holds a frame, 0x7E to 0x7E with none between as cut by FindFrame(), and where the next
+// one starts.
+bool IsRecord(uint8_t const* data, size_t const& size, size_t const& pos, size_t* next) {
+    if (pos > size || size - pos < kRecordHeader)
+        return false;
+    size_t const   frame_size = GetBigEndian(data + pos, 4);
+    uint8_t const* frame      = data + pos + kRecordHeader;
+    if (frame_size < 3 || size - pos - kRecordHeader < frame_size || frame[0] != PROTOCOL_SIGN ||
+        frame[frame_size - 1] != PROTOCOL_SIGN || memchr(frame + 1, PROTOCOL_SIGN, frame_size - 2) != nullptr)
+        return false;
+    *next = pos + kRecordHeader + frame_size;
+    return true;
+}
+
+int64_t SteadyClockMs(void) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Holds the frames of a capture back to the pace of the capture times.
+class Pacer {
+public:
+    Pacer(CaptureReader const& capture, double const& speed) : speed_(speed), start_(std::chrono::steady_clock::now()) {
+        size_t        offset = 0;
+        CaptureRecord record;
+        if (capture.Next(&offset, &record) == 0)
+            first_us_ = record.timestamp_us;
+    }
+
+    // Milliseconds until a frame of the capture is due, 0 if it is.
+    int64_t Delay(int64_t const& timestamp_us) const {
+        if (speed_ <= 0)
+            return 0;
+        auto const due = start_ + std::chrono::microseconds(static_cast<int64_t>((timestamp_us - first_us_) / speed_));
+        auto const now = std::chrono::steady_clock::now();
+        if (due <= now)
+            return 0;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count() + 1;
+    }
+
+private:
+    double                                speed_;
+    std::chrono::steady_clock::time_point start_;
+    int64_t                               first_us_ = 0;
+};
+
+void AddStats(ReplayStats const& shard, ReplayStats* stats) {
+    stats->frames += shard.frames;
+    stats->bytes += shard.bytes;
+    stats->messages += shard.messages;
+    stats->pending += shard.pending;
+    stats->errors += shard.errors;
+    stats->responses += shard.responses;
+    stats->connections += shard.connections;
+}
+
+// Run a replay over options.threads threads, the connections of shard i of n are those with connection % n == i.
+template <typename Shard>
+int RunShards(ReplayOptions const& options, Shard const& shard, ReplayStats* stats) {
+    if (stats == nullptr || options.threads <= 0 || options.speed < 0)
+        return -1;
+    *stats = ReplayStats();
+    auto const               start = std::chrono::steady_clock::now();
+    std::vector<ReplayStats> shards(options.threads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.threads; ++i)
+        threads.emplace_back(shard, static_cast<uint32_t>(i), &shards[i]);
+    for (auto& thread : threads)
+        thread.join();
+    for (auto const& item : shards)
+        AddStats(item, stats);
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 0;
+}
+
+#if defined(__linux__)
+// Replays the connections of a shard to a server.
+class ServerReplay {
+public:
+    ServerReplay(CaptureReader const& capture, Parser const& parser, Packager const& packager,
+                 struct sockaddr_in const& addr, Pacer const& pacer, uint32_t const& shards, uint32_t const& index,
+                 ReplayStats* stats)
+        : capture_(capture), parser_(parser), packager_(packager), addr_(addr), pacer_(pacer), shards_(shards),
+          index_(index), max_handshakes_(std::max<size_t>(1, kMaxHandshakes / shards)), stats_(stats) {
+    }
+
+    void Run(void) {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_ < 0) {
+            ++stats_->errors;
+            return;
+        }
+        size_t        offset = 0;
+        CaptureRecord record;
+        while (1) {
+            size_t const at = offset;
+            if (capture_.Next(&offset, &record) < 0)
+                break;
+            if (record.connection % shards_ != index_)
+                continue;
+            for (int64_t delay; (delay = pacer_.Delay(record.timestamp_us)) > 0;)
+                Service(static_cast<int>(delay));
+            auto& connection = connections_[record.connection];
+            if (connection.fd < 0 && !connection.failed && !connection.deferred) {
+                connection.deferred = true;
+                deferred_.push_back(record.connection);
+                Connect();
+            }
+            if (connection.failed)
+                continue;
+            if (connection.fd < 0 || connection.awaiting != 0 || !connection.queued.empty())
+                connection.queued.push_back(at);
+            else
+                Send(record, &connection);
+            Service(0);
+            if (SteadyClockMs() - expired_ms_ >= 1000)
+                ExpireHandshakes();
+        }
+        // Responses still awaited, then those of the last frames.
+        while (awaiting_ > 0 || !deferred_.empty()) {
+            Service(50);
+            ExpireHandshakes();
+        }
+        while (Service(200) > 0) {
+        }
+        for (auto& item : connections_) {
+            if (item.second.fd >= 0)
+                close(item.second.fd);
+        }
+        close(epoll_);
+        stats_->connections = static_cast<uint32_t>(connections_.size());
+    }
+
+private:
+    struct Connection {
+        int                  fd       = -1;
+        bool                 failed   = false;
+        bool                 deferred = false; // Waits for a handshake of another connection to finish.
+        uint16_t             awaiting = 0; // Message ID of the response awaited, kAwaitingConnect, 0 for none.
+        int64_t              since_ms = 0; // Time the response is awaited since.
+        std::deque<size_t>   queued;       // Offsets of the records held back until the response.
+        std::vector<uint8_t> received;
+        std::vector<uint8_t> authentication_code; // Issued by the server.
+        ProtocolParameter    para;
+    };
+
+    // Start connecting the connections deferred while the handshakes in progress allow, their records are held back
+    // until they are established.
+    void Connect(void) {
+        while (awaiting_ < max_handshakes_ && !deferred_.empty()) {
+            uint32_t const id = deferred_.front();
+            deferred_.pop_front();
+            auto& connection    = connections_[id];
+            connection.deferred = false;
+            Connect(id, &connection);
+        }
+    }
+
+    // A blocking connect would wait for the server to accept connections whose handshakes are held back here.
+    void Connect(uint32_t const& id, Connection* connection) {
+        connection->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        struct epoll_event event;
+        event.events   = EPOLLIN | EPOLLOUT;
+        event.data.u32 = id;
+        if (connection->fd < 0 ||
+            (connect(connection->fd, reinterpret_cast<struct sockaddr const*>(&addr_), sizeof(addr_)) < 0 &&
+             errno != EINPROGRESS) ||
+            epoll_ctl(epoll_, EPOLL_CTL_ADD, connection->fd, &event) < 0) {
+            Fail(connection);
+            return;
+        }
+        connection->awaiting = kAwaitingConnect;
+        connection->since_ms = SteadyClockMs();
+        ++awaiting_;
+    }
+
+    // Switch an established connection to blocking sends and send the records held back.
+    void Connected(uint32_t const& id, Connection* connection) {
+        int       error  = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(connection->fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+            Fail(connection);
+            return;
+        }
+        struct epoll_event event;
+        event.events   = EPOLLIN;
+        event.data.u32 = id;
+        epoll_ctl(epoll_, EPOLL_CTL_MOD, connection->fd, &event);
+        fcntl(connection->fd, F_SETFL, fcntl(connection->fd, F_GETFL, 0) & ~O_NONBLOCK);
+        connection->awaiting = 0;
+        --awaiting_;
+        Release(connection);
+    }
+
+    void Fail(Connection* connection) {
+        if (connection->fd >= 0)
+            close(connection->fd);
+        connection->fd     = -1;
+        connection->failed = true;
+        if (connection->awaiting != 0)
+            --awaiting_;
+        connection->awaiting = 0;
+        connection->queued.clear();
+        ++stats_->errors;
+    }
+
+    void Send(CaptureRecord const& record, Connection* connection) {
+        // Message IDs hold no escaped byte.
+        uint16_t const msg_id = record.size > 3 ? static_cast<uint16_t>((record.data[1] << 8) | record.data[2]) : 0;
+        uint8_t const* data   = record.data;
+        size_t         size   = record.size;
+        if (msg_id == kTerminalAuthentication && !connection->authentication_code.empty()) {
+            // The code issued to the captured terminal is of no use to this server.
+            msg_.assign(record.data, record.data + record.size);
+            auto& para = connection->para;
+            if (!JT808FrameParse(parser_, msg_, &para)) {
+                para.msg_head                  = para.parse.msg_head;
+                para.parse.authentication_code = connection->authentication_code;
+                frame_.clear();
+                if (JT808FramePackage(packager_, para, frame_) == 0) {
+                    data = frame_.data();
+                    size = frame_.size();
+                }
+            }
+        }
+        if (SendAll(connection->fd, data, size) < 0) {
+            Fail(connection);
+            return;
+        }
+        ++stats_->frames;
+        stats_->bytes += size;
+        if (msg_id == kTerminalRegister || msg_id == kTerminalAuthentication) {
+            connection->awaiting = msg_id == kTerminalRegister ? kTerminalRegisterResponse : kPlatformGeneralResponse;
+            connection->since_ms = SteadyClockMs();
+            ++awaiting_;
+        }
+    }
+
+    static int SendAll(int const& fd, uint8_t const* data, size_t size) {
+        while (size > 0) {
+            ssize_t ret = send(fd, data, size, MSG_NOSIGNAL);
+            if (ret <= 0)
+                return -1;
+            data += ret;
+            size -= ret;
+        }
+        return 0;
+    }
+
+    // Read the responses of the server, waiting up to timeout_ms for the first. Returns the connections read.
+    int Service(int const& timeout_ms) {
+        struct epoll_event events[256];
+        int                ready = epoll_wait(epoll_, events, 256, timeout_ms);
+        for (int i = 0; i < ready; ++i) {
+            auto it = connections_.find(events[i].data.u32);
+            if (it == connections_.end() || it->second.fd < 0)
+                continue;
+            if (it->second.awaiting == kAwaitingConnect)
+                Connected(it->first, &it->second);
+            else
+                Receive(&it->second);
+        }
+        Connect();
+        return ready < 0 ? 0 : ready;
+    }
+
+    void Receive(Connection* connection) {
+        uint8_t buffer[4096];
+        ssize_t ret = 0;
+        while ((ret = recv(connection->fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+            connection->received.insert(connection->received.end(), buffer, buffer + ret);
+        auto&  received = connection->received;
+        size_t offset   = 0;
+        size_t begin    = 0;
+        size_t end      = 0;
+        while (FindFrame(received.data() + offset, received.size() - offset, &begin, &end) == 0) {
+            ++stats_->responses;
+            if (connection->awaiting != 0) {
+                msg_.assign(received.begin() + offset + begin, received.begin() + offset + end);
+                auto& para = connection->para;
+                if (!JT808FrameParse(parser_, msg_, &para) && para.parse.msg_head.msg_id == connection->awaiting) {
+                    if (connection->awaiting == kTerminalRegisterResponse)
+                        connection->authentication_code = para.parse.authentication_code;
+                    connection->awaiting = 0;
+                    --awaiting_;
+                }
+            }
+            offset += end;
+        }
+        received.erase(received.begin(), received.begin() + offset);
+        if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            Fail(connection);
+            return;
+        }
+        Release(connection);
+    }
+
+    // Send the records held back behind a response received.
+    void Release(Connection* connection) {
+        while (connection->fd >= 0 && connection->awaiting == 0 && !connection->queued.empty()) {
+            size_t        offset = connection->queued.front();
+            CaptureRecord record;
+            connection->queued.pop_front();
+            if (capture_.Next(&offset, &record) == 0)
+                Send(record, connection);
+        }
+    }
+
+    // Give up the responses awaited too long, the records held back are sent regardless.
+    void ExpireHandshakes(void) {
+        int64_t const now = SteadyClockMs();
+        expired_ms_       = now;
+        for (auto& item : connections_) {
+            auto& connection = item.second;
+            if (connection.awaiting == 0 || now - connection.since_ms < kHandshakeTimeoutMs)
+                continue;
+            if (connection.awaiting == kAwaitingConnect) {
+                Fail(&connection);
+                continue;
+            }
+            connection.awaiting = 0;
+            --awaiting_;
+            ++stats_->errors;
+            Release(&connection);
+        }
+        Connect();
+    }
+
+    CaptureReader const&                     capture_;
+    Parser const&                            parser_;
+    Packager const&                          packager_;
+    struct sockaddr_in                       addr_;
+    Pacer const&                             pacer_;
+    uint32_t                                 shards_;
+    uint32_t                                 index_;
+    size_t                                   max_handshakes_;
+    ReplayStats*                             stats_;
+    int                                      epoll_      = -1;
+    size_t                                   awaiting_   = 0; // Connections awaiting a response.
+    int64_t                                  expired_ms_ = 0; // Time of the last ExpireHandshakes().
+    std::unordered_map<uint32_t, Connection> connections_;
+    std::deque<uint32_t>                     deferred_; // Connections to connect, in the order of their first records.
+    std::vector<uint8_t>                     msg_;
+    std::vector<uint8_t>                     frame_;
+};
+#endif
+
+} // namespace
+
+CaptureWriter::~CaptureWriter() {
+    Close();
+}
+
+int CaptureWriter::Open(std::string const& path) {
+    Close();
+    file_ = fopen(path.c_str(), "wb");
+    if (file_ == nullptr)
+        return -1;
+    // Records are written in chunks of the buffer below.
+    setvbuf(file_, nullptr, _IONBF, 0);
+    buffer_.reserve(kWriteBufferBytes + 4096);
+    buffer_.assign(kMagic, kMagic + sizeof(kMagic));
+    return 0;
+}
+
+void CaptureWriter::Close(void) {
+    if (file_ == nullptr)
+        return;
+    Flush();
+    fclose(file_);
+    file_ = nullptr;
+    buffer_.clear();
+}
+
+int CaptureWriter::Write(uint32_t const& connection, int64_t const& timestamp_us, uint8_t const* data,
+                         size_t const& size) {
+    if (file_ == nullptr || size > UINT32_MAX)
+        return -1;
+    PutBigEndian(size, 4, &buffer_);
+    PutBigEndian(static_cast<uint64_t>(timestamp_us), 8, &buffer_);
+    PutBigEndian(connection, 4, &buffer_);
+    buffer_.insert(buffer_.end(), data, data + size);
+    return buffer_.size() >= kWriteBufferBytes ? Flush() : 0;
+}
+
+int CaptureWriter::Flush(void) {
+    if (file_ == nullptr)
+        return -1;
+    bool const failed = !buffer_.empty() && fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size();
+    buffer_.clear();
+    return failed ? -1 : 0;
+}
+
+CaptureReader::~CaptureReader() {
+    Close();
+}
+
+int CaptureReader::Open(std::string const& path) {
+    Close();
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    void*       map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(kMagic))
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    data_   = static_cast<uint8_t const*>(map);
+    size_   = st.st_size;
+    mapped_ = true;
+#else
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return -1;
+    uint8_t buffer[65536];
+    size_t  ret = 0;
+    while ((ret = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        buffer_.insert(buffer_.end(), buffer, buffer + ret);
+    fclose(file);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+    if (size_ < sizeof(kMagic) || memcmp(data_, kMagic, sizeof(kMagic)) != 0) {
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+void CaptureReader::Close(void) {
+#if defined(__linux__)
+    if (mapped_)
+        munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_   = nullptr;
+    size_   = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+int CaptureReader::Next(size_t* offset, CaptureRecord* record) const {
+    size_t const pos = *offset < sizeof(kMagic) ? sizeof(kMagic) : *offset;
+    if (pos > size_ || size_ - pos < kRecordHeader)
+        return -1;
+    uint8_t const* header = data_ + pos;
+    size_t const   size   = GetBigEndian(header, 4);
+    if (size_ - pos - kRecordHeader < size)
+        return -1;
+    record->timestamp_us = static_cast<int64_t>(GetBigEndian(header + 4, 8));
+    record->connection   = GetBigEndian(header + 12, 4);
+    record->data         = header + kRecordHeader;
+    record->size         = size;
+    *offset              = pos + kRecordHeader + size;
+    return 0;
+}
+
+size_t CaptureReader::Seek(size_t const& offset) const {
+    size_t pos = offset < sizeof(kMagic) ? sizeof(kMagic) : offset;
+    while (pos < size_ && size_ - pos > kRecordHeader) {
+        // A frame starts right after the record header.
+        size_t const frame = pos + kRecordHeader;
+        auto const*  flag  = static_cast<uint8_t const*>(memchr(data_ + frame, PROTOCOL_SIGN, size_ - frame));
+        if (flag == nullptr)
+            break;
+        pos            = flag - data_ - kRecordHeader;
+        size_t next    = pos;
+        int    records = 0;
+        while (records < kSeekRecords && IsRecord(data_, size_, next, &next))
+            ++records;
+        if (records == kSeekRecords || (records > 0 && next == size_))
+            return pos;
+        ++pos;
+    }
+    return size_;
+}
+
+int ReplayParse(CaptureReader const& capture, ReplayOptions const& options, ReplayStats* stats) {
+    Parser          parser;
+    SegmentedParser segmented_parser;
+    JT808FrameParserInit(&parser);
+    JT808SegmentedParserInit(&segmented_parser);
+    Pacer const    pacer(capture, options.speed);
+    uint32_t const shards = static_cast<uint32_t>(options.threads);
+    auto const     shard  = [&](uint32_t const& index, ReplayStats* result) {
+        Reassembler                                     reassembler;
+        std::unordered_map<uint32_t, ProtocolParameter> connections;
+        std::vector<uint8_t>                            msg;
+        size_t                                          offset = 0;
+        CaptureRecord                                   record;
+        while (capture.Next(&offset, &record) == 0) {
+            if (record.connection % shards != index)
+                continue;
+            for (int64_t delay; (delay = pacer.Delay(record.timestamp_us)) > 0;)
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            ++result->frames;
+            result->bytes += record.size;
+            msg.assign(record.data, record.data + record.size);
+            auto error = JT808FrameParse(parser, segmented_parser, &reassembler, msg, record.timestamp_us / 1000,
+                                         &connections[record.connection]);
+            if (!error)
+                ++result->messages;
+            else if (error.value() == static_cast<int>(ParserError::PacketPending))
+                ++result->pending;
+            else
+                ++result->errors;
+        }
+        result->connections = static_cast<uint32_t>(connections.size());
+    };
+    return RunShards(options, shard, stats);
+}
+
+int ReplayToServer(CaptureReader const& capture, std::string const& ip, int const& port, ReplayOptions const& options,
+                   ReplayStats* stats) {
+#if defined(__linux__)
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(static_cast<uint16_t>(port));
+    if (port <= 0 || port > UINT16_MAX || inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1)
+        return -1;
+    Parser   parser;
+    Packager packager;
+    JT808FrameParserInit(&parser);
+    JT808FramePackagerInit(&packager);
+    Pacer const    pacer(capture, options.speed);
+    uint32_t const shards = static_cast<uint32_t>(options.threads);
+    auto const     shard  = [&](uint32_t const& index, ReplayStats* result) {
+        ServerReplay(capture, parser, packager, addr, pacer, shards, index, result).Run();
+    };
+    return RunShards(options, shard, stats);
+#else
+    (void)capture;
+    (void)ip;
+    (void)port;
+    (void)options;
+    (void)stats;
+    return -1;
+#endif
+}
+
+} // namespace libjt808
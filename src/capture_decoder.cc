@@ -0,0 +1,356 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  capture_decoder.cc
+// @Version :  1.0
+// @Time    :  2026/11/06 10:17:43
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/capture_decoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "jt808/capture.h"
+#include "jt808/parser.h"
+#include "jt808/reassembly.h"
+
+namespace libjt808 {
+
+namespace {
+
+// A chunk of a capture. Its offsets are moved to record boundaries by the thread decoding it, the neighbouring
+// chunk moves the shared offset to the same record.
+struct Chunk {
+    size_t file    = 0;
+    size_t begin   = 0;
+    size_t end     = 0;
+    bool   aligned = true; // Whether its records end where the next chunk starts.
+    // Offsets of the records of segmented message IDs, with the threads reassembling their messages.
+    std::vector<std::pair<size_t, size_t>> deferred;
+};
+
+// Chunks to decode, a queue per thread. A thread takes its own chunks from the front and, once out of them, steals
+// from the back of the queue of another, the chunks farthest from those read by its owner.
+class ChunkQueues {
+public:
+    explicit ChunkQueues(size_t const& threads) : queues_(threads) {
+    }
+
+    void Push(size_t const& thread, size_t const& chunk) {
+        std::lock_guard<std::mutex> lock(queues_[thread].mutex);
+        queues_[thread].chunks.push_back(chunk);
+    }
+
+    // Returns 0 with the next chunk of a thread, -1 once all queues are empty.
+    int Pop(size_t const& thread, size_t* chunk, bool* stolen) {
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            auto&                       queue = queues_[(thread + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.chunks.empty())
+                continue;
+            if (i == 0) {
+                *chunk = queue.chunks.front();
+                queue.chunks.pop_front();
+            }
+            else {
+                *chunk = queue.chunks.back();
+                queue.chunks.pop_back();
+            }
+            *stolen = i != 0;
+            return 0;
+        }
+        return -1;
+    }
+
+private:
+    struct Queue {
+        std::mutex         mutex;
+        std::deque<size_t> chunks;
+    };
+
+    std::vector<Queue> queues_;
+};
+
+// Appends the rows of the frames decoded by a thread to a chunk.
+class RowWriter {
+public:
+    explicit RowWriter(DecodeStats* stats) : stats_(stats) {
+    }
+
+    // Start the rows of a chunk, out is cleared with its columns keeping their capacity.
+    void Reset(DecodedChunk* out) {
+        auto& messages = out->messages;
+        messages.timestamp_us.clear();
+        messages.connection.clear();
+        messages.msg_id.clear();
+        messages.flow_num.clear();
+        messages.phone.clear();
+        messages.error.clear();
+        messages.phones.clear();
+        auto& locations = out->locations;
+        locations.message.clear();
+        locations.timestamp.clear();
+        locations.latitude.clear();
+        locations.longitude.clear();
+        locations.altitude.clear();
+        locations.speed.clear();
+        locations.bearing.clear();
+        locations.alarm.clear();
+        locations.status.clear();
+        phones_.clear();
+        out_ = out;
+    }
+
+    void Add(CaptureRecord const& record, std::error_code const& error, ProtocolParameter const& para) {
+        auto&          messages = out_->messages;
+        uint32_t const row      = static_cast<uint32_t>(messages.size());
+        auto const     code     = static_cast<ParserError>(error.value());
+        auto const&    msg_head = para.parse.msg_head;
+        // Errors of the frame before its message body.
+        bool const header = code != ParserError::ParametersNull && code != ParserError::UnesapingError &&
+                            code != ParserError::ChecksumError && code != ParserError::HeaderParseError;
+        messages.timestamp_us.push_back(record.timestamp_us);
+        messages.connection.push_back(record.connection);
+        messages.msg_id.push_back(header ? msg_head.msg_id : CapturedMsgId(record));
+        messages.flow_num.push_back(header ? msg_head.msg_flow_num : 0);
+        uint32_t phone = DecodedMessages::kNoPhone;
+        if (header) {
+            auto item = phones_.emplace(msg_head.phone_num, static_cast<uint32_t>(messages.phones.size()));
+            if (item.second)
+                messages.phones.push_back(msg_head.phone_num);
+            phone = item.first->second;
+        }
+        messages.phone.push_back(phone);
+        messages.error.push_back(error.value());
+        if (code == ParserError::PacketPending) {
+            ++stats_->pending;
+            return;
+        }
+        if (error) {
+            ++stats_->errors;
+            return;
+        }
+        ++stats_->messages;
+        if (msg_head.msg_id == kLocationReport || msg_head.msg_id == kGetLocationInformationResponse) {
+            AddLocation(row, para.parse.location_info);
+        }
+        else if (msg_head.msg_id == kBatchLocationReport) {
+            for (auto const& info : para.parse.batch_loc.loc_info)
+                AddLocation(row, info);
+        }
+    }
+
+    // Message ID of a frame whose header could not be parsed, message IDs hold no escaped byte.
+    static uint16_t CapturedMsgId(CaptureRecord const& record) {
+        return record.size > 3 ? static_cast<uint16_t>((record.data[1] << 8) | record.data[2]) : 0;
+    }
+
+private:
+    void AddLocation(uint32_t const& row, LocationBasicInformation const& info) {
+        auto& locations = out_->locations;
+        locations.message.push_back(row);
+        locations.timestamp.push_back(info.timestamp);
+        locations.latitude.push_back(info.latitude);
+        locations.longitude.push_back(info.longitude);
+        locations.altitude.push_back(info.altitude);
+        locations.speed.push_back(info.speed);
+        locations.bearing.push_back(info.bearing);
+        locations.alarm.push_back(info.alarm.value);
+        locations.status.push_back(info.status.value);
+        ++stats_->locations;
+    }
+
+    DecodeStats*                              stats_;
+    DecodedChunk*                             out_ = nullptr;
+    std::unordered_map<std::string, uint32_t> phones_; // Phone number - index in the phones of out_.
+};
+
+// Hash of the phone number of a frame, read from its message header without parsing the frame, to spread the
+// terminals over threads.
+uint32_t CapturedPhoneHash(CaptureRecord const& record) {
+    // Flag, message ID, message body attributes and phone number, reverse escaped.
+    uint8_t head[5 + kBcdPhoneSize];
+    size_t  size = 0;
+    for (size_t i = 0; i + 1 < record.size && size < sizeof(head); ++i) {
+        uint8_t byte = record.data[i];
+        if (byte == PROTOCOL_ESCAPE && i + 2 < record.size)
+            byte = record.data[++i] == PROTOCOL_ESCAPE_SIGN ? PROTOCOL_SIGN : PROTOCOL_ESCAPE;
+        head[size++] = byte;
+    }
+    uint32_t hash = 2166136261u;
+    for (size_t i = 5; i < size; ++i) {
+        hash ^= head[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void AddStats(DecodeStats const& thread, DecodeStats* stats) {
+    stats->frames += thread.frames;
+    stats->messages += thread.messages;
+    stats->pending += thread.pending;
+    stats->errors += thread.errors;
+    stats->locations += thread.locations;
+    stats->steals += thread.steals;
+}
+
+} // namespace
+
+int DecodeCaptures(std::vector<std::string> const& paths, DecodeOptions const& options, DecodeSink const& sink,
+                   DecodeStats* stats) {
+    if (stats == nullptr || !sink || options.threads < 0 || options.chunk_bytes == 0)
+        return -1;
+    *stats           = DecodeStats();
+    auto const start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<CaptureReader>> captures;
+    std::vector<Chunk>                          chunks;
+    for (size_t file = 0; file < paths.size(); ++file) {
+        captures.emplace_back(new CaptureReader());
+        auto& capture = *captures.back();
+        if (capture.Open(paths[file]) < 0)
+            return -1;
+        stats->bytes += capture.size();
+        for (size_t begin = 0; begin == 0 || begin < capture.size(); begin += options.chunk_bytes) {
+            Chunk chunk;
+            chunk.file  = file;
+            chunk.begin = begin;
+            chunk.end   = capture.size() - begin > options.chunk_bytes ? begin + options.chunk_bytes : capture.size();
+            chunks.push_back(chunk);
+        }
+    }
+    stats->chunks = chunks.size();
+    size_t const threads = options.threads > 0 ? static_cast<size_t>(options.threads)
+                                               : std::max<size_t>(1, std::thread::hardware_concurrency());
+    Parser          parser;
+    SegmentedParser segmented_parser;
+    JT808FrameParserInit(&parser);
+    JT808SegmentedParserInit(&segmented_parser);
+
+    // Runs of consecutive chunks to each thread.
+    ChunkQueues queues(threads);
+    for (size_t i = 0; i < chunks.size(); ++i)
+        queues.Push(i * threads / chunks.size(), i);
+    std::vector<DecodeStats> results(threads);
+    auto const               decode = [&](size_t const& thread) {
+        DecodeStats&         result = results[thread];
+        RowWriter            writer(&result);
+        DecodedChunk         out;
+        ProtocolParameter    para {};
+        std::vector<uint8_t> msg;
+        size_t               index  = 0;
+        bool                 stolen = false;
+        while (queues.Pop(thread, &index, &stolen) == 0) {
+            auto&       chunk   = chunks[index];
+            auto const& capture = *captures[chunk.file];
+            result.steals += stolen ? 1 : 0;
+            chunk.begin = chunk.begin == 0 ? 0 : capture.Seek(chunk.begin);
+            chunk.end   = chunk.end == capture.size() ? chunk.end : capture.Seek(chunk.end);
+            writer.Reset(&out);
+            out.file  = chunk.file;
+            out.index = index;
+            out.begin = chunk.begin;
+            out.end   = chunk.end;
+            size_t        offset = chunk.begin;
+            CaptureRecord record;
+            while (offset < chunk.end) {
+                size_t const at = offset;
+                if (capture.Next(&offset, &record) < 0)
+                    break;
+                ++result.frames;
+                if (segmented_parser.count(RowWriter::CapturedMsgId(record)) != 0) {
+                    chunk.deferred.push_back({at, CapturedPhoneHash(record) % threads});
+                    continue;
+                }
+                msg.assign(record.data, record.data + record.size);
+                writer.Add(record, JT808FrameParse(parser, msg, &para), para);
+            }
+            // The last chunk of a capture may end with a record torn by a crash.
+            chunk.aligned = offset == chunk.end || chunk.end == capture.size();
+            if (out.messages.size() > 0)
+                sink(out);
+        }
+    };
+
+    // The frames of segmented message IDs, a share of the terminals to each thread, in capture order.
+    auto const reassemble = [&](size_t const& thread) {
+        DecodeStats&         result = results[thread];
+        RowWriter            writer(&result);
+        DecodedChunk         out;
+        Reassembler          reassembler;
+        ProtocolParameter    para {};
+        std::vector<uint8_t> msg;
+        for (size_t file = 0; file < captures.size(); ++file) {
+            writer.Reset(&out);
+            out.file  = file;
+            out.index = chunks.size() + file * threads + thread;
+            out.begin = 0;
+            out.end   = 0;
+            for (auto const& chunk : chunks) {
+                if (chunk.file != file)
+                    continue;
+                for (auto const& item : chunk.deferred) {
+                    size_t        offset = item.first;
+                    CaptureRecord record;
+                    if (item.second != thread || captures[file]->Next(&offset, &record) < 0)
+                        continue;
+                    msg.assign(record.data, record.data + record.size);
+                    auto error = JT808FrameParse(parser, segmented_parser, &reassembler, msg,
+                                                 record.timestamp_us / 1000, &para);
+                    writer.Add(record, error, para);
+                }
+            }
+            if (out.messages.size() > 0)
+                sink(out);
+        }
+    };
+
+    auto const run = [threads](std::function<void(size_t const&)> const& stage) {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i)
+            workers.emplace_back(stage, i);
+        for (auto& worker : workers)
+            worker.join();
+    };
+    run(decode);
+    run(reassemble);
+    int ret = 0;
+    for (auto const& chunk : chunks) {
+        if (!chunk.aligned)
+            ret = -1;
+    }
+    for (auto const& result : results)
+        AddStats(result, stats);
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ret;
+}
+
+} // namespace libjt808
@@ -29,18 +29,21 @@
 
 #include "jt808/client.h"
 
+#include <errno.h>
 #include <string.h>
 #include <math.h>
 #if defined(__linux__)
 #include <arpa/inet.h>
 #include <netinet/in.h>
-#include <fcntl.h>
 #endif
 
 #include <chrono>
 #include <fstream>
+#include <future>
 
+#include "jt808/logger.h"
 #include "jt808/socket_util.h"
+#include "jt808/util.h"
 
 namespace libjt808 {
 
@@ -57,18 +60,51 @@ RegisterInfo const kRegisterInfo = {
     "\xD4\xC1\x42\x31\x32\x33\x34\x35", // "粤B12345".
 };
 
+// 单调时钟的毫秒数, 用于分包重组的超时.
+int64_t SteadyClockMs(void) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 按设置属性更新区域集: 更新时先清空已有区域, 追加与修改时按区域ID覆盖.
+template <typename Area>
+void UpdateAreas(uint8_t const& setting_type, std::vector<Area> const& areas, std::map<uint32_t, Area>* area_set) {
+    if (setting_type == kAreaUpdate)
+        area_set->clear();
+    for (auto const& area : areas)
+        (*area_set)[area.area_id] = area;
+}
+
+// 删除指定ID的区域或路线, ID集为空时删除全部.
+template <typename Area>
+void DeleteAreas(std::vector<uint32_t> const& ids, std::map<uint32_t, Area>* area_set) {
+    if (ids.empty())
+        area_set->clear();
+    for (auto const& id : ids)
+        area_set->erase(id);
+}
+
 } // namespace
 
-JT808Client::JT808Client() {
+JT808Client::JT808Client()
+    : manual_deal_(false), client_(-1), is_connected_(false), is_authenticated_(false), port_(0),
+      location_report_inteval_(10), location_report_immediately_flag_(0), location_report_msg_generate_outside_(false),
+      service_is_running_(false), tcp_connection_handling_(false), jt808_connection_handling_(false),
+      heartbeat_timer_(0), report_timer_(0), heartbeat_inteval_(60000), first_report_(true), send_pending_(false),
+      sending_offset_(0), wait_writable_(false) {
 }
 
 JT808Client::~JT808Client() {
+    // 服务线程未分离, 析构前必须等待其退出.
+    if (service_thread_.joinable())
+        Stop();
 }
 
 // 对一些必要的参数设定一个默认值, 防止协议命令生成不完整.
 void JT808Client::Init(void) {
     // 初始化命令解析器和命令封装器.
     JT808FrameParserInit(&parser_);
+    JT808SegmentedParserInit(&segmented_parser_);
     JT808FramePackagerInit(&packager_);
     // 预设终端手机号.
     parameter_.msg_head.phone_num           = std::move("13395279527");
@@ -85,6 +121,9 @@ void JT808Client::Init(void) {
     polygon_area_callback_ = [](void) -> void {
         return;
     };
+    area_route_callback_ = [](uint16_t const& msg_id) -> void {
+        return;
+    };
     // 位置上报相关.
     location_report_inteval_              = 10; // 10s位置上报时间间隔.
     location_report_immediately_flag_     = 0;  // 立即上报标志清零.
@@ -98,6 +137,11 @@ void JT808Client::Init(void) {
     location_report_msg_generate_outside_.store(false);
     tcp_connection_handling_.store(false);
     jt808_connection_handling_.store(false);
+    manual_deal_.store(false);
+    // 初始化服务线程使用的事件循环.
+    if (!loop_.is_running() && (loop_.Init() < 0)) {
+        JT808_LOG_ERROR("%s[%d]: Event loop init failed !!!", __FUNCTION__, __LINE__);
+    }
 }
 
 // 与远程服务器建立TCP连接, 并设置socket为非阻塞模式.
@@ -117,7 +161,7 @@ int JT808Client::ConnectRemote(void) {
     addr.sin_addr.s_addr = inet_addr(ip_.c_str());
     auto tcp_socket      = socket(AF_INET, SOCK_STREAM, 0);
     if (tcp_socket == -1) {
-        printf("%s[%d]: Create socket failed!!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Create socket failed!!!", __FUNCTION__, __LINE__);
         tcp_connection_handling_.store(false);
         return -1;
     }
@@ -132,7 +176,7 @@ int JT808Client::ConnectRemote(void) {
     }
     auto tcp_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (tcp_socket == INVALID_SOCKET) {
-        printf("%s[%d]: Create socket failed!!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Create socket failed!!!", __FUNCTION__, __LINE__);
         WSACleanup();
         tcp_connection_handling_.store(false);
         return -1;
@@ -140,7 +184,7 @@ int JT808Client::ConnectRemote(void) {
     addr.sin_addr.S_un.S_addr = inet_addr(ip_.c_str());
 #endif
     if (Connect(tcp_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
-        printf("[%s:%d] Connect to remote server failed!!!\n", ip_.c_str(), port_);
+        JT808_LOG_ERROR("[%s:%d] Connect to remote server failed!!!", ip_.c_str(), port_);
         Close(tcp_socket);
 #if defined(_WIN32)
         WSACleanup();
@@ -150,13 +194,8 @@ int JT808Client::ConnectRemote(void) {
         return -1;
     }
     // 设置非阻塞模式.
-#if defined(__linux__)
-    int flags = fcntl(tcp_socket, F_GETFL, 0);
-    fcntl(tcp_socket, F_SETFL, flags | O_NONBLOCK);
-#elif defined(_WIN32)
-    unsigned long ul = 1;
-    if (ioctlsocket(tcp_socket, FIONBIO, (unsigned long*)&ul) == SOCKET_ERROR) {
-        printf("[%s:%d] Set socket nonblock failed!!!\n", ip_.c_str(), port_);
+    if (SetNonBlocking(tcp_socket) < 0) {
+        JT808_LOG_ERROR("[%s:%d] Set socket nonblock failed!!!", ip_.c_str(), port_);
         Close(tcp_socket);
 #if defined(_WIN32)
         WSACleanup();
@@ -165,11 +204,12 @@ int JT808Client::ConnectRemote(void) {
         tcp_connection_handling_.store(false);
         return -1;
     }
-#endif
     client_ = tcp_socket;
+    recv_buffer_.clear();
+    reassembler_.Clear();
     is_connected_.store(true);
     tcp_connection_handling_.store(false);
-    printf("[%s:%d] TCP connected.\n", ip_.c_str(), port_);
+    JT808_LOG_INFO("[%s:%d] TCP connected.", ip_.c_str(), port_);
     return 0;
 }
 
@@ -183,24 +223,7 @@ int JT808Client::JT808ConnectionAuthentication(void) {
     if (is_authenticated_.load())
         return 0;
     jt808_connection_handling_.store(true);
-    //
-    // 注册.
-    //
-    // 生成并发送注册消息.
-    if (PackagingAndSendMessage(kTerminalRegister) < 0) {
-        Close(client_);
-#if defined(_WIN32)
-        WSACleanup();
-#endif
-        client_       = -1;
-        is_connected_ = false;
-        jt808_connection_handling_.store(false);
-        return -1;
-    }
-    // 从注册应答消息中解析出注册结果和鉴权码.
-    parameter_.parse.respone_result = kTerminalHaveBeenRegistered;
-    parameter_.parse.authentication_code.clear();
-    if (ReceiveAndParseMessage(5) < 0) {
+    auto failed = [this](void) -> int {
         Close(client_);
 #if defined(_WIN32)
         WSACleanup();
@@ -209,59 +232,61 @@ int JT808Client::JT808ConnectionAuthentication(void) {
         is_connected_.store(false);
         jt808_connection_handling_.store(false);
         return -1;
-    }
-    // 检查注册结果.
-    if ((parameter_.parse.msg_head.msg_id != kTerminalRegisterResponse) ||
-        (parameter_.parse.respone_result != kRegisterSuccess)) {
-        Close(client_);
-#if defined(_WIN32)
-        WSACleanup();
-#endif
-        client_ = -1;
-        is_connected_.store(false);
-        jt808_connection_handling_.store(false);
-        return -1;
-    }
+    };
     //
-    // 鉴权.
+    // 已有鉴权码时直接鉴权, 平台不认可时在同一连接上重新注册.
+    // 鉴权码在鉴权成功前清除, 连接失败后的下次连接进行注册.
     //
-    // 生成并发送鉴权消息.
-    if (PackagingAndSendMessage(kTerminalAuthentication) < 0) {
-        Close(client_);
-#if defined(_WIN32)
-        WSACleanup();
-#endif
-        client_ = -1;
-        is_connected_.store(false);
-        jt808_connection_handling_.store(false);
-        return -1;
-    }
-    // 从通用应答中解析出鉴权结果.
-    parameter_.parse.respone_result = kFailure;
-    if (ReceiveAndParseMessage(5) < 0) {
-        Close(client_);
-#if defined(_WIN32)
-        WSACleanup();
-#endif
-        client_ = -1;
-        is_connected_.store(false);
-        jt808_connection_handling_.store(false);
-        return -1;
-    }
-    // 检查鉴权结果.
-    if ((parameter_.parse.respone_msg_id != kTerminalAuthentication) || (parameter_.parse.respone_result != kSuccess)) {
-        Close(client_);
-#if defined(_WIN32)
-        WSACleanup();
-#endif
-        client_ = -1;
-        is_connected_.store(false);
-        jt808_connection_handling_.store(false);
-        return -1;
+    bool authenticated = false;
+    if (!parameter_.authentication_code.empty()) {
+        parameter_.parse.authentication_code = std::move(parameter_.authentication_code);
+        parameter_.authentication_code.clear();
+        if (PackagingAndSendMessage(kTerminalAuthentication) < 0)
+            return failed();
+        parameter_.parse.respone_result = kFailure;
+        if (ReceiveAndParseMessage(5) < 0)
+            return failed();
+        authenticated = (parameter_.parse.msg_head.msg_id == kPlatformGeneralResponse) &&
+                        (parameter_.parse.respone_msg_id == kTerminalAuthentication) &&
+                        (parameter_.parse.respone_result == kSuccess);
+    }
+    if (!authenticated) {
+        //
+        // 注册.
+        //
+        // 生成并发送注册消息.
+        if (PackagingAndSendMessage(kTerminalRegister) < 0)
+            return failed();
+        // 从注册应答消息中解析出注册结果和鉴权码.
+        parameter_.parse.respone_result = kTerminalHaveBeenRegistered;
+        parameter_.parse.authentication_code.clear();
+        if (ReceiveAndParseMessage(5) < 0)
+            return failed();
+        // 检查注册结果.
+        if ((parameter_.parse.msg_head.msg_id != kTerminalRegisterResponse) ||
+            (parameter_.parse.respone_result != kRegisterSuccess)) {
+            return failed();
+        }
+        //
+        // 鉴权.
+        //
+        // 生成并发送鉴权消息.
+        if (PackagingAndSendMessage(kTerminalAuthentication) < 0)
+            return failed();
+        // 从通用应答中解析出鉴权结果.
+        parameter_.parse.respone_result = kFailure;
+        if (ReceiveAndParseMessage(5) < 0)
+            return failed();
+        // 检查鉴权结果.
+        if ((parameter_.parse.respone_msg_id != kTerminalAuthentication) ||
+            (parameter_.parse.respone_result != kSuccess)) {
+            return failed();
+        }
     }
+    parameter_.authentication_code = parameter_.parse.authentication_code;
     is_authenticated_.store(true);
     jt808_connection_handling_.store(false);
-    printf("[%s:%d]: JT808 connected.\n", ip_.c_str(), port_);
+    JT808_LOG_INFO("[%s:%d]: JT808 connected.", ip_.c_str(), port_);
     return 0;
 }
 
@@ -269,13 +294,25 @@ int JT808Client::JT808ConnectionAuthentication(void) {
 void JT808Client::Run(void) {
     if (!is_connected_ || !is_authenticated_)
         return;
+    if (service_is_running_.load())
+        return;
+    // 回收上一次因连接断开而自行退出的服务线程.
+    if (service_thread_.joinable())
+        service_thread_.join();
+    service_is_running_.store(true);
     service_thread_ = std::thread(&JT808Client::ThreadHandler, this);
-    service_thread_.detach();
 }
 
 // 停止服务线程并清除TCP连接.
 void JT808Client::Stop(void) {
-    service_is_running_.store(false);
+    // 只由清除运行标志的一方通知事件循环退出, 避免遗留的退出请求影响下一次运行.
+    if (service_is_running_.exchange(false))
+        loop_.Quit();
+    // 在服务线程的回调中调用时, 连接由服务线程退出事件循环后清除.
+    if (loop_.IsInLoopThread())
+        return;
+    if (service_thread_.joinable() && (service_thread_.get_id() != std::this_thread::get_id()))
+        service_thread_.join();
     if (tcp_connection_handling_.load())
         return;
     if (jt808_connection_handling_.load())
@@ -293,24 +330,16 @@ void JT808Client::Stop(void) {
 
 void JT808Client::WattingStop(int const& timeout_msec) {
     if (client_ > 0) {
-        auto begin_tp = std::chrono::steady_clock::now();
-        auto end_tp   = begin_tp;
-        while (std::chrono::duration_cast<std::chrono::milliseconds>(end_tp - begin_tp).count() < timeout_msec) {
-            if (general_msg_.empty() && location_report_msg_.empty())
-                break;
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            end_tp = std::chrono::steady_clock::now();
-        }
+        // 等待服务线程发送完队列中的消息.
+        std::unique_lock<std::mutex> lock(msg_queue_mutex_);
+        msg_queue_cv_.wait_for(lock, std::chrono::milliseconds(timeout_msec), [this] {
+            return !service_is_running_.load() ||
+                   (general_msg_.empty() && location_report_msg_.empty() && !send_pending_);
+        });
         general_msg_.clear();
         location_report_msg_.clear();
-        service_is_running_.store(false);
-        Close(client_);
-        client_ = 0;
-#if defined(_WIN32)
-        WSACleanup();
-#endif
-        is_authenticated_.store(false);
-        is_connected_.store(false);
+        lock.unlock();
+        Stop();
     }
 }
 
@@ -318,20 +347,17 @@ void JT808Client::GenerateLocationReportMsgNow(void) {
     // printf("timestamp: %s\n", parameter_.location_info.time.c_str());
     std::vector<uint8_t> msg;
     if (PackagingMessage(kLocationReport, &msg) < 0) {
-        printf("%s[%d]: Package message failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Package message failed !!!", __FUNCTION__, __LINE__);
         return;
     }
-    if (location_report_msg_.size() > 10000) {
-        location_report_msg_.pop_front();
-    }
-    location_report_msg_.push_back(std::move(msg));
+    EnqueueMessage(std::move(msg), true);
 }
 
 int JT808Client::MultimediaUpload(char const* path, std::vector<uint8_t> const& location_basic) {
     std::ifstream ifs;
     ifs.open(path, std::ios::in | std::ios::binary);
     if (!ifs.is_open()) {
-        printf("%s[%d]: Updrade file open failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Updrade file open failed !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     ifs.seekg(0, std::ios::end);
@@ -352,117 +378,144 @@ int JT808Client::MultimediaUpload(char const* path, std::vector<uint8_t> const&
     else {
         media.loaction_report_body.assign(location_basic.begin(), location_basic.end());
     }
-    manual_deal_.store(true);
-    uint16_t max_content = 1023 - 36;
-    if (length > max_content) {                          // 需要分包处理.
-        parameter_.msg_head.msgbody_attr.bit.packet = 1; // 进行分包.
-        parameter_.msg_head.total_packet            = static_cast<uint16_t>(ceil(length * 1.0 / max_content));
-        parameter_.msg_head.packet_seq              = 1;
-        size_t len                                  = 0;
-        for (size_t i = 0; i < length; i += max_content) {
-            len = length - i;
-            if (len > max_content)
-                len = max_content;
-            media.media_data.assign(buffer.get() + i, buffer.get() + i + len);
-            if (PackagingAndSendMessage(kMultimediaDataUpload) < 0) {
-                manual_deal_.store(false);
-                return -1;
-            }
-            if (ReceiveAndParseMessage(3) < 0) {
-                manual_deal_.store(false);
-                return -1;
-            }
-            if (parameter_.parse.msg_head.msg_id != kPlatformGeneralResponse ||
-                parameter_.parse.respone_msg_id != kMultimediaDataUpload ||
-                parameter_.parse.respone_result != kSuccess) {
-                manual_deal_.store(false);
-                return -1;
-            }
-            ++parameter_.msg_head.packet_seq;
-        }
-        parameter_.msg_head.msgbody_attr.bit.packet = 0;
-        parameter_.msg_head.total_packet            = 1;
-    }
-    else {
-        media.media_data.assign(buffer.get(), buffer.get() + length);
-        if (PackagingAndSendMessage(kMultimediaDataUpload) < 0) {
-            manual_deal_.store(false);
-            return -1;
-        }
-        if (ReceiveAndParseMessage(3) < 0) {
-            manual_deal_.store(false);
-            return -1;
-        }
-        if (parameter_.parse.respone_msg_id != kMultimediaDataUpload || parameter_.parse.respone_result != kSuccess) {
-            manual_deal_.store(false);
+    // 完整的消息体按最大长度分包, 各子包封装在同一缓冲区中一次发出, 并保留用于重传.
+    media.media_data.assign(buffer.get(), buffer.get() + length);
+    buffer.reset();
+    SegmentedFrames frames;
+    {
+        std::lock_guard<std::mutex> lock(msg_generate_mutex_);
+        parameter_.msg_head.msg_id = kMultimediaDataUpload;
+        int count                  = JT808SegmentedPackage(packager_, parameter_, kMaxMsgBodyLength, &frames);
+        media.media_data.clear();
+        if (count < 0) {
+            JT808_LOG_ERROR("%s[%d]: Package message failed !!!", __FUNCTION__, __LINE__);
             return -1;
         }
+        parameter_.msg_head.msg_flow_num += count; // 每个子包占用一个消息流水号.
     }
-    if (ReceiveAndParseMessage(5) == 0) {
-        if (parameter_.parse.msg_head.msg_id == kMultimediaDataUploadResponse) {
-            if (parameter_.parse.msg_head.msgbody_attr.bit.msglen == 4) {
-                printf("Completed.\n");
+    PauseServiceIo(true);
+    if (!is_connected_ ||
+        SendAll(client_, reinterpret_cast<char const*>(frames.data.data()), frames.data.size(), 5000) < 0) {
+        JT808_LOG_ERROR("%s[%d]: Send message failed !!!", __FUNCTION__, __LINE__);
+        PauseServiceIo(false);
+        return -1;
+    }
+    // 等待各子包的平台通用应答及多媒体数据上传应答, 按应答中的重传包ID列表或补传分包请求重传子包.
+    std::vector<bool>    acked(frames.count(), false);
+    size_t               acked_count     = 0;
+    int                  retransmissions = 0;
+    int                  ret             = -1;
+    std::vector<uint8_t> resend;
+    while (ReceiveAndParseMessage(5) == 0) {
+        auto const& parse = parameter_.parse;
+        resend.clear();
+        if (parse.msg_head.msg_id == kPlatformGeneralResponse) {
+            if (parse.respone_msg_id != kMultimediaDataUpload)
+                continue;
+            if (parse.respone_result != kSuccess)
+                break;
+            uint16_t index = parse.respone_flow_num - frames.first_flow_num;
+            if (index < acked.size() && !acked[index]) {
+                acked[index] = true;
+                ++acked_count;
             }
-            else {
-                // TODO(mengyuming@hotmail.com): 需要重传.
+            continue;
+        }
+        else if (parse.msg_head.msg_id == kMultimediaDataUploadResponse) {
+            auto const& reload_ids = parse.multimedia_upload_response.reload_packet_ids;
+            if (reload_ids.empty()) {
+                JT808_LOG_INFO("Completed.");
+                ret = 0;
+                break;
             }
+            if (frames.Retransmit(reload_ids, &resend) < 0)
+                break;
+        }
+        else if (parse.msg_head.msg_id == kFillPacketRequest &&
+                 parse.fill_packet.first_packet_msg_flow_num == frames.first_flow_num) {
+            if (frames.Retransmit(parse.fill_packet.packet_id, &resend) < 0)
+                break;
+        }
+        else {
+            continue;
+        }
+        if (++retransmissions > 3 ||
+            SendAll(client_, reinterpret_cast<char const*>(resend.data()), resend.size(), 5000) < 0) {
+            break;
         }
     }
-    printf("Done.\n");
-    manual_deal_.store(false);
-    return 0;
+    // 平台未应答多媒体数据上传时, 以各子包均已应答为准.
+    if (ret < 0 && acked_count == acked.size())
+        ret = 0;
+    JT808_LOG_INFO("Done.");
+    PauseServiceIo(false);
+    return ret;
 }
 
 // 根据提供的消息ID以及调用前此函数前对参数的设定, 生成对应的JT808格式消息,
 // 并通过socket发送到服务端.
 int JT808Client::PackagingAndSendMessage(uint32_t const& msg_id) {
     if (!is_connected_) {
-        printf("%s[%d]: Invalid connection !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Invalid connection !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     std::vector<uint8_t> msg;
     if (PackagingMessage(msg_id, &msg) < 0) {
-        printf("%s[%d]: Package message failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Package message failed !!!", __FUNCTION__, __LINE__);
         return -1;
     }
+    // 服务线程运行时交由其发送, 避免与其尚未写完的消息交错.
+    if (service_is_running_.load() && !manual_deal_.load()) {
+        EnqueueMessage(std::move(msg), false);
+        return 0;
+    }
     if (Send(client_, reinterpret_cast<char*>(msg.data()), msg.size(), 0) <= 0) {
-        printf("%s[%d]: Send message failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Send message failed !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     return 0;
 }
 
-// 阻塞地从socket连接中接收一次数据, 然后按照JT808协议进行解析.
+// 阻塞地从socket连接中接收一帧完整数据, 然后按照JT808协议进行解析.
+// 多余的数据保留在接收缓冲中, 由下一次接收或服务线程继续处理.
 int JT808Client::ReceiveAndParseMessage(int const& timeout) {
     if (!is_connected_) {
-        printf("%s[%d]: Invalid connection !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Invalid connection !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     std::vector<uint8_t>    msg;
-    int                     ret        = -1;
-    int                     timeout_ms = timeout * 1000; // 超时时间, ms.
-    auto                    tp         = std::chrono::steady_clock::now();
+    int                     ret      = -1;
+    size_t                  begin    = 0;
+    size_t                  end      = 0;
+    auto                    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
     std::unique_ptr<char[]> buffer(new char[4096], std::default_delete<char[]>());
     while (1) {
-        if ((ret = Recv(client_, buffer.get(), 4096, 0)) > 0) {
-            // TODO(mengyuming@hotmail.com): 需要处理TCP粘包.
-            msg.assign(buffer.get(), buffer.get() + ret);
+        // 处理TCP粘包和半包.
+        if (FindFrame(recv_buffer_.data(), recv_buffer_.size(), &begin, &end) == 0) {
+            msg.assign(recv_buffer_.begin() + begin, recv_buffer_.begin() + end);
+            recv_buffer_.erase(recv_buffer_.begin(), recv_buffer_.begin() + end);
             break;
         }
+        recv_buffer_.erase(recv_buffer_.begin(), recv_buffer_.begin() + begin); // 丢弃帧外的无效数据.
+        // 检测超时退出.
+        auto remain =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remain <= 0)
+            break;
+        if (WaitReadable(client_, static_cast<int>(remain)) <= 0)
+            continue;
+        if ((ret = Recv(client_, buffer.get(), 4096, 0)) > 0) {
+            recv_buffer_.insert(recv_buffer_.end(), buffer.get(), buffer.get() + ret);
+        }
         else if (ret == 0) {
-            printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
+            JT808_LOG_INFO("%s[%d]: Disconnect !!!", __FUNCTION__, __LINE__);
             is_connected_.store(false);
             return -1;
         }
-        else {
-            // TODO(mengyuming@hotmail.com): 其它连接错误需处理.
-        }
-        // 检测超时退出.
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tp).count() >=
-            timeout_ms) {
-            break;
+        else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            JT808_LOG_ERROR("%s[%d]: Remote socket error !!!", __FUNCTION__, __LINE__);
+            return -1;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     if (msg.empty())
         return -1;
@@ -471,7 +524,7 @@ int JT808Client::ReceiveAndParseMessage(int const& timeout) {
     // printf("\n");
     // 解析消息.
     if (JT808FrameParse(parser_, msg, &parameter_)) {
-        printf("%s[%d]: Parse message failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Parse message failed !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     return 0;
@@ -483,7 +536,7 @@ int JT808Client::PackagingMessage(uint32_t const& msg_id, std::vector<uint8_t>*
     std::unique_lock<std::mutex> lock(msg_generate_mutex_);
     parameter_.msg_head.msg_id = msg_id; // 设置消息ID.
     if (JT808FramePackage(packager_, parameter_, *out) < 0) {
-        printf("%s[%d]: Package message failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Package message failed !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     ++parameter_.msg_head.msg_flow_num; // 每正确生成一条命令, 消息流水号增加1.
@@ -496,286 +549,355 @@ int JT808Client::PackagingGeneralMessage(uint32_t const& msg_id) {
     if (PackagingMessage(msg_id, &msg) != 0) {
         return -1;
     }
-    if (general_msg_.size() > 100) {
-        general_msg_.pop_front();
-    }
-    general_msg_.push_back(std::move(msg));
+    EnqueueMessage(std::move(msg), false);
     return 0;
 }
 
+void JT808Client::EnqueueMessage(std::vector<uint8_t>&& msg, bool const& location_report) {
+    {
+        std::lock_guard<std::mutex> lock(msg_queue_mutex_);
+        if (location_report) {
+            if (location_report_msg_.size() > 10000) {
+                location_report_msg_.pop_front();
+            }
+            location_report_msg_.push_back(std::move(msg));
+        }
+        else {
+            if (general_msg_.size() > 100) {
+                general_msg_.pop_front();
+            }
+            general_msg_.push_back(std::move(msg));
+        }
+    }
+    // 服务线程内生成的消息在当前事件处理结束时统一发送, 其它线程需唤醒服务线程.
+    if (service_is_running_.load() && !loop_.IsInLoopThread()) {
+        loop_.QueueInLoop([this] {
+            FlushMessages();
+        });
+    }
+}
+
+void JT808Client::RequestImmediateReport(uint16_t const& flag) {
+    location_report_immediately_flag_ |= flag;
+    if (!service_is_running_.load() || location_report_msg_generate_outside_.load())
+        return;
+    loop_.RunInLoop([this] {
+        // 已随定时上报一起发出.
+        if (location_report_immediately_flag_.load() == 0)
+            return;
+        OnReportTimer();
+        // 立即上报后重新开始上报计时.
+        if ((location_report_immediately_flag_.load() == 0) && (report_timer_ != 0)) {
+            uint32_t report_intv = location_report_inteval_ * 1000;
+            loop_.ResetTimer(report_timer_, report_intv, report_intv);
+        }
+    });
+}
+
+void JT808Client::PauseServiceIo(bool const& pause) {
+    manual_deal_.store(pause);
+    if (!service_is_running_.load() || loop_.IsInLoopThread())
+        return;
+    // 等待服务线程停止/恢复处理socket, 避免与手动收发的数据交错.
+    auto done   = std::make_shared<std::promise<void>>();
+    auto future = done->get_future();
+    loop_.QueueInLoop([this, pause, done] {
+        if (client_ > 0) {
+            wait_writable_ = false;
+            loop_.ModifyHandle(client_, pause ? 0 : EventLoop::kReadable);
+            if (!pause)
+                FlushMessages();
+        }
+        done->set_value();
+    });
+    future.wait_for(std::chrono::seconds(1));
+}
+
 // 服务端通信线程, 解析接收到的命令, 同时自动进行位置信息上报和心跳包的发送.
+// 线程只在socket可读写, 定时器到期或其它线程提交消息时被唤醒.
 void JT808Client::ThreadHandler(void) {
-    service_is_running_.store(true);
-    std::atomic_bool send_running;
-    std::atomic_bool recv_running;
-    send_running.store(false);
-    recv_running.store(false);
     std::string server_ip   = ip_;
     int         server_port = port_;
-    while (service_is_running_) {
-        if (!send_running.load()) {
-            std::thread(&JT808Client::SendHandler, this, &send_running).detach();
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-        if (!recv_running.load()) {
-            std::thread(&JT808Client::ReceiveHandler, this, &recv_running).detach();
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto const  socket      = client_;
+    uint32_t    temp;
+    // 从终端参数中获取心跳包时间间隔, 若未找到或值为0则使用默认60秒(s)心跳.
+    if ((GetTerminalHeartbeatInterval(&temp) == 0) && (temp > 0)) {
+        heartbeat_inteval_ = temp * 1000;
+    }
+    else {
+        heartbeat_inteval_ = 60000; // 60s.
+    }
+    uint32_t report_intv = location_report_inteval_ * 1000; // 时间间隔, ms.
+    first_report_        = true;
+    last_send_tp_        = std::chrono::steady_clock::now();
+    sending_msg_.clear();
+    sending_offset_ = 0;
+    wait_writable_  = false;
+    if (loop_.AddHandle(socket, manual_deal_.load() ? 0 : EventLoop::kReadable, [this](int const& events) {
+            OnSocketEvent(events);
+        }) < 0) {
+        JT808_LOG_ERROR("[%s:%d] Register socket failed !!!", server_ip.c_str(), server_port);
+    }
+    else {
+        heartbeat_timer_ = loop_.AddTimer(heartbeat_inteval_, 0, [this] {
+            OnHeartbeatTimer();
+        });
+        // 上报时间间隔为0时不进行定时上报.
+        if (report_intv > 0) {
+            report_timer_ = loop_.AddTimer(report_intv, report_intv, [this] {
+                OnReportTimer();
+            });
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        FlushMessages(); // 发送启动前已生成的消息.
+        loop_.Run();
+        loop_.CancelTimer(heartbeat_timer_);
+        loop_.CancelTimer(report_timer_);
+        heartbeat_timer_ = 0;
+        report_timer_    = 0;
+        loop_.RemoveHandle(socket);
     }
     // 线程终止.
-    send_running.store(false);
-    recv_running.store(false);
     service_is_running_.store(false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    {
+        std::lock_guard<std::mutex> lock(msg_queue_mutex_);
+        send_pending_ = false;
+        msg_queue_cv_.notify_all();
+    }
     Stop();
-    printf("[%s:%d] Main service done.\r\n", server_ip.c_str(), server_port);
+    JT808_LOG_INFO("[%s:%d] Main service done.", server_ip.c_str(), server_port);
 }
 
-void JT808Client::SendHandler(std::atomic_bool* const running) {
-    running->store(true);
-    int64_t                 report_intv = location_report_inteval_ * 1000; // 时间间隔, ms.
-    std::unique_ptr<char[]> buffer(new char[4096], std::default_delete<char[]>());
-    auto                    report_begin_tp    = std::chrono::steady_clock::now();
-    auto                    heartbeat_begin_tp = std::chrono::steady_clock::now();
-    auto                    end_tp             = std::chrono::steady_clock::now();
-    auto report_time_lag = std::chrono::duration_cast<std::chrono::milliseconds>(end_tp - report_begin_tp).count();
-    auto heartbeat_time_lag =
-        std::chrono::duration_cast<std::chrono::milliseconds>(end_tp - heartbeat_begin_tp).count();
-    int64_t  heartbeat_intv;
-    uint32_t temp;
-    // 从终端参数中获取心跳包时间间隔, 若未找到或值为0则使用默认60秒(s)心跳.
-    if ((GetTerminalHeartbeatInterval(&temp) == 0) && (temp > 0)) {
-        heartbeat_intv = temp * 1000;
+void JT808Client::OnSocketEvent(int const& events) {
+    if (manual_deal_.load())
+        return;
+    if ((events & EventLoop::kWritable) && (FlushMessages() < 0))
+        return;
+    if (!(events & EventLoop::kReadable))
+        return;
+    int  ret = -1;
+    char buffer[4096];
+    while (1) {
+        if ((ret = Recv(client_, buffer, sizeof(buffer), 0)) > 0) {
+            recv_buffer_.insert(recv_buffer_.end(), buffer, buffer + ret);
+            if (ret < static_cast<int>(sizeof(buffer)))
+                break;
+        }
+        else if (ret == 0) {
+            JT808_LOG_INFO("[%s:%d] Disconnect !!!", ip_.c_str(), port_);
+            Stop();
+            return;
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            break;
+        }
+        else {
+            JT808_LOG_ERROR("[%s:%d] Remote socket error!!!", ip_.c_str(), port_);
+            Stop();
+            return;
+        }
     }
-    else {
-        heartbeat_intv = 60000; // 60s.
+    // 处理TCP粘包和半包, 逐帧解析.
+    std::vector<uint8_t> msg;
+    size_t               offset = 0;
+    size_t               begin  = 0;
+    size_t               end    = 0;
+    size_t               frames = 0;
+    while (FindFrame(recv_buffer_.data() + offset, recv_buffer_.size() - offset, &begin, &end) == 0) {
+        msg.assign(recv_buffer_.begin() + offset + begin, recv_buffer_.begin() + offset + end);
+        offset += end;
+        // printf("JT808 Recv[%d]: ", static_cast<int>(msg.size()));
+        // for (auto const& uch : msg) printf("%02X ", uch);
+        // printf("\n");
+        auto error = JT808FrameParse(parser_, segmented_parser_, &reassembler_, msg, SteadyClockMs(), &parameter_);
+        if (error.value() == static_cast<int>(ParserError::PacketPending)) {
+            // 分包消息逐包应答, 收齐后再处理.
+            parameter_.respone_result = kSuccess;
+            PackagingGeneralMessage(kTerminalGeneralResponse);
+        }
+        else if (!error) {
+            HandleMessage();
+        }
+        // 连续收到大量帧(如分包下发)时中途发送应答, 避免超出消息队列上限被丢弃.
+        if ((++frames % 64 == 0) && (FlushMessages() < 0))
+            return;
     }
-    bool first_report = true;
-    manual_deal_.store(false);
-    std::string server_ip   = ip_;
-    int         server_port = port_;
-    while (running->load()) {
-        // if (manual_deal_.load()) {
-        //   std::this_thread::sleep_for(std::chrono::milliseconds(20));
-        //   continue;
-        // }
-        end_tp = std::chrono::steady_clock::now();
-        // 优先发送应答消息.
-        if (!general_msg_.empty()) {
-            if (!manual_deal_.load()) {
-                for (auto& msg : general_msg_) {
-                    // printf("JT808 Send[%d]: ", static_cast<int>(msg.size()));
-                    // for (auto const& uch : msg) printf("%02X ", uch);
-                    // printf("\n");
-                    if (Send(client_, reinterpret_cast<char*>(msg.data()), msg.size(), 0) <= 0) {
-                        printf("%s[%d]: Send message failed !!!\n", __FUNCTION__, __LINE__);
-                        service_is_running_.store(false);
-                        return;
-                    }
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                general_msg_.clear();
+    recv_buffer_.erase(recv_buffer_.begin(), recv_buffer_.begin() + offset + begin);
+    // 终端不请求补传分包, 只丢弃超时未收齐的消息.
+    std::vector<FillRequest> fill_requests;
+    reassembler_.Poll(SteadyClockMs(), &fill_requests);
+    // 数据中始终没有结束标识位, 丢弃.
+    if (recv_buffer_.size() > 65536) {
+        recv_buffer_.clear();
+    }
+    // 发送处理过程中生成的应答消息.
+    FlushMessages();
+}
+
+void JT808Client::OnHeartbeatTimer(void) {
+    auto now     = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_send_tp_).count();
+    if (elapsed >= heartbeat_inteval_) {
+        PackagingGeneralMessage(kTerminalHeartBeat);
+        FlushMessages();
+        elapsed = 0;
+    }
+    // 心跳间隔内有其它消息发送时, 心跳顺延.
+    heartbeat_timer_ = loop_.AddTimer(static_cast<uint32_t>(heartbeat_inteval_ - elapsed), 0, [this] {
+        OnHeartbeatTimer();
+    });
+}
+
+void JT808Client::OnReportTimer(void) {
+    // 外部生成上报消息, 交由内部进行上报.
+    if (location_report_msg_generate_outside_.load())
+        return;
+    // 首次上报需要等到成功定位后再进行, 再此期间由心跳包维持连接.
+    if (first_report_ && (parameter_.location_info.status.bit.positioning == 0))
+        return;
+    first_report_ = false;
+    location_report_immediately_flag_.store(0);
+    GenerateLocationReportMsgNow();
+    FlushMessages();
+}
+
+int JT808Client::FlushMessages(void) {
+    if (manual_deal_.load() || (client_ <= 0))
+        return 0;
+    while (1) {
+        if (sending_msg_.empty()) {
+            std::lock_guard<std::mutex> lock(msg_queue_mutex_);
+            // 优先发送应答消息.
+            for (auto& msg : general_msg_) {
+                sending_msg_.push_back(std::move(msg));
+            }
+            for (auto& msg : location_report_msg_) {
+                sending_msg_.push_back(std::move(msg));
             }
-            heartbeat_begin_tp = end_tp; // 重置心跳检测时间.
-        }
-        // 到达时间间隔或有立即上报的标志时进行位置信息汇报.
-        // 外部生成上报消息, 交由内部进行上报.
-        if (!location_report_msg_.empty()) {
-            if (!manual_deal_.load()) {
-                for (auto& msg : location_report_msg_) {
-                    // printf("JT808 Send[%d]: ", static_cast<int>(msg.size()));
-                    // for (auto const& uch : msg) printf("%02X ", uch);
-                    // printf("\n");
-                    if (Send(client_, reinterpret_cast<char*>(msg.data()), msg.size(), 0) <= 0) {
-                        printf("[%s:%d] Send data failed !!!\n", server_ip.c_str(), server_port);
-                        service_is_running_.store(false);
-                        return;
-                    }
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                location_report_msg_.clear();
-                // report_begin_tp = end_tp;
+            general_msg_.clear();
+            location_report_msg_.clear();
+            send_pending_ = !sending_msg_.empty();
+            if (!send_pending_) {
+                msg_queue_cv_.notify_all();
+                break;
             }
-            heartbeat_begin_tp = end_tp; // 重置心跳检测时间.
-        }
-        // 上次发送位置上报消息到此时的时间差.
-        report_time_lag = std::chrono::duration_cast<std::chrono::milliseconds>(end_tp - report_begin_tp).count();
-        // 上次发送心跳包到此时的时间差.
-        heartbeat_time_lag = std::chrono::duration_cast<std::chrono::milliseconds>(end_tp - heartbeat_begin_tp).count();
-        // 到达时间间隔或有立即上报的标志时进行位置信息汇报.
-        // 外部生成上报消息, 交由内部进行上报.
-        if (!location_report_msg_generate_outside_ &&
-            (report_time_lag >= report_intv || location_report_immediately_flag_)) {
-            // 首次上报需要等到成功定位后再进行, 再此期间可以进行心跳包发送.
-            if (parameter_.location_info.status.bit.positioning == 0) {
-                if (first_report) {
-                    if (heartbeat_time_lag >= heartbeat_intv) {
-                        heartbeat_begin_tp = end_tp;
-                        PackagingGeneralMessage(kTerminalHeartBeat);
-                    }
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    continue;
-                }
+        }
+        auto const& msg = sending_msg_.front();
+        // printf("JT808 Send[%d]: ", static_cast<int>(msg.size()));
+        // for (auto const& uch : msg) printf("%02X ", uch);
+        // printf("\n");
+        int ret = Send(client_, reinterpret_cast<char const*>(msg.data()) + sending_offset_,
+                       static_cast<int>(msg.size() - sending_offset_), 0);
+        if (ret > 0) {
+            last_send_tp_ = std::chrono::steady_clock::now(); // 重置心跳检测时间.
+            sending_offset_ += ret;
+            if (sending_offset_ >= msg.size()) {
+                sending_msg_.pop_front();
+                sending_offset_ = 0;
             }
-            if (first_report)
-                first_report = false;
-            location_report_immediately_flag_ = 0;
-            report_begin_tp                   = end_tp;
-            heartbeat_begin_tp                = end_tp; // 进行位置汇报后重置心跳检测时间.
-            GenerateLocationReportMsgNow();
         }
-        else if (heartbeat_time_lag >= heartbeat_intv) {
-            heartbeat_begin_tp = end_tp;
-            PackagingGeneralMessage(kTerminalHeartBeat);
+        else if ((ret < 0) && (errno == EINTR)) {
+            continue;
+        }
+        else if ((ret < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            // 发送缓冲区已满, 等待socket可写后继续发送.
+            if (!wait_writable_) {
+                wait_writable_ = true;
+                loop_.ModifyHandle(client_, EventLoop::kReadable | EventLoop::kWritable);
+            }
+            return 0;
         }
         else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            JT808_LOG_ERROR("[%s:%d] Send data failed !!!", ip_.c_str(), port_);
+            Stop();
+            return -1;
         }
     }
-    running->store(false);
-    printf("[%s:%d] Send service done.\r\n", server_ip.c_str(), server_port);
+    if (wait_writable_) {
+        wait_writable_ = false;
+        loop_.ModifyHandle(client_, EventLoop::kReadable);
+    }
+    return 0;
 }
 
-void JT808Client::ReceiveHandler(std::atomic_bool* const running) {
-    running->store(true);
-    int                     ret = -1;
-    std::unique_ptr<char[]> buffer(new char[4096], std::default_delete<char[]>());
-    std::vector<uint8_t>    msg;
-    std::unique_ptr<char[]> upgrade_buffer;
-    int                     total_size      = 0;
-    int                     packet_max_size = 0;
-    manual_deal_.store(false);
-    std::string server_ip   = ip_;
-    int         server_port = port_;
-    while (running->load()) {
-        if (manual_deal_.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(20));
-            continue;
-        }
-        if ((ret = Recv(client_, buffer.get(), 4096, 0)) > 0) {
-            // TODO(mengyuming@hotmail.com): 需要处理TCP粘包.
-            msg.assign(buffer.get(), buffer.get() + ret);
-            // printf("JT808 Recv[%d]: ", static_cast<int>(msg.size()));
-            // for (auto const& uch : msg) printf("%02X ", uch);
-            // printf("\n");
-            if (!JT808FrameParse(parser_, msg, &parameter_)) {
-                auto const& msg_id = parameter_.parse.msg_head.msg_id;
-                if (msg_id == kSetTerminalParameters) { // 设置终端参数.
-                    // 更新终端参数.
-                    for (auto const& it : parameter_.parse.terminal_parameters) {
-                        if (parameter_.terminal_parameters.find(it.first) != parameter_.terminal_parameters.end()) {
-                            parameter_.terminal_parameters[it.first] = it.second;
-                        }
-                        else {
-                            parameter_.terminal_parameters.insert(it);
-                        }
-                    }
-                    // 应答成功.
-                    parameter_.respone_result = kSuccess;
-                    PackagingGeneralMessage(kTerminalGeneralResponse);
-                    // 调用回调函数.
-                    terminal_parameter_callback_();
-                }
-                else if (msg_id == kGetTerminalParameters ||
-                         msg_id == kGetSpecificTerminalParameters) { // 查询终端参数.
-                    auto const& ids = parameter_.parse.terminal_parameter_ids;
-                    if (ids.empty()) { // 返回全部参数.
-                        parameter_.terminal_parameter_ids.clear();
-                    }
-                    else { // 返回指定参数.
-                        parameter_.terminal_parameter_ids.assign(ids.begin(), ids.end());
-                    }
-                    PackagingGeneralMessage(kGetTerminalParametersResponse);
-                }
-                else if (msg_id == kSetPolygonArea) { // 设置矩形区域.
-                    UpdatePolygonAreaByArea(parameter_.parse.polygon_area);
-                    // 应答成功.
-                    parameter_.respone_result = kSuccess;
-                    PackagingMessage(kTerminalGeneralResponse, &msg);
-                    general_msg_.push_back(msg);
-                    // 调用回调函数.
-                    polygon_area_callback_();
-                }
-                else if (msg_id == kDeletePolygonArea) { // 删除矩形区域.
-                    DeletePolygonAreaByIDs(parameter_.polygon_area_id);
-                    // 应答成功.
-                    parameter_.respone_result = kSuccess;
-                    PackagingGeneralMessage(kTerminalGeneralResponse);
-                    // 调用回调函数.
-                    polygon_area_callback_();
-                }
-                else if (msg_id == kTerminalUpgrade) { // 下发终端升级包.
-                    // TODO(mengyuming@hotmail.com): 未做分包完整性校验.
-                    auto const& upgrade_info = parameter_.parse.upgrade_info;
-                    auto const& msg_head     = parameter_.parse.msg_head;
-                    auto const& packet_size  = upgrade_info.upgrade_data.size();
-                    // 检查分包.
-                    if (msg_head.msgbody_attr.bit.packet == 1) { // 分包.
-                        // 分配空间.
-                        if (msg_head.packet_seq == 1) { // 第一包.
-                            int max_len = msg_head.msgbody_attr.bit.msglen * msg_head.total_packet;
-                            upgrade_buffer =
-                                std::move(std::unique_ptr<char[]>(new char[max_len], std::default_delete<char[]>()));
-                            // 子包最大的数据长度.
-                            packet_max_size = packet_size;
-                            total_size      = 0;
-                        }
-                        memcpy(&(upgrade_buffer[packet_max_size * (msg_head.packet_seq - 1)]),
-                               upgrade_info.upgrade_data.data(), packet_size);
-                        total_size += packet_size;
-                        parameter_.respone_result = kSuccess;
-                        PackagingGeneralMessage(kTerminalGeneralResponse);
-                        // 等待所有数据传输完成.
-                        if (msg_head.packet_seq == msg_head.total_packet) {
-                            upgrade_callback_(upgrade_info.upgrade_type, upgrade_buffer.get(), total_size);
-                            upgrade_buffer.reset();
-                            // 暂时直接返回升级结果.
-                            parameter_.upgrade_info.upgrade_type   = upgrade_info.upgrade_type;
-                            parameter_.upgrade_info.upgrade_result = kTerminalUpgradeSuccess;
-                            PackagingGeneralMessage(kTerminalUpgradeResultReport);
-                        }
-                    }
-                    else { // 未分包.
-                        parameter_.respone_result = kSuccess;
-                        PackagingGeneralMessage(kTerminalGeneralResponse);
-                        upgrade_callback_(upgrade_info.upgrade_type,
-                                          reinterpret_cast<char const*>(upgrade_info.upgrade_data.data()),
-                                          static_cast<int>(upgrade_info.upgrade_data.size()));
-                        // 暂时直接返回升级结果.
-                        parameter_.upgrade_info.upgrade_type   = upgrade_info.upgrade_type;
-                        parameter_.upgrade_info.upgrade_result = kTerminalUpgradeSuccess;
-                        PackagingGeneralMessage(kTerminalUpgradeResultReport);
-                    }
-                }
-                else if (msg_id == kPlatformGeneralResponse) {
-                    // 接收到平台应答后, 清除进出区域报警标志位.
-                    if ((parameter_.parse.respone_msg_id == kLocationReport) &&
-                        (parameter_.location_info.alarm.bit.in_out_area == 1)) {
-                        parameter_.location_info.alarm.bit.in_out_area = 0;
-                    }
-                }
-            }
+void JT808Client::HandleMessage(void) {
+    auto const& msg_id = parameter_.parse.msg_head.msg_id;
+    if (msg_id == kSetTerminalParameters) { // 设置终端参数.
+        // 更新终端参数.
+        parameter_.parse.terminal_parameter_store.Export(&parameter_.terminal_parameters);
+        // 应答成功.
+        parameter_.respone_result = kSuccess;
+        PackagingGeneralMessage(kTerminalGeneralResponse);
+        // 调用回调函数.
+        terminal_parameter_callback_();
+    }
+    else if (msg_id == kGetTerminalParameters || msg_id == kGetSpecificTerminalParameters) { // 查询终端参数.
+        auto const& ids = parameter_.parse.terminal_parameter_ids;
+        if (ids.empty()) { // 返回全部参数.
+            parameter_.terminal_parameter_ids.clear();
         }
-        else if (ret == 0) {
-            printf("[%s:%d] Disconnect !!!\n", server_ip.c_str(), server_port);
-            service_is_running_.store(false);
-            return;
+        else { // 返回指定参数.
+            parameter_.terminal_parameter_ids.assign(ids.begin(), ids.end());
         }
-        else {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                continue;
-            }
-            else {
-                printf("[%s:%d] Remote socket error!!!\n", server_ip.c_str(), server_port);
-                service_is_running_.store(false);
-                return;
-            }
+        PackagingGeneralMessage(kGetTerminalParametersResponse);
+    }
+    else if (msg_id == kSetPolygonArea) { // 设置矩形区域.
+        UpdatePolygonAreaByArea(parameter_.parse.polygon_area);
+        // 应答成功.
+        parameter_.respone_result = kSuccess;
+        PackagingGeneralMessage(kTerminalGeneralResponse);
+        // 调用回调函数.
+        polygon_area_callback_();
+    }
+    else if (msg_id == kDeletePolygonArea) { // 删除矩形区域.
+        DeletePolygonAreaByIDs(parameter_.polygon_area_id);
+        // 应答成功.
+        parameter_.respone_result = kSuccess;
+        PackagingGeneralMessage(kTerminalGeneralResponse);
+        // 调用回调函数.
+        polygon_area_callback_();
+    }
+    else if (msg_id == kSetCircularArea || msg_id == kSetRectangleArea || msg_id == kSetRoute ||
+             msg_id == kDeleteCircularArea || msg_id == kDeleteRectangleArea || msg_id == kDeleteRoute) {
+        auto const& parse = parameter_.parse;
+        if (msg_id == kSetCircularArea) // 设置圆形区域.
+            UpdateAreas(parse.area_setting_type, parse.circular_areas, &circular_areas_);
+        else if (msg_id == kSetRectangleArea) // 设置矩形区域.
+            UpdateAreas(parse.area_setting_type, parse.rectangle_areas, &rectangle_areas_);
+        else if (msg_id == kSetRoute) // 设置路线.
+            routes_[parse.route.route_id] = parse.route;
+        else if (msg_id == kDeleteCircularArea) // 删除圆形区域.
+            DeleteAreas(parse.circular_area_id, &circular_areas_);
+        else if (msg_id == kDeleteRectangleArea) // 删除矩形区域.
+            DeleteAreas(parse.rectangle_area_id, &rectangle_areas_);
+        else // 删除路线.
+            DeleteAreas(parse.route_id, &routes_);
+        // 应答成功.
+        parameter_.respone_result = kSuccess;
+        PackagingGeneralMessage(kTerminalGeneralResponse);
+        // 调用回调函数.
+        area_route_callback_(msg_id);
+    }
+    else if (msg_id == kTerminalUpgrade) { // 下发终端升级包, 分包时为收齐后的完整升级包.
+        auto const& upgrade_info  = parameter_.parse.upgrade_info;
+        parameter_.respone_result = kSuccess;
+        PackagingGeneralMessage(kTerminalGeneralResponse);
+        upgrade_callback_(upgrade_info.upgrade_type, reinterpret_cast<char const*>(upgrade_info.upgrade_data.data()),
+                          static_cast<int>(upgrade_info.upgrade_data.size()));
+        // 暂时直接返回升级结果.
+        parameter_.upgrade_info.upgrade_type   = upgrade_info.upgrade_type;
+        parameter_.upgrade_info.upgrade_result = kTerminalUpgradeSuccess;
+        PackagingGeneralMessage(kTerminalUpgradeResultReport);
+    }
+    else if (msg_id == kPlatformGeneralResponse) {
+        // 接收到平台应答后, 清除进出区域报警标志位.
+        if ((parameter_.parse.respone_msg_id == kLocationReport) &&
+            (parameter_.location_info.alarm.bit.in_out_area == 1)) {
+            parameter_.location_info.alarm.bit.in_out_area = 0;
         }
     }
-    running->store(false);
-    printf("[%s:%d] Receive service done.\r\n", server_ip.c_str(), server_port);
 }
 
 } // namespace libjt808
@@ -0,0 +1,411 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  event_loop.cc
+// @Version :  1.0
+// @Time    :  2026/10/16 09:40:02
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/event_loop.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
+#include "jt808/logger.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Upper bound of a single wait without a wakeup descriptor, bounds the cross-thread wakeup latency.
+constexpr int kFallbackMaxWaitMs = 50;
+
+} // namespace
+
+EventLoop::EventLoop()
+    : poller_(-1), timer_fd_(-1), wakeup_fd_(-1), next_timer_id_(1),
+      armed_deadline_(Clock::time_point::max()) {
+    quit_.store(false);
+    is_running_.store(false);
+    is_notified_.store(false);
+}
+
+EventLoop::~EventLoop() {
+#if defined(__linux__)
+    if (wakeup_fd_ >= 0)
+        close(wakeup_fd_);
+    if (timer_fd_ >= 0)
+        close(timer_fd_);
+    if (poller_ >= 0)
+        close(poller_);
+#endif
+}
+
+int EventLoop::Init(void) {
+#if defined(__linux__)
+    if (poller_ >= 0)
+        return 0;
+    poller_ = epoll_create1(EPOLL_CLOEXEC);
+    if (poller_ < 0) {
+        JT808_LOG_ERROR("%s[%d]: Create epoll failed!!!", __FUNCTION__, __LINE__);
+        return -1;
+    }
+    timer_fd_  = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (timer_fd_ < 0 || wakeup_fd_ < 0) {
+        JT808_LOG_ERROR("%s[%d]: Create timerfd/eventfd failed!!!", __FUNCTION__, __LINE__);
+        return -1;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events  = EPOLLIN;
+    ev.data.fd = timer_fd_;
+    if (epoll_ctl(poller_, EPOLL_CTL_ADD, timer_fd_, &ev) < 0)
+        return -1;
+    ev.data.fd = wakeup_fd_;
+    if (epoll_ctl(poller_, EPOLL_CTL_ADD, wakeup_fd_, &ev) < 0)
+        return -1;
+#endif
+    return 0;
+}
+
+#if defined(__linux__)
+namespace {
+
+uint32_t ToEpollEvents(int const& events) {
+    uint32_t ev = 0;
+    if (events & EventLoop::kReadable)
+        ev |= EPOLLIN;
+    if (events & EventLoop::kWritable)
+        ev |= EPOLLOUT;
+    return ev;
+}
+
+} // namespace
+#endif
+
+int EventLoop::AddHandle(Handle const& handle, int const& events, EventCallback const& callback) {
+    if (handles_.find(handle) != handles_.end())
+        return -1;
+#if defined(__linux__)
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events  = ToEpollEvents(events);
+    ev.data.fd = handle;
+    if (epoll_ctl(poller_, EPOLL_CTL_ADD, handle, &ev) < 0)
+        return -1;
+#endif
+    handles_[handle] = std::make_pair(events, callback);
+    return 0;
+}
+
+int EventLoop::ModifyHandle(Handle const& handle, int const& events) {
+    auto it = handles_.find(handle);
+    if (it == handles_.end())
+        return -1;
+    if (it->second.first == events)
+        return 0;
+#if defined(__linux__)
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events  = ToEpollEvents(events);
+    ev.data.fd = handle;
+    if (epoll_ctl(poller_, EPOLL_CTL_MOD, handle, &ev) < 0)
+        return -1;
+#endif
+    it->second.first = events;
+    return 0;
+}
+
+int EventLoop::RemoveHandle(Handle const& handle) {
+    auto it = handles_.find(handle);
+    if (it == handles_.end())
+        return -1;
+#if defined(__linux__)
+    epoll_ctl(poller_, EPOLL_CTL_DEL, handle, nullptr);
+#endif
+    handles_.erase(it);
+    return 0;
+}
+
+EventLoop::TimerId EventLoop::AddTimer(uint32_t const& delay_ms, uint32_t const& interval_ms,
+                                       TimerCallback const& callback) {
+    TimerId id = next_timer_id_++;
+    Timer   timer {Clock::now() + std::chrono::milliseconds(delay_ms), interval_ms, callback};
+    deadlines_.insert(std::make_pair(timer.deadline, id));
+    timers_[id] = std::move(timer);
+    ArmTimer();
+    return id;
+}
+
+int EventLoop::ResetTimer(TimerId const& id, uint32_t const& delay_ms, uint32_t const& interval_ms) {
+    auto it = timers_.find(id);
+    if (it == timers_.end())
+        return -1;
+    deadlines_.erase(std::make_pair(it->second.deadline, id));
+    it->second.deadline    = Clock::now() + std::chrono::milliseconds(delay_ms);
+    it->second.interval_ms = interval_ms;
+    deadlines_.insert(std::make_pair(it->second.deadline, id));
+    ArmTimer();
+    return 0;
+}
+
+void EventLoop::CancelTimer(TimerId const& id) {
+    auto it = timers_.find(id);
+    if (it == timers_.end())
+        return;
+    deadlines_.erase(std::make_pair(it->second.deadline, id));
+    timers_.erase(it);
+    // The descriptor stays armed, an early expiry finds nothing to run and re-arms.
+}
+
+// Only re-arm when the nearest deadline moves earlier, a later one is picked up after the spurious expiry.
+void EventLoop::ArmTimer(void) {
+    if (deadlines_.empty())
+        return;
+    auto const& deadline = deadlines_.begin()->first;
+    if (deadline >= armed_deadline_)
+        return;
+    armed_deadline_ = deadline;
+#if defined(__linux__)
+    auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now()).count();
+    if (delay < 1000)
+        delay = 1000; // Zero would disarm the timer.
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec  = static_cast<time_t>(delay / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(delay % 1000000000);
+    timerfd_settime(timer_fd_, 0, &spec, nullptr);
+#endif
+}
+
+int EventLoop::NextTimeout(void) const {
+    if (deadlines_.empty())
+        return -1;
+    auto delay = std::chrono::duration_cast<std::chrono::microseconds>(deadlines_.begin()->first - Clock::now());
+    if (delay.count() <= 0)
+        return 0;
+    return static_cast<int>((delay.count() + 999) / 1000);
+}
+
+void EventLoop::HandleTimers(void) {
+    armed_deadline_ = Clock::time_point::max();
+    auto now        = Clock::now();
+    while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+        TimerId id = deadlines_.begin()->second;
+        deadlines_.erase(deadlines_.begin());
+        auto it = timers_.find(id);
+        if (it == timers_.end())
+            continue;
+        // The callback may cancel or reset its own timer, so reschedule before running it.
+        TimerCallback callback = it->second.callback;
+        if (it->second.interval_ms > 0) {
+            it->second.deadline = now + std::chrono::milliseconds(it->second.interval_ms);
+            deadlines_.insert(std::make_pair(it->second.deadline, id));
+        }
+        else {
+            timers_.erase(it);
+        }
+        if (callback)
+            callback();
+    }
+    ArmTimer();
+}
+
+void EventLoop::HandleTasks(void) {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        if (tasks_.empty())
+            return;
+        tasks.swap(tasks_);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+#if defined(__linux__)
+int EventLoop::Poll(int const& timeout_ms) {
+    struct epoll_event events[256];
+    int                num = epoll_wait(poller_, events, 256, timeout_ms);
+    if (num < 0) {
+        if (errno == EINTR)
+            return 0;
+        JT808_LOG_ERROR("%s[%d]: epoll_wait failed, errno: %d!!!", __FUNCTION__, __LINE__, errno);
+        return -1;
+    }
+    uint64_t value         = 0;
+    bool     timer_expired = false;
+    for (int i = 0; i < num; ++i) {
+        auto const& fd = events[i].data.fd;
+        if (fd == timer_fd_) {
+            if (read(timer_fd_, &value, sizeof(value)) < 0) {
+                // Spurious readiness, nothing expired.
+            }
+            timer_expired = true;
+            continue;
+        }
+        if (fd == wakeup_fd_) {
+            if (read(wakeup_fd_, &value, sizeof(value)) < 0) {
+                // Already drained.
+            }
+            is_notified_.store(false);
+            continue;
+        }
+        auto it = handles_.find(fd);
+        if (it == handles_.end())
+            continue; // Removed by a previous callback of this batch.
+        int revents = 0;
+        if (events[i].events & EPOLLIN)
+            revents |= kReadable;
+        if (events[i].events & EPOLLOUT)
+            revents |= kWritable;
+        if (events[i].events & (EPOLLERR | EPOLLHUP))
+            revents |= kError | kReadable;
+        // The callback may remove its own handle, keep the callable alive.
+        EventCallback callback = it->second.second;
+        callback(revents);
+    }
+    // Timer callbacks may open descriptors, run them after the batch so that a descriptor number reused by a
+    // timer callback never receives a stale event of this batch.
+    if (timer_expired)
+        HandleTimers();
+    return num;
+}
+#else
+int EventLoop::Poll(int const& timeout_ms) {
+    int timeout = NextTimeout();
+    if (timeout < 0 || timeout > kFallbackMaxWaitMs)
+        timeout = kFallbackMaxWaitMs;
+    if (timeout_ms >= 0 && timeout_ms < timeout)
+        timeout = timeout_ms;
+    int num = 0;
+    if (handles_.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+    }
+    else {
+        fd_set rfds;
+        fd_set wfds;
+        fd_set efds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_ZERO(&efds);
+        Handle max_handle = 0;
+        for (auto const& item : handles_) {
+            if (item.second.first & kReadable)
+                FD_SET(item.first, &rfds);
+            if (item.second.first & kWritable)
+                FD_SET(item.first, &wfds);
+            FD_SET(item.first, &efds);
+            if (item.first > max_handle)
+                max_handle = item.first;
+        }
+        struct timeval tv = {timeout / 1000, (timeout % 1000) * 1000};
+        num               = select(static_cast<int>(max_handle + 1), &rfds, &wfds, &efds, &tv);
+        if (num > 0) {
+            std::vector<std::pair<Handle, int>> ready;
+            for (auto const& item : handles_) {
+                int revents = 0;
+                if (FD_ISSET(item.first, &rfds))
+                    revents |= kReadable;
+                if (FD_ISSET(item.first, &wfds))
+                    revents |= kWritable;
+                if (FD_ISSET(item.first, &efds))
+                    revents |= kError | kReadable;
+                if (revents)
+                    ready.push_back(std::make_pair(item.first, revents));
+            }
+            for (auto const& item : ready) {
+                auto it = handles_.find(item.first);
+                if (it == handles_.end())
+                    continue;
+                EventCallback callback = it->second.second;
+                callback(item.second);
+            }
+        }
+    }
+    if (NextTimeout() == 0)
+        HandleTimers();
+    return num;
+}
+#endif
+
+int EventLoop::RunOnce(int const& timeout_ms) {
+    loop_thread_id_ = std::this_thread::get_id();
+    int ret         = Poll(timeout_ms);
+    HandleTasks();
+    return ret;
+}
+
+void EventLoop::Run(void) {
+    is_running_.store(true);
+    loop_thread_id_ = std::this_thread::get_id();
+    while (!quit_.load()) {
+        if (RunOnce(-1) < 0)
+            break;
+    }
+    quit_.store(false);
+    loop_thread_id_ = std::thread::id();
+    is_running_.store(false);
+}
+
+void EventLoop::Quit(void) {
+    quit_.store(true);
+    Wakeup();
+}
+
+void EventLoop::QueueInLoop(Task const& task) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back(task);
+    }
+    Wakeup();
+}
+
+void EventLoop::RunInLoop(Task const& task) {
+    if (IsInLoopThread())
+        task();
+    else
+        QueueInLoop(task);
+}
+
+void EventLoop::Wakeup(void) {
+#if defined(__linux__)
+    if (wakeup_fd_ < 0 || is_notified_.exchange(true))
+        return;
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) < 0) {
+        is_notified_.store(false);
+    }
+#endif
+}
+
+} // namespace libjt808
@@ -0,0 +1,711 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  geofence.cc
+// @Version :  1.0
+// @Time    :  2026/10/18 10:05:22
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/geofence.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define JT808_GEOFENCE_AVX2 1
+#endif
+
+namespace libjt808 {
+
+namespace {
+
+// Bands per polygon, at most one per vertex.
+constexpr size_t kMaxBands = 1024;
+
+// Meters per millionth of a degree of latitude, on a sphere of the mean earth radius.
+constexpr double kMetersPerGeo = 6371008.8 * M_PI / 180 / 1e6;
+
+// Meters per millionth of a degree of longitude at a latitude, kept above zero near the poles.
+double LongitudeScale(int32_t const& latitude) {
+    return std::max(kMetersPerGeo * cos(latitude * 1e-6 * M_PI / 180), kMetersPerGeo * 1e-6);
+}
+
+// Box grown by a distance in meters, saturated to the coordinate range.
+GeoBox Expand(GeoBox const& box, double const& meters, double const& longitude_scale) {
+    auto grow = [](int32_t const& value, double const& delta) {
+        double result = value + delta;
+        return static_cast<int32_t>(std::max(std::min(result, 180e6), -180e6));
+    };
+    double dlatitude  = ceil(meters / kMetersPerGeo);
+    double dlongitude = ceil(meters / longitude_scale);
+    return {grow(box.min_latitude, -dlatitude), grow(box.min_longitude, -dlongitude),
+            grow(box.max_latitude, dlatitude), grow(box.max_longitude, dlongitude)};
+}
+
+GeoPoint SignedPoint(LocationPoint const& location, bool const& south, bool const& west) {
+    GeoPoint point = {DegreesToGeo(location.latitude), DegreesToGeo(location.longitude)};
+    if (south)
+        point.latitude = -point.latitude;
+    if (west)
+        point.longitude = -point.longitude;
+    return point;
+}
+
+// Floor division, rounds towards negative infinity.
+int64_t FloorDiv(int64_t const& value, int64_t const& divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+#ifdef JT808_GEOFENCE_AVX2
+// Latitude range of 8 points and which of them lie in the box, one bit per point.
+__attribute__((target("avx2"))) uint32_t BoundsAvx2(int32_t const* latitudes, int32_t const* longitudes,
+                                                     GeoBox const& box, int32_t* min_latitude, int32_t* max_latitude) {
+    __m256i latitude  = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(latitudes));
+    __m256i longitude = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(longitudes));
+    __m256i outside   = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(box.min_latitude), latitude),
+                        _mm256_cmpgt_epi32(latitude, _mm256_set1_epi32(box.max_latitude))),
+        _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(box.min_longitude), longitude),
+                        _mm256_cmpgt_epi32(longitude, _mm256_set1_epi32(box.max_longitude))));
+    __m256i low  = _mm256_min_epi32(latitude, _mm256_permute2x128_si256(latitude, latitude, 1));
+    __m256i high = _mm256_max_epi32(latitude, _mm256_permute2x128_si256(latitude, latitude, 1));
+    low          = _mm256_min_epi32(low, _mm256_shuffle_epi32(low, 0x4E));
+    high         = _mm256_max_epi32(high, _mm256_shuffle_epi32(high, 0x4E));
+    low          = _mm256_min_epi32(low, _mm256_shuffle_epi32(low, 0xB1));
+    high         = _mm256_max_epi32(high, _mm256_shuffle_epi32(high, 0xB1));
+    *min_latitude = _mm256_cvtsi256_si32(low);
+    *max_latitude = _mm256_cvtsi256_si32(high);
+    return ~static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xFF;
+}
+
+// Toggle the crossing state of 8 points for each edge, the same test as PreparedPolygon::Contains(). Coordinate
+// differences fit in 32 bits, their products are formed in 64 bits: even lanes directly, odd lanes shifted down.
+// Returns the crossing state, one bit per point.
+__attribute__((target("avx2"))) uint32_t CrossingsAvx2(int32_t const* latitudes, int32_t const* longitudes,
+                                                       int32_t const* edges, size_t const& count) {
+    __m256i latitude  = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(latitudes));
+    __m256i longitude = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(longitudes));
+    __m256i inside    = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; ++i, edges += 4) {
+        __m256i latitude0  = _mm256_set1_epi32(edges[0]);
+        __m256i longitude0 = _mm256_set1_epi32(edges[1]);
+        __m256i latitude1  = _mm256_set1_epi32(edges[2]);
+        __m256i dlatitude  = _mm256_set1_epi32(edges[2] - edges[0]);
+        __m256i dlongitude = _mm256_set1_epi32(edges[3] - edges[1]);
+        // latitude0 <= latitude < latitude1.
+        __m256i span = _mm256_andnot_si256(_mm256_cmpgt_epi32(latitude0, latitude),
+                                           _mm256_cmpgt_epi32(latitude1, latitude));
+        __m256i dx   = _mm256_sub_epi32(longitude, longitude0);
+        __m256i dy   = _mm256_sub_epi32(latitude, latitude0);
+        __m256i even = _mm256_cmpgt_epi64(_mm256_mul_epi32(dy, dlongitude), _mm256_mul_epi32(dx, dlatitude));
+        __m256i odd  = _mm256_cmpgt_epi64(_mm256_mul_epi32(_mm256_srli_epi64(dy, 32), dlongitude),
+                                          _mm256_mul_epi32(_mm256_srli_epi64(dx, 32), dlatitude));
+        __m256i cross = _mm256_blend_epi32(even, odd, 0xAA);
+        inside        = _mm256_xor_si256(inside, _mm256_and_si256(cross, span));
+    }
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(inside)));
+}
+
+bool DetectAvx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+} // namespace
+
+int32_t DegreesToGeo(double const& degrees) {
+    return static_cast<int32_t>(llround(degrees * 1e6));
+}
+
+GeoPoint LocationToGeoPoint(LocationBasicInformation const& location) {
+    GeoPoint point;
+    point.latitude  = static_cast<int32_t>(location.latitude);
+    point.longitude = static_cast<int32_t>(location.longitude);
+    if (location.status.bit.sn_latitude)
+        point.latitude = -point.latitude;
+    if (location.status.bit.ew_longitude)
+        point.longitude = -point.longitude;
+    return point;
+}
+
+bool GeofenceSimdSupported(void) {
+#ifdef JT808_GEOFENCE_AVX2
+    static bool const supported = DetectAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void GeoPointBatch::Append(std::vector<LocationBasicInformation> const& locations) {
+    latitudes.reserve(latitudes.size() + locations.size());
+    longitudes.reserve(longitudes.size() + locations.size());
+    for (auto const& location : locations)
+        Append(LocationToGeoPoint(location));
+}
+
+int ContainsBatch(PolygonArea const& area, GeoPointBatch const& points, std::vector<uint8_t>* inside) {
+    PreparedPolygon polygon;
+    if (polygon.Init(area) < 0)
+        return -1;
+    polygon.ContainsBatch(points, inside);
+    return 0;
+}
+
+//
+// PreparedPolygon.
+//
+int PreparedPolygon::Init(std::vector<GeoPoint> const& vertices) {
+    if (vertices.size() < 3)
+        return -1;
+    vertex_count_ = vertices.size();
+    box_          = {vertices[0].latitude, vertices[0].longitude, vertices[0].latitude, vertices[0].longitude};
+    std::vector<Edge> edges;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto const& a = vertices[i];
+        auto const& b = vertices[(i + 1) % vertices.size()];
+        box_.min_latitude  = std::min(box_.min_latitude, a.latitude);
+        box_.max_latitude  = std::max(box_.max_latitude, a.latitude);
+        box_.min_longitude = std::min(box_.min_longitude, a.longitude);
+        box_.max_longitude = std::max(box_.max_longitude, a.longitude);
+        // Horizontal edges never cross a horizontal ray.
+        if (a.latitude == b.latitude)
+            continue;
+        if (a.latitude < b.latitude)
+            edges.push_back({a.latitude, a.longitude, b.latitude, b.longitude});
+        else
+            edges.push_back({b.latitude, b.longitude, a.latitude, a.longitude});
+    }
+    edges_ = edges;
+    std::sort(edges_.begin(), edges_.end(), [](Edge const& a, Edge const& b) {
+        return a.latitude0 < b.latitude0;
+    });
+    // Bands of equal height over the bounding box, an edge is copied into every band it overlaps so that a point test
+    // reads one contiguous run of edges.
+    int64_t span  = static_cast<int64_t>(box_.max_latitude) - box_.min_latitude + 1;
+    size_t  bands = std::min(std::min(vertex_count_, kMaxBands), static_cast<size_t>(span));
+    band_height_  = (span + bands - 1) / bands;
+    bands         = static_cast<size_t>((span + band_height_ - 1) / band_height_);
+    std::vector<uint32_t> counts(bands + 1, 0);
+    auto band_range = [&](Edge const& edge, size_t* first, size_t* last) {
+        *first = static_cast<size_t>((static_cast<int64_t>(edge.latitude0) - box_.min_latitude) / band_height_);
+        *last  = static_cast<size_t>((static_cast<int64_t>(edge.latitude1) - 1 - box_.min_latitude) / band_height_);
+    };
+    size_t first = 0;
+    size_t last  = 0;
+    for (auto const& edge : edges) {
+        band_range(edge, &first, &last);
+        for (size_t band = first; band <= last; ++band)
+            ++counts[band + 1];
+    }
+    for (size_t band = 1; band <= bands; ++band)
+        counts[band] += counts[band - 1];
+    band_offsets_ = counts;
+    band_edges_.resize(counts[bands]);
+    for (auto const& edge : edges) {
+        band_range(edge, &first, &last);
+        for (size_t band = first; band <= last; ++band)
+            band_edges_[counts[band]++] = edge;
+    }
+    return 0;
+}
+
+int PreparedPolygon::Init(PolygonArea const& area) {
+    std::vector<GeoPoint> vertices;
+    vertices.reserve(area.vertices.size());
+    for (auto const& vertex : area.vertices) {
+        vertices.push_back(
+            SignedPoint(vertex, area.area_attribute.bit.sn_latitude, area.area_attribute.bit.ew_longitude));
+    }
+    return Init(vertices);
+}
+
+// Ray casting towards increasing longitude, limited to the edges of the point's band. Integer arithmetic is exact:
+// the products stay below 2^63 for any coordinate in range.
+bool PreparedPolygon::Contains(GeoPoint const& point) const {
+    if (vertex_count_ == 0 || !box_.Contains(point))
+        return false;
+    size_t band   = static_cast<size_t>((static_cast<int64_t>(point.latitude) - box_.min_latitude) / band_height_);
+    bool   inside = false;
+    for (uint32_t i = band_offsets_[band]; i < band_offsets_[band + 1]; ++i) {
+        auto const& edge = band_edges_[i];
+        if (point.latitude < edge.latitude0 || point.latitude >= edge.latitude1)
+            continue;
+        // Crossing longitude > point longitude, multiplied through by the positive latitude span.
+        int64_t lhs = (static_cast<int64_t>(point.longitude) - edge.longitude0) *
+                      (static_cast<int64_t>(edge.latitude1) - edge.latitude0);
+        int64_t rhs = (static_cast<int64_t>(point.latitude) - edge.latitude0) *
+                      (static_cast<int64_t>(edge.longitude1) - edge.longitude0);
+        if (lhs < rhs)
+            inside = !inside;
+    }
+    return inside;
+}
+
+void PreparedPolygon::ContainsBatch(int32_t const* latitudes, int32_t const* longitudes, size_t const& count,
+                                    uint8_t* inside, bool const& use_simd) const {
+    size_t i = 0;
+#ifdef JT808_GEOFENCE_AVX2
+    static_assert(sizeof(Edge) == 4 * sizeof(int32_t), "Edge is passed as packed int32 quadruples");
+    if (use_simd && vertex_count_ != 0 && GeofenceSimdSupported()) {
+        for (; i + 8 <= count; i += 8) {
+            int32_t  min_latitude = 0;
+            int32_t  max_latitude = 0;
+            uint32_t in_box       = BoundsAvx2(latitudes + i, longitudes + i, box_, &min_latitude, &max_latitude);
+            uint32_t mask         = 0;
+            if (in_box != 0) {
+                // Points within one band take the edges of that band. Otherwise every edge starting below the highest
+                // point, edges_ is ascending by latitude0. Points outside the box are masked off, their coordinate
+                // differences may not fit in 32 bits.
+                min_latitude = std::max(min_latitude, box_.min_latitude);
+                max_latitude = std::min(max_latitude, box_.max_latitude);
+                int64_t     band0 = (static_cast<int64_t>(min_latitude) - box_.min_latitude) / band_height_;
+                int64_t     band1 = (static_cast<int64_t>(max_latitude) - box_.min_latitude) / band_height_;
+                Edge const* first = edges_.data();
+                Edge const* last  = edges_.data() + edges_.size();
+                if (band0 == band1) {
+                    first = band_edges_.data() + band_offsets_[band0];
+                    last  = band_edges_.data() + band_offsets_[band0 + 1];
+                }
+                else {
+                    last = std::upper_bound(first, last, max_latitude, [](int32_t const& value, Edge const& edge) {
+                        return value < edge.latitude0;
+                    });
+                }
+                if (first != last)
+                    mask = CrossingsAvx2(latitudes + i, longitudes + i, &first->latitude0, last - first) & in_box;
+            }
+            for (size_t j = 0; j < 8; ++j)
+                inside[i + j] = (mask >> j) & 1;
+        }
+    }
+#else
+    (void)use_simd;
+#endif
+    for (; i < count; ++i)
+        inside[i] = Contains({latitudes[i], longitudes[i]}) ? 1 : 0;
+}
+
+//
+// PreparedCircle.
+//
+int PreparedCircle::Init(GeoPoint const& center, uint32_t const& radius) {
+    center_          = center;
+    longitude_scale_ = LongitudeScale(center.latitude);
+    radius_sq_       = static_cast<double>(radius) * radius;
+    box_             = Expand({center.latitude, center.longitude, center.latitude, center.longitude}, radius,
+                              longitude_scale_);
+    return 0;
+}
+
+int PreparedCircle::Init(CircularArea const& area) {
+    return Init(SignedPoint(area.center, area.area_attribute.bit.sn_latitude, area.area_attribute.bit.ew_longitude),
+                area.radius);
+}
+
+bool PreparedCircle::Contains(GeoPoint const& point) const {
+    if (!box_.Contains(point))
+        return false;
+    double dx = (static_cast<double>(point.longitude) - center_.longitude) * longitude_scale_;
+    double dy = (static_cast<double>(point.latitude) - center_.latitude) * kMetersPerGeo;
+    return dx * dx + dy * dy <= radius_sq_;
+}
+
+//
+// PreparedRoute.
+//
+int PreparedRoute::Init(Route const& route) {
+    auto const& points = route.turning_points;
+    if (points.size() < 2)
+        return -1;
+    sections_.clear();
+    section_boxes_.clear();
+    for (size_t i = 0; i + 1 < points.size(); ++i) {
+        auto const& attribute = points[i].road_section_attribute.bit;
+        GeoPoint    start     = SignedPoint(points[i].point, attribute.sn_latitude, attribute.ew_longitude);
+        auto const& next      = points[i + 1].road_section_attribute.bit;
+        GeoPoint    end       = SignedPoint(points[i + 1].point, next.sn_latitude, next.ew_longitude);
+        Section     section;
+        section.start           = start;
+        section.longitude_scale = LongitudeScale(start.latitude);
+        section.dx              = (static_cast<double>(end.longitude) - start.longitude) * section.longitude_scale;
+        section.dy              = (static_cast<double>(end.latitude) - start.latitude) * kMetersPerGeo;
+        double length_sq        = section.dx * section.dx + section.dy * section.dy;
+        section.inverse_length_sq = length_sq > 0 ? 1 / length_sq : 0;
+        double half_width         = points[i].road_width / 2.0;
+        section.half_width_sq     = half_width * half_width;
+        section.road_section_id   = points[i].road_section_id;
+        section.max_speed         = attribute.speed_limit ? points[i].max_speed : 0;
+        section.overspeed_time    = attribute.speed_limit ? points[i].overspeed_time : 0;
+        sections_.push_back(section);
+        // Half the road width plus a meter of margin for the scale change along the section.
+        GeoBox box = {std::min(start.latitude, end.latitude), std::min(start.longitude, end.longitude),
+                      std::max(start.latitude, end.latitude), std::max(start.longitude, end.longitude)};
+        section_boxes_.push_back(Expand(box, half_width + 1, std::min(section.longitude_scale,
+                                                                      LongitudeScale(end.latitude))));
+    }
+    box_ = section_boxes_[0];
+    for (auto const& box : section_boxes_) {
+        box_.min_latitude  = std::min(box_.min_latitude, box.min_latitude);
+        box_.min_longitude = std::min(box_.min_longitude, box.min_longitude);
+        box_.max_latitude  = std::max(box_.max_latitude, box.max_latitude);
+        box_.max_longitude = std::max(box_.max_longitude, box.max_longitude);
+    }
+    return 0;
+}
+
+// Distance to the closest point of the section, on the projection at its start.
+bool PreparedRoute::SectionContains(size_t const& i, GeoPoint const& point) const {
+    if (!section_boxes_[i].Contains(point))
+        return false;
+    auto const& section = sections_[i];
+    double      px      = (static_cast<double>(point.longitude) - section.start.longitude) * section.longitude_scale;
+    double      py      = (static_cast<double>(point.latitude) - section.start.latitude) * kMetersPerGeo;
+    double      t       = (px * section.dx + py * section.dy) * section.inverse_length_sq;
+    t                   = std::max(0.0, std::min(1.0, t));
+    px -= t * section.dx;
+    py -= t * section.dy;
+    return px * px + py * py <= section.half_width_sq;
+}
+
+int PreparedRoute::Match(GeoPoint const& point) const {
+    if (!box_.Contains(point))
+        return -1;
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        if (SectionContains(i, point))
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+GeoBox RectangleToGeoBox(RectangleArea const& area) {
+    auto const& attribute = area.area_attribute.bit;
+    GeoPoint    a         = SignedPoint(area.upper_left, attribute.sn_latitude, attribute.ew_longitude);
+    GeoPoint    b         = SignedPoint(area.lower_right, attribute.sn_latitude, attribute.ew_longitude);
+    return {std::min(a.latitude, b.latitude), std::min(a.longitude, b.longitude), std::max(a.latitude, b.latitude),
+            std::max(a.longitude, b.longitude)};
+}
+
+//
+// GeofenceEngine.
+//
+constexpr int64_t GeofenceEngine::kMaxCellsPerArea;
+
+GeofenceEngine::GeofenceEngine(double const& cell_degrees) {
+    cell_size_ = std::max<int64_t>(DegreesToGeo(cell_degrees), 1);
+}
+
+int64_t GeofenceEngine::CellOf(int32_t const& value) const {
+    return FloorDiv(value, cell_size_);
+}
+
+uint64_t GeofenceEngine::CellKey(int64_t const& latitude_cell, int64_t const& longitude_cell) const {
+    return (static_cast<uint64_t>(latitude_cell) << 32) ^ static_cast<uint32_t>(longitude_cell);
+}
+
+int GeofenceEngine::AddPolygonArea(PolygonArea const& area) {
+    Area item           = {};
+    item.type           = kAccessAreaAlarmPolygonArea;
+    item.area_id        = area.area_id;
+    item.max_speed      = area.area_attribute.bit.speed_limit ? area.max_speed : 0;
+    item.overspeed_time = area.area_attribute.bit.speed_limit ? area.overspeed_time : 0;
+    if (item.polygon.Init(area) < 0)
+        return -1;
+    item.box = item.polygon.box();
+    return Add(std::move(item));
+}
+
+int GeofenceEngine::AddCircularArea(CircularArea const& area) {
+    Area item           = {};
+    item.type           = kAccessAreaAlarmCircularArea;
+    item.area_id        = area.area_id;
+    item.max_speed      = area.area_attribute.bit.speed_limit ? area.max_speed : 0;
+    item.overspeed_time = area.area_attribute.bit.speed_limit ? area.overspeed_time : 0;
+    item.circle.Init(area);
+    item.box = item.circle.box();
+    return Add(std::move(item));
+}
+
+int GeofenceEngine::AddRectangleArea(RectangleArea const& area) {
+    Area item           = {};
+    item.type           = kAccessAreaAlarmRectangleArea;
+    item.area_id        = area.area_id;
+    item.max_speed      = area.area_attribute.bit.speed_limit ? area.max_speed : 0;
+    item.overspeed_time = area.area_attribute.bit.speed_limit ? area.overspeed_time : 0;
+    item.box            = RectangleToGeoBox(area);
+    return Add(std::move(item));
+}
+
+int GeofenceEngine::AddRoute(Route const& route) {
+    Area item    = {};
+    item.type    = kOverSpeedAlarmRoute;
+    item.area_id = route.route_id;
+    if (item.route.Init(route) < 0)
+        return -1;
+    item.box = item.route.box();
+    return Add(std::move(item));
+}
+
+int GeofenceEngine::AddPolygonAreas(PolygonAreaSet const& areas) {
+    int ret = 0;
+    for (auto const& item : areas) {
+        if (AddPolygonArea(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int GeofenceEngine::AddCircularAreas(CircularAreaSet const& areas) {
+    int ret = 0;
+    for (auto const& item : areas) {
+        if (AddCircularArea(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int GeofenceEngine::AddRectangleAreas(RectangleAreaSet const& areas) {
+    int ret = 0;
+    for (auto const& item : areas) {
+        if (AddRectangleArea(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int GeofenceEngine::AddRoutes(RouteSet const& routes) {
+    int ret = 0;
+    for (auto const& item : routes) {
+        if (AddRoute(item.second) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int GeofenceEngine::Add(Area&& area) {
+    RemoveArea(area.type, area.area_id);
+    uint32_t index = 0;
+    if (!free_slots_.empty()) {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    else {
+        index = static_cast<uint32_t>(areas_.size());
+        areas_.emplace_back();
+    }
+    area_index_[Key(area.type, area.area_id)] = index;
+    areas_[index]                             = std::move(area);
+    Insert(index);
+    return 0;
+}
+
+int GeofenceEngine::RemoveArea(uint8_t const& type, uint32_t const& area_id) {
+    auto it = area_index_.find(Key(type, area_id));
+    if (it == area_index_.end())
+        return -1;
+    Erase(it->second);
+    areas_[it->second] = Area();
+    free_slots_.push_back(it->second);
+    area_index_.erase(it);
+    return 0;
+}
+
+void GeofenceEngine::Clear(void) {
+    areas_.clear();
+    free_slots_.clear();
+    area_index_.clear();
+    grid_.clear();
+    large_areas_.clear();
+    terminals_.clear();
+}
+
+void GeofenceEngine::Insert(uint32_t const& index) {
+    auto const& area = areas_[index];
+    if (area.type != kOverSpeedAlarmRoute) {
+        InsertBox(area.box, {area.box, index, 0});
+        return;
+    }
+    for (size_t i = 0; i < area.route.section_count(); ++i)
+        InsertBox(area.route.section_box(i), {area.route.section_box(i), index, static_cast<uint32_t>(i)});
+}
+
+void GeofenceEngine::InsertBox(GeoBox const& box, Candidate const& candidate) {
+    int64_t lat0 = CellOf(box.min_latitude);
+    int64_t lat1 = CellOf(box.max_latitude);
+    int64_t lon0 = CellOf(box.min_longitude);
+    int64_t lon1 = CellOf(box.max_longitude);
+    if ((lat1 - lat0 + 1) * (lon1 - lon0 + 1) > kMaxCellsPerArea) {
+        large_areas_.push_back(candidate);
+        return;
+    }
+    for (int64_t lat = lat0; lat <= lat1; ++lat) {
+        for (int64_t lon = lon0; lon <= lon1; ++lon)
+            grid_[CellKey(lat, lon)].push_back(candidate);
+    }
+}
+
+void GeofenceEngine::Erase(uint32_t const& index) {
+    auto const& area = areas_[index];
+    if (area.type != kOverSpeedAlarmRoute) {
+        EraseBox(area.box, index);
+        return;
+    }
+    for (size_t i = 0; i < area.route.section_count(); ++i)
+        EraseBox(area.route.section_box(i), index);
+}
+
+void GeofenceEngine::EraseBox(GeoBox const& box, uint32_t const& index) {
+    auto    matches = [&index](Candidate const& candidate) {
+        return candidate.index == index;
+    };
+    int64_t lat0 = CellOf(box.min_latitude);
+    int64_t lat1 = CellOf(box.max_latitude);
+    int64_t lon0 = CellOf(box.min_longitude);
+    int64_t lon1 = CellOf(box.max_longitude);
+    if ((lat1 - lat0 + 1) * (lon1 - lon0 + 1) > kMaxCellsPerArea) {
+        large_areas_.erase(std::remove_if(large_areas_.begin(), large_areas_.end(), matches), large_areas_.end());
+        return;
+    }
+    for (int64_t lat = lat0; lat <= lat1; ++lat) {
+        for (int64_t lon = lon0; lon <= lon1; ++lon) {
+            auto it = grid_.find(CellKey(lat, lon));
+            if (it == grid_.end())
+                continue;
+            it->second.erase(std::remove_if(it->second.begin(), it->second.end(), matches), it->second.end());
+            if (it->second.empty())
+                grid_.erase(it);
+        }
+    }
+}
+
+bool GeofenceEngine::Test(Candidate const& candidate, GeoPoint const& point, std::vector<GeofenceHit>* hits) const {
+    if (!candidate.box.Contains(point))
+        return false;
+    auto const& area = areas_[candidate.index];
+    switch (area.type) {
+        case kAccessAreaAlarmPolygonArea:
+            if (!area.polygon.Contains(point))
+                return false;
+            break;
+        case kAccessAreaAlarmCircularArea:
+            if (!area.circle.Contains(point))
+                return false;
+            break;
+        case kOverSpeedAlarmRoute: {
+            if (!area.route.SectionContains(candidate.section, point))
+                return false;
+            auto const& section = area.route.section(candidate.section);
+            hits->push_back({area.type, area.area_id, section.road_section_id, section.max_speed,
+                             section.overspeed_time});
+            return true;
+        }
+        default: // Rectangle, the box test is exact.
+            break;
+    }
+    hits->push_back({area.type, area.area_id, 0, area.max_speed, area.overspeed_time});
+    return true;
+}
+
+void GeofenceEngine::Locate(GeoPoint const& point, std::vector<GeofenceHit>* hits) const {
+    if (hits == nullptr)
+        return;
+    hits->clear();
+    // A point falls into exactly one cell, so no area is tested twice. A route may hold it on several sections.
+    auto it = grid_.find(CellKey(CellOf(point.latitude), CellOf(point.longitude)));
+    if (it != grid_.end()) {
+        for (auto const& candidate : it->second)
+            Test(candidate, point, hits);
+    }
+    for (auto const& candidate : large_areas_)
+        Test(candidate, point, hits);
+    if (hits->size() < 2)
+        return;
+    std::sort(hits->begin(), hits->end(), [](GeofenceHit const& a, GeofenceHit const& b) {
+        return Key(a.type, a.area_id) < Key(b.type, b.area_id);
+    });
+    hits->erase(std::unique(hits->begin(), hits->end(),
+                            [](GeofenceHit const& a, GeofenceHit const& b) {
+                                return Key(a.type, a.area_id) == Key(b.type, b.area_id);
+                            }),
+                hits->end());
+}
+
+bool GeofenceEngine::Contains(uint8_t const& type, uint32_t const& area_id, GeoPoint const& point) const {
+    auto it = area_index_.find(Key(type, area_id));
+    if (it == area_index_.end())
+        return false;
+    auto const& area = areas_[it->second];
+    switch (area.type) {
+        case kAccessAreaAlarmPolygonArea:
+            return area.polygon.Contains(point);
+        case kAccessAreaAlarmCircularArea:
+            return area.circle.Contains(point);
+        case kOverSpeedAlarmRoute:
+            return area.route.Match(point) >= 0;
+        default:
+            return area.box.Contains(point);
+    }
+}
+
+void GeofenceEngine::Update(std::string const& terminal, GeoPoint const& point, std::vector<GeofenceEvent>* events,
+                            std::vector<GeofenceHit>* hits) {
+    Locate(point, &scratch_hits_);
+    scratch_.clear();
+    for (auto const& hit : scratch_hits_)
+        scratch_.push_back(Key(hit.type, hit.area_id));
+    auto& previous = terminals_[terminal];
+    if (events != nullptr) {
+        // Both lists are ascending, merge them.
+        auto   event = [](uint64_t const& key, bool const& entered) -> GeofenceEvent {
+            return {static_cast<uint8_t>(key >> 32), static_cast<uint32_t>(key), entered};
+        };
+        size_t i     = 0;
+        size_t j     = 0;
+        while (i < previous.size() || j < scratch_.size()) {
+            if (j == scratch_.size() || (i < previous.size() && previous[i] < scratch_[j])) {
+                events->push_back(event(previous[i++], false));
+            }
+            else if (i == previous.size() || scratch_[j] < previous[i]) {
+                events->push_back(event(scratch_[j++], true));
+            }
+            else {
+                ++i;
+                ++j;
+            }
+        }
+    }
+    previous.swap(scratch_);
+    if (hits != nullptr)
+        hits->swap(scratch_hits_);
+}
+
+void GeofenceEngine::RemoveTerminal(std::string const& terminal) {
+    terminals_.erase(terminal);
+}
+
+} // namespace libjt808
@@ -0,0 +1,363 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  handoff.cc
+// @Version :  1.0
+// @Time    :  2026/10/24 14:05:19
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/handoff.h"
+
+#include <string.h>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+#include "jt808/socket_util.h"
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+#if defined(__linux__)
+
+namespace {
+
+// Channel layout, big endian:
+//     magic[8], state size (DWORD), state
+//     state: number of sessions (DWORD), reassembly size (DWORD), reassembly,
+//            and per session: phone number length (BYTE), phone number, authentication code length (BYTE),
+//            authentication code, platform flow number (WORD), terminal flow number (WORD),
+//            receive buffer size (DWORD), receive buffer, parameters as in the body of 0x8103.
+//     sockets: the listening socket then the session sockets in order, kSocketsPerMessage at most per message,
+//              each message carrying one byte.
+// The receiver answers with kAck once it holds every socket.
+constexpr uint8_t kMagic[8]          = {'J', 'T', '8', '0', '8', 'H', 'O', 0x01};
+constexpr size_t  kHeadSize          = sizeof(kMagic) + 4;
+constexpr size_t  kSocketsPerMessage = 64; // Below the SCM_MAX_FD limit of the kernel.
+constexpr uint8_t kAck               = 0x06;
+// Sanity limit of the state size, receive buffers are bounded by the server.
+constexpr uint32_t kMaxStateSize = 1u << 30;
+
+// Milliseconds left until deadline, at least 0.
+int RemainingMs(std::chrono::steady_clock::time_point const& deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return static_cast<int>(std::max<int64_t>(left.count(), 0));
+}
+
+// Returns 0 on success, -1 on failure or timeout.
+int WriteAll(int const& fd, uint8_t const* data, size_t const& size,
+             std::chrono::steady_clock::time_point const& deadline) {
+    size_t sent = 0;
+    while (sent < size) {
+        auto ret = send(fd, data + sent, size - sent, MSG_NOSIGNAL);
+        if (ret > 0)
+            sent += static_cast<size_t>(ret);
+        else if (ret < 0 && errno == EINTR)
+            continue;
+        else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (WaitWritable(fd, RemainingMs(deadline)) <= 0)
+                return -1;
+        }
+        else
+            return -1;
+    }
+    return 0;
+}
+
+// Returns 0 on success, -1 on failure, timeout or end of stream.
+int ReadAll(int const& fd, uint8_t* data, size_t const& size, std::chrono::steady_clock::time_point const& deadline) {
+    size_t received = 0;
+    while (received < size) {
+        auto ret = recv(fd, data + received, size - received, 0);
+        if (ret > 0)
+            received += static_cast<size_t>(ret);
+        else if (ret < 0 && errno == EINTR)
+            continue;
+        else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (WaitReadable(fd, RemainingMs(deadline)) <= 0)
+                return -1;
+        }
+        else
+            return -1;
+    }
+    return 0;
+}
+
+// Send up to kSocketsPerMessage sockets with a single byte. Returns 0 on success, -1 on failure or timeout.
+int SendSockets(int const& fd, int const* sockets, size_t const& count,
+                std::chrono::steady_clock::time_point const& deadline) {
+    uint8_t      byte = 0;
+    struct iovec iov  = {&byte, 1};
+    union {
+        char           buffer[CMSG_SPACE(sizeof(int) * kSocketsPerMessage)];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.buffer;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+    auto cmsg          = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level   = SOL_SOCKET;
+    cmsg->cmsg_type    = SCM_RIGHTS;
+    cmsg->cmsg_len     = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(cmsg), sockets, sizeof(int) * count);
+    while (true) {
+        auto ret = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (ret == 1)
+            return 0;
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && WaitWritable(fd, RemainingMs(deadline)) > 0)
+            continue;
+        return -1;
+    }
+}
+
+// Receive the sockets of one message of SendSockets() and append them.
+// Returns 0 on success, -1 on failure or timeout.
+int ReceiveSockets(int const& fd, std::chrono::steady_clock::time_point const& deadline, std::vector<int>* sockets) {
+    uint8_t      byte = 0;
+    struct iovec iov  = {&byte, 1};
+    union {
+        char           buffer[CMSG_SPACE(sizeof(int) * kSocketsPerMessage)];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    while (true) {
+        auto ret = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && WaitReadable(fd, RemainingMs(deadline)) > 0)
+            continue;
+        if (ret != 1)
+            return -1;
+        break;
+    }
+    size_t received = 0;
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        size_t begin = sockets->size();
+        sockets->resize(begin + count);
+        memcpy(sockets->data() + begin, CMSG_DATA(cmsg), sizeof(int) * count);
+        received += count;
+    }
+    return received == 0 || (msg.msg_flags & MSG_CTRUNC) != 0 ? -1 : 0;
+}
+
+void EncodeState(HandoffState const& state, std::vector<uint8_t>* out) {
+    PutBigEndian(state.sessions.size(), 4, out);
+    PutBigEndian(state.reassembly.size(), 4, out);
+    out->insert(out->end(), state.reassembly.begin(), state.reassembly.end());
+    for (auto const& session : state.sessions) {
+        out->push_back(static_cast<uint8_t>(session.phone_num.size()));
+        out->insert(out->end(), session.phone_num.begin(), session.phone_num.end());
+        out->push_back(static_cast<uint8_t>(session.authentication_code.size()));
+        out->insert(out->end(), session.authentication_code.begin(), session.authentication_code.end());
+        PutBigEndian(session.platform_flow_num, 2, out);
+        PutBigEndian(session.terminal_flow_num, 2, out);
+        PutBigEndian(session.receive_buffer.size(), 4, out);
+        out->insert(out->end(), session.receive_buffer.begin(), session.receive_buffer.end());
+        session.parameters.Encode(out);
+    }
+}
+
+// Returns 0 on success, -1 for a malformed state.
+int DecodeState(std::vector<uint8_t> const& data, HandoffState* state) {
+    size_t pos  = 0;
+    size_t size = data.size();
+    if (size < 8)
+        return -1;
+    uint32_t count = GetBigEndian(&data[0], 4);
+    uint32_t bytes = GetBigEndian(&data[4], 4);
+    pos            = 8;
+    if (size - pos < bytes)
+        return -1;
+    state->reassembly.assign(data.begin() + pos, data.begin() + pos + bytes);
+    pos += bytes;
+    state->sessions.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        HandoffSession session;
+        if (pos == size || size - pos - 1 < data[pos])
+            return -1;
+        session.phone_num.assign(data.begin() + pos + 1, data.begin() + pos + 1 + data[pos]);
+        pos += 1 + data[pos];
+        if (pos == size || size - pos - 1 < data[pos])
+            return -1;
+        session.authentication_code.assign(data.begin() + pos + 1, data.begin() + pos + 1 + data[pos]);
+        pos += 1 + data[pos];
+        if (size - pos < 8)
+            return -1;
+        session.platform_flow_num = static_cast<uint16_t>(GetBigEndian(&data[pos], 2));
+        session.terminal_flow_num = static_cast<uint16_t>(GetBigEndian(&data[pos + 2], 2));
+        bytes                     = GetBigEndian(&data[pos + 4], 4);
+        pos += 8;
+        if (size - pos < bytes)
+            return -1;
+        session.receive_buffer.assign(data.begin() + pos, data.begin() + pos + bytes);
+        pos += bytes;
+        int ret = session.parameters.Decode(data.data() + pos, size - pos);
+        if (ret < 0)
+            return -1;
+        pos += static_cast<size_t>(ret);
+        state->sessions.push_back(std::move(session));
+    }
+    return pos == size ? 0 : -1;
+}
+
+} // namespace
+
+int HandoffListen(std::string const& path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        return -1;
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    unlink(path.c_str());
+    if (Bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 || Listen(fd, 1) < 0) {
+        Close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int HandoffConnect(std::string const& path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        return -1;
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (Connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        Close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int SendHandoffState(int const& channel, HandoffState const& state, int const& timeout_ms) {
+    if (channel < 0 || state.listen_socket < 0)
+        return -1;
+    std::vector<int> sockets;
+    sockets.reserve(state.sessions.size() + 1);
+    sockets.push_back(state.listen_socket);
+    for (auto const& session : state.sessions)
+        sockets.push_back(session.socket);
+    std::vector<uint8_t> out(kMagic, kMagic + sizeof(kMagic));
+    PutBigEndian(0, 4, &out);
+    EncodeState(state, &out);
+    if (out.size() - kHeadSize > kMaxStateSize)
+        return -1;
+    uint32_t size = static_cast<uint32_t>(out.size() - kHeadSize);
+    for (int i = 0; i < 4; ++i)
+        out[sizeof(kMagic) + i] = static_cast<uint8_t>(size >> (8 * (3 - i)));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    SetNonBlocking(channel);
+    if (WriteAll(channel, out.data(), out.size(), deadline) < 0)
+        return -1;
+    for (size_t i = 0; i < sockets.size(); i += kSocketsPerMessage) {
+        if (SendSockets(channel, &sockets[i], std::min(kSocketsPerMessage, sockets.size() - i), deadline) < 0)
+            return -1;
+    }
+    uint8_t ack = 0;
+    return ReadAll(channel, &ack, 1, deadline) == 0 && ack == kAck ? 0 : -1;
+}
+
+int ReceiveHandoffState(int const& channel, int const& timeout_ms, HandoffState* state) {
+    if (channel < 0 || state == nullptr)
+        return -1;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    SetNonBlocking(channel);
+    uint8_t head[kHeadSize];
+    if (ReadAll(channel, head, sizeof(head), deadline) < 0 || memcmp(head, kMagic, sizeof(kMagic)) != 0)
+        return -1;
+    uint32_t size = GetBigEndian(head + sizeof(kMagic), 4);
+    if (size > kMaxStateSize)
+        return -1;
+    std::vector<uint8_t> data(size);
+    if (ReadAll(channel, data.data(), data.size(), deadline) < 0 || DecodeState(data, state) < 0)
+        return -1;
+    std::vector<int> sockets;
+    int              ret = 0;
+    while (ret == 0 && sockets.size() < state->sessions.size() + 1)
+        ret = ReceiveSockets(channel, deadline, &sockets);
+    if (ret == 0 && sockets.size() == state->sessions.size() + 1) {
+        uint8_t ack = kAck;
+        ret         = WriteAll(channel, &ack, 1, deadline);
+    }
+    else {
+        ret = -1;
+    }
+    if (ret < 0) {
+        for (auto const& socket : sockets)
+            Close(socket);
+        return -1;
+    }
+    state->listen_socket = sockets[0];
+    for (size_t i = 0; i < state->sessions.size(); ++i)
+        state->sessions[i].socket = sockets[i + 1];
+    return 0;
+}
+
+#else
+
+int HandoffListen(std::string const& path) {
+    return -1;
+}
+
+int HandoffConnect(std::string const& path) {
+    return -1;
+}
+
+int SendHandoffState(int const& channel, HandoffState const& state, int const& timeout_ms) {
+    return -1;
+}
+
+int ReceiveHandoffState(int const& channel, int const& timeout_ms, HandoffState* state) {
+    return -1;
+}
+
+#endif
+
+} // namespace libjt808
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  ingest.cc
+// @Version :  1.0
+// @Time    :  2026/10/27 16:05:12
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/ingest.h"
+
+#include <chrono>
+
+namespace libjt808 {
+
+int IngestPipeline::Producer::Push(IngestRecord&& record) {
+    auto route = pipeline_->routes_.find(record.msg_id);
+    if (route == pipeline_->routes_.end())
+        return -1;
+    auto&        pool   = *pipeline_->pools_[route->second];
+    auto const&  rings  = rings_[route->second];
+    size_t const index  = rings.size() == 1 ? 0 : std::hash<std::string>()(record.phone_num) % rings.size();
+    Worker*      worker = pool.workers[index].get();
+    while (!rings[index]->TryPush(std::move(record))) {
+        if (pool.options.overflow == kIngestDrop || !pipeline_->running_.load(std::memory_order_relaxed)) {
+            pool.dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        Wakeup(worker);
+        std::this_thread::yield();
+    }
+    pool.pushed.fetch_add(1, std::memory_order_relaxed);
+    // Pairs with the worker announcing its sleep before it checks the rings a last time, one of them sees the other.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker->sleeping.load(std::memory_order_relaxed))
+        Wakeup(worker);
+    return 0;
+}
+
+IngestPipeline::~IngestPipeline() {
+    Stop();
+}
+
+int IngestPipeline::AddPool(IngestPoolOptions const& options, IngestHandler const& handler) {
+    if (started_ || options.threads <= 0 || options.capacity == 0 || options.max_batch == 0 || !handler)
+        return -1;
+    std::unique_ptr<Pool> pool(new Pool);
+    pool->options = options;
+    pool->handler = handler;
+    for (int i = 0; i < options.threads; ++i)
+        pool->workers.emplace_back(new Worker);
+    for (auto const& producer : producers_)
+        Connect(producer.get(), pool.get());
+    pools_.push_back(std::move(pool));
+    return static_cast<int>(pools_.size() - 1);
+}
+
+int IngestPipeline::Route(uint16_t const& msg_id, int const& pool) {
+    if (started_ || pool < 0 || pool >= static_cast<int>(pools_.size()))
+        return -1;
+    routes_[msg_id] = pool;
+    return 0;
+}
+
+IngestPipeline::Producer* IngestPipeline::CreateProducer(void) {
+    if (started_)
+        return nullptr;
+    std::unique_ptr<Producer> producer(new Producer);
+    producer->pipeline_ = this;
+    for (auto const& pool : pools_)
+        Connect(producer.get(), pool.get());
+    producers_.push_back(std::move(producer));
+    return producers_.back().get();
+}
+
+int IngestPipeline::Start(void) {
+    if (started_)
+        return -1;
+    started_ = true;
+    running_.store(true);
+    for (auto const& pool : pools_) {
+        for (auto const& worker : pool->workers)
+            worker->thread = std::thread(&IngestPipeline::WorkerHandler, this, pool.get(), worker.get());
+    }
+    return 0;
+}
+
+void IngestPipeline::Stop(void) {
+    if (!running_.load())
+        return;
+    stop_.store(true);
+    for (auto const& pool : pools_) {
+        for (auto const& worker : pool->workers) {
+            Wakeup(worker.get());
+            if (worker->thread.joinable())
+                worker->thread.join();
+        }
+    }
+    running_.store(false);
+}
+
+uint64_t IngestPipeline::pushed(int const& pool) const {
+    if (pool < 0 || pool >= static_cast<int>(pools_.size()))
+        return 0;
+    return pools_[pool]->pushed.load(std::memory_order_relaxed);
+}
+
+uint64_t IngestPipeline::dropped(int const& pool) const {
+    if (pool < 0 || pool >= static_cast<int>(pools_.size()))
+        return 0;
+    return pools_[pool]->dropped.load(std::memory_order_relaxed);
+}
+
+void IngestPipeline::WorkerHandler(Pool* pool, Worker* worker) {
+    auto const&               rings     = worker->rings;
+    size_t const              max_batch = pool->options.max_batch;
+    size_t                    next      = 0; // Ring drained first, rotated so no producer starves the others.
+    std::vector<IngestRecord> batch;
+    batch.reserve(max_batch);
+    while (1) {
+        // Records pushed before the stop request are handled before leaving.
+        bool const stopping = stop_.load();
+        batch.clear();
+        for (size_t i = 0; i < rings.size() && batch.size() < max_batch; ++i)
+            rings[(next + i) % rings.size()]->PopBatch(&batch, max_batch - batch.size());
+        next = rings.empty() ? 0 : (next + 1) % rings.size();
+        if (!batch.empty()) {
+            pool->handler(batch.data(), batch.size());
+            continue;
+        }
+        if (stopping)
+            break;
+        std::unique_lock<std::mutex> lock(worker->mutex);
+        worker->sleeping.store(true);
+        bool idle = true;
+        for (auto const& ring : rings)
+            idle = idle && ring->empty();
+        // Producers wake a sleeping worker on every push, the timeout is only a safety net.
+        if (idle && !stop_.load())
+            worker->cv.wait_for(lock, std::chrono::milliseconds(100));
+        worker->sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void IngestPipeline::Wakeup(Worker* worker) {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->cv.notify_one();
+}
+
+void IngestPipeline::Connect(Producer* producer, Pool* pool) {
+    std::vector<SpscRing<IngestRecord>*> rings;
+    for (auto const& worker : pool->workers) {
+        worker->rings.emplace_back(new SpscRing<IngestRecord>(pool->options.capacity));
+        rings.push_back(worker->rings.back().get());
+    }
+    producer->rings_.push_back(std::move(rings));
+}
+
+} // namespace libjt808
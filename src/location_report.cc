@@ -56,11 +56,13 @@ int GetOverSpeedAlarmBody(std::vector<uint8_t> const& out,
                           uint8_t* location_type,
                           uint32_t* area_route_id) {
   if (location_type == nullptr || area_route_id == nullptr) return -1;
-  if (out.size() != 1 || out.size() != 5) return -1;
+  if (out.empty()) return -1;
   *location_type = out[0];
-  if (*location_type != kOverSpeedAlarmNoSpecificLocation) {
-    if (out.size() != 5) return -1;
+  *area_route_id = 0;
+  if (*location_type == kOverSpeedAlarmNoSpecificLocation) {
+    return out.size() == 1 ? 0 : -1;
   }
+  if (out.size() != 5) return -1;
   U32ToU8Array u32converter;
   memcpy(u32converter.u8array, &(out[1]), 4);
   *area_route_id = EndianSwap32(u32converter.u32val);
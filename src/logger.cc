@@ -0,0 +1,358 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  logger.cc
+// @Version :  1.0
+// @Time    :  2026/10/17 14:12:40
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/logger.h"
+
+#include <stdlib.h>
+#include <time.h>
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+#include <algorithm>
+
+namespace libjt808 {
+
+namespace {
+
+constexpr char kLevelLetter[] = {'D', 'I', 'W', 'E', 'O'};
+
+// Format "2026-10-17 14:12:40.123 I [1] " into buffer, returns the length.
+int FormatPrefix(LogRecord const& record, char* buffer, size_t const& size) {
+    auto      since_epoch = record.time.time_since_epoch();
+    time_t    seconds     = std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count();
+    int       millis      = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000;
+    struct tm tm_time;
+#if defined(_WIN32)
+    localtime_s(&tm_time, &seconds);
+#else
+    localtime_r(&seconds, &tm_time);
+#endif
+    size_t len = strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &tm_time);
+    return len + snprintf(buffer + len, size - len, ".%03d %c [%u] ", millis, kLevelLetter[record.level],
+                          record.thread);
+}
+
+void WriteLine(FILE* stream, LogRecord const& record) {
+    char prefix[64];
+    int  len = FormatPrefix(record, prefix, sizeof(prefix));
+    fwrite(prefix, 1, len, stream);
+    fwrite(record.text, 1, record.size, stream);
+    fputc('\n', stream);
+}
+
+template <typename T>
+T ReadArg(uint8_t const* data) {
+    T value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+//
+// Sinks.
+//
+void ConsoleLogSink::Write(LogRecord const& record) {
+    WriteLine(stream_, record);
+}
+
+void ConsoleLogSink::Flush(void) {
+    fflush(stream_);
+}
+
+FileLogSink::~FileLogSink() {
+    if (file_ != nullptr)
+        fclose(file_);
+}
+
+int FileLogSink::Open(std::string const& path) {
+    if (file_ != nullptr)
+        fclose(file_);
+    file_ = fopen(path.c_str(), "ab");
+    return file_ == nullptr ? -1 : 0;
+}
+
+void FileLogSink::Write(LogRecord const& record) {
+    if (file_ != nullptr)
+        WriteLine(file_, record);
+}
+
+void FileLogSink::Flush(void) {
+    if (file_ != nullptr)
+        fflush(file_);
+}
+
+//
+// Logger.
+//
+constexpr size_t      Logger::kSlotCount;
+constexpr size_t      Logger::kArgsSize;
+std::atomic<LogLevel> Logger::level_(kLogInfo);
+
+Logger& Logger::Instance(void) {
+    // Never destroyed, so that logging from other static destructors stays safe.
+    static Logger* logger = new Logger();
+    return *logger;
+}
+
+Logger::Logger()
+    : slots_(new Slot[kSlotCount]), enqueue_pos_(0), dequeue_pos_(0), written_(0), dropped_(0), reported_drops_(0),
+      is_running_(false), is_waiting_(false) {
+    for (size_t i = 0; i < kSlotCount; ++i)
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    sinks_.push_back(std::make_shared<ConsoleLogSink>());
+#if defined(__linux__)
+    pthread_atfork(&Logger::BeforeFork, &Logger::AfterForkParent, &Logger::AfterForkChild);
+#endif
+    atexit([] {
+        Instance().Flush();
+    });
+}
+
+Logger::~Logger() {
+}
+
+void Logger::AddSink(std::shared_ptr<LogSink> const& sink) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sinks_.push_back(sink);
+}
+
+void Logger::ClearSinks(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sinks_.clear();
+}
+
+// Bounded multi-producer ring, each slot carries the position it is free or published for.
+Logger::Slot* Logger::Acquire(void) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (1) {
+        Slot*     slot = &slots_[pos & (kSlotCount - 1)];
+        size_t    seq  = slot->sequence.load(std::memory_order_acquire);
+        ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot->position = pos;
+                return slot;
+            }
+        }
+        else if (diff < 0) { // Full.
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::Publish(Slot* slot) {
+    slot->sequence.store(slot->position + 1, std::memory_order_release);
+    if (!is_running_.load(std::memory_order_acquire))
+        Start();
+    else if (is_waiting_.load(std::memory_order_relaxed))
+        cond_.notify_one();
+}
+
+void Logger::Start(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_running_.load())
+        return;
+    is_running_.store(true);
+    thread_.reset(new std::thread(&Logger::ThreadHandler, this));
+    thread_->detach();
+}
+
+void Logger::Flush(void) {
+    size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    while (is_running_.load() && written_.load(std::memory_order_acquire) < target) {
+        cond_.notify_one();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void Logger::ThreadHandler(void) {
+    std::string text;
+    while (1) {
+        Slot* slot = &slots_[dequeue_pos_ & (kSlotCount - 1)];
+        if (slot->sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            // Ring empty, flush and sleep until a record arrives. A missed wake up only delays by the timeout.
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (auto const& sink : sinks_)
+                sink->Flush();
+            written_.store(dequeue_pos_, std::memory_order_release);
+            is_waiting_.store(true);
+            cond_.wait_for(lock, std::chrono::milliseconds(50));
+            is_waiting_.store(false);
+            continue;
+        }
+        Format(*slot, &text);
+        LogRecord record = {slot->level, slot->time, slot->thread, text.data(), text.size()};
+        slot->sequence.store(dequeue_pos_ + kSlotCount, std::memory_order_release);
+        ++dequeue_pos_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto drops = dropped_.load(std::memory_order_relaxed);
+        if (drops != reported_drops_) {
+            char buffer[64];
+            int  len = snprintf(buffer, sizeof(buffer), "%llu log records dropped",
+                                static_cast<unsigned long long>(drops - reported_drops_));
+            LogRecord dropped = {kLogWarn, record.time, record.thread, buffer, static_cast<size_t>(len)};
+            for (auto const& sink : sinks_)
+                sink->Write(dropped);
+            reported_drops_ = drops;
+        }
+        for (auto const& sink : sinks_)
+            sink->Write(record);
+    }
+}
+
+// printf formatting of the encoded arguments, one conversion at a time.
+void Logger::Format(Slot const& slot, std::string* text) const {
+    text->clear();
+    uint8_t const* arg = slot.args;
+    uint8_t const* end = slot.args + slot.args_len;
+    char           spec[32];
+    char           buffer[512];
+    for (char const* p = slot.format; *p != '\0'; ++p) {
+        if (*p != '%') {
+            text->push_back(*p);
+            continue;
+        }
+        if (p[1] == '%') {
+            text->push_back('%');
+            ++p;
+            continue;
+        }
+        // Flags, width and precision are kept, length modifiers are replaced by the encoded width.
+        size_t len  = 0;
+        spec[len++] = '%';
+        ++p;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && len < sizeof(spec) - 4)
+            spec[len++] = *p++;
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr)
+            ++p;
+        if (*p == '\0')
+            break;
+        char conversion = *p;
+        if (arg >= end) {
+            text->append("<?>");
+            continue;
+        }
+        ArgType type = static_cast<ArgType>(*arg);
+        size_t  size = ReadArg<uint16_t>(arg + 1);
+        uint8_t const* data = arg + 3;
+        arg                 = data + size;
+        int written         = 0;
+        if (type == kArgString || type == kArgHex) {
+            std::string str;
+            if (type == kArgString) {
+                str.assign(reinterpret_cast<char const*>(data), size);
+            }
+            else {
+                for (size_t i = 0; i < size; ++i) {
+                    snprintf(buffer, sizeof(buffer), i ? " %02X" : "%02X", data[i]);
+                    str.append(buffer);
+                }
+            }
+            spec[len++] = 's';
+            spec[len]   = '\0';
+            written     = snprintf(buffer, sizeof(buffer), spec, str.c_str());
+        }
+        else if (strchr("fFeEgGaA", conversion) != nullptr) {
+            double value = type == kArgDouble     ? ReadArg<double>(data)
+                           : type == kArgSigned   ? static_cast<double>(ReadArg<int64_t>(data))
+                                                  : static_cast<double>(ReadArg<uint64_t>(data));
+            spec[len++]  = conversion;
+            spec[len]    = '\0';
+            written      = snprintf(buffer, sizeof(buffer), spec, value);
+        }
+        else if (conversion == 'p' || type == kArgPointer) {
+            spec[len++] = 'p';
+            spec[len]   = '\0';
+            written     = snprintf(buffer, sizeof(buffer), spec, ReadArg<void const*>(data));
+        }
+        else {
+            uint64_t value = type == kArgDouble ? static_cast<uint64_t>(ReadArg<double>(data))
+                                                : ReadArg<uint64_t>(data);
+            if (conversion == 'c') {
+                spec[len++] = 'c';
+                spec[len]   = '\0';
+                written     = snprintf(buffer, sizeof(buffer), spec, static_cast<int>(value));
+            }
+            else {
+                spec[len++] = 'l';
+                spec[len++] = 'l';
+                spec[len++] = strchr("uxXo", conversion) != nullptr ? conversion : 'd';
+                spec[len]   = '\0';
+                written     = snprintf(buffer, sizeof(buffer), spec, value);
+            }
+        }
+        if (written > 0)
+            text->append(buffer, std::min<size_t>(written, sizeof(buffer) - 1));
+    }
+}
+
+uint32_t Logger::ThreadNumber(void) {
+    static std::atomic<uint32_t> next(1);
+    static thread_local uint32_t number = next.fetch_add(1);
+    return number;
+}
+
+// Arguments are stored as a type byte, a 16 bit size and the bytes. What does not fit is truncated.
+void Logger::Append(Slot* slot, ArgType const& type, void const* data, size_t const& size) {
+    size_t room = kArgsSize - slot->args_len;
+    if (room < 3 || ((type != kArgString && type != kArgHex) && room < size + 3))
+        return;
+    size_t   len   = std::min(size, room - 3);
+    uint16_t len16 = static_cast<uint16_t>(len);
+    uint8_t* out   = slot->args + slot->args_len;
+    out[0]         = type;
+    memcpy(out + 1, &len16, sizeof(len16));
+    memcpy(out + 3, data, len);
+    slot->args_len += static_cast<uint16_t>(len + 3);
+}
+
+void Logger::BeforeFork(void) {
+    Instance().mutex_.lock();
+}
+
+void Logger::AfterForkParent(void) {
+    Instance().mutex_.unlock();
+}
+
+void Logger::AfterForkChild(void) {
+    auto& logger = Instance();
+    logger.mutex_.unlock();
+    // The logger thread does not exist in the child, the next record starts a new one.
+    logger.thread_.release();
+    logger.is_waiting_.store(false);
+    logger.is_running_.store(false);
+}
+
+} // namespace libjt808
@@ -0,0 +1,539 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  metrics.cc
+// @Version :  1.0
+// @Time    :  2026/10/17 09:30:15
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/metrics.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "jt808/event_loop.h"
+#include "jt808/logger.h"
+#include "jt808/socket_util.h"
+
+namespace libjt808 {
+
+namespace {
+
+struct MetricInfo {
+    char const* name;
+    char const* help;
+};
+
+constexpr MetricInfo kCounterInfo[kMetricCounterCount] = {
+    {"bytes_in_total", "Bytes received."},
+    {"bytes_out_total", "Bytes sent."},
+    {"escape_bytes_in_total", "Bytes added by escaping in the received frames."},
+    {"escape_bytes_out_total", "Bytes added by escaping in the sent frames."},
+    {"connections_accepted_total", "Connections accepted."},
+    {"handshake_failures_total", "Connections closed before authentication completed."},
+    {"disconnects_total", "Authenticated connections closed."},
+    {"send_failures_total", "Messages failed to be packaged or sent."},
+    {"receive_buffer_overflows_total", "Receive buffers discarded for holding no complete frame."},
+    {"fill_requests_total", "Fill packet requests (0x8003) sent for the missing packets of segmented messages."},
+    {"reassembly_drops_total", "Segmented messages dropped incomplete."},
+    {"sessions_restored_total", "Connections authenticated with a stored session, without registration."},
+    {"sessions_taken_over_total", "Connections taken over from a previous server process."},
+    {"downlinks_forwarded_total", "Messages for terminals held by another server process forwarded to it."},
+    {"idle_disconnects_total", "Authenticated connections closed for receiving nothing within the idle timeout."},
+    {"downlink_retransmits_total", "Packets of messages sent to terminals retransmitted for lack of acknowledgement."},
+    {"downlink_timeouts_total", "Messages sent to terminals given up unacknowledged after the last retransmission."},
+    {"ingest_records_total", "Messages handed over to the ingest pipeline."},
+    {"ingest_drops_total", "Messages dropped by the ingest pipeline for a full ring."},
+};
+
+constexpr MetricInfo kGaugeInfo[kMetricGaugeCount] = {
+    {"active_sessions", "Authenticated connections."},
+    {"pending_sessions", "Authenticated connections not yet taken over by the service thread."},
+    {"reassembly_buffers", "Segmented messages being reassembled."},
+    {"receive_buffer_bytes", "Bytes waiting for the rest of their frame."},
+    {"reassembly_bytes", "Packet bytes of the segmented messages being reassembled."},
+    {"timers", "Timers pending on the main service thread."},
+};
+
+constexpr MetricInfo kHistogramInfo[kMetricHistogramCount] = {
+    {"handshake_duration_seconds", "Accept to authentication response."},
+    {"frame_handle_duration_seconds", "Parse, handle and respond to one received frame."},
+};
+
+// Recorded unit of each histogram, in seconds.
+constexpr double kHistogramUnit[kMetricHistogramCount] = {1e-6, 1e-9};
+
+// ParserError values, negated, then the name of the values beyond, one per slot of Metrics::Shard.
+constexpr char const* kParseErrorName[] = {
+    "ok",     "misc",                 "parameters_null", "unescaping", "checksum",
+    "header", "unregistered_message", "packet_pending",  "reassembly", "other",
+};
+
+// Message ID reported for the IDs beyond the per thread table.
+constexpr uint16_t kOverflowMessageId = 0xFFFF;
+
+} // namespace
+
+//
+// LatencyHistogram.
+//
+constexpr int    LatencyHistogram::kSubBucketBits;
+constexpr int    LatencyHistogram::kSubBuckets;
+constexpr size_t LatencyHistogram::kBucketCount;
+
+LatencyHistogram::LatencyHistogram() : buckets_(kBucketCount, 0), count_(0), sum_(0), min_(UINT64_MAX), max_(0) {
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t const& value) {
+    if (value < static_cast<uint64_t>(kSubBuckets))
+        return static_cast<size_t>(value);
+    int msb = 63 - __builtin_clzll(value);
+    int sub = static_cast<int>((value >> (msb - kSubBucketBits)) & (kSubBuckets - 1));
+    return static_cast<size_t>((msb - kSubBucketBits + 1) * kSubBuckets + sub);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t const& index) {
+    if (index < static_cast<size_t>(kSubBuckets))
+        return index;
+    size_t group = index / kSubBuckets;
+    size_t sub   = index % kSubBuckets;
+    if (index >= kBucketCount - 1)
+        return UINT64_MAX;
+    return ((static_cast<uint64_t>(kSubBuckets + sub + 1)) << (group - 1)) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t const& value) {
+    ++buckets_[BucketIndex(value)];
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::Merge(LatencyHistogram const& other) {
+    Merge(other.buckets_.data(), other.sum_, other.min_, other.max_);
+}
+
+void LatencyHistogram::Merge(uint64_t const* buckets, uint64_t const& sum, uint64_t const& min, uint64_t const& max) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        buckets_[i] += buckets[i];
+        count_ += buckets[i];
+    }
+    sum_ += sum;
+    min_ = std::min(min_, min);
+    max_ = std::max(max_, max);
+}
+
+void LatencyHistogram::Reset(void) {
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    count_ = 0;
+    sum_   = 0;
+    min_   = UINT64_MAX;
+    max_   = 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double const& percentile) const {
+    if (count_ == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * count_ + 0.5);
+    rank          = std::min(std::max<uint64_t>(rank, 1), count_);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        seen += buckets_[i];
+        if (seen >= rank)
+            return std::min(BucketUpperBound(i), max_);
+    }
+    return max_;
+}
+
+//
+// Metrics::Shard.
+//
+constexpr size_t Metrics::Shard::kFrameSlots;
+constexpr size_t Metrics::Shard::kParseErrorSlots;
+
+Metrics::Shard::Shard() {
+    // std::atomic members are not zero initialized in C++11.
+    for (auto& counter : counters_)
+        counter.store(0, std::memory_order_relaxed);
+    for (auto& error : parse_errors_)
+        error.store(0, std::memory_order_relaxed);
+    for (auto& frame : frames_) {
+        frame.key.store(0, std::memory_order_relaxed);
+        frame.in.store(0, std::memory_order_relaxed);
+        frame.out.store(0, std::memory_order_relaxed);
+    }
+    for (auto& histogram : histograms_) {
+        for (auto& bucket : histogram.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        histogram.sum.store(0, std::memory_order_relaxed);
+        histogram.min.store(UINT64_MAX, std::memory_order_relaxed);
+        histogram.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+Metrics::Shard::FrameCounter* Metrics::Shard::FrameSlot(uint16_t const& msg_id) {
+    uint32_t key   = static_cast<uint32_t>(msg_id) + 1;
+    size_t   index = (msg_id * 0x9E37u) >> 4;
+    for (size_t i = 0; i < kFrameSlots; ++i) {
+        auto& slot      = frames_[(index + i) & (kFrameSlots - 1)];
+        auto  slot_key  = slot.key.load(std::memory_order_relaxed);
+        if (slot_key == key)
+            return &slot;
+        if (slot_key == 0) {
+            // Readers only look at the counts of published keys.
+            slot.key.store(key, std::memory_order_release);
+            return &slot;
+        }
+    }
+    return FrameSlot(kOverflowMessageId);
+}
+
+void Metrics::Shard::ParseError(int const& error) {
+    size_t slot = (error <= 0 && -error < static_cast<int>(kParseErrorSlots) - 1) ? -error : kParseErrorSlots - 1;
+    Increase(&parse_errors_[slot], 1);
+}
+
+void Metrics::Shard::Record(MetricHistogram const& histogram, uint64_t const& value) {
+    auto& target = histograms_[histogram];
+    Increase(&target.buckets[LatencyHistogram::BucketIndex(value)], 1);
+    Increase(&target.sum, value);
+    if (value < target.min.load(std::memory_order_relaxed))
+        target.min.store(value, std::memory_order_relaxed);
+    if (value > target.max.load(std::memory_order_relaxed))
+        target.max.store(value, std::memory_order_relaxed);
+}
+
+//
+// Metrics.
+//
+Metrics::Metrics() {
+    for (auto& gauge : gauges_)
+        gauge.store(0, std::memory_order_relaxed);
+}
+
+Metrics::~Metrics() {
+}
+
+Metrics::Shard* Metrics::CreateShard(void) {
+    std::unique_ptr<Shard>      shard(new Shard());
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    shards_.push_back(std::move(shard));
+    return shards_.back().get();
+}
+
+void Metrics::Snapshot(MetricsSnapshot* snapshot) const {
+    if (snapshot == nullptr)
+        return;
+    memset(snapshot->counters, 0, sizeof(snapshot->counters));
+    for (int i = 0; i < kMetricGaugeCount; ++i)
+        snapshot->gauges[i] = gauges_[i].load(std::memory_order_relaxed);
+    for (auto& histogram : snapshot->histograms)
+        histogram.Reset();
+    snapshot->frames.clear();
+    snapshot->parse_errors.clear();
+    std::vector<uint64_t>       buckets(LatencyHistogram::kBucketCount);
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (auto const& shard : shards_) {
+        for (int i = 0; i < kMetricCounterCount; ++i)
+            snapshot->counters[i] += shard->counters_[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < Shard::kParseErrorSlots; ++i) {
+            auto count = shard->parse_errors_[i].load(std::memory_order_relaxed);
+            if (count > 0)
+                snapshot->parse_errors[-static_cast<int>(i)] += count;
+        }
+        for (auto const& frame : shard->frames_) {
+            auto key = frame.key.load(std::memory_order_acquire);
+            if (key == 0)
+                continue;
+            auto& counts = snapshot->frames[static_cast<uint16_t>(key - 1)];
+            counts.first += frame.in.load(std::memory_order_relaxed);
+            counts.second += frame.out.load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < kMetricHistogramCount; ++i) {
+            auto const& histogram = shard->histograms_[i];
+            for (size_t j = 0; j < buckets.size(); ++j)
+                buckets[j] = histogram.buckets[j].load(std::memory_order_relaxed);
+            snapshot->histograms[i].Merge(buckets.data(), histogram.sum.load(std::memory_order_relaxed),
+                                          histogram.min.load(std::memory_order_relaxed),
+                                          histogram.max.load(std::memory_order_relaxed));
+        }
+    }
+}
+
+std::string Metrics::FormatPrometheus(MetricsSnapshot const& snapshot, std::string const& prefix) {
+    std::string out;
+    char        line[256];
+    auto        header = [&](char const* name, char const* help, char const* type) {
+        snprintf(line, sizeof(line), "# HELP %s%s %s\n# TYPE %s%s %s\n", prefix.c_str(), name, help, prefix.c_str(),
+                 name, type);
+        out += line;
+    };
+    for (int i = 0; i < kMetricCounterCount; ++i) {
+        header(kCounterInfo[i].name, kCounterInfo[i].help, "counter");
+        snprintf(line, sizeof(line), "%s%s %llu\n", prefix.c_str(), kCounterInfo[i].name,
+                 static_cast<unsigned long long>(snapshot.counters[i]));
+        out += line;
+    }
+    for (int i = 0; i < kMetricGaugeCount; ++i) {
+        header(kGaugeInfo[i].name, kGaugeInfo[i].help, "gauge");
+        snprintf(line, sizeof(line), "%s%s %lld\n", prefix.c_str(), kGaugeInfo[i].name,
+                 static_cast<long long>(snapshot.gauges[i]));
+        out += line;
+    }
+    header("frames_in_total", "Frames received by message ID.", "counter");
+    for (auto const& item : snapshot.frames) {
+        if (item.second.first == 0)
+            continue;
+        snprintf(line, sizeof(line), "%sframes_in_total{msg_id=\"0x%04X\"} %llu\n", prefix.c_str(), item.first,
+                 static_cast<unsigned long long>(item.second.first));
+        out += line;
+    }
+    header("frames_out_total", "Frames sent by message ID.", "counter");
+    for (auto const& item : snapshot.frames) {
+        if (item.second.second == 0)
+            continue;
+        snprintf(line, sizeof(line), "%sframes_out_total{msg_id=\"0x%04X\"} %llu\n", prefix.c_str(), item.first,
+                 static_cast<unsigned long long>(item.second.second));
+        out += line;
+    }
+    header("parse_errors_total", "Received frames failed to parse by error.", "counter");
+    for (auto const& item : snapshot.parse_errors) {
+        size_t index = std::min<size_t>(-item.first, sizeof(kParseErrorName) / sizeof(kParseErrorName[0]) - 1);
+        snprintf(line, sizeof(line), "%sparse_errors_total{error=\"%s\"} %llu\n", prefix.c_str(),
+                 kParseErrorName[index], static_cast<unsigned long long>(item.second));
+        out += line;
+    }
+    // Histogram buckets are reported once per power of two, between the smallest and largest samples.
+    for (int i = 0; i < kMetricHistogramCount; ++i) {
+        auto const& histogram = snapshot.histograms[i];
+        auto const& buckets   = histogram.buckets();
+        auto const& name      = kHistogramInfo[i].name;
+        header(name, kHistogramInfo[i].help, "histogram");
+        if (histogram.count() > 0) {
+            size_t   first = LatencyHistogram::BucketIndex(histogram.min());
+            size_t   last  = LatencyHistogram::BucketIndex(histogram.max());
+            uint64_t seen  = 0;
+            for (size_t j = 0; j <= last; ++j) {
+                seen += buckets[j];
+                if (j < first || ((j + 1) % LatencyHistogram::kSubBuckets != 0 && j != last))
+                    continue;
+                snprintf(line, sizeof(line), "%s%s_bucket{le=\"%.9g\"} %llu\n", prefix.c_str(), name,
+                         (LatencyHistogram::BucketUpperBound(j) + 1) * kHistogramUnit[i],
+                         static_cast<unsigned long long>(seen));
+                out += line;
+            }
+        }
+        snprintf(line, sizeof(line), "%s%s_bucket{le=\"+Inf\"} %llu\n%s%s_sum %.9g\n%s%s_count %llu\n",
+                 prefix.c_str(), name, static_cast<unsigned long long>(histogram.count()), prefix.c_str(), name,
+                 histogram.sum() * kHistogramUnit[i], prefix.c_str(), name,
+                 static_cast<unsigned long long>(histogram.count()));
+        out += line;
+    }
+    return out;
+}
+
+int Metrics::WritePrometheusFile(std::string const& path) const {
+    MetricsSnapshot snapshot;
+    Snapshot(&snapshot);
+    auto        text = FormatPrometheus(snapshot);
+    std::string tmp  = path + ".tmp";
+    FILE*       file = fopen(tmp.c_str(), "wb");
+    if (file == nullptr) {
+        JT808_LOG_ERROR("%s[%d]: Open %s failed!!!", __FUNCTION__, __LINE__, tmp.c_str());
+        return -1;
+    }
+    bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (fclose(file) != 0 || !written) {
+        remove(tmp.c_str());
+        return -1;
+    }
+#if defined(_WIN32)
+    remove(path.c_str()); // rename() does not replace on Windows.
+#endif
+    return rename(tmp.c_str(), path.c_str()) == 0 ? 0 : -1;
+}
+
+//
+// MetricsHttpExporter.
+//
+class MetricsHttpExporter::Impl {
+public:
+    using Handle = EventLoop::Handle;
+
+    Impl(Metrics const* metrics, Handle const& listen) : metrics_(metrics), listen_(listen) {
+    }
+
+    int Start(void) {
+        if (loop_.Init() < 0)
+            return -1;
+        if (loop_.AddHandle(listen_, EventLoop::kReadable, [this](int const&) {
+                OnAccept();
+            }) < 0)
+            return -1;
+        thread_ = std::thread([this] {
+            loop_.Run();
+        });
+        return 0;
+    }
+
+    void Stop(void) {
+        if (thread_.joinable()) {
+            loop_.Quit();
+            thread_.join();
+        }
+        for (auto& item : connections_) {
+            loop_.RemoveHandle(item.first);
+            Close(item.first);
+        }
+        connections_.clear();
+        loop_.RemoveHandle(listen_);
+        Close(listen_);
+    }
+
+private:
+    struct Connection {
+        std::string request;
+        std::string response;
+        size_t      offset = 0;
+    };
+
+    void OnAccept(void) {
+        struct sockaddr_in addr;
+        int                len = sizeof(addr);
+        while (1) {
+            auto socket = Accept(listen_, reinterpret_cast<struct sockaddr*>(&addr), &len);
+            if (socket < 0)
+                return;
+            if (SetNonBlocking(socket) < 0 || loop_.AddHandle(socket, EventLoop::kReadable, [this, socket](int const&
+                                                                                                  events) {
+                    OnEvent(socket, events);
+                }) < 0) {
+                Close(socket);
+                continue;
+            }
+            connections_[socket];
+        }
+    }
+
+    void OnEvent(Handle const& socket, int const& events) {
+        auto& connection = connections_[socket];
+        if (connection.response.empty()) {
+            char buffer[1024];
+            int  ret = Recv(socket, buffer, sizeof(buffer), 0);
+            if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                return;
+            if (ret <= 0) {
+                CloseConnection(socket);
+                return;
+            }
+            connection.request.append(buffer, ret);
+            // Answer once the request header is complete, the request itself does not matter.
+            if (connection.request.find("\r\n\r\n") == std::string::npos && connection.request.size() < 8192)
+                return;
+            MetricsSnapshot snapshot;
+            metrics_->Snapshot(&snapshot);
+            auto body = Metrics::FormatPrometheus(snapshot);
+            connection.response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                  std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            loop_.ModifyHandle(socket, EventLoop::kWritable);
+        }
+        while (connection.offset < connection.response.size()) {
+            int ret = Send(socket, connection.response.data() + connection.offset,
+                           static_cast<int>(connection.response.size() - connection.offset), 0);
+            if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                return;
+            if (ret <= 0)
+                break;
+            connection.offset += ret;
+        }
+        CloseConnection(socket);
+    }
+
+    void CloseConnection(Handle const& socket) {
+        loop_.RemoveHandle(socket);
+        Close(socket);
+        connections_.erase(socket);
+    }
+
+    Metrics const*                         metrics_;
+    Handle                                 listen_;
+    EventLoop                              loop_;
+    std::thread                            thread_;
+    std::unordered_map<Handle, Connection> connections_;
+};
+
+MetricsHttpExporter::MetricsHttpExporter() {
+}
+
+MetricsHttpExporter::~MetricsHttpExporter() {
+    Stop();
+}
+
+int MetricsHttpExporter::Start(Metrics const* metrics, std::string const& ip, int const& port) {
+    if (metrics == nullptr || impl_ != nullptr)
+        return -1;
+    auto listen = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen < 0) {
+        JT808_LOG_ERROR("%s[%d]: Create socket failed!!!", __FUNCTION__, __LINE__);
+        return -1;
+    }
+    int on = 1;
+    setsockopt(listen, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char const*>(&on), sizeof(on));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = inet_addr(ip.c_str());
+    if (Bind(listen, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 || Listen(listen, 16) < 0 ||
+        SetNonBlocking(listen) < 0) {
+        JT808_LOG_ERROR("%s[%d]: Listen on %s:%d failed!!!", __FUNCTION__, __LINE__, ip.c_str(), port);
+        Close(listen);
+        return -1;
+    }
+    impl_.reset(new Impl(metrics, listen));
+    if (impl_->Start() < 0) {
+        impl_->Stop();
+        impl_.reset();
+        return -1;
+    }
+    return 0;
+}
+
+void MetricsHttpExporter::Stop(void) {
+    if (impl_ == nullptr)
+        return;
+    impl_->Stop();
+    impl_.reset();
+}
+
+} // namespace libjt808
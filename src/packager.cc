@@ -29,7 +29,12 @@
 
 #include "jt808/packager.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "jt808/bcd.h"
+#include "jt808/message_bodies.h"
 #include "jt808/util.h"
 
 namespace libjt808 {
@@ -49,12 +54,11 @@ int JT808FrameHeadPackage(MsgHead const& msg_head, std::vector<uint8_t>& out) {
     u16converter.u16val = EndianSwap16(msg_head.msgbody_attr.u16val);
     for (int i = 0; i < 2; ++i)
         out.push_back(u16converter.u8array[i]);
-    // 终端手机号(BCD码).
-    std::vector<uint8_t> phone_num_bcd;
-    if (StringToBcd(msg_head.phone_num, &phone_num_bcd) != 0)
+    // 终端手机号(BCD[6]), 不足12位时高位补0.
+    uint8_t phone_num_bcd[kBcdPhoneSize];
+    if (PhoneToBcd(msg_head.phone_num, phone_num_bcd) != 0)
         return -1;
-    for (auto& u8val : phone_num_bcd)
-        out.push_back(u8val);
+    out.insert(out.end(), phone_num_bcd, phone_num_bcd + kBcdPhoneSize);
     // 消息流水号.
     u16converter.u16val = EndianSwap16(msg_head.msg_flow_num);
     for (int i = 0; i < 2; ++i)
@@ -72,8 +76,9 @@ int JT808FrameHeadPackage(MsgHead const& msg_head, std::vector<uint8_t>& out) {
 }
 
 // 消息内容长度修正.
-int JT808MsgBodyLengthFix(MsgHead const& msg_head, uint16_t const& msg_len, std::vector<uint8_t>& out) {
-    if (out.size() < 12)
+// 消息体长度只有10位, 超出时不能截断.
+int JT808MsgBodyLengthFix(MsgHead const& msg_head, size_t const& msg_len, std::vector<uint8_t>& out) {
+    if (out.size() < 12 || msg_len > kMaxMsgBodyLength)
         return -1;
     auto msgbody_attr       = msg_head.msgbody_attr;
     msgbody_attr.bit.msglen = msg_len;
@@ -96,6 +101,134 @@ int JT808MsgEscape(std::vector<uint8_t>& out) {
     return 0;
 }
 
+// 转义in并追加到out.
+void JT808MsgEscapeAppend(uint8_t const* in, size_t const& size, std::vector<uint8_t>* out) {
+    for (size_t i = 0; i < size; ++i) {
+        if (in[i] == PROTOCOL_SIGN) {
+            out->push_back(PROTOCOL_ESCAPE);
+            out->push_back(PROTOCOL_ESCAPE_SIGN);
+        }
+        else if (in[i] == PROTOCOL_ESCAPE) {
+            out->push_back(PROTOCOL_ESCAPE);
+            out->push_back(PROTOCOL_ESCAPE_ESCAPE);
+        }
+        else {
+            out->push_back(in[i]);
+        }
+    }
+}
+
+// 封装BCD[6]的时间YYMMDDhhmmss, 不足12位时高位补0, 格式错误时为全0.
+void TimePackage(std::string const& time, std::vector<uint8_t>* out) {
+    uint8_t bcd[kBcdTimeSize];
+    if (DigitsToBcd(time.data(), time.size(), bcd, kBcdTimeSize) != 0)
+        memset(bcd, 0, sizeof(bcd));
+    out->insert(out->end(), bcd, bcd + kBcdTimeSize);
+}
+
+// 封装位置汇报消息体, 0x0200, 0x0201与0x0704共用.
+// 返回封装的长度.
+int LocationReportBodyPackage(LocationBasicInformation const& basic_info, LocationExtensions const& extension_info,
+                              std::vector<uint8_t>* out) {
+    // 位置基本信息.
+    int msg_len = LocationBasicBody::Write(basic_info, out);
+    std::vector<uint8_t> extension_custom;
+    // 位置附加信息项.
+    for (auto const& item : extension_info) {
+        if (item.first < kCustomInformationLength) {
+            out->push_back(item.first);
+            out->push_back(item.second.size());
+            msg_len += 2 + item.second.size();
+            for (auto const& uch : item.second)
+                out->push_back(uch);
+        }
+        else if (item.first > kCustomInformationLength) {
+            extension_custom.push_back(item.first);
+            extension_custom.push_back(item.second.size());
+            for (auto const& uch : item.second)
+                extension_custom.push_back(uch);
+        }
+    }
+    // 后续自定义信息长度项, 没有后续自定义信息时不封装.
+    auto const& length = extension_custom.size();
+    if (length >= 256) {
+        out->push_back(kCustomInformationLength);
+        out->push_back(2);
+        out->push_back(length % 65536 / 256);
+        out->push_back(length % 256);
+        msg_len += 4;
+    }
+    else if (length > 0) {
+        out->push_back(kCustomInformationLength);
+        out->push_back(1);
+        out->push_back(length % 256);
+        msg_len += 3;
+    }
+    for (auto const& uch : extension_custom)
+        out->push_back(uch);
+    msg_len += length;
+    return msg_len;
+}
+
+// 封装大端序WORD.
+void U16Package(uint16_t const& value, std::vector<uint8_t>* out) {
+    out->push_back(value >> 8);
+    out->push_back(value & 0xFF);
+}
+
+// 封装大端序DWORD.
+void U32Package(uint32_t const& value, std::vector<uint8_t>* out) {
+    for (int i = 3; i >= 0; --i)
+        out->push_back((value >> (i * 8)) & 0xFF);
+}
+
+// 封装以度为单位的纬度或经度, 精确到百万分之一度.
+void CoordinatePackage(double const& degrees, std::vector<uint8_t>* out) {
+    U32Package(static_cast<uint32_t>(degrees * 1e6 + 0.5), out);
+}
+
+// 封装区域的可选项: 区域属性时间位为1时的起始时间与结束时间(各BCD[6]),
+// 限速位为1时的最高速度(WORD)与超速持续时间(BYTE).
+// 返回封装的长度.
+int AreaOptionsPackage(bool const& by_time, bool const& speed_limit, std::string const& start_time,
+                       std::string const& stop_time, uint16_t const& max_speed, uint8_t const& overspeed_time,
+                       std::vector<uint8_t>* out) {
+    int msg_len = 0;
+    if (by_time) {
+        TimePackage(start_time, out);
+        TimePackage(stop_time, out);
+        msg_len += 2 * kBcdTimeSize;
+    }
+    if (speed_limit) {
+        U16Package(max_speed, out);
+        out->push_back(overspeed_time);
+        msg_len += 3;
+    }
+    return msg_len;
+}
+
+// 封装删除区域/路线消息体, ID个数(BYTE)与所有ID, 没有ID时删除全部.
+// 返回封装的长度, 超过255个ID时返回-1.
+int AreaIdsPackage(std::vector<uint32_t> const& ids, std::vector<uint8_t>* out) {
+    if (out == nullptr || ids.size() > 255)
+        return -1;
+    out->push_back(ids.size());
+    for (auto const& id : ids)
+        U32Package(id, out);
+    return 1 + ids.size() * 4;
+}
+
+// 0x8103/0x0104封装的终端参数, terminal_parameter_store, 或导入(Import)到imported的terminal_parameters.
+// 两者都不为空时返回nullptr.
+TerminalParameterStore const* OutboundParameters(ProtocolParameter const& para, TerminalParameterStore* imported) {
+    if (!para.terminal_parameter_store.empty() && !para.terminal_parameters.empty())
+        return nullptr;
+    if (para.terminal_parameters.empty())
+        return &para.terminal_parameter_store;
+    imported->Import(para.terminal_parameters);
+    return imported;
+}
+
 } // namespace
 
 // 命令封装器初始化.
@@ -151,70 +284,14 @@ int JT808FramePackagerInit(Packager* packager) {
         kFillPacketRequest, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int         msg_len     = 0;
-            auto const& fill_packet = para.fill_packet;
-            // 首包流水号.
-            U16ToU8Array u16convert;
-            u16convert.u16val = EndianSwap16(fill_packet.first_packet_msg_flow_num);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16convert.u8array[i]);
-            msg_len += 2;
-            // 重传包总数.
-            uint8_t cnt = fill_packet.packet_id.end() - fill_packet.packet_id.begin();
-            out->push_back(cnt);
-            ++msg_len;
-            // 重传包ID.
-            for (auto const& id : fill_packet.packet_id) {
-                u16convert.u16val = EndianSwap16(id);
-                for (int i = 0; i < 2; ++i)
-                    out->push_back(u16convert.u8array[i]);
-                msg_len += 2;
-            }
-            return msg_len;
+            return FillPacketBody::Write(para.fill_packet, out);
         }));
     // 0x0100, 终端注册.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kTerminalRegister, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int          msg_len       = 37;
-            auto&        register_info = para.register_info;
-            U16ToU8Array u16converter;
-            // 省域ID.
-            u16converter.u16val = EndianSwap16(register_info.province_id);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 市县域ID.
-            u16converter.u16val = EndianSwap16(register_info.city_id);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 制造商ID.
-            for (auto& ch : register_info.manufacturer_id)
-                out->push_back(ch);
-            // 终端型号.
-            for (auto& ch : register_info.terminal_model)
-                out->push_back(ch);
-            if (register_info.terminal_model.size() < 20) { // 长度不足补0x00.
-                size_t size = 20 - register_info.terminal_model.size();
-                for (size_t i = 0; i < size; ++i)
-                    out->push_back(0x00);
-            }
-            // 终端ID.
-            for (auto& ch : register_info.terminal_id)
-                out->push_back(ch);
-            if (register_info.terminal_id.size() < 7) { // 长度不足补0x00.
-                size_t size = 7 - register_info.terminal_id.size();
-                for (size_t i = 0; i < size; ++i)
-                    out->push_back(0x00);
-            }
-            // 车牌颜色及标识.
-            out->push_back(register_info.car_plate_color);
-            if (register_info.car_plate_color != VehiclePlateColor::kVin) {
-                for (auto& ch : register_info.car_plate_num)
-                    out->push_back(ch);
-                msg_len += register_info.car_plate_num.size();
-            }
-            return msg_len;
+            return RegisterBody::Write(para.register_info, out);
         }));
     // 0x8100, 终端注册应答.
     packager->insert(std::pair<uint16_t, PackageHandler>(
@@ -246,42 +323,22 @@ int JT808FramePackagerInit(Packager* packager) {
                                                              return 0;
                                                          }));
     // 0x0102, 终端鉴权.
-    packager->insert(std::pair<uint16_t, PackageHandler>(kTerminalAuthentication,
-                                                         [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
-                                                             if (out == nullptr)
-                                                                 return -1;
-                                                             int msg_len = para.parse.authentication_code.size();
-                                                             // 鉴权码.
-                                                             for (auto& ch : para.parse.authentication_code)
-                                                                 out->push_back(ch);
-                                                             return msg_len;
-                                                         }));
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kTerminalAuthentication, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            if (out == nullptr)
+                return -1;
+            return AuthenticationBody::Write(para.parse.authentication_code, out);
+        }));
     // 0x8103, Set terminal parameters.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kSetTerminalParameters, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int     msg_len = 0;
-            uint8_t cnt     = static_cast<uint8_t>(para.terminal_parameters.size());
-            // Total number of parameter items.
-            out->push_back(cnt);
-            ++msg_len;
-            U32ToU8Array u32converter;
-            // Parameter items.
-            for (auto const& item : para.terminal_parameters) {
-                // Parameter ID.
-                u32converter.u32val = EndianSwap32(item.first);
-                for (int i = 0; i < 4; ++i)
-                    out->push_back(u32converter.u8array[i]);
-                // Parameter length.
-                cnt = static_cast<uint8_t>(item.second.size());
-                out->push_back(cnt);
-                // Parameter value.
-                for (auto const& uch : item.second)
-                    out->push_back(uch);
-                msg_len += 5 + cnt;
-            }
-            return msg_len;
+            TerminalParameterStore        imported;
+            TerminalParameterStore const* store = OutboundParameters(para, &imported);
+            if (store == nullptr)
+                return -1;
+            return store->Encode(out);
         }));
 
     // 0x8104, Query terminal parameters.
@@ -297,20 +354,7 @@ int JT808FramePackagerInit(Packager* packager) {
         kGetSpecificTerminalParameters, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int     msg_len = 0;
-            uint8_t cnt     = static_cast<uint8_t>(para.terminal_parameter_ids.size());
-            // 查询的参数ID总数.
-            out->push_back(cnt);
-            ++msg_len;
-            U32ToU8Array u32converter;
-            // 查询的参数ID.
-            for (auto const& id : para.terminal_parameter_ids) {
-                u32converter.u32val = EndianSwap32(id);
-                for (int i = 0; i < 4; ++i)
-                    out->push_back(u32converter.u8array[i]);
-                msg_len += 4;
-            }
-            return msg_len;
+            return TerminalParameterIdsBody::Write(para.terminal_parameter_ids, out);
         }));
     // 0x0104, 查询终端参数应答.
     packager->insert(std::pair<uint16_t, PackageHandler>(
@@ -324,179 +368,62 @@ int JT808FramePackagerInit(Packager* packager) {
             for (int i = 0; i < 2; ++i)
                 out->push_back(u16converter.u8array[i]);
             msg_len += 2;
-            if (para.terminal_parameter_ids.empty()) { // 所有终端参数.
-                // 以下与设置终端参数命令消息体内一致.
-                uint8_t cnt = static_cast<uint8_t>(para.terminal_parameters.size());
-                // 参数项总数.
-                out->push_back(cnt);
-                ++msg_len;
-                U32ToU8Array u32converter;
-                // 参数项.
-                for (auto const& item : para.terminal_parameters) {
-                    // 参数ID.
-                    u32converter.u32val = EndianSwap32(item.first);
-                    for (int i = 0; i < 4; ++i)
-                        out->push_back(u32converter.u8array[i]);
-                    // 参数长度.
-                    cnt = static_cast<uint8_t>(item.second.size());
-                    out->push_back(cnt);
-                    // 参数值.
-                    for (auto const& uch : item.second)
-                        out->push_back(uch);
-                    msg_len += 5 + cnt;
-                }
-            }
-            else { // 指定终端参数.
-                uint8_t cnt = static_cast<uint8_t>(para.terminal_parameter_ids.size());
-                // 参数项总数.
-                auto pos = static_cast<uint8_t>(out->size()); // 记录总数位置.
-                out->push_back(cnt);
-                ++msg_len;
-                U32ToU8Array u32converter;
-                // 参数项.
-                for (auto const& id : para.terminal_parameter_ids) {
-                    auto const& it = para.terminal_parameters.find(id);
-                    if (it == para.terminal_parameters.end()) {
-                        --(*out)[pos]; // 未找到终端参数时修正参数项总数.
-                        continue;
-                    }
-                    // 参数ID.
-                    u32converter.u32val = EndianSwap32(it->first);
-                    for (int i = 0; i < 4; ++i)
-                        out->push_back(u32converter.u8array[i]);
-                    // 参数长度.
-                    cnt = static_cast<uint8_t>(it->second.size());
-                    out->push_back(cnt);
-                    // 参数值.
-                    for (auto const& uch : it->second)
-                        out->push_back(uch);
-                    msg_len += 5 + cnt;
-                }
-            }
-            return msg_len;
+            TerminalParameterStore        imported;
+            TerminalParameterStore const* store = OutboundParameters(para, &imported);
+            if (store == nullptr)
+                return -1;
+            int len = para.terminal_parameter_ids.empty() ? store->Encode(out)
+                                                          : store->Encode(para.terminal_parameter_ids, out);
+            return len < 0 ? -1 : msg_len + len;
         }));
     // 0x8108, 下发终端升级包.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kTerminalUpgrade, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int msg_len = 11;
-            // 升级类型.
-            out->push_back(para.upgrade_info.upgrade_type);
-            // 制造商ID.
-            for (auto const& uch : para.upgrade_info.manufacturer_id) {
-                out->push_back(uch);
-            }
-            // 版本号长度.
-            out->push_back(para.upgrade_info.version_id.size());
-            // 版本号.
-            for (auto const& ch : para.upgrade_info.version_id) {
-                out->push_back(static_cast<uint8_t>(ch));
-            }
-            msg_len += para.upgrade_info.version_id.size();
-            // 升级数据包长度.
-            uint32_t     content_len = para.upgrade_info.upgrade_data_total_len;
-            U32ToU8Array u32convert;
-            u32convert.u32val = EndianSwap32(content_len);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32convert.u8array[i]);
-            // 升级数据包.
-            out->insert(out->end(), para.upgrade_info.upgrade_data.begin(), para.upgrade_info.upgrade_data.end());
-            msg_len += para.upgrade_info.upgrade_data.size();
-            return msg_len;
+            return UpgradeBody::Write(para.upgrade_info, out);
         }));
     // 0x0108, 终端升级结果通知.
-    packager->insert(std::pair<uint16_t, PackageHandler>(kTerminalUpgradeResultReport,
-                                                         [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
-                                                             if (out == nullptr)
-                                                                 return -1;
-                                                             int msg_len = 2;
-                                                             // 升级类型.
-                                                             out->push_back(para.upgrade_info.upgrade_type);
-                                                             // 升级结果.
-                                                             out->push_back(para.upgrade_info.upgrade_result);
-                                                             return msg_len;
-                                                         }));
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kTerminalUpgradeResultReport, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            if (out == nullptr)
+                return -1;
+            return UpgradeResultBody::Write(para.upgrade_info, out);
+        }));
     // 0x0200, 位置信息汇报.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kLocationReport, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int          msg_len        = 28;
-            auto&        basic_info     = para.location_info;
-            auto&        extension_info = para.location_extension;
-            U32ToU8Array u32converter;
-            // 报警标志.
-            u32converter.u32val = EndianSwap32(basic_info.alarm.value);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 状态.
-            u32converter.u32val = EndianSwap32(basic_info.status.value);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 纬度.
-            u32converter.u32val = EndianSwap32(basic_info.latitude);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 经度.
-            u32converter.u32val = EndianSwap32(basic_info.longitude);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            U16ToU8Array u16converter;
-            // 海拔高程.
-            u16converter.u16val = EndianSwap16(basic_info.altitude);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 速度.
-            u16converter.u16val = EndianSwap16(basic_info.speed);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 方向.
-            u16converter.u16val = EndianSwap16(basic_info.bearing);
+            return LocationReportBodyPackage(para.location_info, para.location_extension, out);
+        }));
+    // 0x0704, 定位数据批量上传.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kBatchLocationReport, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            if (out == nullptr)
+                return -1;
+            auto const&              batch_loc = para.batch_loc;
+            int                      msg_len   = 3;
+            LocationExtensions const no_extension;
+            U16ToU8Array             u16converter;
+            // 数据项个数.
+            u16converter.u16val = EndianSwap16(static_cast<uint16_t>(batch_loc.loc_info.size()));
             for (int i = 0; i < 2; ++i)
                 out->push_back(u16converter.u8array[i]);
-            std::vector<uint8_t> bcd;
-            // UTC时间(BCD-8421码).
-            StringToBcd(basic_info.time, &bcd);
-            for (auto const& uch : bcd)
-                out->push_back(uch);
-            std::vector<uint8_t> extension_custom;
-            // 位置附加信息项.
-            for (auto const& item : extension_info) {
-                if (item.first <= kCustomInformationLength) {
-                    out->push_back(item.first);
-                    if (item.first == kCustomInformationLength)
-                        continue;
-                    out->push_back(item.second.size());
-                    msg_len += 2 + item.second.size();
-                    for (auto const& uch : item.second)
-                        out->push_back(uch);
-                }
-                else if (item.first > kCustomInformationLength) {
-                    extension_custom.push_back(item.first);
-                    extension_custom.push_back(item.second.size());
-                    for (auto const& uch : item.second)
-                        extension_custom.push_back(uch);
-                }
-            }
-            auto const& length = extension_custom.size();
-            if (length >= 256) {
-                out->push_back(2);
-                out->push_back(length % 65536 / 256);
-                out->push_back(length % 256);
-                msg_len += 4;
-            }
-            else if (length > 0) {
-                out->push_back(1);
-                out->push_back(length % 256);
-                msg_len += 3;
+            // 位置数据类型.
+            out->push_back(batch_loc.data_type);
+            // 位置汇报数据项.
+            for (size_t i = 0; i < batch_loc.loc_info.size(); ++i) {
+                // 位置汇报数据体长度, 封装数据体后回填.
+                auto len_pos = out->size();
+                out->push_back(0);
+                out->push_back(0);
+                int len = LocationReportBodyPackage(
+                    batch_loc.loc_info[i], i < batch_loc.loc_ext.size() ? batch_loc.loc_ext[i] : no_extension, out);
+                (*out)[len_pos]     = static_cast<uint8_t>(len / 256);
+                (*out)[len_pos + 1] = static_cast<uint8_t>(len % 256);
+                msg_len += 2 + len;
             }
-            else { // 没有后续自定义信息.
-                out->pop_back();
-            }
-            for (auto const& uch : extension_custom)
-                out->push_back(uch);
-            msg_len += length;
             return msg_len;
         }));
     // 0x8201, 位置信息查询.
@@ -512,106 +439,78 @@ int JT808FramePackagerInit(Packager* packager) {
         kGetLocationInformationResponse, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int          msg_len = 30;
-            U16ToU8Array u16converter;
             // 应答消息流水号.
-            u16converter.u16val = EndianSwap16(para.parse.msg_head.msg_flow_num);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
+            U16Package(para.parse.msg_head.msg_flow_num, out);
             // 以下为位置信息汇报内容.
-            auto&        basic_info     = para.location_info;
-            auto&        extension_info = para.location_extension;
-            U32ToU8Array u32converter;
-            // 报警标志.
-            u32converter.u32val = EndianSwap32(basic_info.alarm.value);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 状态.
-            u32converter.u32val = EndianSwap32(basic_info.status.value);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 纬度.
-            u32converter.u32val = EndianSwap32(basic_info.latitude);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 经度.
-            u32converter.u32val = EndianSwap32(basic_info.longitude);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
-            // 海拔高程.
-            u16converter.u16val = EndianSwap16(basic_info.altitude);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 速度.
-            u16converter.u16val = EndianSwap16(basic_info.speed);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 方向.
-            u16converter.u16val = EndianSwap16(basic_info.bearing);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            std::vector<uint8_t> bcd;
-            // UTC时间(BCD-8421码).
-            StringToBcd(basic_info.time, &bcd);
-            for (auto const& uch : bcd)
-                out->push_back(uch);
-            std::vector<uint8_t> extension_custom;
-            // 位置附加信息项.
-            for (auto const& item : extension_info) {
-                if (item.first <= kCustomInformationLength) {
-                    out->push_back(item.first);
-                    if (item.first == kCustomInformationLength)
-                        continue;
-                    out->push_back(item.second.size());
-                    msg_len += 2 + item.second.size();
-                    for (auto const& uch : item.second)
-                        out->push_back(uch);
-                }
-                else if (item.first > kCustomInformationLength) {
-                    extension_custom.push_back(item.first);
-                    extension_custom.push_back(item.second.size());
-                    for (auto const& uch : item.second)
-                        extension_custom.push_back(uch);
-                }
-            }
-            auto const& length = extension_custom.size();
-            if (length >= 256) {
-                out->push_back(2);
-                out->push_back(length % 65536 / 256);
-                out->push_back(length % 256);
-                msg_len += 4;
-            }
-            else if (length > 0) {
-                out->push_back(1);
-                out->push_back(length % 256);
-                msg_len += 3;
-            }
-            else { // 没有后续自定义信息.
-                out->pop_back();
-            }
-            for (auto const& uch : extension_custom)
-                out->push_back(uch);
-            msg_len += length;
-            return msg_len;
+            int msg_len = LocationReportBodyPackage(para.location_info, para.location_extension, out);
+            return msg_len < 0 ? -1 : 2 + msg_len;
         }));
     // 0x8202, 临时位置跟踪控制.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kLocationTrackingControl, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int msg_len = 6;
-            // 跟踪期间位置信息汇报时间间隔.
-            U16ToU8Array u16converter;
-            u16converter.u16val = EndianSwap16(para.location_tracking_control.interval);
-            for (int i = 0; i < 2; ++i)
-                out->push_back(u16converter.u8array[i]);
-            // 跟踪有效时间.
-            U32ToU8Array u32converter;
-            u32converter.u32val = EndianSwap32(para.location_tracking_control.tracking_time);
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[i]);
+            return LocationTrackingControlBody::Write(para.location_tracking_control, out);
+        }));
+    // 0x8600, 设置圆形区域.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kSetCircularArea, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            if (out == nullptr || para.circular_areas.size() > 255)
+                return -1;
+            // 设置属性.
+            out->push_back(para.area_setting_type);
+            // 区域总数.
+            out->push_back(para.circular_areas.size());
+            int msg_len = 2;
+            for (auto const& area : para.circular_areas) {
+                U32Package(area.area_id, out);
+                U16Package(area.area_attribute.value, out);
+                // 中心点纬度, 经度与半径.
+                CoordinatePackage(area.center.latitude, out);
+                CoordinatePackage(area.center.longitude, out);
+                U32Package(area.radius, out);
+                msg_len += 18;
+                msg_len += AreaOptionsPackage(area.area_attribute.bit.by_time, area.area_attribute.bit.speed_limit,
+                                              area.start_time, area.stop_time, area.max_speed, area.overspeed_time,
+                                              out);
+            }
+            return msg_len;
+        }));
+    // 0x8601, 删除圆形区域.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kDeleteCircularArea, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            return AreaIdsPackage(para.circular_area_id, out);
+        }));
+    // 0x8602, 设置矩形区域.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kSetRectangleArea, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            if (out == nullptr || para.rectangle_areas.size() > 255)
+                return -1;
+            // 设置属性.
+            out->push_back(para.area_setting_type);
+            // 区域总数.
+            out->push_back(para.rectangle_areas.size());
+            int msg_len = 2;
+            for (auto const& area : para.rectangle_areas) {
+                U32Package(area.area_id, out);
+                U16Package(area.area_attribute.value, out);
+                // 左上点与右下点的纬度, 经度.
+                CoordinatePackage(area.upper_left.latitude, out);
+                CoordinatePackage(area.upper_left.longitude, out);
+                CoordinatePackage(area.lower_right.latitude, out);
+                CoordinatePackage(area.lower_right.longitude, out);
+                msg_len += 22;
+                msg_len += AreaOptionsPackage(area.area_attribute.bit.by_time, area.area_attribute.bit.speed_limit,
+                                              area.start_time, area.stop_time, area.max_speed, area.overspeed_time,
+                                              out);
+            }
             return msg_len;
         }));
+    // 0x8603, 删除矩形区域.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kDeleteRectangleArea, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            return AreaIdsPackage(para.rectangle_area_id, out);
+        }));
     // 0x8604, 设置多边形区域.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kSetPolygonArea, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
@@ -631,15 +530,9 @@ int JT808FramePackagerInit(Packager* packager) {
                 out->push_back(u16converter.u8array[1 - i]);
             // 起始时间, 在区域属性中相关标志位为1时才启用.
             if (polygon_area.area_attribute.bit.by_time) {
-                std::vector<uint8_t> bcd;
-                StringToBcd(polygon_area.start_time, &bcd);
-                for (auto const& uch : bcd)
-                    out->push_back(uch);
-                msg_len += polygon_area.start_time.size();
-                StringToBcd(polygon_area.stop_time, &bcd);
-                for (auto const& uch : bcd)
-                    out->push_back(uch);
-                msg_len += polygon_area.stop_time.size();
+                TimePackage(polygon_area.start_time, out);
+                TimePackage(polygon_area.stop_time, out);
+                msg_len += 2 * kBcdTimeSize;
             }
             // 限速, 在区域属性中相关标志位为1时才启用.
             if (polygon_area.area_attribute.bit.speed_limit) {
@@ -688,48 +581,64 @@ int JT808FramePackagerInit(Packager* packager) {
                                                              }
                                                              return msg_len;
                                                          }));
+    // 0x8606, 设置路线.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kSetRoute, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            if (out == nullptr)
+                return -1;
+            auto const& route = para.route;
+            // 路线ID与路线属性.
+            U32Package(route.route_id, out);
+            U16Package(route.route_attribute.value, out);
+            int msg_len = 6;
+            // 起始时间与结束时间, 在路线属性中相关标志位为1时才启用.
+            msg_len += AreaOptionsPackage(route.route_attribute.bit.by_time, false, route.start_time,
+                                          route.stop_time, 0, 0, out);
+            // 拐点总数.
+            U16Package(route.turning_points.size(), out);
+            msg_len += 2;
+            // 所有拐点.
+            for (auto const& point : route.turning_points) {
+                U32Package(point.turning_point_id, out);
+                U32Package(point.road_section_id, out);
+                CoordinatePackage(point.point.latitude, out);
+                CoordinatePackage(point.point.longitude, out);
+                out->push_back(point.road_width);
+                out->push_back(point.road_section_attribute.value);
+                msg_len += 18;
+                // 路段行驶过长与不足阈值, 在路段属性中相关标志位为1时才启用.
+                if (point.road_section_attribute.bit.driving_time) {
+                    U16Package(point.max_driving_time, out);
+                    U16Package(point.min_driving_time, out);
+                    msg_len += 4;
+                }
+                // 路段限速, 在路段属性中相关标志位为1时才启用.
+                if (point.road_section_attribute.bit.speed_limit) {
+                    U16Package(point.max_speed, out);
+                    out->push_back(point.overspeed_time);
+                    msg_len += 3;
+                }
+            }
+            return msg_len;
+        }));
+    // 0x8607, 删除路线.
+    packager->insert(std::pair<uint16_t, PackageHandler>(
+        kDeleteRoute, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
+            return AreaIdsPackage(para.route_id, out);
+        }));
     // 0x0801, 多媒体数据上传.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kMultimediaDataUpload, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int          msg_len = 36 + para.multimedia_upload.media_data.size();
-            U32ToU8Array u32converter;
-            u32converter.u32val = para.multimedia_upload.media_id;
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[1 - i]);
-            out->push_back(para.multimedia_upload.media_type);
-            out->push_back(para.multimedia_upload.media_format);
-            out->push_back(para.multimedia_upload.media_event);
-            out->push_back(para.multimedia_upload.channel_id);
-            out->insert(out->end(), para.multimedia_upload.loaction_report_body.begin(),
-                        para.multimedia_upload.loaction_report_body.end());
-            out->insert(out->end(), para.multimedia_upload.media_data.begin(), para.multimedia_upload.media_data.end());
-            return msg_len;
+            return MultimediaUploadBody::Write(para.multimedia_upload, out);
         }));
     // 0x8800, 多媒体数据上传应答.
     packager->insert(std::pair<uint16_t, PackageHandler>(
         kMultimediaDataUploadResponse, [](ProtocolParameter const& para, std::vector<uint8_t>* out) {
             if (out == nullptr)
                 return -1;
-            int          msg_len = 4;
-            U32ToU8Array u32converter;
-            U16ToU8Array u16converter;
-            u32converter.u32val = para.multimedia_upload_response.media_id;
-            for (int i = 0; i < 4; ++i)
-                out->push_back(u32converter.u8array[1 - i]);
-            if (!para.multimedia_upload_response.reload_packet_ids.empty()) {
-                auto const& ids = para.multimedia_upload_response.reload_packet_ids;
-                out->push_back(ids.size());
-                for (auto& id : ids) {
-                    u16converter.u16val = id;
-                    for (int i = 0; i < 2; ++i) {
-                        out->push_back(u16converter.u8array[1 - i]);
-                    }
-                    msg_len += 2;
-                }
-            }
-            return msg_len;
+            return MultimediaUploadResponseBody::Write(para.multimedia_upload_response, out);
         }));
 
     return 0;
@@ -792,4 +701,81 @@ int JT808FramePackage(Packager const& packager, ProtocolParameter const& para, s
     return -1;
 }
 
+int SegmentedFrames::Frame(uint16_t const& packet_seq, uint8_t const** frame, size_t* size) const {
+    if (frame == nullptr || size == nullptr || packet_seq == 0 || packet_seq > count())
+        return -1;
+    *frame = data.data() + offsets[packet_seq - 1];
+    *size  = offsets[packet_seq] - offsets[packet_seq - 1];
+    return 0;
+}
+
+int SegmentedFrames::Retransmit(std::vector<uint16_t> const& packet_seqs, std::vector<uint8_t>* out) const {
+    if (out == nullptr)
+        return -1;
+    uint8_t const* frame = nullptr;
+    size_t         size  = 0;
+    for (auto const& packet_seq : packet_seqs) {
+        if (Frame(packet_seq, &frame, &size) < 0)
+            return -1;
+        out->insert(out->end(), frame, frame + size);
+    }
+    return 0;
+}
+
+// 分包封装, 各子包转义后依次追加到同一缓冲区.
+int JT808SegmentedPackage(MsgHead const& msg_head, uint8_t const* body, size_t const& size,
+                          size_t const& max_packet_body, SegmentedFrames* frames) {
+    if (frames == nullptr || (body == nullptr && size > 0) || max_packet_body == 0 ||
+        max_packet_body > kMaxMsgBodyLength)
+        return -1;
+    size_t const total = size == 0 ? 1 : (size + max_packet_body - 1) / max_packet_body;
+    if (total > UINT16_MAX)
+        return -1;
+    frames->data.clear();
+    frames->offsets.clear();
+    frames->first_flow_num = msg_head.msg_flow_num;
+    // 消息头最长16字节, 加上校验码和首尾标识位, 转义按少量预留.
+    frames->data.reserve(size + size / 64 + total * 20);
+    frames->offsets.reserve(total + 1);
+    MsgHead head                 = msg_head;
+    head.msgbody_attr.bit.packet = total > 1 ? 1 : 0;
+    head.total_packet            = static_cast<uint16_t>(total);
+    std::vector<uint8_t> frame;
+    for (size_t i = 0; i < total; ++i) {
+        size_t const offset = i * max_packet_body;
+        size_t const len    = std::min(max_packet_body, size - offset);
+        head.msg_flow_num   = static_cast<uint16_t>(msg_head.msg_flow_num + i);
+        head.packet_seq     = static_cast<uint16_t>(i + 1);
+        // 生成消息头, 封装消息内容并修正消息长度.
+        if (JT808FrameHeadPackage(head, frame) < 0) {
+            frames->data.clear();
+            frames->offsets.clear();
+            return -1;
+        }
+        frame.insert(frame.end(), body + offset, body + offset + len);
+        JT808MsgBodyLengthFix(head, len, frame);
+        // 校验码.
+        frame.push_back(BccCheckSum(&(frame[1]), frame.size() - 1));
+        // 首尾标识位之间的内容转义.
+        frames->offsets.push_back(frames->data.size());
+        frames->data.push_back(PROTOCOL_SIGN);
+        JT808MsgEscapeAppend(&(frame[1]), frame.size() - 1, &frames->data);
+        frames->data.push_back(PROTOCOL_SIGN);
+    }
+    frames->offsets.push_back(frames->data.size());
+    return static_cast<int>(total);
+}
+
+// 由封装器生成完整的消息体后分包封装.
+int JT808SegmentedPackage(Packager const& packager, ProtocolParameter const& para, size_t const& max_packet_body,
+                          SegmentedFrames* frames) {
+    auto it = packager.find(para.msg_head.msg_id);
+    if (it == packager.end())
+        return -1;
+    std::vector<uint8_t> body;
+    if (it->second(para, &body) < 0)
+        return -1;
+    return JT808SegmentedPackage(para.msg_head, body.data(), body.size(), max_packet_body, frames);
+}
+
 } // namespace libjt808
@@ -0,0 +1,235 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  parameter_push.cc
+// @Version :  1.0
+// @Time    :  2026/10/20 10:12:33
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/parameter_push.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "jt808/protocol_parameter.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Size of the total number of parameters, and of the ID and length of a parameter item.
+constexpr size_t kCountSize = 1;
+constexpr size_t kItemHead  = 5;
+
+} // namespace
+
+int TerminalParameterDelta(TerminalParameterStore const& desired, TerminalParameterStore const& snapshot,
+                           TerminalParameterStore* delta) {
+    if (delta == nullptr || delta == &desired || delta == &snapshot)
+        return -1;
+    delta->Clear();
+    desired.ForEach([&](uint32_t const& id, uint8_t const* data, size_t const& size) {
+        uint8_t const* known      = nullptr;
+        size_t         known_size = 0;
+        if (snapshot.Find(id, &known, &known_size) == 0 && known_size == size &&
+            (size == 0 || memcmp(known, data, size) == 0)) {
+            return;
+        }
+        delta->Set(id, data, size);
+    });
+    return 0;
+}
+
+int PackTerminalParameters(TerminalParameterStore const& parameters, size_t const& max_body_size,
+                           std::vector<TerminalParameterStore>* batches) {
+    if (batches == nullptr || max_body_size <= kCountSize)
+        return -1;
+    batches->clear();
+    struct Item {
+        uint32_t       id;
+        uint8_t const* data;
+        size_t         size;
+    };
+    std::vector<Item> items;
+    items.reserve(parameters.size());
+    parameters.ForEach(
+        [&items](uint32_t const& id, uint8_t const* data, size_t const& size) { items.push_back({id, data, size}); });
+    std::stable_sort(items.begin(), items.end(), [](Item const& lhs, Item const& rhs) { return lhs.size > rhs.size; });
+    size_t const        capacity = max_body_size - kCountSize;
+    std::vector<size_t> used; // Bytes of the parameter items of each batch.
+    for (auto const& item : items) {
+        size_t bytes = kItemHead + item.size;
+        if (bytes > capacity) {
+            batches->clear();
+            return -1;
+        }
+        size_t i = 0;
+        while (i < used.size() && (used[i] + bytes > capacity || (*batches)[i].size() == UINT8_MAX))
+            ++i;
+        if (i == used.size()) {
+            used.push_back(0);
+            batches->emplace_back();
+        }
+        used[i] += bytes;
+        (*batches)[i].Set(item.id, item.data, item.size);
+    }
+    return 0;
+}
+
+ParameterPush::ParameterPush(TerminalParameterStore const& desired, ParameterPushOptions const& options)
+    : desired_(desired), options_(options) {
+    if (options_.max_in_flight == 0)
+        options_.max_in_flight = 1;
+}
+
+int ParameterPush::AddTerminal(std::string const& terminal, TerminalParameterStore const& snapshot) {
+    if (terminals_.find(terminal) != terminals_.end())
+        return -1;
+    // Key the delta by its parameter items, deltas against the same snapshot are alike and packed once.
+    scratch_.clear();
+    desired_.ForEach([&](uint32_t const& id, uint8_t const* data, size_t const& size) {
+        uint8_t const* known      = nullptr;
+        size_t         known_size = 0;
+        if (snapshot.Find(id, &known, &known_size) == 0 && known_size == size &&
+            (size == 0 || memcmp(known, data, size) == 0)) {
+            return;
+        }
+        uint8_t head[kItemHead] = {static_cast<uint8_t>(id >> 24), static_cast<uint8_t>(id >> 16),
+                                   static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id), static_cast<uint8_t>(size)};
+        scratch_.insert(scratch_.end(), head, head + kItemHead);
+        scratch_.insert(scratch_.end(), data, data + size);
+    });
+    Terminal state = {nullptr, 0, false, false, 0, 0, 0};
+    if (scratch_.empty()) {
+        terminals_[terminal] = state;
+        results_.push_back({terminal, kParameterPushUpToDate, 0});
+        return 0;
+    }
+    std::string key(scratch_.begin(), scratch_.end());
+    auto        it = plans_.find(key);
+    if (it == plans_.end()) {
+        TerminalParameterStore delta;
+        TerminalParameterDelta(desired_, snapshot, &delta);
+        auto batches = std::make_shared<std::vector<TerminalParameterStore>>();
+        if (PackTerminalParameters(delta, options_.max_body_size, batches.get()) < 0)
+            return -1;
+        it = plans_.insert(std::make_pair(std::move(key), Plan(batches))).first;
+    }
+    state.plan           = it->second;
+    terminals_[terminal] = state;
+    queue_.push_back(terminal);
+    return 0;
+}
+
+void ParameterPush::Send(std::string const& terminal, Terminal* state, int64_t const& now_ms,
+                         SendFunction const& send) {
+    uint16_t flow_num = 0;
+    if (send(terminal, (*state->plan)[state->next], &flow_num) < 0) {
+        Finish(terminal, state, kParameterPushDisconnected);
+        return;
+    }
+    state->pending  = true;
+    state->flow_num = flow_num;
+    ++state->generation;
+    timeouts_.push_back({now_ms + options_.ack_timeout_ms, terminal, state->generation});
+}
+
+void ParameterPush::Finish(std::string const& terminal, Terminal* state, ParameterPushStatus const& status) {
+    if (state->in_flight) {
+        state->in_flight = false;
+        --in_flight_;
+    }
+    state->pending = false;
+    state->plan.reset();
+    results_.push_back({terminal, status, static_cast<uint16_t>(state->next)});
+}
+
+void ParameterPush::Poll(int64_t const& now_ms, SendFunction const& send) {
+    // Retry or fail the frames not acknowledged in time, stale entries were acknowledged or resent since.
+    while (!timeouts_.empty() && timeouts_.front().deadline_ms <= now_ms) {
+        Timeout timeout = std::move(timeouts_.front());
+        timeouts_.pop_front();
+        auto it = terminals_.find(timeout.terminal);
+        if (it == terminals_.end() || !it->second.pending || it->second.generation != timeout.generation)
+            continue;
+        if (it->second.retries >= options_.max_retries) {
+            Finish(it->first, &it->second, kParameterPushTimeout);
+            continue;
+        }
+        ++it->second.retries;
+        Send(it->first, &it->second, now_ms, send);
+    }
+    // Terminals in flight continue with their next frame.
+    while (!ready_.empty()) {
+        auto it = terminals_.find(ready_.front());
+        ready_.pop_front();
+        if (it != terminals_.end() && it->second.in_flight && !it->second.pending)
+            Send(it->first, &it->second, now_ms, send);
+    }
+    // Free slots go to the waiting terminals.
+    while (in_flight_ < options_.max_in_flight && !queue_.empty()) {
+        auto it = terminals_.find(queue_.front());
+        queue_.pop_front();
+        if (it == terminals_.end() || it->second.plan == nullptr || it->second.in_flight)
+            continue;
+        it->second.in_flight = true;
+        ++in_flight_;
+        Send(it->first, &it->second, now_ms, send);
+    }
+}
+
+int ParameterPush::OnResponse(std::string const& terminal, uint16_t const& flow_num, uint8_t const& result,
+                              TerminalParameterStore const** batch) {
+    if (batch != nullptr)
+        *batch = nullptr;
+    auto it = terminals_.find(terminal);
+    if (it == terminals_.end() || !it->second.pending || it->second.flow_num != flow_num)
+        return -1;
+    auto& state   = it->second;
+    state.pending = false;
+    if (result != kSuccess) {
+        Finish(terminal, &state, kParameterPushRejected);
+        return 0;
+    }
+    // plans_ keeps the plan alive after Finish().
+    if (batch != nullptr)
+        *batch = &(*state.plan)[state.next];
+    ++state.next;
+    state.retries = 0;
+    if (state.next == state.plan->size())
+        Finish(terminal, &state, kParameterPushAcked);
+    else
+        ready_.push_back(terminal);
+    return 0;
+}
+
+void ParameterPush::OnDisconnected(std::string const& terminal) {
+    auto it = terminals_.find(terminal);
+    if (it == terminals_.end() || it->second.plan == nullptr)
+        return;
+    Finish(terminal, &it->second, kParameterPushDisconnected);
+}
+
+} // namespace libjt808
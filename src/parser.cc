@@ -32,12 +32,16 @@
 #include <string.h>
 
 #include "jt808/bcd.h"
+#include "jt808/message_bodies.h"
 #include "jt808/util.h"
 
 namespace libjt808 {
 
 namespace {
 
+// Longest body of an unsegmented frame, held by the 10 bits body length of its header.
+constexpr size_t kMaxFrameBodyLength = 1023;
+
 // Parse message header.
 int JT808FrameHeadParse(InputBuffer in, MsgHead* msg_head) {
     if (msg_head == nullptr || in.size() < 15)
@@ -46,15 +50,18 @@ int JT808FrameHeadParse(InputBuffer in, MsgHead* msg_head) {
     msg_head->msg_id = in[1] * 256 + in[2];
     // Message body attributes.
     msg_head->msgbody_attr.u16val = in[3] * 256 + in[4];
-    // Terminal phone number.
-    std::vector<uint8_t> phone_num_bcd;
-    phone_num_bcd.assign(in.begin() + 5, in.begin() + 11);
-    if (BcdToString(phone_num_bcd, &(msg_head->phone_num)) != 0)
+    // Terminal phone number, a leading zero digit is dropped.
+    char phone_num[2 * kBcdPhoneSize];
+    if (BcdToPhone(&in[5], phone_num) != 0)
         return -1;
+    size_t const zero = phone_num[0] == '0' ? 1 : 0;
+    msg_head->phone_num.assign(phone_num + zero, sizeof(phone_num) - zero);
     // Message flow number.
     msg_head->msg_flow_num = in[11] * 256 + in[12];
-    // Packet occurrence.
-    if ((msg_head->msgbody_attr.bit.packet == 1) && ((in.size() - 15 - msg_head->msgbody_attr.bit.msglen) == 4)) {
+    // Packet occurrence, the packet fields follow the flow number whenever the packet bit is set.
+    if (msg_head->msgbody_attr.bit.packet == 1) {
+        if (in.size() < MSGBODY_PACKET_POS + 2)
+            return -1;
         msg_head->total_packet = in[13] * 256 + in[14];
         msg_head->packet_seq   = in[15] * 256 + in[16];
     }
@@ -65,6 +72,116 @@ int JT808FrameHeadParse(InputBuffer in, MsgHead* msg_head) {
     return 0;
 }
 
+// Body of a frame as located by its message header.
+// Returns 0 on success, -1 if the body exceeds the frame.
+int MsgBodyLocate(InputBuffer in, MsgHead const& msg_head, uint8_t const** body, size_t* size) {
+    size_t pos = msg_head.msgbody_attr.bit.packet == 1 ? MSGBODY_PACKET_POS : MSGBODY_NOPACKET_POS;
+    size_t len = msg_head.msgbody_attr.bit.msglen;
+    if (in.size() < pos + len + 2) // Body, check code and end flag.
+        return -1;
+    *body = in.data() + pos;
+    *size = len;
+    return 0;
+}
+
+// Parse a message body with its schema.
+// Args:
+//     in:  Unescaped frame.
+//     msg_head:  Parsed message header.
+//     object:  Parsed fields.
+//     exact:  The schema must take the whole body, otherwise trailing bytes are ignored.
+// Returns:
+//     Returns 0 on success, -1 on failure.
+template <typename Body, typename Object>
+int MsgBodyParse(InputBuffer in, MsgHead const& msg_head, Object* object, bool const& exact = false) {
+    uint8_t const* body = nullptr;
+    size_t         size = 0;
+    if (MsgBodyLocate(in, msg_head, &body, &size) < 0)
+        return -1;
+    int used = Body::Read(body, size, object);
+    if (used < 0 || (exact && static_cast<size_t>(used) != size))
+        return -1;
+    return 0;
+}
+
+// Parse a location report body, shared by 0x0200, 0x0201 and 0x0704.
+// Args:
+//     body:  The body.
+//     size:  Size of the body.
+//     basic_info:  Parsed basic location information.
+//     extension_info:  Parsed location additional information items.
+//     time_cache:  Epoch of the date of the previous report of the session.
+// Returns:
+//     Returns 0 on success, -1 on failure.
+int LocationReportBodyParse(uint8_t const* body, size_t const& size, LocationBasicInformation* basic_info,
+                            LocationExtensions* extension_info, BcdTimeCache* time_cache) {
+    int used = LocationBasicBody::Read(body, size, basic_info);
+    if (used < 0)
+        return -1;
+    // UTC time (BCD-8421 code), the last basic field.
+    if (time_cache->ToEpoch(body + used - kBcdTimeSize, &basic_info->timestamp) != 0)
+        basic_info->timestamp = -1;
+    // Location additional information items.
+    if (LocationExtensionsBody::Read(body + used, size - used, extension_info) < 0)
+        return -1;
+    return 0;
+}
+
+// Parse the optional fields of an area, start and stop time (BCD[6] each) if the time bit is set, then the max speed
+// (WORD) and overspeed time (BYTE) if the speed limit bit is set.
+// Args:
+//     body:  The message body.
+//     size:  Size of the message body.
+//     pos:  Position of the fields, advanced past them.
+// Returns:
+//     Returns 0 on success, -1 if the fields exceed the body.
+int AreaOptionsParse(uint8_t const* body, size_t const& size, size_t* pos, bool const& by_time,
+                     bool const& speed_limit, std::string* start_time, std::string* stop_time, uint16_t* max_speed,
+                     uint8_t* overspeed_time) {
+    using Time = schema::Bcd<kBcdTimeSize>;
+    if (size - *pos < (by_time ? 2 * Time::kSize : 0) + (speed_limit ? schema::Word::kSize + schema::Byte::kSize : 0))
+        return -1;
+    if (by_time) {
+        Time::Read(body + *pos, start_time);
+        Time::Read(body + *pos + Time::kSize, stop_time);
+        *pos += 2 * Time::kSize;
+    }
+    if (speed_limit) {
+        schema::Word::Read(body + *pos, max_speed);
+        schema::Byte::Read(body + *pos + schema::Word::kSize, overspeed_time);
+        *pos += schema::Word::kSize + schema::Byte::kSize;
+    }
+    return 0;
+}
+
+// Parse the areas of a set circular/rectangle area message, the setting type (BYTE) and the number of areas (BYTE)
+// followed by the areas, each of a fixed head and the optional fields of AreaOptionsParse().
+template <typename HeadBody, typename Area>
+int AreasParse(InputBuffer in, MsgHead const& msg_head, uint8_t* setting_type, std::vector<Area>* areas) {
+    uint8_t const* body = nullptr;
+    size_t         size = 0;
+    if (MsgBodyLocate(in, msg_head, &body, &size) < 0 || size < 2 * schema::Byte::kSize)
+        return -1;
+    uint8_t cnt = 0;
+    schema::Byte::Read(body, setting_type);
+    schema::Byte::Read(body + schema::Byte::kSize, &cnt);
+    size_t pos = 2 * schema::Byte::kSize;
+    areas->clear();
+    for (uint8_t i = 0; i < cnt; ++i) {
+        Area area {};
+        int  used = HeadBody::Read(body + pos, size - pos, &area);
+        if (used < 0)
+            return -1;
+        pos += used;
+        if (AreaOptionsParse(body, size, &pos, area.area_attribute.bit.by_time, area.area_attribute.bit.speed_limit,
+                             &area.start_time, &area.stop_time, &area.max_speed, &area.overspeed_time) < 0) {
+            return -1;
+        }
+        areas->push_back(area);
+    }
+    return pos == size ? 0 : -1;
+}
+
 } // namespace
 
 // Command parser initialization.
@@ -74,16 +191,7 @@ int JT808FrameParserInit(Parser* parser) {
         kTerminalGeneralResponse, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            // if (para->msg_head.msgbody_attr.bit.package == 1)
-            //   pos = MSGBODY_PACKET_POS;
-            // Response flow number.
-            para->parse.respone_flow_num = in[pos] * 256 + in[pos + 1];
-            // Response message ID.
-            para->parse.respone_msg_id = in[pos + 2] * 256 + in[pos + 3];
-            // Response result.
-            para->parse.respone_result = in[pos + 4];
-            return 0;
+            return MsgBodyParse<GeneralResponseBody>(in, para->parse.msg_head, &para->parse);
         }));
 
     // 0x8001, Platform general response.
@@ -91,16 +199,7 @@ int JT808FrameParserInit(Parser* parser) {
         kPlatformGeneralResponse, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            // if (para->msg_head.msgbody_attr.bit.package == 1)
-            //   pos = MSGBODY_PACKET_POS;
-            // Response flow number.
-            para->parse.respone_flow_num = in[pos] * 256 + in[pos + 1];
-            // Response message ID.
-            para->parse.respone_msg_id = in[pos + 2] * 256 + in[pos + 3];
-            // Response result.
-            para->parse.respone_result = in[pos + 4];
-            return 0;
+            return MsgBodyParse<GeneralResponseBody>(in, para->parse.msg_head, &para->parse);
         }));
 
     // 0x0002, Terminal heartbeat.
@@ -117,27 +216,7 @@ int JT808FrameParserInit(Parser* parser) {
         kFillPacketRequest, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            uint16_t    pos     = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            auto& fill_packet = para->parse.fill_packet;
-            // First packet flow number.
-            fill_packet.first_packet_msg_flow_num = in[pos] * 256 + in[pos + 1];
-            pos += 2;
-            // Total number of retransmission packets.
-            uint16_t cnt = in[pos];
-            ++pos;
-            // Retransmission packet IDs.
-            if (msg_len - 3 != cnt * 2)
-                return -1;
-            fill_packet.packet_id.clear();
-            uint16_t id = 0;
-            for (uint8_t i = 0; i < cnt; ++i) {
-                id = in[pos + i * 2] + in[pos + 1 + i * 2];
-                fill_packet.packet_id.push_back(id);
-            }
-            return 0;
+            return MsgBodyParse<FillPacketBody>(in, para->parse.msg_head, &para->parse.fill_packet, true);
         }));
 
     // 0x0100, Terminal registration.
@@ -145,44 +224,7 @@ int JT808FrameParserInit(Parser* parser) {
         kTerminalRegister, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos           = MSGBODY_NOPACKET_POS;
-            auto&    register_info = para->parse.register_info;
-            // Province ID.
-            U16ToU8Array u16converter;
-            for (int i = 0; i < 2; ++i)
-                u16converter.u8array[i] = in[pos++];
-            register_info.province_id = EndianSwap16(u16converter.u16val);
-            // City/County ID.
-            for (int i = 0; i < 2; ++i)
-                u16converter.u8array[i] = in[pos++];
-            register_info.city_id = EndianSwap16(u16converter.u16val);
-            // Manufacturer ID.
-            register_info.manufacturer_id.clear();
-            for (size_t i = 0; i < 5; ++i)
-                register_info.manufacturer_id.push_back(in[pos + i]);
-            pos += 5;
-            // Terminal model.
-            for (size_t i = 0; i < 20; ++i) {
-                if (in[pos + i] == 0x0)
-                    break;
-                register_info.terminal_model.push_back(in[pos + i]);
-            }
-            pos += 20;
-            // Terminal ID.
-            for (size_t i = 0; i < 7; ++i) {
-                if (in[pos + i] == 0x0)
-                    break;
-                register_info.terminal_id.push_back(in[pos + i]);
-            }
-            pos += 7;
-            // Vehicle plate color and identifier.
-            register_info.car_plate_color = in[pos++];
-            if (register_info.car_plate_color != VehiclePlateColor::kVin) {
-                register_info.car_plate_num.clear();
-                size_t len = para->parse.msg_head.msgbody_attr.bit.msglen - 37;
-                register_info.car_plate_num.assign(in.begin() + pos, in.begin() + pos + len);
-            }
-            return 0;
+            return MsgBodyParse<RegisterBody>(in, para->parse.msg_head, &para->parse.register_info);
         }));
 
     // 0x8100, Terminal registration response.
@@ -190,17 +232,11 @@ int JT808FrameParserInit(Parser* parser) {
         kTerminalRegisterResponse, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            // Response flow number.
-            para->parse.respone_flow_num = in[pos] * 256 + in[pos + 1];
-            // Response result.
-            para->parse.respone_result = in[pos + 2];
-            // Parse the additional authentication code if the response result is 0 (success).
-            if (para->parse.respone_result == 0) {
-                auto begin = in.begin() + pos + 3;
-                auto end   = begin + para->parse.msg_head.msgbody_attr.bit.msglen - 3;
-                para->parse.authentication_code.assign(begin, end);
-            }
+            if (MsgBodyParse<RegisterResponseBody>(in, para->parse.msg_head, &para->parse) < 0)
+                return -1;
+            // The authentication code only follows a successful registration.
+            if (para->parse.respone_result != 0)
+                para->parse.authentication_code.clear();
             return 0;
         }));
 
@@ -218,14 +254,7 @@ int JT808FrameParserInit(Parser* parser) {
         kTerminalAuthentication, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            // Extract authentication code.
-            auto begin = in.begin() + pos;
-            auto end   = begin + para->parse.msg_head.msgbody_attr.bit.msglen;
-            para->parse.authentication_code.assign(begin, end);
-            return 0;
+            return MsgBodyParse<AuthenticationBody>(in, para->parse.msg_head, &para->parse.authentication_code);
         }));
 
     // 0x8103, Set terminal parameters.
@@ -237,27 +266,11 @@ int JT808FrameParserInit(Parser* parser) {
             if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
                 pos = MSGBODY_PACKET_POS;
             auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len < 1)
-                return -1;
-            // Total number of parameters set.
-            uint8_t cnt = in[pos];
-            ++pos;
-            U32ToU8Array u32converter;
-            // Parameter items set.
-            uint32_t             id = 0;
-            std::vector<uint8_t> value;
-            auto&                paras = para->parse.terminal_parameters;
-            paras.clear();
-            for (int i = 0; i < cnt; ++i) {
-                // Parameter ID.
-                memcpy(u32converter.u8array, &(in[pos]), 4);
-                id = EndianSwap32(u32converter.u32val);
-                pos += 4;
-                // Parameter value.
-                value.assign(in.begin() + pos + 1, in.begin() + pos + 1 + in[pos]);
-                paras.insert({id, value});
-                pos += 1 + in[pos];
-            }
+            if (msg_len < 1 || in.size() < pos + msg_len + 2u)
+                return -1;
+            // Total number of parameters set and parameter items.
+            if (para->parse.terminal_parameter_store.Decode(&(in[pos]), msg_len) < 0)
+                return -1;
             return 0;
         }));
 
@@ -277,27 +290,8 @@ int JT808FrameParserInit(Parser* parser) {
         kGetSpecificTerminalParameters, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len < 1)
-                return -1;
-            // Total number of parameter IDs.
-            uint8_t cnt = in[pos++];
-            if (msg_len != cnt * 4 + 1)
-                return -1;
-            // Parameter ID parsing.
-            uint32_t     id = 0;
-            U32ToU8Array u32converter;
-            para->parse.terminal_parameter_ids.clear();
-            for (uint8_t i = 0; i < cnt; ++i) {
-                memcpy(u32converter.u8array, &(in[pos]), 4);
-                id = EndianSwap32(u32converter.u32val);
-                para->parse.terminal_parameter_ids.push_back(id);
-                pos += 4;
-            }
-            return 0;
+            return MsgBodyParse<TerminalParameterIdsBody>(in, para->parse.msg_head, &para->parse.terminal_parameter_ids,
+                                                          true);
         }));
 
     // 0x0104, Query terminal parameters response.
@@ -309,7 +303,7 @@ int JT808FrameParserInit(Parser* parser) {
             if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
                 pos = MSGBODY_PACKET_POS;
             auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len < 3)
+            if (msg_len < 3 || in.size() < pos + msg_len + 2u)
                 return -1;
             // Response flow number.
             U16ToU8Array u16converter;
@@ -317,25 +311,8 @@ int JT808FrameParserInit(Parser* parser) {
             para->parse.respone_flow_num = EndianSwap16(u16converter.u16val);
             pos += 2;
             // The following content is consistent with the parsing of setting terminal parameters.
-            // Total number of parameters set.
-            uint8_t cnt = in[pos];
-            ++pos;
-            U32ToU8Array u32converter;
-            // Parameter items set.
-            uint32_t             id = 0;
-            std::vector<uint8_t> value;
-            auto&                paras = para->parse.terminal_parameters;
-            paras.clear();
-            for (int i = 0; i < cnt; ++i) {
-                // Parameter ID.
-                memcpy(u32converter.u8array, &(in[pos]), 4);
-                id = EndianSwap32(u32converter.u32val);
-                pos += 4;
-                // Parameter value.
-                value.assign(in.begin() + pos + 1, in.begin() + pos + 1 + in[pos]);
-                paras.insert({id, value});
-                pos += 1 + in[pos];
-            }
+            if (para->parse.terminal_parameter_store.Decode(&(in[pos]), msg_len - 2) < 0)
+                return -1;
             return 0;
         }));
 
@@ -344,35 +321,7 @@ int JT808FrameParserInit(Parser* parser) {
         kTerminalUpgrade, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            uint16_t    pos     = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            uint16_t beg          = pos;
-            auto&    upgrade_info = para->parse.upgrade_info;
-            // Upgrade type.
-            upgrade_info.upgrade_type = in[pos++];
-            // Manufacturer ID.
-            upgrade_info.manufacturer_id.clear();
-            for (int i = 0; i < 5; ++i) {
-                upgrade_info.manufacturer_id.push_back(in[pos++]);
-            }
-            // Upgrade version number.
-            upgrade_info.version_id.clear();
-            for (int i = 0; i < in[pos]; ++i) {
-                upgrade_info.version_id.push_back(static_cast<char>(in[pos + i + 1]));
-            }
-            pos += in[pos] + 1;
-            // Total length of the upgrade package.
-            upgrade_info.upgrade_data_total_len =
-                in[pos] * 65536 * 256 + in[pos + 1] * 65536 + in[pos + 2] * 256 + in[pos + 3];
-            // Upgrade data package content.
-            pos += 4;
-            uint16_t content_len = msg_len - (pos - beg);
-            if (content_len + 9 + upgrade_info.version_id.size() > msg_len)
-                return -1;
-            upgrade_info.upgrade_data.assign(in.begin() + pos, in.begin() + pos + content_len);
-            return 0;
+            return MsgBodyParse<UpgradeBody>(in, para->parse.msg_head, &para->parse.upgrade_info);
         }));
 
     // 0x0108, Terminal upgrade result notification.
@@ -380,68 +329,59 @@ int JT808FrameParserInit(Parser* parser) {
         kTerminalUpgradeResultReport, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            auto& upgrade_info = para->parse.upgrade_info;
-            // Upgrade type.
-            upgrade_info.upgrade_type = in[pos++];
-            // Upgrade result.
-            upgrade_info.upgrade_result = in[pos++];
-            return 0;
+            return MsgBodyParse<UpgradeResultBody>(in, para->parse.msg_head, &para->parse.upgrade_info);
         }));
 
     // 0x0200, Location information report.
     parser->insert(std::pair<uint16_t, ParseHandler>(
         kLocationReport, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
+                return -1;
+            uint8_t const* body = nullptr;
+            size_t         size = 0;
+            if (MsgBodyLocate(in, para->parse.msg_head, &body, &size) < 0)
+                return -1;
+            return LocationReportBodyParse(body, size, &para->parse.location_info, &para->parse.location_extension,
+                                           &para->parse.location_time_cache);
+        }));
+
+    // 0x0704, Batch location data upload.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kBatchLocationReport, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
             auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len < 28)
+            if (msg_len < 3)
                 return -1;
             uint16_t pos = MSGBODY_NOPACKET_POS;
             if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
                 pos = MSGBODY_PACKET_POS;
-            auto&        basic_info     = para->parse.location_info;
-            auto&        extension_info = para->parse.location_extension;
-            U32ToU8Array u32converter;
-            // Alarm flag.
-            memcpy(u32converter.u8array, &(in[pos]), 4);
-            basic_info.alarm.value = EndianSwap32(u32converter.u32val);
-            // Status.
-            memcpy(u32converter.u8array, &(in[pos + 4]), 4);
-            basic_info.status.value = EndianSwap32(u32converter.u32val);
-            // Latitude.
-            memcpy(u32converter.u8array, &(in[pos + 8]), 4);
-            basic_info.latitude = EndianSwap32(u32converter.u32val);
-            // Longitude.
-            memcpy(u32converter.u8array, &(in[pos + 12]), 4);
-            basic_info.longitude = EndianSwap32(u32converter.u32val);
-            U16ToU8Array u16converter;
-            // Altitude.
-            memcpy(u16converter.u8array, &(in[pos + 16]), 2);
-            basic_info.altitude = EndianSwap16(u16converter.u16val);
-            // Speed.
-            memcpy(u16converter.u8array, &(in[pos + 18]), 2);
-            basic_info.speed = EndianSwap16(u16converter.u16val);
-            // Bearing.
-            memcpy(u16converter.u8array, &(in[pos + 20]), 2);
-            basic_info.bearing = EndianSwap16(u16converter.u16val);
-            // UTC time (BCD-8421 code).
-            std::vector<uint8_t> bcd;
-            bcd.assign(in.begin() + pos + 22, in.begin() + pos + 28);
-            BcdToStringFillZero(bcd, &basic_info.time);
-            if (msg_len > 28) { // Location additional information items.
-                uint8_t end = msg_len + pos;
-                pos += 28;
-                std::vector<uint8_t> item_content;
-                while (pos <= end - 2) { // Additional information length is at least 1.
-                    if (pos + 1 + in[pos + 1] > end)
-                        return -1; // Additional information length exceeds the range.
-                    item_content.assign(in.begin() + pos + 2, in.begin() + pos + 2 + in[pos + 1]);
-                    extension_info[in[pos]] = item_content;
-                    pos += 2 + in[pos + 1];
+            uint16_t end = pos + msg_len;
+            if (in.size() < end + 2u)
+                return -1;
+            auto& batch_loc = para->parse.batch_loc;
+            // Number of data items.
+            batch_loc.nbr_of_dat = in[pos] * 256 + in[pos + 1];
+            // Location data type.
+            batch_loc.data_type = in[pos + 2];
+            batch_loc.loc_info.clear();
+            batch_loc.loc_ext.clear();
+            pos += 3;
+            for (uint16_t i = 0; i < batch_loc.nbr_of_dat; ++i) {
+                // Location report data body length.
+                if (pos + 2 > end)
+                    return -1;
+                uint16_t len = in[pos] * 256 + in[pos + 1];
+                pos += 2;
+                if (len < 28 || pos + len > end)
+                    return -1;
+                batch_loc.loc_info.push_back(LocationBasicInformation());
+                batch_loc.loc_ext.push_back(LocationExtensions());
+                if (LocationReportBodyParse(&in[pos], len, &batch_loc.loc_info.back(), &batch_loc.loc_ext.back(),
+                                            &para->parse.location_time_cache) != 0) {
+                    return -1;
                 }
+                pos += len;
             }
             return 0;
         }));
@@ -459,59 +399,17 @@ int JT808FrameParserInit(Parser* parser) {
     parser->insert(std::pair<uint16_t, ParseHandler>(
         kGetLocationInformationResponse, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
-                return -100;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len < 30)
-                return -101;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
+                return -1;
+            uint8_t const* body = nullptr;
+            size_t         size = 0;
+            if (MsgBodyLocate(in, para->parse.msg_head, &body, &size) < 0 || size < schema::Word::kSize)
+                return -1;
             // Response flow number.
-            para->parse.respone_flow_num = in[pos] * 256 + in[pos];
-            pos += 2;
+            schema::Word::Read(body, &para->parse.respone_flow_num);
             // The following is the location information report content.
-            auto&        basic_info     = para->parse.location_info;
-            auto&        extension_info = para->parse.location_extension;
-            U32ToU8Array u32converter;
-            // Alarm flag.
-            memcpy(u32converter.u8array, &(in[pos]), 4);
-            basic_info.alarm.value = EndianSwap32(u32converter.u32val);
-            // Status.
-            memcpy(u32converter.u8array, &(in[pos + 4]), 4);
-            basic_info.status.value = EndianSwap32(u32converter.u32val);
-            // Latitude.
-            memcpy(u32converter.u8array, &(in[pos + 8]), 4);
-            basic_info.latitude = EndianSwap32(u32converter.u32val);
-            // Longitude.
-            memcpy(u32converter.u8array, &(in[pos + 12]), 4);
-            basic_info.longitude = EndianSwap32(u32converter.u32val);
-            U16ToU8Array u16converter;
-            // Altitude.
-            memcpy(u16converter.u8array, &(in[pos + 16]), 2);
-            basic_info.altitude = EndianSwap16(u16converter.u16val);
-            // Speed.
-            memcpy(u16converter.u8array, &(in[pos + 18]), 2);
-            basic_info.speed = EndianSwap16(u16converter.u16val);
-            // Bearing.
-            memcpy(u16converter.u8array, &(in[pos + 20]), 2);
-            basic_info.bearing = EndianSwap16(u16converter.u16val);
-            // UTC time (BCD-8421 code).
-            std::vector<uint8_t> bcd;
-            bcd.assign(in.begin() + pos + 22, in.begin() + pos + 28);
-            BcdToStringFillZero(bcd, &basic_info.time);
-            if (msg_len > 30) { // Location additional information items.
-                uint8_t end = msg_len + pos - 2;
-                pos += 28;
-                std::vector<uint8_t> item_content;
-                while (pos <= end - 2) { // Additional information length is at least 1.
-                    if (pos + 1 + in[pos + 1] > end)
-                        return -102; // Additional information length exceeds the range.
-                    item_content.assign(in.begin() + pos + 2, in.begin() + pos + 2 + in[pos + 1]);
-                    extension_info[in[pos]] = item_content;
-                    pos += 2 + in[pos + 1];
-                }
-            }
-            return 0;
+            return LocationReportBodyParse(body + schema::Word::kSize, size - schema::Word::kSize,
+                                           &para->parse.location_info, &para->parse.location_extension,
+                                           &para->parse.location_time_cache);
         }));
 
     // 0x8202, Temporary location tracking control.
@@ -519,21 +417,42 @@ int JT808FrameParserInit(Parser* parser) {
         kLocationTrackingControl, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len != 6)
+            return MsgBodyParse<LocationTrackingControlBody>(in, para->parse.msg_head,
+                                                             &para->parse.location_tracking_control, true);
+        }));
+
+    // 0x8600, Set circular area.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kSetCircularArea, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            auto& ctrl = para->parse.location_tracking_control;
-            // Location information reporting interval during tracking.
-            ctrl.interval = in[pos] * 256 + in[pos + 1];
-            pos += 2;
-            // Tracking valid time.
-            U32ToU8Array u32converter;
-            memcpy(u32converter.u8array, &(in[pos]), 4);
-            ctrl.tracking_time = EndianSwap32(u32converter.u32val);
-            return 0;
+            return AreasParse<CircularAreaHeadBody>(in, para->parse.msg_head, &para->parse.area_setting_type,
+                                                    &para->parse.circular_areas);
+        }));
+
+    // 0x8601, Delete circular area.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kDeleteCircularArea, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
+                return -1;
+            return MsgBodyParse<AreaIdsBody>(in, para->parse.msg_head, &para->parse.circular_area_id, true);
+        }));
+
+    // 0x8602, Set rectangle area.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kSetRectangleArea, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
+                return -1;
+            return AreasParse<RectangleAreaHeadBody>(in, para->parse.msg_head, &para->parse.area_setting_type,
+                                                     &para->parse.rectangle_areas);
+        }));
+
+    // 0x8603, Delete rectangle area.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kDeleteRectangleArea, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
+                return -1;
+            return MsgBodyParse<AreaIdsBody>(in, para->parse.msg_head, &para->parse.rectangle_area_id, true);
         }));
 
     // 0x08604, Set polygon area.
@@ -541,62 +460,25 @@ int JT808FrameParserInit(Parser* parser) {
         kSetPolygonArea, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            if (msg_len < 28)
+            uint8_t const* body = nullptr;
+            size_t         size = 0;
+            if (MsgBodyLocate(in, para->parse.msg_head, &body, &size) < 0)
+                return -1;
+            auto& polygon_area = para->parse.polygon_area;
+            // Area ID and area attributes.
+            int used = PolygonAreaHeadBody::Read(body, size, &polygon_area);
+            if (used < 0)
+                return -1;
+            size_t pos = used;
+            // Start and stop time, speed limit, enabled only if the relevant flags in area attributes are set to 1.
+            if (AreaOptionsParse(body, size, &pos, polygon_area.area_attribute.bit.by_time,
+                                 polygon_area.area_attribute.bit.speed_limit, &polygon_area.start_time,
+                                 &polygon_area.stop_time, &polygon_area.max_speed, &polygon_area.overspeed_time) < 0) {
                 return -1;
-            uint16_t pos = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            uint16_t     end          = pos + msg_len;
-            auto&        polygon_area = para->parse.polygon_area;
-            U16ToU8Array u16converter;
-            U32ToU8Array u32converter;
-            // Area ID.
-            memcpy(u32converter.u8array, &(in[pos]), 4);
-            polygon_area.area_id = EndianSwap32(u32converter.u32val);
-            pos += 4;
-            // Area attributes.
-            memcpy(u16converter.u8array, &(in[pos]), 2);
-            polygon_area.area_attribute.value = EndianSwap16(u16converter.u16val);
-            pos += 2;
-            // Start time, enabled only if the relevant flag in area attributes is set to 1.
-            if (polygon_area.area_attribute.bit.by_time) {
-                std::vector<uint8_t> bcd;
-                bcd.assign(in.begin() + pos, in.begin() + pos);
-                BcdToStringFillZero(bcd, &polygon_area.start_time);
-                pos += 6;
-                bcd.assign(in.begin() + pos, in.begin() + pos);
-                BcdToStringFillZero(bcd, &polygon_area.stop_time);
-                pos += 6;
-            }
-            // Speed limit, enabled only if the relevant flag in area attributes is set to 1.
-            if (polygon_area.area_attribute.bit.speed_limit) {
-                memcpy(u16converter.u8array, &(in[pos]), 2);
-                polygon_area.max_speed = EndianSwap16(u16converter.u16val);
-                pos += 2;
-                polygon_area.overspeed_time = in[pos];
-                ++pos;
-            }
-            // Number of vertices.
-            memcpy(u16converter.u8array, &(in[pos]), 2);
-            uint16_t cnt = EndianSwap16(u16converter.u16val);
-            pos += 2;
-            // Check the length of the subsequent content.
-            if (end - pos != cnt * 8)
-                return -1;
-            LocationPoint location_point {};
-            polygon_area.vertices.clear();
-            // All vertex latitudes and longitudes.
-            while (pos < end) {
-                memcpy(u32converter.u8array, &(in[pos]), 4);
-                location_point.latitude = EndianSwap32(u32converter.u32val) * 1e-6;
-                pos += 4;
-                memcpy(u32converter.u8array, &(in[pos]), 4);
-                location_point.longitude = EndianSwap32(u32converter.u32val) * 1e-6;
-                pos += 4;
-                polygon_area.vertices.push_back(location_point);
             }
-            return 0;
+            // Number of vertices and all vertex latitudes and longitudes, up to the end of the body.
+            used = PolygonVerticesBody::Read(body + pos, size - pos, &polygon_area.vertices);
+            return used < 0 || pos + used != size ? -1 : 0;
         }));
 
     // 0x08605, Delete polygon area.
@@ -604,23 +486,69 @@ int JT808FrameParserInit(Parser* parser) {
         kDeletePolygonArea, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            uint16_t    pos     = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            // Number of areas to delete.
-            uint8_t cnt = in[pos];
-            if (cnt * 4 + 1 != msg_len)
-                return -1;
-            auto& polygon_area_id = para->parse.polygon_area_id;
-            polygon_area_id.clear();
-            U32ToU8Array u32converter;
-            // All area IDs to delete.
-            for (uint8_t i = 0; i < cnt; ++i) {
-                memcpy(u32converter.u8array, &(in[pos + 1 + i * 4]), 4);
-                polygon_area_id.push_back(EndianSwap32(u32converter.u32val));
+            return MsgBodyParse<AreaIdsBody>(in, para->parse.msg_head, &para->parse.polygon_area_id, true);
+        }));
+
+    // 0x8606, Set route.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kSetRoute, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
+                return -1;
+            uint8_t const* body = nullptr;
+            size_t         size = 0;
+            if (MsgBodyLocate(in, para->parse.msg_head, &body, &size) < 0)
+                return -1;
+            auto& route = para->parse.route;
+            // Route ID and route attributes.
+            int used = RouteHeadBody::Read(body, size, &route);
+            if (used < 0)
+                return -1;
+            size_t pos = used;
+            // Start and stop time, enabled only if the relevant flag in route attributes is set to 1.
+            uint16_t unused_speed = 0;
+            uint8_t  unused_time  = 0;
+            if (AreaOptionsParse(body, size, &pos, route.route_attribute.bit.by_time, false, &route.start_time,
+                                 &route.stop_time, &unused_speed, &unused_time) < 0) {
+                return -1;
             }
-            return 0;
+            // Number of turning points.
+            if (size - pos < schema::Word::kSize)
+                return -1;
+            uint16_t cnt = 0;
+            schema::Word::Read(body + pos, &cnt);
+            pos += schema::Word::kSize;
+            route.turning_points.clear();
+            for (uint16_t i = 0; i < cnt; ++i) {
+                RouteTurningPoint point {};
+                used = TurningPointHeadBody::Read(body + pos, size - pos, &point);
+                if (used < 0)
+                    return -1;
+                pos += used;
+                // Driving time thresholds, enabled only if the relevant flag in road section attributes is set to 1.
+                if (point.road_section_attribute.bit.driving_time) {
+                    used = TurningPointDrivingTimeBody::Read(body + pos, size - pos, &point);
+                    if (used < 0)
+                        return -1;
+                    pos += used;
+                }
+                // Speed limit, enabled only if the relevant flag in road section attributes is set to 1.
+                if (point.road_section_attribute.bit.speed_limit) {
+                    used = TurningPointSpeedLimitBody::Read(body + pos, size - pos, &point);
+                    if (used < 0)
+                        return -1;
+                    pos += used;
+                }
+                route.turning_points.push_back(point);
+            }
+            return pos == size ? 0 : -1;
+        }));
+
+    // 0x8607, Delete route.
+    parser->insert(std::pair<uint16_t, ParseHandler>(
+        kDeleteRoute, [](InputBuffer in, ProtocolParameter* para) -> int {
+            if (para == nullptr)
+                return -1;
+            return MsgBodyParse<AreaIdsBody>(in, para->parse.msg_head, &para->parse.route_id, true);
         }));
 
     // 0x0801, Multimedia data upload.
@@ -628,25 +556,7 @@ int JT808FrameParserInit(Parser* parser) {
         kMultimediaDataUpload, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            uint16_t    pos     = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            U32ToU8Array u32converter;
-            // Multimedia ID.
-            memcpy(u32converter.u8array, in.data() + pos, 4);
-            para->parse.multimedia_upload.media_id = EndianSwap32(u32converter.u32val);
-            // Multimedia type.
-            para->parse.multimedia_upload.media_type = in[pos + 4];
-            // Multimedia format.
-            para->parse.multimedia_upload.media_format = in[pos + 5];
-            // Event item.
-            para->parse.multimedia_upload.media_event = in[pos + 6];
-            // Channel ID.
-            para->parse.multimedia_upload.channel_id = in[pos + 7];
-            para->parse.multimedia_upload.loaction_report_body.assign(in.begin() + pos + 8, in.begin() + pos + 36);
-            para->parse.multimedia_upload.media_data.assign(in.begin() + pos + 36, in.begin() + pos + msg_len);
-            return 0;
+            return MsgBodyParse<MultimediaUploadBody>(in, para->parse.msg_head, &para->parse.multimedia_upload);
         }));
 
     // 0x8800, Multimedia data upload response.
@@ -654,26 +564,8 @@ int JT808FrameParserInit(Parser* parser) {
         kMultimediaDataUploadResponse, [](InputBuffer in, ProtocolParameter* para) -> int {
             if (para == nullptr)
                 return -1;
-            auto const& msg_len = para->parse.msg_head.msgbody_attr.bit.msglen;
-            uint16_t    pos     = MSGBODY_NOPACKET_POS;
-            if (para->parse.msg_head.msgbody_attr.bit.packet == 1)
-                pos = MSGBODY_PACKET_POS;
-            U32ToU8Array u32converter;
-            // Multimedia ID.
-            memcpy(u32converter.u8array, in.data() + pos, 4);
-            para->parse.multimedia_upload_response.media_id = EndianSwap32(u32converter.u32val);
-            // Check if retransmission is needed.
-            if (msg_len > 4) {
-                U16ToU8Array u16converter;
-                para->parse.multimedia_upload_response.reload_packet_ids.clear();
-                int   cnt = in[pos + 4];
-                auto& ids = para->parse.multimedia_upload_response.reload_packet_ids;
-                for (int i = 0; i < cnt; ++i) {
-                    memcpy(u16converter.u8array, &(in[pos + 5 + 2 * i]), 2);
-                    ids.push_back(EndianSwap16(u16converter.u16val));
-                }
-            }
-            return 0;
+            return MsgBodyParse<MultimediaUploadResponseBody>(in, para->parse.msg_head,
+                                                              &para->parse.multimedia_upload_response);
         }));
 
     return 0;
@@ -717,21 +609,33 @@ bool JT808FrameParserOverride(Parser* parser, uint16_t const& msg_id, ParseHandl
  * @param para The protocol parameter structure pointer to store parsed data.
  * @return int Returns 0 on success, -1 on failure.
  */
-std::error_code JT808FrameParse(Parser const& parser, InputBuffer in, ProtocolParameter* para) {
+namespace {
+
+// Reverse escape a frame, check it and parse its message header.
+ParserError JT808FrameUnpack(InputBuffer in, std::vector<uint8_t>* out, ProtocolParameter* para) {
     if (para == nullptr)
-        return make_error_code(ParserError::ParametersNull);
-    std::vector<uint8_t> out;
-    out.reserve(in.size());
+        return ParserError::ParametersNull;
+    out->reserve(in.size());
     // Reverse escape.
-    if (ReverseEscape(in, out) < 0)
-        return make_error_code(ParserError::UnesapingError);
+    if (ReverseEscape(in, *out) < 0)
+        return ParserError::UnesapingError;
     // XOR checksum check.
-    if (BccCheckSum(&(out[1]), out.size() - 3) != *(out.end() - 2))
-        return make_error_code(ParserError::ChecksumError);
+    if (BccCheckSum(&((*out)[1]), out->size() - 3) != *(out->end() - 2))
+        return ParserError::ChecksumError;
     // Parse message header.
-    if (JT808FrameHeadParse(out, &para->parse.msg_head) != 0)
-        return make_error_code(ParserError::HeaderParseError);
+    if (JT808FrameHeadParse(*out, &para->parse.msg_head) != 0)
+        return ParserError::HeaderParseError;
     para->msg_head.phone_num = para->parse.msg_head.phone_num;
+    return ParserError::Ok;
+}
+
+} // namespace
+
+std::error_code JT808FrameParse(Parser const& parser, InputBuffer in, ProtocolParameter* para) {
+    std::vector<uint8_t> out;
+    auto                 error = JT808FrameUnpack(in, &out, para);
+    if (error != ParserError::Ok)
+        return make_error_code(error);
     // Parse message content.
     auto it = parser.find(para->parse.msg_head.msg_id);
     if (it == parser.end())
@@ -739,4 +643,151 @@ std::error_code JT808FrameParse(Parser const& parser, InputBuffer in, ProtocolPa
     return std::error_code(it->second(out, para), parser_category());
 }
 
+int JT808SegmentedParserInit(SegmentedParser* parser) {
+    if (parser == nullptr)
+        return -1;
+    if (!parser->empty())
+        parser->clear();
+
+    // 0x0801, Multimedia data upload.
+    parser->insert(std::pair<uint16_t, SegmentedParseHandler>(
+        kMultimediaDataUpload, [](ScatterList const& body, ProtocolParameter* para) -> int {
+            if (para == nullptr || body.segments.empty())
+                return -1;
+            // The 36 bytes of fields before the multimedia data, in the first packet.
+            auto&   media = para->parse.multimedia_upload;
+            uint8_t head[36];
+            if (body.Read(0, sizeof(head), head) < 0 || MultimediaUploadBody::Read(head, sizeof(head), &media) < 0)
+                return -1;
+            // Multimedia data. Packets repeating the fields of the first packet, as sent by some terminals, have them
+            // skipped.
+            auto const& first = body.segments.front();
+            media.media_data.clear();
+            media.media_data.reserve(body.size - sizeof(head));
+            media.media_data.insert(media.media_data.end(), first.data + sizeof(head), first.data + first.size);
+            for (size_t i = 1; i < body.segments.size(); ++i) {
+                auto const& segment = body.segments[i];
+                size_t      skip    = 0;
+                if (segment.size >= sizeof(head) && memcmp(segment.data, first.data, sizeof(head)) == 0)
+                    skip = sizeof(head);
+                media.media_data.insert(media.media_data.end(), segment.data + skip, segment.data + segment.size);
+            }
+            return 0;
+        }));
+
+    // 0x8108, Terminal upgrade package.
+    parser->insert(std::pair<uint16_t, SegmentedParseHandler>(
+        kTerminalUpgrade, [](ScatterList const& body, ProtocolParameter* para) -> int {
+            if (para == nullptr || body.segments.empty())
+                return -1;
+            // The fields before the upgrade data, in the first packet: upgrade type, manufacturer ID, version ID
+            // length, version ID and upgrade data length.
+            uint8_t head[11 + UINT8_MAX];
+            if (body.Read(0, 7, head) < 0)
+                return -1;
+            size_t const head_size = 11 + head[6];
+            auto&        info      = para->parse.upgrade_info;
+            if (body.Read(0, head_size, head) < 0 || UpgradeBody::Read(head, head_size, &info) < 0)
+                return -1;
+            // Upgrade data. Packets repeating the fields of the first packet, as sent by some platforms, have them
+            // skipped.
+            auto const& first = body.segments.front();
+            info.upgrade_data.clear();
+            info.upgrade_data.reserve(body.size - head_size);
+            info.upgrade_data.insert(info.upgrade_data.end(), first.data + head_size, first.data + first.size);
+            for (size_t i = 1; i < body.segments.size(); ++i) {
+                auto const& segment = body.segments[i];
+                size_t      skip    = 0;
+                if (segment.size >= head_size && memcmp(segment.data, first.data, head_size) == 0)
+                    skip = head_size;
+                info.upgrade_data.insert(info.upgrade_data.end(), segment.data + skip, segment.data + segment.size);
+            }
+            return 0;
+        }));
+
+    return 0;
+}
+
+std::error_code JT808FrameParse(Parser const& parser, SegmentedParser const& segmented_parser,
+                                Reassembler* reassembler, InputBuffer in, int64_t const& now_ms,
+                                ProtocolParameter* para, std::vector<uint8_t>* body, RawBodyPredicate const& raw) {
+    if (body != nullptr)
+        body->clear();
+    std::vector<uint8_t> out;
+    auto                 error = JT808FrameUnpack(in, &out, para);
+    if (error != ParserError::Ok)
+        return make_error_code(error);
+    auto const& msg_head  = para->parse.msg_head;
+    bool const  raw_body  = body != nullptr && raw && raw(msg_head.msg_id);
+    bool const  take_body = body != nullptr && (raw_body || !raw);
+    auto        it        = segmented_parser.find(msg_head.msg_id);
+    auto        handler   = parser.find(msg_head.msg_id);
+    if (reassembler == nullptr || msg_head.msgbody_attr.bit.packet == 0 ||
+        (!raw_body && it == segmented_parser.end() && handler == parser.end())) {
+        // Parse message content.
+        std::error_code ret;
+        if (!raw_body) {
+            if (handler == parser.end())
+                return make_error_code(ParserError::UnregisteredMessageParser);
+            ret = std::error_code(handler->second(out, para), parser_category());
+        }
+        uint8_t const* data = nullptr;
+        size_t         size = 0;
+        if (!ret && take_body) {
+            if (MsgBodyLocate(out, msg_head, &data, &size) == 0) {
+                // The body is moved to the front of the unpacked frame, which is handed out.
+                size_t const offset = data - out.data();
+                out.erase(out.begin(), out.begin() + offset);
+                out.resize(size);
+                body->swap(out);
+            }
+            else if (raw_body) {
+                ret = make_error_code(ParserError::MiscError);
+            }
+        }
+        return ret;
+    }
+    uint8_t const* data = nullptr;
+    size_t         size = 0;
+    if (MsgBodyLocate(out, msg_head, &data, &size) < 0)
+        return make_error_code(ParserError::ReassemblyError);
+    ScatterList message;
+    switch (reassembler->Add(msg_head, data, size, now_ms, &message)) {
+        case kReassemblyPending:
+        case kReassemblyDuplicate:
+            return make_error_code(ParserError::PacketPending);
+        case kReassemblyRejected:
+            return make_error_code(ParserError::ReassemblyError);
+        case kReassemblyComplete:
+            break;
+    }
+    if (raw_body) {
+        message.Append(0, body);
+        return make_error_code(ParserError::Ok);
+    }
+    if (it != segmented_parser.end()) {
+        std::error_code ret(it->second(message, para), parser_category());
+        if (!ret && take_body)
+            message.Append(0, body);
+        return ret;
+    }
+    // Without a segmented handler the body is copied behind the header of the last packet, as in an unsegmented
+    // frame, for the handler of its message ID.
+    if (message.size > kMaxFrameBodyLength)
+        return make_error_code(ParserError::ReassemblyError);
+    auto& attr      = para->parse.msg_head.msgbody_attr;
+    attr.bit.packet = 0;
+    attr.bit.msglen = static_cast<uint16_t>(message.size);
+    out[3]          = static_cast<uint8_t>(attr.u16val >> 8);
+    out[4]          = static_cast<uint8_t>(attr.u16val);
+    out.resize(MSGBODY_NOPACKET_POS);
+    message.Append(0, &out);
+    out.push_back(BccCheckSum(out.data() + 1, out.size() - 1));
+    out.push_back(PROTOCOL_SIGN);
+    std::error_code ret(handler->second(out, para), parser_category());
+    if (!ret && take_body)
+        body->assign(out.begin() + MSGBODY_NOPACKET_POS, out.end() - 2);
+    return ret;
+}
+
 } // namespace libjt808
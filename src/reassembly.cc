@@ -0,0 +1,341 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  reassembly.cc
+// @Version :  1.0
+// @Time    :  2026/10/22 09:48:15
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/reassembly.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Read size bytes in big endian at *pos and advance it. Returns 0 on success, -1 past end.
+int ReadBigEndian(uint8_t const* data, size_t const& end, size_t const& size, size_t* pos, uint64_t* value) {
+    if (end - *pos < size)
+        return -1;
+    *value = GetBigEndian(data + *pos, size);
+    *pos += size;
+    return 0;
+}
+
+} // namespace
+
+constexpr uint32_t Reassembler::kMissing;
+constexpr size_t   Reassembler::kReserveLimit;
+
+int ScatterList::Read(size_t const& offset, size_t const& len, uint8_t* out) const {
+    if (offset > size || len > size - offset)
+        return -1;
+    size_t skip = offset;
+    size_t left = len;
+    for (auto const& segment : segments) {
+        if (left == 0)
+            break;
+        if (skip >= segment.size) {
+            skip -= segment.size;
+            continue;
+        }
+        size_t count = std::min(segment.size - skip, left);
+        memcpy(out, segment.data + skip, count);
+        out += count;
+        left -= count;
+        skip = 0;
+    }
+    return 0;
+}
+
+void ScatterList::Append(size_t const& offset, std::vector<uint8_t>* out) const {
+    if (offset >= size)
+        return;
+    out->reserve(out->size() + size - offset);
+    size_t skip = offset;
+    for (auto const& segment : segments) {
+        if (skip >= segment.size) {
+            skip -= segment.size;
+            continue;
+        }
+        out->insert(out->end(), segment.data + skip, segment.data + segment.size);
+        skip = 0;
+    }
+}
+
+void Reassembler::MakeKey(std::string const& phone_num, uint16_t const& msg_id, uint16_t const& first_flow_num,
+                          std::string* key) {
+    key->assign(phone_num);
+    key->push_back('\0');
+    key->push_back(static_cast<char>(msg_id >> 8));
+    key->push_back(static_cast<char>(msg_id));
+    key->push_back(static_cast<char>(first_flow_num >> 8));
+    key->push_back(static_cast<char>(first_flow_num));
+}
+
+bool Reassembler::IsRecent(std::string const& key) const {
+    return std::find(recent_.begin(), recent_.end(), key) != recent_.end();
+}
+
+bool Reassembler::MakeRoom(size_t const& count, Message const* keep) {
+    if (count > options_.max_bytes)
+        return false;
+    while (bytes_ + count > options_.max_bytes || (keep == nullptr && index_.size() >= options_.max_messages)) {
+        auto it = messages_.begin();
+        if (it != messages_.end() && &*it == keep)
+            ++it;
+        if (it == messages_.end())
+            return keep == nullptr;
+        Drop(it);
+    }
+    return true;
+}
+
+void Reassembler::Drop(Messages::iterator it) {
+    bytes_ -= it->data.size();
+    index_.erase(it->key);
+    messages_.erase(it);
+    ++dropped_;
+}
+
+void Reassembler::RequestFill(Messages::iterator it, int64_t const& now_ms, std::vector<FillRequest>* requests) {
+    FillRequest request;
+    request.phone_num                             = it->phone_num;
+    request.msg_id                                = it->msg_id;
+    request.fill_packet.first_packet_msg_flow_num = it->first_flow_num;
+    // The 0x8003 body holds up to 255 packet IDs, the rest are requested on the next timeout.
+    for (size_t i = 0; i < it->offsets.size() && request.fill_packet.packet_id.size() < UINT8_MAX; ++i) {
+        if (it->offsets[i] == kMissing)
+            request.fill_packet.packet_id.push_back(static_cast<uint16_t>(i + 1));
+    }
+    requests->push_back(std::move(request));
+    ++it->fill_requests;
+    it->last_ms = now_ms;
+    messages_.splice(messages_.end(), messages_, it);
+}
+
+ReassemblyStatus Reassembler::Add(MsgHead const& msg_head, uint8_t const* body, size_t const& size,
+                                  int64_t const& now_ms, ScatterList* message) {
+    done_.clear();
+    auto const& total = msg_head.total_packet;
+    auto const& seq   = msg_head.packet_seq;
+    if (message == nullptr || (body == nullptr && size > 0) || size > UINT16_MAX || total == 0 || seq == 0 ||
+        seq > total) {
+        return kReassemblyRejected;
+    }
+    MakeKey(msg_head.phone_num, msg_head.msg_id, static_cast<uint16_t>(msg_head.msg_flow_num - (seq - 1)), &key_);
+    Messages::iterator it;
+    auto               found = index_.find(key_);
+    if (found == index_.end()) {
+        // A late retransmission of a message already complete.
+        if (IsRecent(key_))
+            return kReassemblyDuplicate;
+        if (!MakeRoom(size, nullptr))
+            return kReassemblyRejected;
+        it                 = messages_.insert(messages_.end(), Message());
+        it->key            = key_;
+        it->phone_num      = msg_head.phone_num;
+        it->msg_id         = msg_head.msg_id;
+        it->first_flow_num = static_cast<uint16_t>(msg_head.msg_flow_num - (seq - 1));
+        it->received       = 0;
+        it->offsets.assign(total, kMissing);
+        it->sizes.assign(total, 0);
+        // Packets of a message mostly share the size of the first, the claimed total is trusted up to a limit.
+        it->data.reserve(std::min<size_t>(size * total, kReserveLimit));
+        it->fill_requests = 0;
+        index_[key_]      = it;
+    }
+    else {
+        it = found->second;
+        if (it->offsets.size() != total)
+            return kReassemblyRejected;
+        if (it->offsets[seq - 1] != kMissing)
+            return kReassemblyDuplicate;
+        if (!MakeRoom(size, &*it))
+            return kReassemblyRejected;
+    }
+    it->offsets[seq - 1] = static_cast<uint32_t>(it->data.size());
+    it->sizes[seq - 1]   = static_cast<uint16_t>(size);
+    it->data.insert(it->data.end(), body, body + size);
+    bytes_ += size;
+    ++it->received;
+    it->last_ms = now_ms;
+    messages_.splice(messages_.end(), messages_, it);
+    if (it->received < total) {
+        if (seq == total)
+            due_.push_back(it->key);
+        return kReassemblyPending;
+    }
+    message->segments.clear();
+    message->segments.reserve(total);
+    for (size_t i = 0; i < total; ++i)
+        message->segments.push_back({it->data.data() + it->offsets[i], it->sizes[i]});
+    message->size = it->data.size();
+    recent_.push_back(it->key);
+    if (recent_.size() > kRecentMessages)
+        recent_.pop_front();
+    bytes_ -= it->data.size();
+    index_.erase(it->key);
+    // Moving the node keeps the body in place for the caller.
+    done_.splice(done_.end(), messages_, it);
+    return kReassemblyComplete;
+}
+
+void Reassembler::Poll(int64_t const& now_ms, std::vector<FillRequest>* requests) {
+    done_.clear();
+    if (requests == nullptr)
+        return;
+    // Messages whose last packet arrived with gaps are not waited for.
+    for (auto const& key : due_) {
+        auto found = index_.find(key);
+        if (found != index_.end() && found->second->fill_requests == 0 && options_.max_fill_requests > 0)
+            RequestFill(found->second, now_ms, requests);
+    }
+    due_.clear();
+    // Requested and touched messages move to the back, each is visited once.
+    size_t count = messages_.size();
+    while (count-- > 0 && !messages_.empty() && messages_.front().last_ms + options_.fill_timeout_ms <= now_ms) {
+        auto it = messages_.begin();
+        if (it->fill_requests >= options_.max_fill_requests)
+            Drop(it);
+        else
+            RequestFill(it, now_ms, requests);
+    }
+}
+
+void Reassembler::RemoveTerminal(std::string const& phone_num) {
+    done_.clear();
+    for (auto it = messages_.begin(); it != messages_.end();) {
+        auto next = std::next(it);
+        if (it->phone_num == phone_num)
+            Drop(it);
+        it = next;
+    }
+}
+
+void Reassembler::Clear(void) {
+    messages_.clear();
+    index_.clear();
+    done_.clear();
+    recent_.clear();
+    due_.clear();
+    bytes_ = 0;
+}
+
+// Layout, big endian:
+//     number of messages (DWORD)
+//     message: phone number length (BYTE), phone number, message ID (WORD), first flow number (WORD),
+//              total packets (WORD), fill requests (BYTE), last activity (8 bytes),
+//              and per packet in sequence: received (BYTE), for received packets body size (WORD) and body.
+void Reassembler::Save(std::vector<uint8_t>* out) const {
+    if (out == nullptr)
+        return;
+    PutBigEndian(messages_.size(), 4, out);
+    for (auto const& message : messages_) {
+        out->push_back(static_cast<uint8_t>(message.phone_num.size()));
+        out->insert(out->end(), message.phone_num.begin(), message.phone_num.end());
+        PutBigEndian(message.msg_id, 2, out);
+        PutBigEndian(message.first_flow_num, 2, out);
+        PutBigEndian(message.offsets.size(), 2, out);
+        PutBigEndian(static_cast<uint64_t>(std::min(message.fill_requests, 255)), 1, out);
+        PutBigEndian(static_cast<uint64_t>(message.last_ms), 8, out);
+        for (size_t i = 0; i < message.offsets.size(); ++i) {
+            out->push_back(message.offsets[i] == kMissing ? 0 : 1);
+            if (message.offsets[i] == kMissing)
+                continue;
+            PutBigEndian(message.sizes[i], 2, out);
+            out->insert(out->end(), message.data.begin() + message.offsets[i],
+                        message.data.begin() + message.offsets[i] + message.sizes[i]);
+        }
+    }
+}
+
+int Reassembler::Load(uint8_t const* data, size_t const& size) {
+    done_.clear();
+    if (data == nullptr)
+        return size == 0 ? 0 : -1;
+    size_t   pos   = 0;
+    uint64_t count = 0;
+    if (ReadBigEndian(data, size, 4, &pos, &count) < 0)
+        return -1;
+    for (uint64_t n = 0; n < count; ++n) {
+        Message  message;
+        uint64_t value = 0;
+        if (ReadBigEndian(data, size, 1, &pos, &value) < 0 || size - pos < value)
+            return -1;
+        message.phone_num.assign(data + pos, data + pos + value);
+        pos += value;
+        if (ReadBigEndian(data, size, 2, &pos, &value) < 0)
+            return -1;
+        message.msg_id = static_cast<uint16_t>(value);
+        if (ReadBigEndian(data, size, 2, &pos, &value) < 0)
+            return -1;
+        message.first_flow_num = static_cast<uint16_t>(value);
+        if (ReadBigEndian(data, size, 2, &pos, &value) < 0 || value == 0)
+            return -1;
+        message.offsets.assign(value, kMissing);
+        message.sizes.assign(value, 0);
+        if (ReadBigEndian(data, size, 1, &pos, &value) < 0)
+            return -1;
+        message.fill_requests = static_cast<int>(value);
+        if (ReadBigEndian(data, size, 8, &pos, &value) < 0)
+            return -1;
+        message.last_ms  = static_cast<int64_t>(value);
+        message.received = 0;
+        for (size_t i = 0; i < message.offsets.size(); ++i) {
+            if (pos == size)
+                return -1;
+            if (data[pos++] == 0)
+                continue;
+            if (ReadBigEndian(data, size, 2, &pos, &value) < 0 || size - pos < value)
+                return -1;
+            message.offsets[i] = static_cast<uint32_t>(message.data.size());
+            message.sizes[i]   = static_cast<uint16_t>(value);
+            message.data.insert(message.data.end(), data + pos, data + pos + value);
+            pos += value;
+            ++message.received;
+        }
+        MakeKey(message.phone_num, message.msg_id, message.first_flow_num, &message.key);
+        if (message.received == 0 || message.received == message.offsets.size() ||
+            index_.find(message.key) != index_.end()) {
+            continue;
+        }
+        bytes_ += message.data.size();
+        // Saved ascending by last activity, messages of this process may be more recent.
+        auto it = messages_.begin();
+        while (it != messages_.end() && it->last_ms <= message.last_ms)
+            ++it;
+        it              = messages_.insert(it, std::move(message));
+        index_[it->key] = it;
+    }
+    return 0;
+}
+
+} // namespace libjt808
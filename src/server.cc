@@ -38,77 +38,182 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/un.h>
 #endif
 
 #include <algorithm>
 #include <chrono>
 #include <fstream>
 
+#include "jt808/logger.h"
 #include "jt808/socket_util.h"
+#include "jt808/util.h"
 
 namespace libjt808 {
 
 namespace {
 
-// Display location report information.
-void PrintLocationReportInfo(ProtocolParameter const& para) {
+// Dump location report information as debug records.
+void LogLocationReport(ProtocolParameter const& para) {
     auto const& basic_info     = para.parse.location_info;
     auto const& extension_info = para.parse.location_extension;
-    printf("Location Report:\n");
-    printf("  inout area alarm bit: %d\n", basic_info.alarm.bit.in_out_area);
-    printf("  position status: %d\n", basic_info.status.bit.positioning);
-    printf("  latitude: %.6lf\n", basic_info.latitude * 1e-6);
-    printf("  longitude: %.6lf\n", basic_info.longitude * 1e-6);
-    printf("  altitude: %d\n", basic_info.altitude);
-    printf("  speed: %f\n", basic_info.speed / 10.0f);
-    printf("  bearing: %d\n", basic_info.bearing);
-    printf("  time: %s\n", basic_info.time.c_str());
-    printf("  location extension:\n");
+    JT808_LOG_DEBUG("Location Report: inout area alarm bit: %d, position status: %d, latitude: %.6lf, longitude: "
+                    "%.6lf, altitude: %d, speed: %.1f, bearing: %d, time: %s",
+                    basic_info.alarm.bit.in_out_area, basic_info.status.bit.positioning, basic_info.latitude * 1e-6,
+                    basic_info.longitude * 1e-6, basic_info.altitude, basic_info.speed / 10.0f, basic_info.bearing,
+                    basic_info.time);
     for (auto const& item : extension_info) {
-        printf("    id:%02X, len: %02X, value:", item.first, static_cast<uint8_t>(item.second.size()));
-        for (auto const& uch : item.second)
-            printf(" %02X", uch);
-        printf("\n");
+        JT808_LOG_DEBUG("  location extension id:%02X, len: %02X, value: %s", item.first,
+                        static_cast<uint8_t>(item.second.size()), LogHex(item.second));
     }
     auto it = extension_info.find(libjt808::kAccessAreaAlarm);
     if (it != extension_info.end()) {
         uint8_t  location_type;
         uint32_t area_route_id;
         uint8_t  direction;
-        printf("  in or out area and route information:\n");
         if (libjt808::GetAccessAreaAlarmBody(it->second, &location_type, &area_route_id, &direction) == 0) {
-            printf("    location type: %d\n", location_type);
-            printf("    id: %04X\n", area_route_id);
-            printf("    direction: %d\n", direction);
+            JT808_LOG_DEBUG("  in or out area and route information: location type: %d, id: %04X, direction: %d",
+                            location_type, area_route_id, direction);
         }
     }
 }
 
-// Display terminal parameters.
-void PrintTerminalParameter(ProtocolParameter const& para) {
-    std::string str;
-    printf("Terminal Parameters:\n");
+// Dump terminal parameters as debug records.
+void LogTerminalParameter(ProtocolParameter const& para) {
+    JT808_LOG_DEBUG("Terminal Parameters:");
+    auto const&    store = para.parse.terminal_parameter_store;
+    uint8_t const* data  = nullptr;
+    size_t         size  = 0;
     if (!para.terminal_parameter_ids.empty()) {
         for (auto const& id : para.terminal_parameter_ids) {
-            auto const& it = para.parse.terminal_parameters.find(id);
-            if (it != para.parse.terminal_parameters.end()) {
-                printf("  ID:%08X, Length:%d, Value:", it->first, static_cast<int>(it->second.size()));
-                for (auto const& uch : it->second)
-                    printf(" %02X", uch);
-                printf("\n");
+            if (store.Find(id, &data, &size) == 0) {
+                JT808_LOG_DEBUG("  ID:%08X, Length:%d, Value: %s", id, static_cast<int>(size),
+                                LogHex(data, size));
             }
         }
     }
     else {
-        for (auto const& item : para.parse.terminal_parameters) {
-            printf("  ID:%08X, Value:", item.first);
-            for (auto const& uch : item.second)
-                printf(" %02X", uch);
-            printf("\n");
-        }
+        store.ForEach([](uint32_t const& id, uint8_t const* data, size_t const& size) {
+            JT808_LOG_DEBUG("  ID:%08X, Value: %s", id, LogHex(data, size));
+        });
+    }
+}
+
+// Bytes added by escaping, each escaped byte becomes 0x7D and one more byte.
+uint64_t EscapedBytes(std::vector<uint8_t> const& frame) {
+    return std::count(frame.begin(), frame.end(), 0x7D);
+}
+
+// Records the lifetime of the scope into a latency histogram, in nanoseconds.
+class ScopedLatency {
+public:
+    ScopedLatency(Metrics::Shard* shard, MetricHistogram const& histogram)
+        : shard_(shard), histogram_(histogram), tp_(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedLatency() {
+        shard_->Record(histogram_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - tp_).count());
+    }
+
+private:
+    Metrics::Shard*                       shard_;
+    MetricHistogram                       histogram_;
+    std::chrono::steady_clock::time_point tp_;
+};
+
+// Milliseconds of the steady clock.
+int64_t SteadyClockMs(void) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Milliseconds since the Unix epoch.
+int64_t SystemClockMs(void) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Period of the reassembly timeouts check.
+constexpr uint32_t kReassemblyPollMs = 100;
+// Period of writing the capture buffer out.
+constexpr uint32_t kCaptureFlushMs = 1000;
+// Period of writing the aged blocks of the track store out.
+constexpr uint32_t kTrackFlushMs = 1000;
+
+// Messages the main service thread decodes for itself, handed to the ingest pipeline with the decoded fields.
+bool IngestDecoded(uint16_t const& msg_id) {
+    switch (msg_id) {
+        case kTerminalGeneralResponse:
+        case kGetTerminalParametersResponse:
+        case kLocationReport:
+        case kGetLocationInformationResponse:
+        case kBatchLocationReport:
+        case kMultimediaDataUpload:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Move the decoded fields of a message into its ingest record, see IngestRecord.
+void IngestFields(ProtocolParameter* para, IngestRecord* record) {
+    auto& parse = para->parse;
+    switch (record->msg_id) {
+        case kTerminalGeneralResponse:
+            record->respone_flow_num = parse.respone_flow_num;
+            record->respone_msg_id   = parse.respone_msg_id;
+            record->respone_result   = parse.respone_result;
+            break;
+        case kGetTerminalParametersResponse: // Kept as well, for the session.
+            record->respone_flow_num = parse.respone_flow_num;
+            record->parameters       = parse.terminal_parameter_store;
+            break;
+        case kGetLocationInformationResponse:
+            record->respone_flow_num = parse.respone_flow_num;
+            record->locations.push_back(std::move(parse.location_info));
+            record->extensions.push_back(std::move(parse.location_extension));
+            break;
+        case kLocationReport:
+            record->locations.push_back(std::move(parse.location_info));
+            record->extensions.push_back(std::move(parse.location_extension));
+            break;
+        case kBatchLocationReport:
+            record->locations.swap(parse.batch_loc.loc_info);
+            record->extensions.swap(parse.batch_loc.loc_ext);
+            break;
+        case kMultimediaDataUpload: // The media ID stays for the response.
+            record->media = std::move(parse.multimedia_upload);
+            break;
+        default:
+            break;
     }
 }
 
+// Key of a packet sent to a terminal, waiting for its acknowledgement.
+uint64_t PacketKey(decltype(socket(0, 0, 0)) const& socket, uint16_t const& flow_num) {
+    return (static_cast<uint64_t>(socket) << 16) | flow_num;
+}
+
+#if defined(__linux__)
+// Messages forwarded between server processes, one per datagram: phone number length (BYTE), phone number,
+// message ID (WORD), message body.
+constexpr size_t kMaxDownlinkDatagram = 65536;
+
+// Address of the socket taking the messages forwarded to a server process.
+int DownlinkAddress(std::string const& directory_path, uint32_t const& process_id, struct sockaddr_un* addr) {
+    std::string const path = directory_path + "." + std::to_string(process_id);
+    memset(addr, 0, sizeof(*addr));
+    if (path.size() >= sizeof(addr->sun_path))
+        return -1;
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path.c_str(), path.size());
+    return 0;
+}
+#endif
+
 } // namespace
 
 // Initialize some parameters.
@@ -119,10 +224,16 @@ void JT808Server::Init(void) {
     max_connection_num_ = 10;
     // Initialize the command parser and packager.
     JT808FrameParserInit(&parser_);
+    JT808SegmentedParserInit(&segmented_parser_);
     JT808FramePackagerInit(&packager_);
     // Initialize thread running status.
     waiting_is_running_.store(false);
     service_is_running_.store(false);
+    message_display_.store(false);
+    // Set a default callback to prevent errors when not set externally.
+    multimedia_data_upload_callback_ = [](MultiMediaDataUpload const& media) -> void {
+        return;
+    };
 }
 
 // Create a socket and bind it to the specified IP and port.
@@ -135,7 +246,14 @@ int JT808Server::InitServer(void) {
     addr.sin_addr.s_addr = inet_addr(ip_.c_str());
     listen_              = socket(AF_INET, SOCK_STREAM, 0);
     if (listen_ == -1) {
-        printf("%s[%d]: Create socket failed!!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Create socket failed!!!", __FUNCTION__, __LINE__);
+        return -1;
+    }
+    // Each server process on the port has its own listening socket, the kernel balances the connections over them.
+    int on = 1;
+    if (reuse_port_ && setsockopt(listen_, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+        JT808_LOG_ERROR("%s[%d]: Set SO_REUSEPORT failed!!!", __FUNCTION__, __LINE__);
+        Close(listen_);
         return -1;
     }
 #elif defined(_WIN32)
@@ -145,14 +263,14 @@ int JT808Server::InitServer(void) {
     }
     listen_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (listen_ == INVALID_SOCKET) {
-        printf("%s[%d]: Create socket failed!!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Create socket failed!!!", __FUNCTION__, __LINE__);
         WSACleanup();
         return -1;
     }
     addr.sin_addr.S_un.S_addr = inet_addr(ip_.c_str());
 #endif
     if (Bind(listen_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
-        printf("%s[%d]: Connect to remote server failed!!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Connect to remote server failed!!!", __FUNCTION__, __LINE__);
         Close(listen_);
 #if defined(_WIN32)
         WSACleanup();
@@ -163,6 +281,460 @@ int JT808Server::InitServer(void) {
     return 0;
 }
 
+int JT808Server::OpenSessionDirectory(std::string const& path) {
+#if defined(__linux__)
+    if (downlink_socket_ >= 0 || directory_.Open(path) < 0) {
+        JT808_LOG_ERROR("%s[%d]: Open session directory %s failed!!!", __FUNCTION__, __LINE__, path.c_str());
+        return -1;
+    }
+    process_id_     = static_cast<uint32_t>(getpid());
+    directory_path_ = path;
+    // Entries left by a crashed process with the same ID.
+    directory_.EraseOwner(process_id_);
+    struct sockaddr_un addr;
+    int                fd      = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int                forward = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    // The receive queue of a datagram socket is short, a blocking send waits for the owner to drain it.
+    struct timeval timeout = {1, 0};
+    if (fd < 0 || forward < 0 || DownlinkAddress(path, process_id_, &addr) < 0 ||
+        setsockopt(forward, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
+        JT808_LOG_ERROR("%s[%d]: Create downlink socket failed!!!", __FUNCTION__, __LINE__);
+        if (fd >= 0)
+            Close(fd);
+        if (forward >= 0)
+            Close(forward);
+        directory_.Close();
+        return -1;
+    }
+    unlink(addr.sun_path);
+    if (Bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        JT808_LOG_ERROR("%s[%d]: Bind downlink socket %s failed!!!", __FUNCTION__, __LINE__, addr.sun_path);
+        Close(fd);
+        Close(forward);
+        directory_.Close();
+        return -1;
+    }
+    downlink_buffer_.resize(kMaxDownlinkDatagram);
+    downlink_socket_ = fd;
+    forward_socket_  = forward;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+int JT808Server::SendToTerminal(std::string const& phone, uint16_t const& msg_id, std::vector<uint8_t> const& body) {
+#if defined(__linux__)
+    uint32_t owner = 0;
+    if (downlink_socket_ >= 0) {
+        if (directory_.Find(phone, &owner) < 0)
+            return -1;
+    }
+    if (downlink_socket_ >= 0 && owner != process_id_) {
+        // A crashed process leaves its entries behind.
+        if ((kill(static_cast<pid_t>(owner), 0) < 0 && errno == ESRCH) || phone.size() > UINT8_MAX ||
+            3 + phone.size() + body.size() > kMaxDownlinkDatagram) {
+            return -1;
+        }
+        std::vector<uint8_t> datagram;
+        datagram.reserve(3 + phone.size() + body.size());
+        datagram.push_back(static_cast<uint8_t>(phone.size()));
+        datagram.insert(datagram.end(), phone.begin(), phone.end());
+        datagram.push_back(static_cast<uint8_t>(msg_id >> 8));
+        datagram.push_back(static_cast<uint8_t>(msg_id));
+        datagram.insert(datagram.end(), body.begin(), body.end());
+        struct sockaddr_un addr;
+        if (DownlinkAddress(directory_path_, owner, &addr) < 0 ||
+            sendto(forward_socket_, datagram.data(), datagram.size(), MSG_NOSIGNAL,
+                   reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+            return -1;
+        }
+        std::lock_guard<std::mutex> lock(external_metrics_mutex_);
+        external_metrics_->Add(kDownlinksForwarded, 1);
+        return 0;
+    }
+#endif
+    std::lock_guard<std::mutex> lock(downlink_mutex_);
+    if (handed_over_)
+        return -1;
+    downlinks_.push_back({phone, msg_id, body});
+    return 0;
+}
+
+void JT808Server::SendDownlinks(void) {
+    std::vector<Downlink> downlinks;
+    {
+        std::lock_guard<std::mutex> lock(downlink_mutex_);
+        downlinks.swap(downlinks_);
+    }
+#if defined(__linux__)
+    // Messages forwarded by the other processes.
+    ssize_t ret = 0;
+    while (downlink_socket_ >= 0 &&
+           (ret = recv(downlink_socket_, downlink_buffer_.data(), downlink_buffer_.size(), 0)) > 0) {
+        uint8_t const* data = downlink_buffer_.data();
+        size_t const   size = static_cast<size_t>(ret);
+        if (size < 3 || size - 3 < data[0])
+            continue;
+        Downlink downlink;
+        downlink.phone_num.assign(data + 1, data + 1 + data[0]);
+        downlink.msg_id = static_cast<uint16_t>((data[1 + data[0]] << 8) | data[2 + data[0]]);
+        downlink.body.assign(data + 3 + data[0], data + size);
+        downlinks.push_back(std::move(downlink));
+    }
+#endif
+    SegmentedFrames frames;
+    for (auto const& downlink : downlinks) {
+        auto entry  = client_sockets_.find(downlink.phone_num);
+        auto client = entry != client_sockets_.end() ? clients_.find(entry->second) : clients_.end();
+        if (client == clients_.end()) {
+            JT808_LOG_WARN("%s[%d]: Terminal %s not connected", __FUNCTION__, __LINE__, downlink.phone_num.c_str());
+            continue;
+        }
+        auto&   para = client->second;
+        MsgHead head = para.msg_head;
+        head.msg_id  = downlink.msg_id;
+        int count    = JT808SegmentedPackage(head, downlink.body.data(), downlink.body.size(), kMaxMsgBodyLength,
+                                             &frames);
+        if (count < 0 || SendAll(client->first, reinterpret_cast<char const*>(frames.data.data()),
+                                 static_cast<int>(frames.data.size()), 1000) < 0) {
+            JT808_LOG_ERROR("%s[%d]: Send message failed !!!", __FUNCTION__, __LINE__);
+            service_metrics_->Add(kSendFailures, 1);
+            continue;
+        }
+        para.msg_head.msg_flow_num += count; // Each packet takes a message flow number.
+        service_metrics_->Add(kBytesOut, frames.data.size());
+        service_metrics_->Add(kEscapeBytesOut, EscapedBytes(frames.data));
+        for (int i = 0; i < count; ++i)
+            service_metrics_->FrameOut(downlink.msg_id);
+        if (downlink_retries_ <= 0)
+            continue;
+        // Wait for the acknowledgement of every packet, retransmitted with the same flow number on timeout.
+        uint64_t const id      = ++next_downlink_id_;
+        auto&          unacked = unacked_downlinks_[id];
+        for (int i = 0; i < count; ++i)
+            downlink_acks_[PacketKey(client->first, static_cast<uint16_t>(frames.first_flow_num + i))] = id;
+        unacked.client          = client->first;
+        unacked.phone_num       = downlink.phone_num;
+        unacked.frames          = std::move(frames);
+        unacked.acked.assign(count, false);
+        unacked.unacked         = static_cast<uint16_t>(count);
+        unacked.retransmissions = 0;
+        unacked.timeout_ms      = downlink_timeout_ms_;
+        unacked.timer           = timers_.Add(unacked.timeout_ms, [this, id] { RetransmitDownlink(id); });
+    }
+}
+
+void JT808Server::AcknowledgeDownlink(decltype(socket(0, 0, 0)) const& socket, std::string const& phone_num,
+                                      uint16_t const& flow_num) {
+    auto ack = downlink_acks_.find(PacketKey(socket, flow_num));
+    if (ack == downlink_acks_.end())
+        return;
+    auto it = unacked_downlinks_.find(ack->second);
+    downlink_acks_.erase(ack);
+    // The terminal of a closed connection may still wait for its last timeout, the socket taken by another one.
+    if (it == unacked_downlinks_.end() || it->second.phone_num != phone_num)
+        return;
+    auto&          unacked = it->second;
+    uint16_t const seq     = static_cast<uint16_t>(flow_num - unacked.frames.first_flow_num);
+    if (seq < unacked.acked.size() && !unacked.acked[seq]) {
+        unacked.acked[seq] = true;
+        --unacked.unacked;
+    }
+    if (unacked.unacked == 0) {
+        timers_.Cancel(unacked.timer);
+        unacked_downlinks_.erase(it);
+    }
+}
+
+void JT808Server::RetransmitDownlink(uint64_t const& id) {
+    auto it = unacked_downlinks_.find(id);
+    if (it == unacked_downlinks_.end())
+        return;
+    auto&      unacked   = it->second;
+    auto       client    = clients_.find(unacked.client);
+    bool const connected = client != clients_.end() && client->second.msg_head.phone_num == unacked.phone_num;
+    std::vector<uint16_t> packet_seqs;
+    for (size_t i = 0; i < unacked.acked.size(); ++i) {
+        if (!unacked.acked[i])
+            packet_seqs.push_back(static_cast<uint16_t>(i + 1));
+    }
+    std::vector<uint8_t> data;
+    if (connected && unacked.retransmissions < downlink_retries_ &&
+        unacked.frames.Retransmit(packet_seqs, &data) == 0 &&
+        SendAll(unacked.client, reinterpret_cast<char const*>(data.data()), static_cast<int>(data.size()), 1000) >= 0) {
+        service_metrics_->Add(kBytesOut, data.size());
+        service_metrics_->Add(kDownlinkRetransmits, packet_seqs.size());
+        // T(n+1) = T(n) * (n+1), n retransmissions so far.
+        unacked.timeout_ms *= static_cast<uint32_t>(unacked.retransmissions + 1);
+        ++unacked.retransmissions;
+        unacked.timer = timers_.Add(unacked.timeout_ms, [this, id] { RetransmitDownlink(id); });
+        return;
+    }
+    if (connected) {
+        JT808_LOG_WARN("%s[%d]: Terminal %s did not acknowledge message of flow number %d", __FUNCTION__,
+                       __LINE__, unacked.phone_num.c_str(), unacked.frames.first_flow_num);
+        service_metrics_->Add(kDownlinkTimeouts, 1);
+    }
+    for (auto const& seq : packet_seqs) {
+        auto ack = downlink_acks_.find(
+            PacketKey(unacked.client, static_cast<uint16_t>(unacked.frames.first_flow_num + seq - 1)));
+        if (ack != downlink_acks_.end() && ack->second == id)
+            downlink_acks_.erase(ack);
+    }
+    unacked_downlinks_.erase(it);
+}
+
+void JT808Server::ArmIdleTimer(decltype(socket(0, 0, 0)) const& socket, ProtocolParameter const& para) {
+    if (idle_timeout_ms_ == 0)
+        return;
+    // Three heartbeats of a terminal configured with a longer interval.
+    uint64_t timeout_ms = idle_timeout_ms_;
+    uint32_t interval   = 0;
+    if (para.parse.terminal_parameter_store.Get<kTerminalHeartBeatInterval>(&interval) == 0)
+        timeout_ms = std::max<uint64_t>(timeout_ms, 3000ull * interval);
+    auto& timer  = idle_timers_[socket];
+    timer.second = static_cast<uint32_t>(std::min<uint64_t>(timeout_ms, UINT32_MAX));
+    timer.first  = timers_.Add(timer.second, [this, socket] {
+        idle_timers_.erase(socket);
+        if (clients_.find(socket) == clients_.end())
+            return;
+        // The upgrade thread holds the connection and receives on it meanwhile.
+        if (is_upgrading_clients_.find(socket) != is_upgrading_clients_.end()) {
+            ArmIdleTimer(socket, clients_[socket]);
+            return;
+        }
+        JT808_LOG_INFO("%s[%d]: Terminal %s idle, disconnect", __FUNCTION__, __LINE__,
+                       clients_[socket].msg_head.phone_num.c_str());
+        service_metrics_->Add(kIdleDisconnects, 1);
+        CloseClient(socket);
+    });
+}
+
+void JT808Server::CloseClient(decltype(socket(0, 0, 0)) const& socket) {
+    auto client = clients_.find(socket);
+    if (client == clients_.end())
+        return;
+    service_metrics_->Add(kDisconnects, 1);
+    auto buffer = receive_buffers_.find(socket);
+    if (buffer != receive_buffers_.end()) {
+        metrics_.AddGauge(kReceiveBufferBytes, -static_cast<int64_t>(buffer->second.size()));
+        receive_buffers_.erase(buffer);
+    }
+    auto timer = idle_timers_.find(socket);
+    if (timer != idle_timers_.end()) {
+        timers_.Cancel(timer->second.first);
+        idle_timers_.erase(timer);
+    }
+    if (capture_.is_open()) {
+        std::lock_guard<std::mutex> lock(capture_mutex_);
+        capture_connections_.erase(socket);
+    }
+    Close(socket);
+    auto const& phone_num = client->second.msg_head.phone_num;
+    auto        latest    = client_sockets_.find(phone_num);
+    if (latest != client_sockets_.end() && latest->second == socket)
+        client_sockets_.erase(latest);
+    reassembler_.RemoveTerminal(phone_num);
+    if (push_ != nullptr)
+        push_->OnDisconnected(phone_num);
+    directory_.Erase(phone_num, process_id_);
+    SaveSession(client->second);
+    clients_.erase(client);
+}
+
+void JT808Server::CaptureConnection(decltype(socket(0, 0, 0)) const& socket) {
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    capture_connections_[socket] = ++capture_connection_count_;
+}
+
+void JT808Server::CaptureFrame(decltype(socket(0, 0, 0)) const& socket, std::vector<uint8_t> const& frame) {
+    int64_t const now_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    auto&                       connection = capture_connections_[socket];
+    // Connections taken over from a previous process.
+    if (connection == 0)
+        connection = ++capture_connection_count_;
+    capture_.Write(connection, now_us, frame.data(), frame.size());
+}
+
+void JT808Server::FlushCapture(void) {
+    timers_.Add(kCaptureFlushMs, [this] { FlushCapture(); });
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    capture_.Flush();
+}
+
+void JT808Server::FlushTrackStore(void) {
+    timers_.Add(kTrackFlushMs, [this] { FlushTrackStore(); });
+    track_store_.FlushAged();
+}
+
+int JT808Server::SetIngest(IngestPipeline* pipeline) {
+    IngestPipeline::Producer* producer = pipeline != nullptr ? pipeline->CreateProducer() : nullptr;
+    if (pipeline != nullptr && producer == nullptr)
+        return -1;
+    ingest_          = pipeline;
+    ingest_producer_ = producer;
+    ingest_raw_      = nullptr;
+    if (pipeline != nullptr) {
+        ingest_raw_ = [pipeline](uint16_t const& msg_id) {
+            return !IngestDecoded(msg_id) && pipeline->Routes(msg_id);
+        };
+    }
+    return 0;
+}
+
+int JT808Server::ServeHandoff(std::string const& path) {
+    if (!is_ready_ || handoff_listen_ >= 0)
+        return -1;
+    handoff_listen_ = HandoffListen(path);
+    if (handoff_listen_ < 0) {
+        JT808_LOG_ERROR("%s[%d]: Listen for handoff at %s failed!!!", __FUNCTION__, __LINE__, path.c_str());
+        return -1;
+    }
+    handoff_path_ = path;
+    return 0;
+}
+
+// Receive the listening socket and the connections of the old process, and resume their sessions.
+int JT808Server::TakeOverServer(std::string const& path) {
+#if defined(__linux__)
+    int channel = HandoffConnect(path);
+    if (channel < 0) {
+        JT808_LOG_INFO("%s[%d]: No server process to take over at %s", __FUNCTION__, __LINE__, path.c_str());
+        return -1;
+    }
+    HandoffState state;
+    int          ret = ReceiveHandoffState(channel, 10000, &state);
+    Close(channel);
+    if (ret < 0) {
+        JT808_LOG_ERROR("%s[%d]: Take over from %s failed!!!", __FUNCTION__, __LINE__, path.c_str());
+        return -1;
+    }
+    listen_          = state.listen_socket;
+    int64_t buffered = 0;
+    for (auto& session : state.sessions) {
+        auto& para                          = clients_[session.socket];
+        para.msg_head.phone_num             = session.phone_num;
+        para.parse.msg_head.phone_num       = session.phone_num;
+        para.msg_head.msg_flow_num          = session.platform_flow_num;
+        para.parse.msg_head.msg_flow_num    = session.terminal_flow_num;
+        para.authentication_code            = std::move(session.authentication_code);
+        para.parse.terminal_parameter_store = std::move(session.parameters);
+        client_sockets_[session.phone_num]  = session.socket;
+        buffered += session.receive_buffer.size();
+        receive_buffers_[session.socket] = std::move(session.receive_buffer);
+    }
+    if (reassembler_.Load(state.reassembly.data(), state.reassembly.size()) < 0)
+        JT808_LOG_WARN("%s[%d]: Segmented messages of %s dropped", __FUNCTION__, __LINE__, path.c_str());
+    metrics_.AddGauge(kReceiveBufferBytes, buffered);
+    {
+        std::lock_guard<std::mutex> lock(external_metrics_mutex_);
+        external_metrics_->Add(kSessionsTakenOver, state.sessions.size());
+    }
+    JT808_LOG_INFO("%s[%d]: Took over %d connections from %s", __FUNCTION__, __LINE__,
+                   static_cast<int>(state.sessions.size()), path.c_str());
+    is_ready_.store(true);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+int JT808Server::AcceptTakeover(void) {
+    auto channel = Accept(handoff_listen_, nullptr, nullptr);
+    if (channel < 0)
+        return -1;
+    int result = 0;
+    {
+        std::unique_lock<std::mutex> lock(handoff_mutex_);
+        handoff_channel_ = channel;
+        handoff_result_  = 0;
+        handoff_requested_.store(true);
+        while (handoff_result_ == 0 && service_is_running_)
+            handoff_cv_.wait_for(lock, std::chrono::milliseconds(100));
+        result = handoff_result_;
+        handoff_requested_.store(false);
+        handoff_channel_ = -1;
+    }
+    Close(channel);
+    return result == 1 ? 0 : -1;
+}
+
+void JT808Server::HandOver(void) {
+    // Upgrades, parameter pushes and messages waiting for their acknowledgements keep state beyond the sessions,
+    // they finish first.
+    if (!handoff_requested_ || !is_upgrading_clients_.empty() || push_ != nullptr || !unacked_downlinks_.empty())
+        return;
+    // So do the messages queued by SendToTerminal(), and none is queued until the handoff is over.
+    std::lock_guard<std::mutex> downlink_lock(downlink_mutex_);
+    if (!downlinks_.empty())
+        return;
+    int channel = -1;
+    {
+        std::lock_guard<std::mutex> lock(handoff_mutex_);
+        if (handoff_result_ != 0)
+            return;
+        channel = handoff_channel_;
+    }
+    HandoffState state;
+    state.listen_socket = listen_;
+    state.sessions.reserve(clients_.size());
+    for (auto const& client : clients_) {
+        HandoffSession session;
+        session.socket              = client.first;
+        session.phone_num           = client.second.msg_head.phone_num;
+        session.authentication_code = client.second.authentication_code;
+        session.platform_flow_num   = client.second.msg_head.msg_flow_num;
+        session.terminal_flow_num   = client.second.parse.msg_head.msg_flow_num;
+        session.parameters          = client.second.parse.terminal_parameter_store;
+        auto it                     = receive_buffers_.find(client.first);
+        if (it != receive_buffers_.end())
+            session.receive_buffer = it->second;
+        state.sessions.push_back(std::move(session));
+    }
+    reassembler_.Save(&state.reassembly);
+    // The new process opens the track store once it holds the connections, it locks the directory.
+    bool const track_store_open = track_store_.is_open();
+    track_store_.Close();
+    int result = SendHandoffState(channel, state, 5000) == 0 ? 1 : -1;
+    if (result == 1) {
+        // The new process holds the connections, closing the copies of this process leaves them open.
+        JT808_LOG_INFO("%s[%d]: Handed over %d connections", __FUNCTION__, __LINE__,
+                       static_cast<int>(clients_.size()));
+        for (auto const& client : clients_)
+            Close(client.first);
+        clients_.clear();
+        client_sockets_.clear();
+        receive_buffers_.clear();
+        reassembler_.Clear();
+        timers_.Clear();
+        idle_timers_.clear();
+        unacked_downlinks_.clear();
+        downlink_acks_.clear();
+        {
+            std::lock_guard<std::mutex> capture_lock(capture_mutex_);
+            capture_.Flush();
+            capture_connections_.clear();
+        }
+        metrics_.SetGauge(kReceiveBufferBytes, 0);
+        handed_over_ = true;
+        service_is_running_.store(false);
+    }
+    else {
+        JT808_LOG_ERROR("%s[%d]: Handoff failed, keep serving!!!", __FUNCTION__, __LINE__);
+        if (track_store_open && track_store_.Open(track_dir_, track_options_) < 0)
+            JT808_LOG_ERROR("%s[%d]: Reopen track store %s failed!!!", __FUNCTION__, __LINE__, track_dir_.c_str());
+    }
+    {
+        std::lock_guard<std::mutex> lock(handoff_mutex_);
+        handoff_result_ = result;
+    }
+    handoff_cv_.notify_all();
+}
+
 // Start threads for waiting for client connections and communicating with clients.
 void JT808Server::Run(void) {
     if (!is_ready_)
@@ -180,11 +752,52 @@ void JT808Server::Stop(void) {
         waiting_is_running_.store(false);
         std::this_thread::sleep_for(std::chrono::seconds(3));
         for (auto& socket : clients_) {
+            SaveSession(socket.second);
             Close(socket.first);
         }
         clients_.erase(clients_.begin(), clients_.end());
+        client_sockets_.clear();
+        receive_buffers_.clear();
+        reassembler_.Clear();
+        timers_.Clear();
+        idle_timers_.clear();
+        unacked_downlinks_.clear();
+        downlink_acks_.clear();
+        {
+            std::lock_guard<std::mutex> capture_lock(capture_mutex_);
+            capture_.Flush();
+            capture_connections_.clear();
+        }
+        if (track_store_.is_open())
+            track_store_.Flush();
+        std::lock_guard<std::mutex> lock(pending_clients_mutex_);
+        for (auto& item : pending_clients_) {
+            Close(item.first);
+        }
+        pending_clients_.clear();
         Close(listen_);
         listen_ = 0;
+#if defined(__linux__)
+        // After a handoff the terminals are entered under the new process.
+        directory_.EraseOwner(process_id_);
+        if (downlink_socket_ >= 0) {
+            struct sockaddr_un addr;
+            if (DownlinkAddress(directory_path_, process_id_, &addr) == 0)
+                unlink(addr.sun_path);
+            Close(downlink_socket_);
+            Close(forward_socket_);
+            downlink_socket_ = -1;
+            forward_socket_  = -1;
+        }
+        if (handoff_listen_ >= 0) {
+            Close(handoff_listen_);
+            handoff_listen_ = -1;
+            // After a handoff the path belongs to the new process.
+            std::lock_guard<std::mutex> handoff_lock(handoff_mutex_);
+            if (handoff_result_ != 1)
+                unlink(handoff_path_.c_str());
+        }
+#endif
 #if defined(_WIN32)
         WSACleanup();
 #endif
@@ -195,123 +808,360 @@ void JT808Server::Stop(void) {
 int JT808Server::UpgradeRequest(decltype(socket(0, 0, 0)) const& socket, int const& upgrade_type,
                                 std::vector<uint8_t> const& manufacturer_id, std::string const& version_id,
                                 char const* path) {
+    std::shared_ptr<UpgradeJob> job(new UpgradeJob);
+    job->client = socket;
+    return RunUpgrade(job, upgrade_type, manufacturer_id, version_id, path);
+}
+
+int JT808Server::UpgradeRequestByPhoneNumber(std::string const& phone, int const& upgrade_type,
+                                             std::vector<uint8_t> const& manufacturer_id,
+                                             std::string const& version_id, char const* path) {
+    std::shared_ptr<UpgradeJob> job(new UpgradeJob);
+    job->by_phone  = true;
+    job->phone_num = phone;
+    return RunUpgrade(job, upgrade_type, manufacturer_id, version_id, path);
+}
+
+int JT808Server::RunUpgrade(std::shared_ptr<UpgradeJob> const& job, int const& upgrade_type,
+                            std::vector<uint8_t> const& manufacturer_id, std::string const& version_id,
+                            char const* path) {
     std::ifstream ifs;
     ifs.open(path, std::ios::in | std::ios::binary);
     if (!ifs.is_open()) {
-        printf("%s[%d]: Updrade file open failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Updrade file open failed !!!", __FUNCTION__, __LINE__);
         return -1;
     }
     ifs.seekg(0, std::ios::end);
     size_t length = ifs.tellg();
     ifs.seekg(0, std::ios::beg);
-    std::unique_ptr<char[]> buffer(new char[length], std::default_delete<char[]>());
-    ifs.read(buffer.get(), length);
+    auto& info = job->para.upgrade_info;
+    info.upgrade_data.resize(length);
+    ifs.read(reinterpret_cast<char*>(info.upgrade_data.data()), length);
     ifs.close();
-    is_upgrading_clients_.insert(std::make_pair(socket, 0));
-    auto& para = clients_[socket];
-    para.upgrade_info.manufacturer_id.assign(manufacturer_id.begin(), manufacturer_id.end());
-    para.upgrade_info.upgrade_type = upgrade_type;
-    para.upgrade_info.version_id   = version_id;
-    uint16_t max_content           = 1023 - 9 - para.upgrade_info.version_id.size();
-    if (length > max_content) {                    // Need to handle packet segmentation.
-        para.msg_head.msgbody_attr.bit.packet = 1; // Perform packet segmentation.
-        para.msg_head.total_packet            = static_cast<uint16_t>(ceil(length * 1.0 / max_content));
-        para.msg_head.packet_seq              = 1;
-        size_t len                            = 0;
-        for (size_t i = 0; i < length; i += max_content) {
-            len = length - i;
-            if (len > max_content)
-                len = max_content;
-            para.upgrade_info.upgrade_data.assign(buffer.get() + i, buffer.get() + i + len);
-            if (PackagingAndSendMessage(socket, kTerminalUpgrade, &para) < 0) {
-                is_upgrading_clients_.erase(socket);
-                return -1;
+    info.manufacturer_id.assign(manufacturer_id.begin(), manufacturer_id.end());
+    info.upgrade_type           = upgrade_type;
+    info.version_id             = version_id;
+    info.upgrade_data_total_len = static_cast<uint32_t>(length);
+    // The main service thread owns the clients, it packages the upgrade.
+    {
+        std::unique_lock<std::mutex> lock(upgrade_mutex_);
+        if (!service_is_running_)
+            return -1;
+        upgrade_jobs_.push_back(job);
+        while (job->state == 0 && service_is_running_)
+            upgrade_cv_.wait_for(lock, std::chrono::milliseconds(100));
+        if (job->state != 1) {
+            job->state = -1;
+            return -1;
+        }
+    }
+    // The whole body is split into packets of the maximum length, sent at once and acknowledged packet by packet.
+    int ret = SendSegmentedAndWait(job->client, job->frames, 5, &job->para);
+    std::lock_guard<std::mutex> lock(upgrade_mutex_);
+    job->state = 2;
+    return ret;
+}
+
+void JT808Server::PrepareUpgrades(void) {
+    std::lock_guard<std::mutex> lock(upgrade_mutex_);
+    for (auto it = upgrade_jobs_.begin(); it != upgrade_jobs_.end();) {
+        auto& job = **it;
+        if (job.state == 0) {
+            job.state   = -1;
+            auto client = clients_.end();
+            if (!job.by_phone) {
+                client = clients_.find(job.client);
             }
-            if (ReceiveAndParseMessage(socket, 5, &para) < 0) {
-                is_upgrading_clients_.erase(socket);
-                return -1;
+            else {
+                auto socket = client_sockets_.find(job.phone_num);
+                if (socket != client_sockets_.end())
+                    client = clients_.find(socket->second);
             }
-            if (para.parse.msg_head.msg_id != kTerminalGeneralResponse ||
-                para.parse.respone_msg_id != kTerminalUpgrade || para.parse.respone_result != kSuccess) {
-                is_upgrading_clients_.erase(socket);
-                return -1;
+            if (client != clients_.end() && is_upgrading_clients_.find(client->first) == is_upgrading_clients_.end()) {
+                // Sent with a copy of the client, the receive loop leaves the client alone meanwhile.
+                UpgradeInfo info         = std::move(job.para.upgrade_info);
+                job.client               = client->first;
+                job.para                 = client->second;
+                job.para.upgrade_info    = std::move(info);
+                job.para.msg_head.msg_id = kTerminalUpgrade;
+                int count = JT808SegmentedPackage(packager_, job.para, kMaxMsgBodyLength, &job.frames);
+                job.para.upgrade_info.upgrade_data.clear();
+                if (count < 0) {
+                    JT808_LOG_ERROR("%s[%d]: Package message failed !!!", __FUNCTION__, __LINE__);
+                }
+                else {
+                    // Each packet takes a message flow number.
+                    job.para.msg_head.msg_flow_num += count;
+                    client->second.msg_head.msg_flow_num = job.para.msg_head.msg_flow_num;
+                    is_upgrading_clients_.insert(std::make_pair(client->first, 0));
+                    job.state = 1;
+                }
             }
-            ++para.msg_head.packet_seq;
+            upgrade_cv_.notify_all();
         }
-        para.msg_head.msgbody_attr.bit.packet = 0;
-        para.msg_head.total_packet            = 1;
+        if (job.state == 2)
+            is_upgrading_clients_.erase(job.client);
+        if (job.state == 2 || job.state == -1)
+            it = upgrade_jobs_.erase(it);
+        else
+            ++it;
     }
-    else {
-        para.upgrade_info.upgrade_data.assign(buffer.get(), buffer.get() + length);
-        if (PackagingAndSendMessage(socket, kTerminalUpgrade, &para) < 0) {
-            is_upgrading_clients_.erase(socket);
+}
+
+int JT808Server::RestoreSession(ProtocolParameter* para) {
+    TerminalSession session;
+    if (session_store_.Find(para->parse.msg_head.phone_num, &session) < 0 || session.authentication_code.empty() ||
+        session.authentication_code != para->parse.authentication_code) {
+        return -1;
+    }
+    para->authentication_code            = std::move(session.authentication_code);
+    para->msg_head.msg_flow_num          = session.platform_flow_num;
+    para->parse.terminal_parameter_store = std::move(session.parameters);
+    return 0;
+}
+
+void JT808Server::SaveSession(ProtocolParameter const& para) {
+    if (!session_store_.is_open() || para.authentication_code.empty())
+        return;
+    TerminalSession session;
+    session.authentication_code = para.authentication_code;
+    session.platform_flow_num   = para.msg_head.msg_flow_num;
+    session.terminal_flow_num   = para.parse.msg_head.msg_flow_num;
+    session.parameters          = para.parse.terminal_parameter_store;
+    if (session_store_.Put(para.msg_head.phone_num, session) < 0)
+        JT808_LOG_ERROR("%s[%d]: Save session of %s failed !!!", __FUNCTION__, __LINE__,
+                        para.msg_head.phone_num.c_str());
+}
+
+int JT808Server::SendSegmentedAndWait(decltype(socket(0, 0, 0)) const& socket, SegmentedFrames const& frames,
+                                      int const& timeout, ProtocolParameter* para) {
+    std::lock_guard<std::mutex> lock(external_metrics_mutex_);
+    auto*                       shard = external_metrics_;
+    int ret = SendAll(socket, reinterpret_cast<char const*>(frames.data.data()), frames.data.size(), timeout * 1000);
+    if (ret < 0) {
+        JT808_LOG_ERROR("%s[%d]: Send message failed !!!", __FUNCTION__, __LINE__);
+        shard->Add(kSendFailures, 1);
+        return -1;
+    }
+    shard->Add(kBytesOut, ret);
+    shard->Add(kEscapeBytesOut, EscapedBytes(frames.data));
+    for (uint16_t i = 0; i < frames.count(); ++i)
+        shard->FrameOut(para->msg_head.msg_id);
+    std::vector<bool>    acked(frames.count(), false);
+    size_t               acked_count = 0;
+    std::vector<uint8_t> recv_buffer;
+    std::vector<uint8_t> msg;
+    char                 buffer[4096];
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+    while (acked_count < acked.size()) {
+        size_t begin = 0;
+        size_t end   = 0;
+        if (FindFrame(recv_buffer.data(), recv_buffer.size(), &begin, &end) == 0) {
+            msg.assign(recv_buffer.begin() + begin, recv_buffer.begin() + end);
+            recv_buffer.erase(recv_buffer.begin(), recv_buffer.begin() + end);
+            shard->Add(kEscapeBytesIn, EscapedBytes(msg));
+            if (auto error = JT808FrameParse(parser_, msg, para)) {
+                shard->ParseError(error.value());
+                continue;
+            }
+            auto const& parse = para->parse;
+            shard->FrameIn(parse.msg_head.msg_id);
+            if (parse.msg_head.msg_id != kTerminalGeneralResponse || parse.respone_msg_id != para->msg_head.msg_id)
+                continue;
+            if (parse.respone_result != kSuccess)
+                return -1;
+            uint16_t index = parse.respone_flow_num - frames.first_flow_num;
+            if (index < acked.size() && !acked[index]) {
+                acked[index] = true;
+                ++acked_count;
+                // Each response extends the wait, a large message takes a while to be received.
+                deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+            }
+            continue;
+        }
+        recv_buffer.erase(recv_buffer.begin(), recv_buffer.begin() + begin); // Drop bytes outside a frame.
+        auto remain =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remain <= 0) {
+            JT808_LOG_ERROR("%s[%d]: %zu of %zu packets acknowledged !!!", __FUNCTION__, __LINE__, acked_count,
+                            acked.size());
             return -1;
         }
-        if (ReceiveAndParseMessage(socket, 5, &para) < 0) {
-            is_upgrading_clients_.erase(socket);
+        if (WaitReadable(socket, static_cast<int>(remain)) <= 0)
+            continue;
+        if ((ret = Recv(socket, buffer, sizeof(buffer), 0)) > 0) {
+            shard->Add(kBytesIn, ret);
+            recv_buffer.insert(recv_buffer.end(), buffer, buffer + ret);
+        }
+        else if (ret == 0) {
+            JT808_LOG_INFO("%s[%d]: Disconnect !!!", __FUNCTION__, __LINE__);
             return -1;
         }
-        if (para.parse.respone_msg_id != kTerminalUpgrade || para.parse.respone_result != kSuccess) {
-            is_upgrading_clients_.erase(socket);
+        else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
             return -1;
         }
     }
-    is_upgrading_clients_.erase(socket);
     return 0;
 }
 
+int JT808Server::PushTerminalParameters(TerminalParameters const& desired, ParameterPushOptions const& options,
+                                        ParameterPushCallback const& callback) {
+    std::lock_guard<std::mutex> lock(push_request_mutex_);
+    if (push_request_ != nullptr || push_running_)
+        return -1;
+    push_request_.reset(new ParameterPushRequest);
+    push_request_->desired.Import(desired);
+    push_request_->options  = options;
+    push_request_->callback = callback;
+    return 0;
+}
+
+void JT808Server::RunParameterPush(void) {
+    {
+        std::lock_guard<std::mutex> lock(push_request_mutex_);
+        if (push_request_ != nullptr && push_ == nullptr) {
+            push_.reset(new ParameterPush(push_request_->desired, push_request_->options));
+            push_callback_ = push_request_->callback;
+            push_sockets_.clear();
+            for (auto const& client : clients_) {
+                auto const& phone = client.second.msg_head.phone_num;
+                if (push_->AddTerminal(phone, client.second.parse.terminal_parameter_store) == 0)
+                    push_sockets_[phone] = client.first;
+            }
+            push_request_.reset();
+            push_running_ = true;
+        }
+    }
+    if (push_ == nullptr)
+        return;
+    push_->Poll(SteadyClockMs(), [this](std::string const& terminal, TerminalParameterStore const& batch,
+                                        uint16_t* flow_num) -> int {
+        auto it = push_sockets_.find(terminal);
+        if (it == push_sockets_.end())
+            return -1;
+        auto client = clients_.find(it->second);
+        if (client == clients_.end())
+            return -1;
+        auto& para                    = client->second;
+        *flow_num                     = para.msg_head.msg_flow_num;
+        para.terminal_parameter_store = batch;
+        int ret = PackagingAndSendMessage(it->second, kSetTerminalParameters, &para, service_metrics_);
+        para.terminal_parameter_store.Clear();
+        return ret < 0 ? -1 : 0;
+    });
+    if (!push_->finished())
+        return;
+    if (push_callback_)
+        push_callback_(push_->results());
+    push_.reset();
+    push_callback_ = nullptr;
+    push_sockets_.clear();
+    std::lock_guard<std::mutex> lock(push_request_mutex_);
+    push_running_ = false;
+}
+
+void JT808Server::RequestMissingPackets(void) {
+    timers_.Add(kReassemblyPollMs, [this] { RequestMissingPackets(); });
+    fill_requests_.clear();
+    reassembler_.Poll(SteadyClockMs(), &fill_requests_);
+    service_metrics_->Add(kReassemblyDrops, reassembler_.dropped() - reassembly_dropped_);
+    reassembly_dropped_ = reassembler_.dropped();
+    for (auto const& request : fill_requests_) {
+        auto entry = client_sockets_.find(request.phone_num);
+        if (entry == client_sockets_.end())
+            continue;
+        auto client = clients_.find(entry->second);
+        if (client == clients_.end())
+            continue;
+        client->second.fill_packet = request.fill_packet;
+        if (PackagingAndSendMessage(client->first, kFillPacketRequest, &client->second, service_metrics_) == 0)
+            service_metrics_->Add(kFillRequests, 1);
+    }
+}
+
 // Generate the corresponding JT808 format message based on the provided message ID and the parameters set before
 // calling this function, and send it to the server through the socket.
 int JT808Server::PackagingAndSendMessage(decltype(socket(0, 0, 0)) const& socket, uint32_t const& msg_id,
                                          ProtocolParameter* para) {
+    std::lock_guard<std::mutex> lock(external_metrics_mutex_);
+    return PackagingAndSendMessage(socket, msg_id, para, external_metrics_);
+}
+
+int JT808Server::PackagingAndSendMessage(decltype(socket(0, 0, 0)) const& socket, uint32_t const& msg_id,
+                                         ProtocolParameter* para, Metrics::Shard* shard) {
     std::vector<uint8_t> msg;
     para->msg_head.msg_id = msg_id; // Set message ID.
     if (JT808FramePackage(packager_, *para, msg) < 0) {
-        printf("%s[%d]: Package message failed !!!\n", __FUNCTION__, __LINE__);
+        JT808_LOG_ERROR("%s[%d]: Package message failed !!!", __FUNCTION__, __LINE__);
+        shard->Add(kSendFailures, 1);
         return -1;
     }
     ++para->msg_head.msg_flow_num; // Increment message flow number for each successfully generated command.
-    if (Send(socket, reinterpret_cast<char*>(msg.data()), msg.size(), 0) <= 0) {
-        printf("%s[%d]: Send message failed !!!\n", __FUNCTION__, __LINE__);
+    int ret = Send(socket, reinterpret_cast<char*>(msg.data()), msg.size(), 0);
+    if (ret <= 0) {
+        JT808_LOG_ERROR("%s[%d]: Send message failed !!!", __FUNCTION__, __LINE__);
+        shard->Add(kSendFailures, 1);
         return -2;
     }
+    shard->Add(kBytesOut, ret);
+    shard->Add(kEscapeBytesOut, EscapedBytes(msg));
+    shard->FrameOut(static_cast<uint16_t>(msg_id));
     return 0;
 }
 
-// Blocking receive data from the socket connection once, then parse it according to the JT808 protocol.
+// Receive data from the socket connection once within timeout seconds, then parse it according to the JT808 protocol.
 int JT808Server::ReceiveAndParseMessage(decltype(socket(0, 0, 0)) const& socket, int const& timeout,
                                         ProtocolParameter* para) {
+    std::lock_guard<std::mutex> lock(external_metrics_mutex_);
+    return ReceiveAndParseMessage(socket, timeout, para, external_metrics_);
+}
+
+int JT808Server::ReceiveAndParseMessage(decltype(socket(0, 0, 0)) const& socket, int const& timeout,
+                                        ProtocolParameter* para, Metrics::Shard* shard) {
     std::vector<uint8_t>    msg;
     int                     ret        = -1;
     int                     timeout_ms = timeout * 1000; // Timeout period in milliseconds.
     auto                    tp         = std::chrono::steady_clock::now();
     std::unique_ptr<char[]> buffer(new char[4096], std::default_delete<char[]>());
     while (1) {
+        auto const remain =
+            timeout_ms -
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tp).count();
+        if (remain <= 0) {
+            JT808_LOG_INFO("%s[%d]: Receive timeout !!!", __FUNCTION__, __LINE__);
+            break;
+        }
+        // Accepted sockets stay blocking until authenticated, a terminal sending nothing must not block the receive.
+        int const ready = WaitReadable(socket, static_cast<int>(remain));
+        if (ready < 0 && errno != EINTR)
+            break;
+        if (ready <= 0)
+            continue;
         if ((ret = Recv(socket, buffer.get(), 4096, 0)) > 0) {
             msg.assign(buffer.get(), buffer.get() + ret);
             break;
         }
         else if (ret == 0) {
-            printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
+            JT808_LOG_INFO("%s[%d]: Disconnect !!!", __FUNCTION__, __LINE__);
             return -2;
         }
-        else {
-            // TODO: Handle other connection errors.
-        }
-        // Check for timeout exit.
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tp).count() >=
-            timeout_ms) {
+        else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
             break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     if (msg.empty())
         return -2;
+    if (capture_.is_open())
+        CaptureFrame(socket, msg);
+    shard->Add(kBytesIn, msg.size());
+    shard->Add(kEscapeBytesIn, EscapedBytes(msg));
     // Parse the message.
-    if (JT808FrameParse(parser_, msg, para)) {
-        printf("%s[%d]: Parse message failed !!!\n", __FUNCTION__, __LINE__);
+    if (auto error = JT808FrameParse(parser_, msg, para)) {
+        JT808_LOG_ERROR("%s[%d]: Parse message failed !!!", __FUNCTION__, __LINE__);
+        shard->ParseError(error.value());
         return -1;
     }
+    shard->FrameIn(para->parse.msg_head.msg_id);
     return 0;
 }
 
@@ -328,41 +1178,89 @@ void JT808Server::WaitHandler(void) {
     struct sockaddr_in addr;
     int                len = sizeof(addr);
     while (waiting_is_running_) {
+#if defined(__linux__)
+        // Takeovers are served between handshakes, the connections left in the backlog go to the new process.
+        if (handoff_listen_ >= 0) {
+            struct pollfd fds[2] = {{listen_, POLLIN, 0}, {handoff_listen_, POLLIN, 0}};
+            int           ready  = poll(fds, 2, -1);
+            if (ready > 0 && fds[1].revents != 0) {
+                if (AcceptTakeover() == 0)
+                    return; // The main service thread stops the server.
+                continue;
+            }
+            if (ready <= 0 || fds[0].revents == 0)
+                continue;
+        }
+#endif
         auto socket = Accept(listen_, reinterpret_cast<struct sockaddr*>(&addr), &len);
         if (socket <= 0) {
-            printf("%s[%d]: Invalid socket!!!\n", __FUNCTION__, __LINE__);
+            JT808_LOG_ERROR("%s[%d]: Invalid socket!!!", __FUNCTION__, __LINE__);
             break;
         }
+        wait_metrics_->Add(kConnectionsAccepted, 1);
+        if (capture_.is_open())
+            CaptureConnection(socket);
+        auto              accept_tp = std::chrono::steady_clock::now();
         ProtocolParameter para {};
-        if (ReceiveAndParseMessage(socket, 3, &para) < 0 || para.parse.msg_head.msg_id != kTerminalRegister) {
-            Close(socket);
-            continue;
-        }
-        // Generate authentication code.
-        srand(time(NULL));
-        std::string tmp(std::to_string(rand()));
-        para.authentication_code.assign(tmp.begin(), tmp.end());
-        para.respone_result = kRegisterSuccess;
-        if (PackagingAndSendMessage(socket, kTerminalRegisterResponse, &para) < 0) {
+        if (ReceiveAndParseMessage(socket, 3, &para, wait_metrics_) < 0) {
+            wait_metrics_->Add(kHandshakeFailures, 1);
             Close(socket);
             continue;
         }
-        // Wait for the authentication code to be returned.
-        if (ReceiveAndParseMessage(socket, 3, &para) < 0) {
-            Close(socket);
-            continue;
-        }
-        // Parse the returned message and compare the authentication code.
-        if (para.parse.msg_head.msg_id != kTerminalAuthentication ||
-            para.authentication_code != para.parse.authentication_code) {
-            Close(socket);
-            continue;
+        // A terminal registered before authenticates straight away with the authentication code of its session.
+        // Without a matching session the authentication fails and the terminal registers on the same connection.
+        bool restored = false;
+        if (para.parse.msg_head.msg_id == kTerminalAuthentication) {
+            restored            = RestoreSession(&para) == 0;
+            para.respone_result = restored ? kSuccess : kFailure;
+            if (PackagingAndSendMessage(socket, kPlatformGeneralResponse, &para, wait_metrics_) < 0 ||
+                (!restored && ReceiveAndParseMessage(socket, 3, &para, wait_metrics_) < 0)) {
+                wait_metrics_->Add(kHandshakeFailures, 1);
+                Close(socket);
+                continue;
+            }
+            if (restored)
+                wait_metrics_->Add(kSessionsRestored, 1);
         }
-        para.respone_result = kSuccess;
-        if (PackagingAndSendMessage(socket, kPlatformGeneralResponse, &para) < 0) {
-            Close(socket);
-            continue;
+        if (!restored) {
+            if (para.parse.msg_head.msg_id != kTerminalRegister) {
+                wait_metrics_->Add(kHandshakeFailures, 1);
+                Close(socket);
+                continue;
+            }
+            // Generate authentication code.
+            srand(time(NULL));
+            std::string tmp(std::to_string(rand()));
+            para.authentication_code.assign(tmp.begin(), tmp.end());
+            para.respone_result = kRegisterSuccess;
+            if (PackagingAndSendMessage(socket, kTerminalRegisterResponse, &para, wait_metrics_) < 0) {
+                wait_metrics_->Add(kHandshakeFailures, 1);
+                Close(socket);
+                continue;
+            }
+            // Wait for the authentication code to be returned.
+            if (ReceiveAndParseMessage(socket, 3, &para, wait_metrics_) < 0) {
+                wait_metrics_->Add(kHandshakeFailures, 1);
+                Close(socket);
+                continue;
+            }
+            // Parse the returned message and compare the authentication code.
+            if (para.parse.msg_head.msg_id != kTerminalAuthentication ||
+                para.authentication_code != para.parse.authentication_code) {
+                wait_metrics_->Add(kHandshakeFailures, 1);
+                Close(socket);
+                continue;
+            }
+            para.respone_result = kSuccess;
+            if (PackagingAndSendMessage(socket, kPlatformGeneralResponse, &para, wait_metrics_) < 0) {
+                wait_metrics_->Add(kHandshakeFailures, 1);
+                Close(socket);
+                continue;
+            }
+            SaveSession(para);
         }
+        wait_metrics_->Record(kHandshakeMicros, std::chrono::duration_cast<std::chrono::microseconds>(
+                                                    std::chrono::steady_clock::now() - accept_tp).count());
         // printf("Connected\n");
         // Set non-blocking mode.
 #if defined(__linux__)
@@ -371,12 +1269,15 @@ void JT808Server::WaitHandler(void) {
 #elif defined(_WIN32)
         unsigned long ul = 1;
         if (ioctlsocket(socket, FIONBIO, (unsigned long*)&ul) == SOCKET_ERROR) {
-            printf("%s[%d]: Set socket nonblock failed!!!\n", __FUNCTION__, __LINE__);
+            JT808_LOG_ERROR("%s[%d]: Set socket nonblock failed!!!", __FUNCTION__, __LINE__);
             Close(socket);
             continue;
         }
 #endif
-        clients_.insert(std::make_pair(socket, para));
+        // Hand over to the main service thread, which owns the client list.
+        std::lock_guard<std::mutex> lock(pending_clients_mutex_);
+        pending_clients_.push_back(std::make_pair(socket, std::move(para)));
+        metrics_.SetGauge(kPendingSessions, pending_clients_.size());
     }
     waiting_is_running_.store(false);
     Stop();
@@ -394,10 +1295,44 @@ void JT808Server::ServiceHandler(void) {
     std::vector<uint8_t>    msg;
     std::vector<uint16_t>   response_cmd = {kResponseCommand,
                                             kResponseCommand + sizeof(kResponseCommand) / sizeof(kResponseCommand[0])};
-    std::unique_ptr<char[]> data_buffer;
-    int                     total_size      = 0;
-    int                     packet_max_size = 0;
+    timers_.Start(SteadyClockMs());
+    RequestMissingPackets();
+    if (capture_.is_open())
+        FlushCapture();
+    if (track_store_.is_open())
+        FlushTrackStore();
+    // Clients taken over from a previous process.
+    for (auto const& client : clients_) {
+        directory_.Put(client.second.msg_head.phone_num, process_id_);
+        ArmIdleTimer(client.first, client.second);
+    }
     while (service_is_running_) {
+        // Take over the newly authenticated clients.
+        {
+            std::lock_guard<std::mutex> lock(pending_clients_mutex_);
+            for (auto& item : pending_clients_) {
+                if (directory_.is_open() && directory_.Put(item.second.msg_head.phone_num, process_id_) < 0) {
+                    JT808_LOG_WARN("%s[%d]: Session directory full, %s not entered", __FUNCTION__, __LINE__,
+                                   item.second.msg_head.phone_num.c_str());
+                }
+                ArmIdleTimer(item.first, item.second);
+                client_sockets_[item.second.msg_head.phone_num] = item.first;
+                clients_[item.first]                            = std::move(item.second);
+                receive_buffers_[item.first].clear();
+            }
+            pending_clients_.clear();
+            metrics_.SetGauge(kPendingSessions, 0);
+        }
+        PrepareUpgrades();
+        HandOver();
+        // Idle connections, retransmissions and reassembly timeouts.
+        timers_.Advance(SteadyClockMs());
+        SendDownlinks();
+        RunParameterPush();
+        metrics_.SetGauge(kActiveSessions, clients_.size());
+        metrics_.SetGauge(kReassemblyBuffers, reassembler_.size());
+        metrics_.SetGauge(kReassemblyBytes, reassembler_.bytes());
+        metrics_.SetGauge(kTimers, timers_.size());
         for (auto& socket : clients_) {
             // Upgrade requests are not handled here.
             if (is_upgrading_clients_.find(socket.first) != is_upgrading_clients_.end()) {
@@ -407,95 +1342,152 @@ void JT808Server::ServiceHandler(void) {
             if ((ret = Recv(socket.first, buffer.get(), 4096, 0)) > 0) {
                 if (!alive)
                     alive = true;
-                msg.assign(buffer.get(), buffer.get() + ret);
                 // printf("Recv[%d]: ", ret);
-                // for (auto const& ch : msg) printf("%02X ", ch);
+                // for (int i = 0; i < ret; ++i) printf("%02X ", static_cast<uint8_t>(buffer[i]));
                 // printf("\n");
-                if (!JT808FrameParse(parser_, msg, &socket.second)) {
+                service_metrics_->Add(kBytesIn, ret);
+                auto timer = idle_timers_.find(socket.first);
+                if (timer != idle_timers_.end())
+                    timers_.Reset(timer->second.first, timer->second.second);
+                auto&  recv_buffer = receive_buffers_[socket.first];
+                size_t buffered    = recv_buffer.size();
+                recv_buffer.insert(recv_buffer.end(), buffer.get(), buffer.get() + ret);
+                // Handle TCP sticky and half packets, parse frame by frame.
+                bool    disconnected = false;
+                size_t  offset       = 0;
+                size_t  begin        = 0;
+                size_t  end          = 0;
+                int64_t receive_ms   = ingest_producer_ != nullptr ? SystemClockMs() : 0;
+                while (!disconnected &&
+                       (FindFrame(recv_buffer.data() + offset, recv_buffer.size() - offset, &begin, &end) == 0)) {
+                    msg.assign(recv_buffer.begin() + offset + begin, recv_buffer.begin() + offset + end);
+                    offset += end;
+                    if (capture_.is_open())
+                        CaptureFrame(socket.first, msg);
+                    ScopedLatency latency(service_metrics_, kFrameHandleNanos);
+                    service_metrics_->Add(kEscapeBytesIn, EscapedBytes(msg));
+                    auto error = JT808FrameParse(parser_, segmented_parser_, &reassembler_, msg, SteadyClockMs(),
+                                                 &socket.second, ingest_producer_ != nullptr ? &ingest_body_ : nullptr,
+                                                 ingest_raw_);
+                    bool pending = error.value() == static_cast<int>(ParserError::PacketPending);
+                    if (error && !pending) {
+                        service_metrics_->ParseError(error.value());
+                        continue;
+                    }
                     socket.second.respone_result = kSuccess;
                     auto const& msg_id           = socket.second.parse.msg_head.msg_id;
+                    service_metrics_->FrameIn(msg_id);
+                    // Each packet of a segmented message is acknowledged, the message is handled once complete.
+                    if (pending) {
+                        if (PackagingAndSendMessage(socket.first, kPlatformGeneralResponse, &socket.second,
+                                                    service_metrics_) < 0) {
+                            disconnected = true;
+                        }
+                        continue;
+                    }
+                    // Handed over to the application threads with what was decoded here, or the undecoded body.
+                    bool ingested = false;
+                    if (ingest_producer_ != nullptr && ingest_->Routes(msg_id)) {
+                        IngestRecord record;
+                        record.phone_num  = socket.second.msg_head.phone_num;
+                        record.msg_id     = msg_id;
+                        record.flow_num   = socket.second.parse.msg_head.msg_flow_num;
+                        record.receive_ms = receive_ms;
+                        IngestFields(&socket.second, &record);
+                        record.body.swap(ingest_body_);
+                        service_metrics_->Add(ingest_producer_->Push(std::move(record)) == 0 ? kIngestRecords
+                                                                                               : kIngestDrops,
+                                              1);
+                        ingested = true;
+                    }
+                    if (!downlink_acks_.empty() &&
+                        (msg_id == kTerminalGeneralResponse || msg_id == kGetTerminalParametersResponse ||
+                         msg_id == kGetLocationInformationResponse)) {
+                        AcknowledgeDownlink(socket.first, socket.second.msg_head.phone_num,
+                                            socket.second.parse.respone_flow_num);
+                    }
                     if (msg_id == kLocationReport) {
-                        PrintLocationReportInfo(socket.second);
+                        if (message_display_.load() && !ingested)
+                            LogLocationReport(socket.second);
+                        if (track_store_.is_open() && !ingested)
+                            track_store_.Append(socket.second.msg_head.phone_num, socket.second.parse.location_info);
+                    }
+                    else if (msg_id == kGetLocationInformationResponse) {
+                        if (track_store_.is_open() && !ingested)
+                            track_store_.Append(socket.second.msg_head.phone_num, socket.second.parse.location_info);
+                    }
+                    else if (msg_id == kBatchLocationReport) { // Locations of a blind area, reported late.
+                        if (track_store_.is_open() && !ingested) {
+                            for (auto const& info : socket.second.parse.batch_loc.loc_info)
+                                track_store_.Append(socket.second.msg_head.phone_num, info);
+                        }
                     }
                     else if (msg_id == kGetTerminalParametersResponse) {
-                        PrintTerminalParameter(socket.second);
+                        if (message_display_.load() && !ingested)
+                            LogTerminalParameter(socket.second);
+                        SaveSession(socket.second);
                     }
-                    else if (msg_id == kMultimediaDataUpload) { // Multimedia data upload.
-                        // TODO: No packet integrity check is performed.
-                        auto&       media       = socket.second.parse.multimedia_upload;
-                        auto const& msg_head    = socket.second.parse.msg_head;
-                        auto const& packet_size = media.media_data.size();
-                        // Check for packet segmentation.
-                        if (msg_head.msgbody_attr.bit.packet == 1) { // Segmented packet.
-                            // Allocate space.
-                            if (msg_head.packet_seq == 1) { // First packet.
-                                int max_len = (1023 - 36) * msg_head.total_packet;
-                                data_buffer = std::move(
-                                    std::unique_ptr<char[]>(new char[max_len], std::default_delete<char[]>()));
-                                // Maximum data length of sub-packet.
-                                packet_max_size = packet_size;
-                                total_size      = 0;
-                            }
-                            memcpy(&(data_buffer[packet_max_size * (msg_head.packet_seq - 1)]), media.media_data.data(),
-                                   packet_size);
-                            total_size += packet_size;
-                            socket.second.respone_result = kSuccess;
-                            if (PackagingAndSendMessage(socket.first, kPlatformGeneralResponse, &socket.second) < 0) {
-                                printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
-                                data_buffer.reset();
-                                Close(socket.first);
-                                clients_.erase(socket.first);
-                                break; // When deleting a connection, do not continue traversing, but restart
-                                       // traversing.
-                            }
-                            // Wait for all data to be transmitted.
-                            if (msg_head.packet_seq == msg_head.total_packet) {
-                                media.media_data.clear();
-                                media.media_data.assign(data_buffer.get(), data_buffer.get() + total_size);
-                                multimedia_data_upload_callback_(media);
-                                media.media_data.clear();
-                                media.loaction_report_body.clear();
-                                data_buffer.reset();
-                                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                                // Temporarily return success directly.
-                                auto& resp    = socket.second.multimedia_upload_response;
-                                resp.media_id = media.media_id;
-                                resp.reload_packet_ids.clear();
-                                if (PackagingAndSendMessage(socket.first, kMultimediaDataUploadResponse,
-                                                            &socket.second) < 0) {
-                                    printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
-                                    Close(socket.first);
-                                    clients_.erase(socket.first);
-                                    break; // When deleting a connection, do not continue traversing, but restart
-                                           // traversing.
-                                }
+                    else if (msg_id == kTerminalLogOut) { // The terminal registers again on its next connection.
+                        session_store_.Erase(socket.second.msg_head.phone_num);
+                    }
+                    else if (msg_id == kTerminalGeneralResponse) {
+                        auto& parse = socket.second.parse;
+                        if (push_ != nullptr && parse.respone_msg_id == kSetTerminalParameters) {
+                            TerminalParameterStore const* batch = nullptr;
+                            if (push_->OnResponse(socket.second.msg_head.phone_num, parse.respone_flow_num,
+                                                  parse.respone_result, &batch) == 0 &&
+                                batch != nullptr) {
+                                parse.terminal_parameter_store.Merge(*batch);
+                                SaveSession(socket.second);
                             }
                         }
-                        else { // Not segmented.
+                    }
+                    else if (msg_id == kMultimediaDataUpload) { // Multimedia data upload, reassembled if segmented.
+                        auto& media = socket.second.parse.multimedia_upload;
+                        // The frame is acknowledged before the upload is answered.
+                        if (PackagingAndSendMessage(socket.first, kPlatformGeneralResponse, &socket.second,
+                                                    service_metrics_) < 0) {
+                            disconnected = true;
+                            continue;
+                        }
+                        if (!ingested)
                             multimedia_data_upload_callback_(media);
-                            media.media_data.clear();
-                            media.loaction_report_body.clear();
-                            socket.second.multimedia_upload_response.media_id = media.media_id;
-                            if (PackagingAndSendMessage(socket.first, kMultimediaDataUploadResponse, &socket.second) <
-                                0) {
-                                printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
-                                Close(socket.first);
-                                clients_.erase(socket.first);
-                                break; // When deleting a connection, do not continue traversing, but restart
-                                       // traversing.
-                            }
+                        media.media_data.clear();
+                        media.loaction_report_body.clear();
+                        // Temporarily return success directly.
+                        auto& resp    = socket.second.multimedia_upload_response;
+                        resp.media_id = media.media_id;
+                        resp.reload_packet_ids.clear();
+                        if (PackagingAndSendMessage(socket.first, kMultimediaDataUploadResponse, &socket.second,
+                                                    service_metrics_) < 0) {
+                            disconnected = true;
                         }
+                        continue;
                     }
                     // For non-response commands, the default is to use the platform general response.
                     if (find(response_cmd.begin(), response_cmd.end(), msg_id) == response_cmd.end()) {
-                        if (PackagingAndSendMessage(socket.first, kPlatformGeneralResponse, &socket.second) < 0) {
-                            printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
-                            Close(socket.first);
-                            clients_.erase(socket.first);
-                            break; // When deleting a connection, do not continue traversing, but restart traversing.
+                        if (PackagingAndSendMessage(socket.first, kPlatformGeneralResponse, &socket.second,
+                                                    service_metrics_) < 0) {
+                            disconnected = true;
+                            continue;
                         }
                     }
                 }
+                if (disconnected) {
+                    JT808_LOG_INFO("%s[%d]: Disconnect !!!", __FUNCTION__, __LINE__);
+                    // The gauge holds the bytes before this read, CloseClient() takes off the whole buffer.
+                    metrics_.AddGauge(kReceiveBufferBytes, static_cast<int64_t>(recv_buffer.size() - buffered));
+                    CloseClient(socket.first);
+                    break; // When deleting a connection, do not continue traversing, but restart traversing.
+                }
+                recv_buffer.erase(recv_buffer.begin(), recv_buffer.begin() + offset + begin);
+                // No frame end flag for too long, discard.
+                if (recv_buffer.size() > 65536) {
+                    recv_buffer.clear();
+                    service_metrics_->Add(kReceiveBufferOverflows, 1);
+                }
+                metrics_.AddGauge(kReceiveBufferBytes,
+                                  static_cast<int64_t>(recv_buffer.size()) - static_cast<int64_t>(buffered));
                 continue;
             }
             else if (ret <= 0) {
@@ -510,9 +1502,8 @@ void JT808Server::ServiceHandler(void) {
                         continue;
 #endif
                 }
-                printf("%s[%d]: Disconnect !!!\n", __FUNCTION__, __LINE__);
-                Close(socket.first);
-                clients_.erase(socket.first);
+                JT808_LOG_INFO("%s[%d]: Disconnect !!!", __FUNCTION__, __LINE__);
+                CloseClient(socket.first);
                 if (!alive)
                     alive = true;
                 break; // When deleting a connection, do not continue traversing, but restart traversing.
@@ -0,0 +1,288 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  session_directory.cc
+// @Version :  1.0
+// @Time    :  2026/10/25 10:37:52
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/session_directory.h"
+
+#include <string.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+constexpr uint8_t kMagic[8]     = {'J', 'T', '8', '0', '8', 'S', 'D', 0x01};
+constexpr size_t  kMaxPhoneSize = 22;
+// Keeps the load arithmetic in 32 bits, at 32 bytes a slot the file stays within 2 GiB.
+constexpr size_t kMaxCapacity = 1 << 26;
+// Slot states.
+constexpr uint8_t kSlotEmpty   = 0x0;
+constexpr uint8_t kSlotUsed    = 0x1;
+constexpr uint8_t kSlotRemoved = 0x2; // Tombstone, probing continues past it.
+
+} // namespace
+
+// Layout of the file, in host byte order as it never leaves the host: the header and capacity slots.
+struct SessionDirectory::Header {
+    uint8_t  magic[8];
+    uint32_t capacity;
+    uint32_t live;       // Slots in use.
+    uint32_t tombstones; // Slots of removed terminals.
+    uint32_t reserved;
+};
+
+struct SessionDirectory::Slot {
+    uint8_t  state;
+    uint8_t  size; // Length of the phone number.
+    char     phone_num[kMaxPhoneSize];
+    uint32_t owner;
+    uint32_t reserved;
+};
+
+SessionDirectory::~SessionDirectory() {
+    Close();
+}
+
+int SessionDirectory::Open(std::string const& path, size_t const& capacity) {
+#if defined(__linux__)
+    Close();
+    if (capacity == 0 || capacity > kMaxCapacity)
+        return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -1;
+    flock(fd, LOCK_EX);
+    struct stat st;
+    Header      header;
+    bool        failed = fstat(fd, &st) != 0;
+    // A file shorter than its header was never initialized, or its creator failed before it was.
+    if (!failed && static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.capacity = static_cast<uint32_t>(capacity);
+        failed          = pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header));
+    }
+    else if (!failed) {
+        failed = pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                 memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.capacity == 0 ||
+                 header.capacity > kMaxCapacity;
+    }
+    size_t const length = failed ? 0 : sizeof(Header) + static_cast<size_t>(header.capacity) * sizeof(Slot);
+    // The slots of a new file are zero filled, that is empty.
+    if (!failed && static_cast<size_t>(st.st_size) < length)
+        failed = ftruncate(fd, static_cast<off_t>(length)) != 0;
+    void* map = failed ? MAP_FAILED : mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    flock(fd, LOCK_UN);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    fd_     = fd;
+    map_    = map;
+    length_ = length;
+    header_ = static_cast<Header*>(map);
+    slots_  = reinterpret_cast<Slot*>(static_cast<uint8_t*>(map) + sizeof(Header));
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void SessionDirectory::Close(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+#if defined(__linux__)
+    if (map_ != nullptr)
+        munmap(map_, length_);
+    if (fd_ >= 0)
+        close(fd_);
+#endif
+    fd_     = -1;
+    map_    = nullptr;
+    length_ = 0;
+    header_ = nullptr;
+    slots_  = nullptr;
+}
+
+bool SessionDirectory::is_open(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fd_ >= 0;
+}
+
+void SessionDirectory::Lock(bool const& exclusive) const {
+#if defined(__linux__)
+    flock(fd_, exclusive ? LOCK_EX : LOCK_SH);
+#endif
+}
+
+void SessionDirectory::Unlock(void) const {
+#if defined(__linux__)
+    flock(fd_, LOCK_UN);
+#endif
+}
+
+SessionDirectory::Slot* SessionDirectory::Lookup(std::string const& phone_num) const {
+    if (phone_num.size() > kMaxPhoneSize)
+        return nullptr;
+    uint32_t const capacity = header_->capacity;
+    uint32_t       index    = Fnv1a(reinterpret_cast<uint8_t const*>(phone_num.data()), phone_num.size()) % capacity;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        auto& slot = slots_[index];
+        if (slot.state == kSlotEmpty)
+            return nullptr;
+        if (slot.state == kSlotUsed && slot.size == phone_num.size() &&
+            memcmp(slot.phone_num, phone_num.data(), slot.size) == 0) {
+            return &slot;
+        }
+        index = index + 1 == capacity ? 0 : index + 1;
+    }
+    return nullptr;
+}
+
+int SessionDirectory::Find(std::string const& phone_num, uint32_t* owner) const {
+    if (owner == nullptr)
+        return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0)
+        return -1;
+    Lock(false);
+    auto slot = Lookup(phone_num);
+    if (slot != nullptr)
+        *owner = slot->owner;
+    Unlock();
+    return slot != nullptr ? 0 : -1;
+}
+
+int SessionDirectory::Put(std::string const& phone_num, uint32_t const& owner) {
+    if (phone_num.size() > kMaxPhoneSize)
+        return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0)
+        return -1;
+    Lock(true);
+    int  ret  = 0;
+    auto slot = Lookup(phone_num);
+    if (slot != nullptr) {
+        slot->owner = owner;
+    }
+    else if ((header_->live + 1) * 4 > header_->capacity * 3) { // Probe chains stay short under 3/4 load.
+        ret = -1;
+    }
+    else {
+        if ((header_->live + header_->tombstones + 1) * 4 > header_->capacity * 3)
+            Rehash();
+        uint32_t index =
+            Fnv1a(reinterpret_cast<uint8_t const*>(phone_num.data()), phone_num.size()) % header_->capacity;
+        while (slots_[index].state == kSlotUsed)
+            index = index + 1 == header_->capacity ? 0 : index + 1;
+        slot = &slots_[index];
+        if (slot->state == kSlotRemoved)
+            --header_->tombstones;
+        slot->state = kSlotUsed;
+        slot->size  = static_cast<uint8_t>(phone_num.size());
+        memcpy(slot->phone_num, phone_num.data(), phone_num.size());
+        slot->owner = owner;
+        ++header_->live;
+    }
+    Unlock();
+    return ret;
+}
+
+int SessionDirectory::Erase(std::string const& phone_num, uint32_t const& owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0)
+        return -1;
+    Lock(true);
+    auto slot  = Lookup(phone_num);
+    bool found = slot != nullptr && slot->owner == owner;
+    if (found) {
+        slot->state = kSlotRemoved;
+        --header_->live;
+        ++header_->tombstones;
+    }
+    Unlock();
+    return found ? 0 : -1;
+}
+
+size_t SessionDirectory::EraseOwner(uint32_t const& owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0)
+        return 0;
+    Lock(true);
+    size_t count = 0;
+    for (uint32_t i = 0; i < header_->capacity; ++i) {
+        auto& slot = slots_[i];
+        if (slot.state == kSlotUsed && slot.owner == owner) {
+            slot.state = kSlotRemoved;
+            --header_->live;
+            ++header_->tombstones;
+            ++count;
+        }
+    }
+    Unlock();
+    return count;
+}
+
+void SessionDirectory::Rehash(void) {
+    std::vector<Slot> used;
+    used.reserve(header_->live);
+    for (uint32_t i = 0; i < header_->capacity; ++i) {
+        if (slots_[i].state == kSlotUsed)
+            used.push_back(slots_[i]);
+    }
+    memset(slots_, 0, sizeof(Slot) * header_->capacity);
+    for (auto const& slot : used) {
+        uint32_t index = Fnv1a(reinterpret_cast<uint8_t const*>(slot.phone_num), slot.size) % header_->capacity;
+        while (slots_[index].state == kSlotUsed)
+            index = index + 1 == header_->capacity ? 0 : index + 1;
+        slots_[index] = slot;
+    }
+    header_->tombstones = 0;
+}
+
+size_t SessionDirectory::size(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_ != nullptr ? header_->live : 0;
+}
+
+size_t SessionDirectory::capacity(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_ != nullptr ? header_->capacity : 0;
+}
+
+} // namespace libjt808
@@ -0,0 +1,268 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  session_store.cc
+// @Version :  1.0
+// @Time    :  2026/10/21 09:48:05
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/session_store.h"
+
+#include <string.h>
+
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Log layout, big endian:
+//     magic[8]
+//     record: payload size (DWORD), payload, FNV-1a of the payload (DWORD)
+//     payload: operation (BYTE), phone number length (BYTE), phone number,
+//              and for kRecordPut: authentication code length (BYTE), authentication code,
+//              platform flow number (WORD), terminal flow number (WORD), parameters as in the body of 0x8103.
+constexpr uint8_t kMagic[8]       = {'J', 'T', '8', '0', '8', 'S', 'S', 0x01};
+constexpr size_t  kRecordOverhead = 8;
+constexpr uint8_t kRecordPut      = 0x01;
+constexpr uint8_t kRecordErase    = 0x02;
+// Logs smaller than this are never compacted.
+constexpr size_t kCompactMinBytes = 1 << 20;
+
+int ReadFile(std::string const& path, std::vector<uint8_t>* out) {
+    out->clear();
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return -1;
+    uint8_t buffer[65536];
+    size_t  ret = 0;
+    while ((ret = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        out->insert(out->end(), buffer, buffer + ret);
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    return failed ? -1 : 0;
+}
+
+} // namespace
+
+SessionStore::~SessionStore() {
+    Close();
+}
+
+int SessionStore::Open(std::string const& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+    sessions_.clear();
+    live_bytes_ = 0;
+    path_       = path;
+    std::vector<uint8_t> log;
+    if (ReadFile(path, &log) == 0 && !log.empty()) {
+        if (log.size() < sizeof(kMagic) || memcmp(log.data(), kMagic, sizeof(kMagic)) != 0)
+            return -1;
+        file_bytes_ = sizeof(kMagic) + Replay(log);
+        // A torn record at the end, or records after it, would hide the records appended next.
+        if (file_bytes_ < log.size())
+            return CompactLocked();
+        file_ = fopen(path.c_str(), "ab");
+        return file_ == nullptr ? -1 : 0;
+    }
+    return CompactLocked();
+}
+
+void SessionStore::Close(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool SessionStore::is_open(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_ != nullptr;
+}
+
+size_t SessionStore::size(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+int SessionStore::Find(std::string const& phone_num, TerminalSession* session) const {
+    if (session == nullptr)
+        return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = sessions_.find(phone_num);
+    if (it == sessions_.end())
+        return -1;
+    *session = it->second.session;
+    return 0;
+}
+
+int SessionStore::Put(std::string const& phone_num, TerminalSession const& session) {
+    if (phone_num.size() > UINT8_MAX || session.authentication_code.size() > UINT8_MAX)
+        return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    scratch_.clear();
+    EncodeRecord(phone_num, &session, &scratch_);
+    auto& entry = sessions_[phone_num];
+    live_bytes_ = live_bytes_ - entry.record_size + scratch_.size();
+    entry       = {session, scratch_.size()};
+    return Append(scratch_);
+}
+
+int SessionStore::Erase(std::string const& phone_num) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = sessions_.find(phone_num);
+    if (it == sessions_.end())
+        return -1;
+    live_bytes_ -= it->second.record_size;
+    sessions_.erase(it);
+    scratch_.clear();
+    EncodeRecord(phone_num, nullptr, &scratch_);
+    return Append(scratch_);
+}
+
+int SessionStore::Compact(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return CompactLocked();
+}
+
+void SessionStore::EncodeRecord(std::string const& phone_num, TerminalSession const* session,
+                                std::vector<uint8_t>* out) {
+    size_t const begin = out->size();
+    PutBigEndian(0, 4, out); // Payload size, set below.
+    out->push_back(session != nullptr ? kRecordPut : kRecordErase);
+    out->push_back(static_cast<uint8_t>(phone_num.size()));
+    out->insert(out->end(), phone_num.begin(), phone_num.end());
+    if (session != nullptr) {
+        auto const& code = session->authentication_code;
+        out->push_back(static_cast<uint8_t>(code.size()));
+        out->insert(out->end(), code.begin(), code.end());
+        PutBigEndian(session->platform_flow_num, 2, out);
+        PutBigEndian(session->terminal_flow_num, 2, out);
+        size_t const parameters = out->size();
+        if (session->parameters.Encode(out) < 0) {
+            out->resize(parameters);
+            out->push_back(0);
+        }
+    }
+    uint32_t const size = static_cast<uint32_t>(out->size() - begin - 4);
+    for (int i = 0; i < 4; ++i)
+        (*out)[begin + i] = static_cast<uint8_t>(size >> (24 - 8 * i));
+    PutBigEndian(Fnv1a(out->data() + begin + 4, size), 4, out);
+}
+
+size_t SessionStore::Replay(std::vector<uint8_t> const& log) {
+    size_t pos = sizeof(kMagic);
+    while (log.size() - pos >= kRecordOverhead) {
+        uint32_t const size = GetBigEndian(&log[pos], 4);
+        if (size < 2 || log.size() - pos - kRecordOverhead < size)
+            break;
+        uint8_t const* payload = &log[pos + 4];
+        if (GetBigEndian(payload + size, 4) != Fnv1a(payload, size))
+            break;
+        uint8_t const* end = payload + size;
+        uint8_t const* p   = payload + 2;
+        if (end - p < payload[1])
+            break;
+        std::string phone_num(reinterpret_cast<char const*>(p), payload[1]);
+        p += payload[1];
+        if (payload[0] == kRecordErase) {
+            auto it = sessions_.find(phone_num);
+            if (it != sessions_.end()) {
+                live_bytes_ -= it->second.record_size;
+                sessions_.erase(it);
+            }
+        }
+        else {
+            if (payload[0] != kRecordPut || p == end || end - p < 1 + *p + 4)
+                break;
+            TerminalSession session;
+            session.authentication_code.assign(p + 1, p + 1 + *p);
+            p += 1 + *p;
+            session.platform_flow_num = static_cast<uint16_t>((p[0] << 8) | p[1]);
+            session.terminal_flow_num = static_cast<uint16_t>((p[2] << 8) | p[3]);
+            p += 4;
+            if (session.parameters.Decode(p, end - p) < 0)
+                break;
+            auto& entry = sessions_[phone_num];
+            live_bytes_ = live_bytes_ - entry.record_size + size + kRecordOverhead;
+            entry       = {std::move(session), size + kRecordOverhead};
+        }
+        pos += size + kRecordOverhead;
+    }
+    return pos - sizeof(kMagic);
+}
+
+int SessionStore::Append(std::vector<uint8_t> const& record) {
+    if (file_ == nullptr)
+        return -1;
+    if (fwrite(record.data(), 1, record.size(), file_) != record.size() || fflush(file_) != 0)
+        return -1;
+    file_bytes_ += record.size();
+    if (file_bytes_ > kCompactMinBytes && file_bytes_ > 2 * (sizeof(kMagic) + live_bytes_))
+        return CompactLocked();
+    return 0;
+}
+
+int SessionStore::CompactLocked(void) {
+    if (path_.empty())
+        return -1;
+    std::vector<uint8_t> log(kMagic, kMagic + sizeof(kMagic));
+    log.reserve(sizeof(kMagic) + live_bytes_);
+    for (auto& item : sessions_) {
+        size_t const begin = log.size();
+        EncodeRecord(item.first, &item.second.session, &log);
+        item.second.record_size = log.size() - begin;
+    }
+    // Write a new log next to the current one and replace it, a crash in between leaves either of them whole.
+    std::string const temp_path = path_ + ".tmp";
+    FILE*             temp      = fopen(temp_path.c_str(), "wb");
+    if (temp == nullptr)
+        return -1;
+    bool failed = fwrite(log.data(), 1, log.size(), temp) != log.size();
+    failed      = fclose(temp) != 0 || failed;
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+#if defined(_WIN32)
+    if (!failed)
+        remove(path_.c_str());
+#endif
+    if (failed || rename(temp_path.c_str(), path_.c_str()) != 0) {
+        remove(temp_path.c_str());
+        file_ = fopen(path_.c_str(), "ab");
+        return -1;
+    }
+    file_bytes_ = log.size();
+    live_bytes_ = log.size() - sizeof(kMagic);
+    file_       = fopen(path_.c_str(), "ab");
+    return file_ == nullptr ? -1 : 0;
+}
+
+} // namespace libjt808
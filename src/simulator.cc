@@ -0,0 +1,822 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  simulator.cc
+// @Version :  1.0
+// @Time    :  2026/10/16 15:20:08
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/simulator.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#endif
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "jt808/event_loop.h"
+#include "jt808/logger.h"
+#include "jt808/packager.h"
+#include "jt808/parser.h"
+#include "jt808/socket_util.h"
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+constexpr uint32_t kConnectTickMs    = 10;         // Connection pacing period.
+constexpr uint32_t kMaxMediaContent  = 1023 - 36;  // Multimedia data bytes per 0x0801 packet.
+constexpr uint16_t kMaxBatchSize     = (1023 - 3) / 30; // Locations without extensions fitting in one 0x0704 body.
+constexpr size_t   kMaxInFlight      = 64;         // Requests awaiting a response per terminal.
+constexpr size_t   kMaxSendBuffer    = 1 << 20;    // Pending bytes of a stalled terminal before dropping it.
+constexpr size_t   kMaxReceiveBuffer = 1 << 16;    // Bytes without a complete frame before discarding them.
+
+enum TerminalState : uint8_t {
+    kIdle = 0,       // Not connected.
+    kConnecting,     // TCP connection in progress.
+    kRegistering,    // 0x0100 sent, waiting for 0x8100.
+    kAuthenticating, // 0x0102 sent, waiting for 0x8001.
+    kResuming,       // 0x0102 with the code of an earlier connection sent, waiting for 0x8001.
+    kOnline,         // Authenticated.
+};
+
+// Request waiting for a platform response.
+struct InFlight {
+    uint16_t                     flow_num;
+    EventLoop::Clock::time_point send_tp;
+};
+
+// Virtual terminal.
+struct Terminal {
+    EventLoop::Handle            socket      = -1;
+    uint8_t                      state       = kIdle;
+    uint16_t                     flow_num    = 0;
+    uint32_t                     route_step  = 0; // Position on the simulated route.
+    EventLoop::TimerId           timer       = 0; // Handshake timeout, reconnect delay or traffic timer.
+    std::string                  phone_num;
+    std::vector<uint8_t>         auth_code;
+    std::vector<uint8_t>         recv_buffer;
+    std::vector<uint8_t>         send_buffer;
+    size_t                       send_offset = 0;
+    std::vector<InFlight>        in_flight;
+    EventLoop::Clock::time_point last_send_tp;
+    EventLoop::Clock::time_point next_report_tp;
+    EventLoop::Clock::time_point next_batch_tp;
+    EventLoop::Clock::time_point next_media_tp;
+    // Multimedia upload in progress.
+    bool                         media_uploading   = false;
+    uint32_t                     media_id          = 0;
+    uint16_t                     media_total       = 0;
+    uint16_t                     media_seq         = 0;
+    uint16_t                     media_wait_flow   = 0;
+    EventLoop::Clock::time_point media_tp;
+};
+
+int64_t ElapsedMs(EventLoop::Clock::time_point const& from, EventLoop::Clock::time_point const& to) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+} // namespace
+
+//
+// Worker, one event loop driving a slice of the terminals.
+//
+class TerminalSimulator::Worker {
+public:
+    Worker(SimulatorOptions const& options, uint32_t const& first_index, uint32_t const& count);
+    ~Worker();
+
+    int  Start(void);
+    void Stop(void);
+    void GetStatistics(SimulatorStatistics* stats, bool const& reset_rtt);
+
+private:
+    void ThreadHandler(void);
+    // Start the connections allowed by the connect rate.
+    void OnConnectTick(void);
+    void StartConnect(uint32_t const& index);
+    void OnSocketEvent(uint32_t const& index, int const& events);
+    void OnConnected(uint32_t const& index);
+    void OnHandshakeTimeout(uint32_t const& index);
+    void OnTrafficTimer(uint32_t const& index);
+    void HandleFrame(uint32_t const& index);
+    void GoOnline(uint32_t const& index);
+    // Package a message for the terminal and write it.
+    // Returns 0 on success, -1 if the connection was dropped.
+    int  SendMessage(uint32_t const& index, uint16_t const& msg_id);
+    // Write the pending bytes of the terminal.
+    int  Flush(uint32_t const& index);
+    void SendNextMediaPacket(uint32_t const& index);
+    void MatchResponse(Terminal* terminal, uint16_t const& flow_num);
+    // Close the connection and schedule a reconnect.
+    void Drop(uint32_t const& index);
+    void FillLocation(Terminal* terminal, uint32_t const& index, LocationBasicInformation* location);
+    std::string const& Timestamp(void);
+
+    SimulatorOptions      options_;
+    uint32_t              first_index_; // Index of the first terminal over all workers.
+    double                connect_per_tick_;
+    double                connect_credit_;
+    uint32_t              traffic_interval_; // Traffic timer period, the smallest enabled interval.
+    EventLoop             loop_;
+    std::thread           thread_;
+    std::atomic_bool      is_running_;
+    std::vector<Terminal> terminals_;
+    std::deque<uint32_t>  connect_queue_; // Terminals waiting to connect.
+    std::mt19937          random_;
+    Packager              packager_;
+    Parser                parser_;
+    ProtocolParameter     para_;  // Parameters used to package messages.
+    ProtocolParameter     parse_; // Parameters filled by parsing.
+    std::vector<uint8_t>  frame_;
+    std::vector<uint8_t>  media_data_; // Payload of every multimedia upload.
+    time_t                timestamp_time_;
+    std::string           timestamp_;
+    // Statistics, written by the worker thread and read by others.
+    std::atomic<uint64_t> online_;
+    std::atomic<uint64_t> connects_;
+    std::atomic<uint64_t> connect_failures_;
+    std::atomic<uint64_t> auth_failures_;
+    std::atomic<uint64_t> resumes_;
+    std::atomic<uint64_t> disconnects_;
+    std::atomic<uint64_t> timeouts_;
+    std::atomic<uint64_t> sent_messages_;
+    std::atomic<uint64_t> received_messages_;
+    std::atomic<uint64_t> sent_bytes_;
+    std::atomic<uint64_t> received_bytes_;
+    std::atomic<uint64_t> location_reports_;
+    std::atomic<uint64_t> batch_reports_;
+    std::atomic<uint64_t> multimedia_uploads_;
+    std::mutex            rtt_mutex_;
+    LatencyHistogram      rtt_;
+};
+
+TerminalSimulator::Worker::Worker(SimulatorOptions const& options, uint32_t const& first_index,
+                                  uint32_t const& count)
+    : options_(options), first_index_(first_index), connect_per_tick_(0), connect_credit_(0), traffic_interval_(0),
+      is_running_(false), terminals_(count), random_(first_index), para_(), parse_(), timestamp_time_(0),
+      online_(0), connects_(0), connect_failures_(0), auth_failures_(0), resumes_(0), disconnects_(0), timeouts_(0),
+      sent_messages_(0), received_messages_(0), sent_bytes_(0), received_bytes_(0), location_reports_(0),
+      batch_reports_(0), multimedia_uploads_(0) {
+    JT808FrameParserInit(&parser_);
+    JT808FramePackagerInit(&packager_);
+    for (uint32_t i = 0; i < count; ++i) {
+        terminals_[i].phone_num = std::to_string(options_.first_phone_num + first_index + i);
+    }
+    // Default registration information.
+    para_.register_info.province_id  = 0x002c;
+    para_.register_info.city_id      = 0x012c;
+    para_.register_info.manufacturer_id.assign({'S', 'K', 'O', 'E', 'M'});
+    para_.register_info.terminal_model.assign({'S', 'K', '9', '1', '5', '1'});
+    para_.register_info.terminal_id.assign({'0', '0', '0', '0', '0', '1'});
+    para_.register_info.car_plate_color = kBlue;
+    para_.register_info.car_plate_num   = "\xD4\xC1\x42\x31\x32\x33\x34\x35";
+    para_.msg_head.msgbody_attr.u16val  = 0;
+    // Multimedia upload without location information.
+    para_.multimedia_upload.media_type   = 0x00;
+    para_.multimedia_upload.media_format = 0x00;
+    para_.multimedia_upload.media_event  = 0x01;
+    para_.multimedia_upload.channel_id   = 0x01;
+    para_.multimedia_upload.loaction_report_body.assign(28, 0);
+    media_data_.resize(options_.multimedia_size);
+    for (size_t i = 0; i < media_data_.size(); ++i)
+        media_data_[i] = static_cast<uint8_t>(i);
+    // The traffic timer runs at the smallest enabled interval.
+    uint32_t intervals[] = {options_.report_interval, options_.heartbeat_interval, options_.batch_interval,
+                            options_.multimedia_interval};
+    for (auto const& interval : intervals) {
+        if (interval > 0 && (traffic_interval_ == 0 || interval < traffic_interval_))
+            traffic_interval_ = interval;
+    }
+}
+
+TerminalSimulator::Worker::~Worker() {
+    Stop();
+}
+
+int TerminalSimulator::Worker::Start(void) {
+    if (loop_.Init() < 0)
+        return -1;
+    if (options_.connect_rate > 0) {
+        connect_per_tick_ = options_.connect_rate * kConnectTickMs / 1000.0 / options_.thread_count;
+    }
+    connect_credit_ = 0;
+    for (uint32_t i = 0; i < terminals_.size(); ++i)
+        connect_queue_.push_back(i);
+    is_running_.store(true);
+    thread_ = std::thread(&Worker::ThreadHandler, this);
+    return 0;
+}
+
+void TerminalSimulator::Worker::Stop(void) {
+    if (!thread_.joinable())
+        return;
+    is_running_.store(false);
+    loop_.Quit();
+    thread_.join();
+}
+
+void TerminalSimulator::Worker::GetStatistics(SimulatorStatistics* stats, bool const& reset_rtt) {
+    stats->online += online_.load(std::memory_order_relaxed);
+    stats->connects += connects_.load(std::memory_order_relaxed);
+    stats->connect_failures += connect_failures_.load(std::memory_order_relaxed);
+    stats->auth_failures += auth_failures_.load(std::memory_order_relaxed);
+    stats->resumes += resumes_.load(std::memory_order_relaxed);
+    stats->disconnects += disconnects_.load(std::memory_order_relaxed);
+    stats->timeouts += timeouts_.load(std::memory_order_relaxed);
+    stats->sent_messages += sent_messages_.load(std::memory_order_relaxed);
+    stats->received_messages += received_messages_.load(std::memory_order_relaxed);
+    stats->sent_bytes += sent_bytes_.load(std::memory_order_relaxed);
+    stats->received_bytes += received_bytes_.load(std::memory_order_relaxed);
+    stats->location_reports += location_reports_.load(std::memory_order_relaxed);
+    stats->batch_reports += batch_reports_.load(std::memory_order_relaxed);
+    stats->multimedia_uploads += multimedia_uploads_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(rtt_mutex_);
+    stats->rtt.Merge(rtt_);
+    if (reset_rtt)
+        rtt_.Reset();
+}
+
+void TerminalSimulator::Worker::ThreadHandler(void) {
+#if defined(__linux__)
+    // Named so that benchmarks can tell the simulator CPU time from the server's.
+    pthread_setname_np(pthread_self(), "jt808-sim");
+#endif
+    loop_.AddTimer(0, kConnectTickMs, [this] {
+        OnConnectTick();
+    });
+    loop_.Run();
+    // Close all connections.
+    for (uint32_t i = 0; i < terminals_.size(); ++i) {
+        auto& terminal = terminals_[i];
+        if (terminal.socket >= 0) {
+            loop_.RemoveHandle(terminal.socket);
+            Close(terminal.socket);
+            terminal.socket = -1;
+        }
+        if (terminal.timer != 0) {
+            loop_.CancelTimer(terminal.timer);
+            terminal.timer = 0;
+        }
+        terminal.state = kIdle;
+    }
+    online_.store(0);
+}
+
+void TerminalSimulator::Worker::OnConnectTick(void) {
+    size_t num = connect_queue_.size();
+    if (connect_per_tick_ > 0) {
+        connect_credit_ = std::min(connect_credit_ + connect_per_tick_, std::max(connect_per_tick_, 1.0) * 2);
+        num             = std::min(num, static_cast<size_t>(connect_credit_));
+        connect_credit_ -= num;
+    }
+    while (num-- > 0) {
+        auto index = connect_queue_.front();
+        connect_queue_.pop_front();
+        StartConnect(index);
+    }
+}
+
+void TerminalSimulator::Worker::StartConnect(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    auto  global   = first_index_ + index;
+    auto  socket   = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socket < 0 || SetNonBlocking(socket) < 0) {
+        if (socket >= 0)
+            Close(socket);
+        ++connect_failures_;
+        terminal.socket = -1;
+        Drop(index);
+        return;
+    }
+    int on = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const*>(&on), sizeof(on));
+    struct sockaddr_in addr;
+    // Spread the terminals over the source addresses, each address has its own ephemeral port range.
+    if (!options_.source_ips.empty()) {
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = inet_addr(options_.source_ips[global % options_.source_ips.size()].c_str());
+#if defined(IP_BIND_ADDRESS_NO_PORT)
+        // Defer the port choice to connect(), ports are then shared by different destinations.
+        setsockopt(socket, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &on, sizeof(on));
+#endif
+        if (Bind(socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+            Close(socket);
+            ++connect_failures_;
+            terminal.socket = -1;
+            Drop(index);
+            return;
+        }
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(static_cast<uint16_t>(options_.server_port));
+    addr.sin_addr.s_addr = inet_addr(options_.server_ip.c_str());
+    terminal.socket      = socket;
+    terminal.state       = kConnecting;
+    if (loop_.AddHandle(socket, EventLoop::kWritable, [this, index](int const& events) {
+            OnSocketEvent(index, events);
+        }) < 0) {
+        ++connect_failures_;
+        Drop(index);
+        return;
+    }
+    terminal.timer = loop_.AddTimer(options_.response_timeout, 0, [this, index] {
+        terminals_[index].timer = 0;
+        OnHandshakeTimeout(index);
+    });
+    if (Connect(socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        OnConnected(index);
+    }
+    else if (errno != EINPROGRESS) {
+        ++connect_failures_;
+        Drop(index);
+    }
+}
+
+void TerminalSimulator::Worker::OnConnected(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    ++connects_;
+    loop_.ModifyHandle(terminal.socket, EventLoop::kReadable);
+    terminal.state = kRegistering;
+    terminal.recv_buffer.clear();
+    terminal.send_buffer.clear();
+    terminal.send_offset = 0;
+    terminal.in_flight.clear();
+    // Terminals registered on an earlier connection only authenticate, as real terminals keep their code.
+    if (!terminal.auth_code.empty()) {
+        terminal.state = kResuming;
+        SendMessage(index, kTerminalAuthentication);
+        return;
+    }
+    SendMessage(index, kTerminalRegister);
+}
+
+void TerminalSimulator::Worker::OnHandshakeTimeout(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    if (terminal.state == kConnecting)
+        ++connect_failures_;
+    else if (terminal.state != kOnline)
+        ++auth_failures_;
+    Drop(index);
+}
+
+void TerminalSimulator::Worker::OnSocketEvent(uint32_t const& index, int const& events) {
+    auto& terminal = terminals_[index];
+    if (terminal.state == kConnecting) {
+        int       error = 0;
+        socklen_t len   = sizeof(error);
+        getsockopt(terminal.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len);
+        if (error != 0) {
+            ++connect_failures_;
+            Drop(index);
+            return;
+        }
+        OnConnected(index);
+        return;
+    }
+    if ((events & EventLoop::kWritable) && (Flush(index) < 0))
+        return;
+    if (!(events & EventLoop::kReadable))
+        return;
+    char buffer[4096];
+    while (1) {
+        int ret = Recv(terminal.socket, buffer, sizeof(buffer), 0);
+        if (ret > 0) {
+            received_bytes_.fetch_add(ret, std::memory_order_relaxed);
+            terminal.recv_buffer.insert(terminal.recv_buffer.end(), buffer, buffer + ret);
+            if (ret < static_cast<int>(sizeof(buffer)))
+                break;
+        }
+        else if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else {
+            Drop(index);
+            return;
+        }
+    }
+    // Handle TCP sticky and half packets.
+    size_t offset = 0;
+    size_t begin  = 0;
+    size_t end    = 0;
+    while (FindFrame(terminal.recv_buffer.data() + offset, terminal.recv_buffer.size() - offset, &begin, &end) == 0) {
+        frame_.assign(terminal.recv_buffer.begin() + offset + begin, terminal.recv_buffer.begin() + offset + end);
+        offset += end;
+        HandleFrame(index);
+        if (terminal.socket < 0) // Dropped while handling the frame.
+            return;
+    }
+    terminal.recv_buffer.erase(terminal.recv_buffer.begin(), terminal.recv_buffer.begin() + offset + begin);
+    if (terminal.recv_buffer.size() > kMaxReceiveBuffer)
+        terminal.recv_buffer.clear();
+}
+
+void TerminalSimulator::Worker::HandleFrame(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    if (JT808FrameParse(parser_, frame_, &parse_))
+        return;
+    received_messages_.fetch_add(1, std::memory_order_relaxed);
+    auto const& parse  = parse_.parse;
+    auto const& msg_id = parse.msg_head.msg_id;
+    if (msg_id == kTerminalRegisterResponse) {
+        MatchResponse(&terminal, parse.respone_flow_num);
+        if (terminal.state != kRegistering)
+            return;
+        if (parse.respone_result != kRegisterSuccess) {
+            ++auth_failures_;
+            Drop(index);
+            return;
+        }
+        terminal.auth_code = parse.authentication_code;
+        terminal.state     = kAuthenticating;
+        SendMessage(index, kTerminalAuthentication);
+    }
+    else if (msg_id == kPlatformGeneralResponse) {
+        MatchResponse(&terminal, parse.respone_flow_num);
+        if (terminal.state == kResuming && parse.respone_msg_id == kTerminalAuthentication) {
+            if (parse.respone_result == kSuccess) {
+                ++resumes_;
+                GoOnline(index);
+                return;
+            }
+            // The platform no longer knows the code, register again on the same connection.
+            terminal.auth_code.clear();
+            terminal.state = kRegistering;
+            SendMessage(index, kTerminalRegister);
+        }
+        else if (terminal.state == kAuthenticating && parse.respone_msg_id == kTerminalAuthentication) {
+            if (parse.respone_result != kSuccess) {
+                ++auth_failures_;
+                Drop(index);
+                return;
+            }
+            GoOnline(index);
+        }
+        else if (terminal.media_uploading && parse.respone_msg_id == kMultimediaDataUpload &&
+                 parse.respone_flow_num == terminal.media_wait_flow) {
+            // Stop and wait, one packet in flight per upload.
+            terminal.media_wait_flow = terminal.flow_num;
+            SendNextMediaPacket(index);
+        }
+    }
+    else if (msg_id == kMultimediaDataUploadResponse) {
+        if (terminal.media_uploading && terminal.media_seq > terminal.media_total) {
+            terminal.media_uploading = false;
+            multimedia_uploads_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else if (msg_id == kSetTerminalParameters) {
+        // Acknowledge, the parameters are not applied.
+        para_.parse.msg_head = parse.msg_head;
+        para_.respone_result = kSuccess;
+        SendMessage(index, kTerminalGeneralResponse);
+    }
+}
+
+void TerminalSimulator::Worker::GoOnline(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    auto  now      = EventLoop::Clock::now();
+    terminal.state = kOnline;
+    ++online_;
+    loop_.CancelTimer(terminal.timer);
+    terminal.timer = 0;
+    if (traffic_interval_ == 0)
+        return;
+    // Spread the first traffic of the terminals over one period.
+    auto delay              = random_() % traffic_interval_;
+    auto first_tp           = now + std::chrono::milliseconds(delay);
+    terminal.next_report_tp = first_tp;
+    terminal.next_batch_tp  = first_tp + std::chrono::milliseconds(options_.batch_interval);
+    terminal.next_media_tp  = first_tp + std::chrono::milliseconds(options_.multimedia_interval);
+    terminal.timer          = loop_.AddTimer(delay, traffic_interval_, [this, index] {
+        OnTrafficTimer(index);
+    });
+}
+
+void TerminalSimulator::Worker::OnTrafficTimer(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    auto  now      = EventLoop::Clock::now();
+    if (options_.report_interval > 0 && now >= terminal.next_report_tp) {
+        terminal.next_report_tp += std::chrono::milliseconds(options_.report_interval);
+        if (terminal.next_report_tp < now)
+            terminal.next_report_tp = now + std::chrono::milliseconds(options_.report_interval);
+        FillLocation(&terminal, index, &para_.location_info);
+        if (SendMessage(index, kLocationReport) < 0)
+            return;
+        location_reports_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (options_.batch_interval > 0 && now >= terminal.next_batch_tp) {
+        terminal.next_batch_tp = now + std::chrono::milliseconds(options_.batch_interval);
+        auto& batch_loc        = para_.batch_loc;
+        batch_loc.data_type    = 0;
+        batch_loc.loc_info.resize(options_.batch_size);
+        batch_loc.loc_ext.clear();
+        for (auto& location : batch_loc.loc_info)
+            FillLocation(&terminal, index, &location);
+        if (SendMessage(index, kBatchLocationReport) < 0)
+            return;
+        batch_reports_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (options_.multimedia_interval > 0) {
+        if (terminal.media_uploading && ElapsedMs(terminal.media_tp, now) >= options_.response_timeout) {
+            terminal.media_uploading = false; // Give up the upload, the platform stopped answering.
+            timeouts_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!terminal.media_uploading && now >= terminal.next_media_tp) {
+            terminal.next_media_tp   = now + std::chrono::milliseconds(options_.multimedia_interval);
+            terminal.media_uploading = true;
+            terminal.media_tp        = now;
+            terminal.media_total     = static_cast<uint16_t>((media_data_.size() + kMaxMediaContent - 1) /
+                                                         kMaxMediaContent);
+            terminal.media_seq       = 1;
+            terminal.media_wait_flow = terminal.flow_num;
+            ++terminal.media_id;
+            SendNextMediaPacket(index);
+            if (terminal.socket < 0)
+                return;
+        }
+    }
+    if (options_.heartbeat_interval > 0 && ElapsedMs(terminal.last_send_tp, now) >= options_.heartbeat_interval) {
+        SendMessage(index, kTerminalHeartBeat);
+    }
+}
+
+void TerminalSimulator::Worker::SendNextMediaPacket(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    if (terminal.media_seq > terminal.media_total) // All packets sent, waiting for 0x8800.
+        return;
+    auto& media    = para_.multimedia_upload;
+    auto  offset   = (terminal.media_seq - 1) * kMaxMediaContent;
+    auto  len      = std::min<size_t>(kMaxMediaContent, media_data_.size() - offset);
+    media.media_id = terminal.media_id;
+    media.media_data.assign(media_data_.begin() + offset, media_data_.begin() + offset + len);
+    if (terminal.media_total > 1) {
+        para_.msg_head.msgbody_attr.bit.packet = 1;
+        para_.msg_head.total_packet            = terminal.media_total;
+        para_.msg_head.packet_seq              = terminal.media_seq;
+    }
+    ++terminal.media_seq;
+    terminal.media_tp = EventLoop::Clock::now();
+    SendMessage(index, kMultimediaDataUpload);
+    para_.msg_head.msgbody_attr.bit.packet = 0;
+    para_.msg_head.total_packet            = 0;
+    para_.msg_head.packet_seq              = 0;
+}
+
+int TerminalSimulator::Worker::SendMessage(uint32_t const& index, uint16_t const& msg_id) {
+    auto& terminal = terminals_[index];
+    auto  now      = EventLoop::Clock::now();
+    para_.msg_head.msg_id       = msg_id;
+    para_.msg_head.phone_num    = terminal.phone_num;
+    para_.msg_head.msg_flow_num = terminal.flow_num;
+    if (msg_id == kTerminalAuthentication)
+        para_.parse.authentication_code = terminal.auth_code;
+    if (JT808FramePackage(packager_, para_, frame_) < 0)
+        return 0;
+    // Every terminal request of the simulator is answered by the platform, its responses are not.
+    if (msg_id != kTerminalGeneralResponse) {
+        if (terminal.in_flight.size() >= kMaxInFlight) {
+            terminal.in_flight.erase(terminal.in_flight.begin());
+            timeouts_.fetch_add(1, std::memory_order_relaxed);
+        }
+        terminal.in_flight.push_back(InFlight {terminal.flow_num, now});
+    }
+    ++terminal.flow_num;
+    terminal.last_send_tp = now;
+    sent_messages_.fetch_add(1, std::memory_order_relaxed);
+    sent_bytes_.fetch_add(frame_.size(), std::memory_order_relaxed);
+    if (terminal.send_buffer.size() - terminal.send_offset + frame_.size() > kMaxSendBuffer) {
+        Drop(index); // The platform stopped reading.
+        return -1;
+    }
+    terminal.send_buffer.insert(terminal.send_buffer.end(), frame_.begin(), frame_.end());
+    return Flush(index);
+}
+
+int TerminalSimulator::Worker::Flush(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    while (terminal.send_offset < terminal.send_buffer.size()) {
+        int ret = Send(terminal.socket, reinterpret_cast<char const*>(terminal.send_buffer.data()) + terminal.send_offset,
+                       static_cast<int>(terminal.send_buffer.size() - terminal.send_offset), MSG_NOSIGNAL);
+        if (ret > 0) {
+            terminal.send_offset += ret;
+        }
+        else if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            loop_.ModifyHandle(terminal.socket, EventLoop::kReadable | EventLoop::kWritable);
+            return 0;
+        }
+        else {
+            Drop(index);
+            return -1;
+        }
+    }
+    terminal.send_buffer.clear();
+    terminal.send_offset = 0;
+    loop_.ModifyHandle(terminal.socket, EventLoop::kReadable);
+    return 0;
+}
+
+void TerminalSimulator::Worker::MatchResponse(Terminal* terminal, uint16_t const& flow_num) {
+    auto& in_flight = terminal->in_flight;
+    for (size_t i = 0; i < in_flight.size(); ++i) {
+        if (in_flight[i].flow_num != flow_num)
+            continue;
+        auto usec = std::chrono::duration_cast<std::chrono::microseconds>(EventLoop::Clock::now() -
+                                                                          in_flight[i].send_tp)
+                        .count();
+        {
+            std::lock_guard<std::mutex> lock(rtt_mutex_);
+            rtt_.Record(static_cast<uint64_t>(usec));
+        }
+        // Responses come in request order, the earlier requests were not answered.
+        timeouts_.fetch_add(i, std::memory_order_relaxed);
+        in_flight.erase(in_flight.begin(), in_flight.begin() + i + 1);
+        return;
+    }
+}
+
+void TerminalSimulator::Worker::Drop(uint32_t const& index) {
+    auto& terminal = terminals_[index];
+    if (terminal.socket >= 0) {
+        loop_.RemoveHandle(terminal.socket);
+        Close(terminal.socket);
+        terminal.socket = -1;
+    }
+    if (terminal.timer != 0) {
+        loop_.CancelTimer(terminal.timer);
+        terminal.timer = 0;
+    }
+    if (terminal.state == kOnline) {
+        --online_;
+        ++disconnects_;
+    }
+    terminal.state           = kIdle;
+    terminal.media_uploading = false;
+    terminal.in_flight.clear();
+    std::vector<uint8_t>().swap(terminal.recv_buffer);
+    std::vector<uint8_t>().swap(terminal.send_buffer);
+    terminal.send_offset = 0;
+    if (options_.reconnect_delay == 0 || !is_running_.load())
+        return;
+    terminal.timer = loop_.AddTimer(options_.reconnect_delay, 0, [this, index] {
+        terminals_[index].timer = 0;
+        connect_queue_.push_back(index);
+    });
+}
+
+void TerminalSimulator::Worker::FillLocation(Terminal* terminal, uint32_t const& index,
+                                             LocationBasicInformation* location) {
+    auto global   = first_index_ + index;
+    auto step     = terminal->route_step++;
+    location->alarm.value             = 0;
+    location->status.value            = 0;
+    location->status.bit.positioning  = 1;
+    // Each terminal drives back and forth on its own short road near Shenzhen.
+    location->latitude  = 22500000 + (global % 1000) * 100 + step % 600;
+    location->longitude = 113900000 + (global / 1000) % 1000 * 100 + step % 600;
+    location->altitude  = 54;
+    location->speed     = 600;
+    location->bearing   = step % 360;
+    location->time      = Timestamp();
+}
+
+std::string const& TerminalSimulator::Worker::Timestamp(void) {
+    auto now = time(NULL);
+    if (now != timestamp_time_) {
+        struct tm tm_now;
+#if defined(_WIN32)
+        localtime_s(&tm_now, &now);
+#else
+        localtime_r(&now, &tm_now);
+#endif
+        char date[16] = {0};
+        strftime(date, sizeof(date), "%y%m%d%H%M%S", &tm_now);
+        timestamp_      = date;
+        timestamp_time_ = now;
+    }
+    return timestamp_;
+}
+
+//
+// TerminalSimulator.
+//
+TerminalSimulator::TerminalSimulator() : is_running_(false) {
+}
+
+TerminalSimulator::~TerminalSimulator() {
+    Stop();
+}
+
+int TerminalSimulator::Init(SimulatorOptions const& options) {
+    if (is_running_.load())
+        return -1;
+    if (options.terminal_count == 0 || options.thread_count <= 0) {
+        JT808_LOG_ERROR("%s[%d]: Invalid terminal or thread count!!!", __FUNCTION__, __LINE__);
+        return -1;
+    }
+    if (std::to_string(options.first_phone_num + options.terminal_count - 1).size() > 12) {
+        JT808_LOG_ERROR("%s[%d]: Phone number range exceeds 12 digits!!!", __FUNCTION__, __LINE__);
+        return -1;
+    }
+    options_ = options;
+    if (options_.batch_size == 0 || options_.batch_size > kMaxBatchSize) {
+        JT808_LOG_ERROR("%s[%d]: Batch size limited to %d!!!", __FUNCTION__, __LINE__, kMaxBatchSize);
+        options_.batch_size = kMaxBatchSize;
+    }
+    if (options_.multimedia_size == 0 || options_.multimedia_size > kMaxMediaContent * 0xFFFFu)
+        options_.multimedia_size = kMaxMediaContent;
+    if (static_cast<uint32_t>(options_.thread_count) > options_.terminal_count)
+        options_.thread_count = static_cast<int>(options_.terminal_count);
+    workers_.clear();
+    uint32_t first = 0;
+    for (int i = 0; i < options_.thread_count; ++i) {
+        uint32_t count = options_.terminal_count / options_.thread_count +
+                         (static_cast<uint32_t>(i) < options_.terminal_count % options_.thread_count ? 1 : 0);
+        workers_.push_back(std::unique_ptr<Worker>(new Worker(options_, first, count)));
+        first += count;
+    }
+    return 0;
+}
+
+int TerminalSimulator::Run(void) {
+    if (workers_.empty() || is_running_.load())
+        return -1;
+    for (auto& worker : workers_) {
+        if (worker->Start() < 0) {
+            Stop();
+            return -1;
+        }
+    }
+    is_running_.store(true);
+    return 0;
+}
+
+void TerminalSimulator::Stop(void) {
+    for (auto& worker : workers_)
+        worker->Stop();
+    is_running_.store(false);
+}
+
+void TerminalSimulator::GetStatistics(SimulatorStatistics* stats, bool const& reset_rtt) {
+    if (stats == nullptr)
+        return;
+    stats->online             = 0;
+    stats->connects           = 0;
+    stats->connect_failures   = 0;
+    stats->auth_failures      = 0;
+    stats->resumes            = 0;
+    stats->disconnects        = 0;
+    stats->timeouts           = 0;
+    stats->sent_messages      = 0;
+    stats->received_messages  = 0;
+    stats->sent_bytes         = 0;
+    stats->received_bytes     = 0;
+    stats->location_reports   = 0;
+    stats->batch_reports      = 0;
+    stats->multimedia_uploads = 0;
+    stats->rtt.Reset();
+    for (auto& worker : workers_)
+        worker->GetStatistics(stats, reset_rtt);
+}
+
+} // namespace libjt808
@@ -0,0 +1,329 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  terminal_parameter_store.cc
+// @Version :  1.0
+// @Time    :  2026/10/19 15:40:12
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/terminal_parameter_store.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+constexpr bool TerminalParameterTableSorted(size_t const& index = 1) {
+    return index >= kTerminalParameterTableSize ||
+           (kTerminalParameterTable[index - 1].id < kTerminalParameterTable[index].id &&
+            TerminalParameterTableSorted(index + 1));
+}
+
+static_assert(TerminalParameterTableSorted(), "kTerminalParameterTable must be ascending by ID");
+
+// Size of the total number of parameters, and of the ID and length of a parameter item.
+constexpr size_t kCountSize = 1;
+constexpr size_t kItemHead  = 5;
+
+} // namespace
+
+constexpr size_t TerminalParameterStore::kInlineSize;
+
+uint8_t const* TerminalParameterStore::Data(Entry const& entry) const {
+    if (entry.size <= kInlineSize)
+        return entry.value;
+    uint32_t offset;
+    memcpy(&offset, entry.value, sizeof(offset));
+    return arena_.data() + offset;
+}
+
+TerminalParameterStore::Entry const* TerminalParameterStore::Lookup(uint32_t const& id) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), id,
+                               [](Entry const& entry, uint32_t const& key) { return entry.id < key; });
+    if (it == entries_.end() || it->id != id)
+        return nullptr;
+    return &*it;
+}
+
+void TerminalParameterStore::Assign(Entry* entry, uint8_t const* data, size_t const& size) {
+    if (entry->size > kInlineSize)
+        garbage_ += entry->size;
+    entry->size = static_cast<uint8_t>(size);
+    if (size <= kInlineSize) {
+        if (size > 0)
+            memcpy(entry->value, data, size);
+        return;
+    }
+    auto offset = static_cast<uint32_t>(arena_.size());
+    arena_.insert(arena_.end(), data, data + size);
+    memcpy(entry->value, &offset, sizeof(offset));
+}
+
+void TerminalParameterStore::Compact(void) {
+    if (garbage_ < 256 || garbage_ * 2 < arena_.size())
+        return;
+    std::vector<uint8_t> arena;
+    arena.reserve(arena_.size() - garbage_);
+    for (auto& entry : entries_) {
+        if (entry.size <= kInlineSize)
+            continue;
+        uint8_t const* data   = Data(entry);
+        auto           offset = static_cast<uint32_t>(arena.size());
+        arena.insert(arena.end(), data, data + entry.size);
+        memcpy(entry.value, &offset, sizeof(offset));
+    }
+    arena_.swap(arena);
+    garbage_ = 0;
+}
+
+int TerminalParameterStore::Find(uint32_t const& id, uint8_t const** data, size_t* size) const {
+    if (data == nullptr || size == nullptr)
+        return -1;
+    Entry const* entry = Lookup(id);
+    if (entry == nullptr)
+        return -1;
+    *data = Data(*entry);
+    *size = entry->size;
+    return 0;
+}
+
+bool TerminalParameterStore::Contains(uint32_t const& id) const {
+    return Lookup(id) != nullptr;
+}
+
+int TerminalParameterStore::Set(uint32_t const& id, uint8_t const* data, size_t const& size) {
+    if (size > UINT8_MAX || (data == nullptr && size > 0))
+        return -1;
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), id,
+                               [](Entry const& entry, uint32_t const& key) { return entry.id < key; });
+    if (it == entries_.end() || it->id != id) {
+        Entry entry = {id, 0, {0}};
+        it          = entries_.insert(it, entry);
+    }
+    Assign(&*it, data, size);
+    Compact();
+    return 0;
+}
+
+int TerminalParameterStore::Remove(uint32_t const& id) {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), id,
+                               [](Entry const& entry, uint32_t const& key) { return entry.id < key; });
+    if (it == entries_.end() || it->id != id)
+        return -1;
+    if (it->size > kInlineSize)
+        garbage_ += it->size;
+    entries_.erase(it);
+    Compact();
+    return 0;
+}
+
+void TerminalParameterStore::Clear(void) {
+    entries_.clear();
+    arena_.clear();
+    garbage_ = 0;
+}
+
+int TerminalParameterStore::GetBigEndian(uint32_t const& id, size_t const& size, uint64_t* value) const {
+    if (value == nullptr)
+        return -1;
+    Entry const* entry = Lookup(id);
+    if (entry == nullptr || entry->size != size)
+        return -1;
+    *value = libjt808::GetBigEndian(entry->value, size);
+    return 0;
+}
+
+int TerminalParameterStore::SetBigEndian(uint32_t const& id, size_t const& size, uint64_t const& value) {
+    uint8_t data[kInlineSize];
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<uint8_t>(value >> ((size - 1 - i) * 8));
+    return Set(id, data, size);
+}
+
+int TerminalParameterStore::Get(uint32_t const& id, uint8_t* value) const {
+    uint64_t result;
+    if (value == nullptr || GetBigEndian(id, 1, &result) < 0)
+        return -1;
+    *value = static_cast<uint8_t>(result);
+    return 0;
+}
+
+int TerminalParameterStore::Get(uint32_t const& id, uint16_t* value) const {
+    uint64_t result;
+    if (value == nullptr || GetBigEndian(id, 2, &result) < 0)
+        return -1;
+    *value = static_cast<uint16_t>(result);
+    return 0;
+}
+
+int TerminalParameterStore::Get(uint32_t const& id, uint32_t* value) const {
+    uint64_t result;
+    if (value == nullptr || GetBigEndian(id, 4, &result) < 0)
+        return -1;
+    *value = static_cast<uint32_t>(result);
+    return 0;
+}
+
+int TerminalParameterStore::Get(uint32_t const& id, uint64_t* value) const {
+    return GetBigEndian(id, 8, value);
+}
+
+int TerminalParameterStore::Get(uint32_t const& id, std::string* value) const {
+    if (value == nullptr)
+        return -1;
+    Entry const* entry = Lookup(id);
+    if (entry == nullptr)
+        return -1;
+    auto data = reinterpret_cast<char const*>(Data(*entry));
+    value->assign(data, data + entry->size);
+    return 0;
+}
+
+int TerminalParameterStore::Set(uint32_t const& id, uint8_t const& value) {
+    return SetBigEndian(id, 1, value);
+}
+
+int TerminalParameterStore::Set(uint32_t const& id, uint16_t const& value) {
+    return SetBigEndian(id, 2, value);
+}
+
+int TerminalParameterStore::Set(uint32_t const& id, uint32_t const& value) {
+    return SetBigEndian(id, 4, value);
+}
+
+int TerminalParameterStore::Set(uint32_t const& id, uint64_t const& value) {
+    return SetBigEndian(id, 8, value);
+}
+
+int TerminalParameterStore::Set(uint32_t const& id, std::string const& value) {
+    return Set(id, reinterpret_cast<uint8_t const*>(value.data()), value.size());
+}
+
+void TerminalParameterStore::Merge(TerminalParameterStore const& other) {
+    if (&other == this)
+        return;
+    if (entries_.empty()) {
+        *this = other;
+        return;
+    }
+    other.ForEach([this](uint32_t const& id, uint8_t const* data, size_t const& size) { Set(id, data, size); });
+}
+
+void TerminalParameterStore::Import(TerminalParameters const& items) {
+    for (auto const& item : items)
+        Set(item.first, item.second.data(), item.second.size());
+}
+
+void TerminalParameterStore::Export(TerminalParameters* items) const {
+    if (items == nullptr)
+        return;
+    ForEach([items](uint32_t const& id, uint8_t const* data, size_t const& size) {
+        (*items)[id].assign(data, data + size);
+    });
+}
+
+int TerminalParameterStore::Encode(std::vector<uint8_t>* out) const {
+    if (out == nullptr || entries_.size() > UINT8_MAX)
+        return -1;
+    size_t begin = out->size();
+    out->reserve(begin + kCountSize + entries_.size() * (kItemHead + kInlineSize) + arena_.size() - garbage_);
+    out->push_back(static_cast<uint8_t>(entries_.size()));
+    for (auto const& entry : entries_) {
+        uint8_t head[kItemHead] = {static_cast<uint8_t>(entry.id >> 24), static_cast<uint8_t>(entry.id >> 16),
+                                   static_cast<uint8_t>(entry.id >> 8), static_cast<uint8_t>(entry.id), entry.size};
+        out->insert(out->end(), head, head + kItemHead);
+        uint8_t const* data = Data(entry);
+        out->insert(out->end(), data, data + entry.size);
+    }
+    return static_cast<int>(out->size() - begin);
+}
+
+int TerminalParameterStore::Encode(std::vector<uint32_t> const& ids, std::vector<uint8_t>* out) const {
+    if (out == nullptr || ids.size() > UINT8_MAX)
+        return -1;
+    size_t begin = out->size();
+    out->push_back(0);
+    uint8_t cnt = 0;
+    for (auto const& id : ids) {
+        Entry const* entry = Lookup(id);
+        if (entry == nullptr)
+            continue;
+        uint8_t head[kItemHead] = {static_cast<uint8_t>(id >> 24), static_cast<uint8_t>(id >> 16),
+                                   static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id), entry->size};
+        out->insert(out->end(), head, head + kItemHead);
+        uint8_t const* data = Data(*entry);
+        out->insert(out->end(), data, data + entry->size);
+        ++cnt;
+    }
+    (*out)[begin] = cnt;
+    return static_cast<int>(out->size() - begin);
+}
+
+int TerminalParameterStore::Decode(uint8_t const* data, size_t const& size) {
+    Clear();
+    if (data == nullptr || size < kCountSize)
+        return -1;
+    uint8_t cnt    = data[0];
+    size_t  pos    = kCountSize;
+    bool    sorted = true;
+    entries_.reserve(cnt);
+    for (uint8_t i = 0; i < cnt; ++i) {
+        if (pos + kItemHead > size || pos + kItemHead + data[pos + 4] > size) {
+            Clear();
+            return -1;
+        }
+        uint32_t id  = static_cast<uint32_t>(libjt808::GetBigEndian(data + pos, 4));
+        uint8_t  len = data[pos + 4];
+        pos += kItemHead;
+        if (!entries_.empty() && entries_.back().id >= id)
+            sorted = false;
+        Entry entry = {id, 0, {0}};
+        Assign(&entry, data + pos, len);
+        entries_.push_back(entry);
+        pos += len;
+    }
+    // Terminals usually report ascending IDs, sort otherwise and keep the first of duplicates.
+    if (!sorted) {
+        std::stable_sort(entries_.begin(), entries_.end(),
+                         [](Entry const& lhs, Entry const& rhs) { return lhs.id < rhs.id; });
+        auto end = std::unique(entries_.begin(), entries_.end(),
+                               [](Entry const& lhs, Entry const& rhs) { return lhs.id == rhs.id; });
+        entries_.erase(end, entries_.end());
+        // Values of dropped duplicates stay in the arena until the next Compact().
+        size_t referenced = 0;
+        for (auto const& entry : entries_) {
+            if (entry.size > kInlineSize)
+                referenced += entry.size;
+        }
+        garbage_ = arena_.size() - referenced;
+    }
+    return static_cast<int>(pos);
+}
+
+} // namespace libjt808
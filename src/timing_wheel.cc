@@ -0,0 +1,196 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  timing_wheel.cc
+// @Version :  1.0
+// @Time    :  2026/10/26 14:21:37
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/timing_wheel.h"
+
+#include <utility>
+
+namespace libjt808 {
+
+constexpr uint32_t TimingWheel::kNil;
+constexpr uint32_t TimingWheel::kSlots;
+constexpr uint32_t TimingWheel::kFiringList;
+
+TimingWheel::TimingWheel(uint32_t const& tick_ms)
+    : tick_ms_(tick_ms == 0 ? 1 : tick_ms), heads_(kFiringList + 1, kNil) {
+}
+
+void TimingWheel::Start(int64_t const& now_ms) {
+    now_ms_  = now_ms < 0 ? 0 : now_ms;
+    current_ = static_cast<uint64_t>(now_ms_) / tick_ms_ + 1;
+}
+
+TimingWheel::TimerId TimingWheel::Add(uint32_t const& delay_ms, Callback const& callback) {
+    uint32_t index = free_;
+    if (index != kNil) {
+        free_ = nodes_[index].next;
+    }
+    else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    auto& node    = nodes_[index];
+    node.callback = callback;
+    node.deadline = DeadlineTick(delay_ms);
+    Place(index);
+    ++size_;
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+int TimingWheel::Reset(TimerId const& id, uint32_t const& delay_ms) {
+    uint32_t const index = Find(id);
+    if (index == kNil)
+        return -1;
+    Unlink(index);
+    nodes_[index].deadline = DeadlineTick(delay_ms);
+    Place(index);
+    return 0;
+}
+
+void TimingWheel::Cancel(TimerId const& id) {
+    uint32_t const index = Find(id);
+    if (index == kNil)
+        return;
+    Unlink(index);
+    Free(index);
+}
+
+size_t TimingWheel::Advance(int64_t const& now_ms) {
+    if (now_ms > now_ms_)
+        now_ms_ = now_ms;
+    uint64_t const target = static_cast<uint64_t>(now_ms_) / tick_ms_;
+    size_t         fired  = 0;
+    while (current_ <= target) {
+        // Nothing to move down or fire on the ticks left.
+        if (size_ == 0) {
+            current_ = target + 1;
+            break;
+        }
+        uint32_t const slot = static_cast<uint32_t>(current_) & kSlotMask;
+        if (slot == 0 && Cascade(1) == 0 && Cascade(2) == 0)
+            Cascade(3);
+        ++current_;
+        // Timers added by the callbacks may land in this slot again, they wait for its next turn.
+        uint32_t index = heads_[slot];
+        heads_[slot]   = kNil;
+        while (index != kNil) {
+            uint32_t const next = nodes_[index].next;
+            Link(index, kFiringList);
+            index = next;
+        }
+        while ((index = heads_[kFiringList]) != kNil) {
+            Unlink(index);
+            Callback callback(std::move(nodes_[index].callback));
+            Free(index);
+            ++fired;
+            callback();
+        }
+    }
+    return fired;
+}
+
+void TimingWheel::Clear(void) {
+    for (uint32_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].list != kNil)
+            Free(i);
+    }
+    heads_.assign(heads_.size(), kNil);
+}
+
+uint32_t TimingWheel::Find(TimerId const& id) const {
+    uint32_t const index = static_cast<uint32_t>(id) - 1;
+    if (index >= nodes_.size() || nodes_[index].list == kNil || nodes_[index].generation != (id >> 32))
+        return kNil;
+    return index;
+}
+
+void TimingWheel::Place(uint32_t const& index) {
+    auto& node = nodes_[index];
+    if (node.deadline < current_)
+        node.deadline = current_;
+    uint64_t delta = node.deadline - current_;
+    int      level = 0;
+    while (level < kLevels - 1 && delta >= (1ull << (kSlotBits * (level + 1))))
+        ++level;
+    // Beyond the top wheel, fire at its end and let the owner re-arm.
+    if (delta > UINT32_MAX)
+        node.deadline = current_ + UINT32_MAX;
+    uint32_t const slot = static_cast<uint32_t>(node.deadline >> (kSlotBits * level)) & kSlotMask;
+    Link(index, level * kSlots + slot);
+}
+
+void TimingWheel::Link(uint32_t const& index, uint32_t const& list) {
+    auto& node = nodes_[index];
+    node.list  = list;
+    node.prev  = kNil;
+    node.next  = heads_[list];
+    if (node.next != kNil)
+        nodes_[node.next].prev = index;
+    heads_[list] = index;
+}
+
+void TimingWheel::Unlink(uint32_t const& index) {
+    auto& node = nodes_[index];
+    if (node.prev != kNil)
+        nodes_[node.prev].next = node.next;
+    else
+        heads_[node.list] = node.next;
+    if (node.next != kNil)
+        nodes_[node.next].prev = node.prev;
+    node.list = kNil;
+}
+
+void TimingWheel::Free(uint32_t const& index) {
+    auto& node    = nodes_[index];
+    node.callback = nullptr;
+    node.list     = kNil;
+    node.next     = free_;
+    ++node.generation;
+    free_ = index;
+    --size_;
+}
+
+uint32_t TimingWheel::Cascade(int const& level) {
+    uint32_t const slot  = static_cast<uint32_t>(current_ >> (kSlotBits * level)) & kSlotMask;
+    uint32_t const list  = level * kSlots + slot;
+    uint32_t       index = heads_[list];
+    heads_[list]         = kNil;
+    while (index != kNil) {
+        uint32_t const next = nodes_[index].next;
+        Place(index);
+        index = next;
+    }
+    return slot;
+}
+
+uint64_t TimingWheel::DeadlineTick(uint32_t const& delay_ms) const {
+    return (static_cast<uint64_t>(now_ms_) + delay_ms + tick_ms_ - 1) / tick_ms_;
+}
+
+} // namespace libjt808
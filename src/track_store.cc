@@ -0,0 +1,646 @@
+// MIT License
+//
+// Copyright (c) 2020 Yuming Meng
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @File    :  track_store.cc
+// @Version :  1.0
+// @Time    :  2026/10/29 10:12:40
+// @Author  :  Meng Yuming
+// @Contact :  mengyuming@hotmail.com
+// @Desc    :  None
+
+#include "jt808/track_store.h"
+
+#include <errno.h>
+#include <string.h>
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+#include "jt808/util.h"
+
+namespace libjt808 {
+
+namespace {
+
+// Segment layout, big endian:
+//     magic[8], partition start (8 bytes)
+//     record: payload size (DWORD), payload, FNV-1a of the payload (DWORD)
+//     payload: phone number length (BYTE), phone number, locations (DWORD), min time (8 bytes), max time (8 bytes),
+//              byte size of each column (DWORD), columns.
+// A column is a sequence of varints, 2 * zigzag(value) for a value other than 0, 2 * n + 1 for a run of n zeros.
+constexpr uint8_t kMagic[8]        = {'J', 'T', '8', '0', '8', 'T', 'K', 0x01};
+constexpr size_t  kHeaderSize      = sizeof(kMagic) + 8;
+constexpr size_t  kRecordOverhead  = 8;
+constexpr size_t  kColumnCount     = 8;
+constexpr size_t  kPayloadOverhead = 1 + 4 + 8 + 8 + 4 * kColumnCount; // Without the phone number.
+
+enum ColumnKind {
+    kDeltaOfDelta = 0x0, // Value minus the previous, minus the same of the previous value.
+    kDelta,              // Value minus the previous.
+    kXor,                // Value XOR the previous.
+};
+
+// Columns: time, latitude, longitude, altitude, speed, bearing, alarm, status.
+constexpr ColumnKind kColumnKinds[kColumnCount] = {kDeltaOfDelta, kDeltaOfDelta, kDeltaOfDelta, kDelta,
+                                                   kDelta,        kDelta,        kXor,          kXor};
+
+// Write a varint to out, room for 10 bytes. Returns its size.
+size_t EncodeVarint(uint64_t value, uint8_t* out) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+void PutVarint(uint64_t const& value, std::vector<uint8_t>* out) {
+    uint8_t buffer[10];
+    out->insert(out->end(), buffer, buffer + EncodeVarint(value, buffer));
+}
+
+// Returns 0 on success, -1 for a truncated or overlong varint.
+int GetVarint(uint8_t const** data, uint8_t const* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *data < end; shift += 7) {
+        uint8_t const byte = *(*data)++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+uint64_t ZigZag(int64_t const& value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t const& value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Reverses the encoding of a column.
+class ColumnDecoder {
+public:
+    void Init(uint8_t const* data, size_t const& size, ColumnKind const& kind) {
+        data_ = data;
+        end_  = data + size;
+        kind_ = kind;
+    }
+
+    // Returns 0 on success, -1 past the end of the column.
+    int Next(int64_t* value) {
+        int64_t v = 0;
+        if (zeros_ > 0) {
+            --zeros_;
+        }
+        else {
+            uint64_t token = 0;
+            if (GetVarint(&data_, end_, &token) < 0)
+                return -1;
+            if (token & 1) {
+                if (token < 2)
+                    return -1;
+                zeros_ = (token >> 1) - 1;
+            }
+            else {
+                v = UnZigZag(token >> 1);
+            }
+        }
+        switch (kind_) {
+            case kDeltaOfDelta:
+                prev_delta_ += v;
+                prev_ += prev_delta_;
+                break;
+            case kDelta:
+                prev_ += v;
+                break;
+            case kXor:
+                prev_ ^= v;
+                break;
+        }
+        *value = prev_;
+        return 0;
+    }
+
+private:
+    uint8_t const* data_       = nullptr;
+    uint8_t const* end_        = nullptr;
+    ColumnKind     kind_       = kDelta;
+    int64_t        prev_       = 0;
+    int64_t        prev_delta_ = 0;
+    uint64_t       zeros_      = 0;
+};
+
+// Add the locations of a block payload with from_s <= timestamp < to_s to points.
+// Returns 0 on success, -1 for a malformed payload.
+int DecodeBlock(uint8_t const* payload, size_t const& size, int64_t const& from_s, int64_t const& to_s,
+                std::vector<TrackPoint>* points) {
+    if (size < kPayloadOverhead || size - kPayloadOverhead < payload[0])
+        return -1;
+    uint8_t const* p     = payload + 1 + payload[0];
+    uint32_t const count = GetBigEndian(p, 4);
+    p += 4 + 16;
+    uint8_t const* column = p + 4 * kColumnCount;
+    uint8_t const* end    = payload + size;
+    ColumnDecoder  decoders[kColumnCount];
+    for (size_t i = 0; i < kColumnCount; ++i) {
+        uint32_t const column_size = GetBigEndian(p + 4 * i, 4);
+        if (static_cast<size_t>(end - column) < column_size)
+            return -1;
+        decoders[i].Init(column, column_size, kColumnKinds[i]);
+        column += column_size;
+    }
+    int64_t values[kColumnCount];
+    for (uint32_t n = 0; n < count; ++n) {
+        for (size_t i = 0; i < kColumnCount; ++i) {
+            if (decoders[i].Next(&values[i]) < 0)
+                return -1;
+        }
+        if (values[0] < from_s || values[0] >= to_s)
+            continue;
+        TrackPoint point;
+        point.timestamp = values[0];
+        point.latitude  = static_cast<uint32_t>(values[1]);
+        point.longitude = static_cast<uint32_t>(values[2]);
+        point.altitude  = static_cast<uint16_t>(values[3]);
+        point.speed     = static_cast<uint16_t>(values[4]);
+        point.bearing   = static_cast<uint16_t>(values[5]);
+        point.alarm     = static_cast<uint32_t>(values[6]);
+        point.status    = static_cast<uint32_t>(values[7]);
+        points->push_back(point);
+    }
+    return 0;
+}
+
+int64_t SteadyClockMs(void) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+TrackStore::~TrackStore() {
+    Close();
+}
+
+int TrackStore::Open(std::string const& dir, TrackStoreOptions const& options) {
+#if defined(__linux__)
+    std::lock_guard<std::mutex> lock(mutex_);
+    CloseLocked();
+    if (options.partition_s <= 0 || options.block_points == 0 || options.block_points > UINT32_MAX)
+        return -1;
+    if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST)
+        return -1;
+    // Another process, e.g. the one handing its connections over to this one, would append behind the segment
+    // sizes indexed here.
+    lock_fd_ = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (lock_fd_ < 0)
+        return -1;
+    if (flock(lock_fd_, LOCK_EX | LOCK_NB) < 0) {
+        close(lock_fd_);
+        lock_fd_ = -1;
+        return -1;
+    }
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) {
+        CloseLocked();
+        return -1;
+    }
+    std::vector<std::string> paths;
+    while (dirent* entry = readdir(handle)) {
+        std::string const name = entry->d_name;
+        if (name.size() > 10 && name.compare(0, 6, "track_") == 0 && name.compare(name.size() - 4, 4, ".seg") == 0)
+            paths.push_back(dir + "/" + name);
+    }
+    closedir(handle);
+    for (auto const& path : paths) {
+        if (LoadSegment(path) < 0) {
+            CloseLocked();
+            return -1;
+        }
+    }
+    dir_     = dir;
+    options_ = options;
+    open_    = true;
+    return 0;
+#else
+    (void)dir;
+    (void)options;
+    return -1;
+#endif
+}
+
+void TrackStore::Close(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CloseLocked();
+}
+
+bool TrackStore::is_open(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_;
+}
+
+int TrackStore::Append(std::string const& phone_num, LocationBasicInformation const& info) {
+    TrackPoint point;
+    point.timestamp = info.timestamp;
+    point.latitude  = info.latitude;
+    point.longitude = info.longitude;
+    point.altitude  = info.altitude;
+    point.speed     = info.speed;
+    point.bearing   = info.bearing;
+    point.alarm     = info.alarm.value;
+    point.status    = info.status.value;
+    return Append(phone_num, point);
+}
+
+int TrackStore::Append(std::string const& phone_num, TrackPoint const& point) {
+    static_assert(kColumns == kColumnCount, "columns of the header and of the layout differ");
+    if (phone_num.size() > UINT8_MAX || point.timestamp < 0)
+        return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return -1;
+    int64_t const partition = point.timestamp - point.timestamp % options_.partition_s;
+    auto&         block     = active_[phone_num];
+    int           ret       = 0;
+    if (block.count > 0 && block.partition != partition)
+        ret = Seal(phone_num, &block);
+    if (block.count == 0) {
+        block.partition = partition;
+        block.min_time  = point.timestamp;
+        block.max_time  = point.timestamp;
+        block.opened_ms = SteadyClockMs();
+        if (options_.max_block_age_ms > 0)
+            opened_.emplace_back(block.opened_ms, phone_num);
+    }
+    int64_t const values[kColumns] = {point.timestamp, point.latitude, point.longitude, point.altitude,
+                                      point.speed,     point.bearing,  point.alarm,     point.status};
+    for (size_t i = 0; i < kColumns; ++i) {
+        auto&   column = block.columns[i];
+        int64_t value  = 0;
+        switch (kColumnKinds[i]) {
+            case kDeltaOfDelta: {
+                int64_t const delta = values[i] - column.prev;
+                value               = delta - column.prev_delta;
+                column.prev_delta   = delta;
+                break;
+            }
+            case kDelta:
+                value = values[i] - column.prev;
+                break;
+            case kXor:
+                value = values[i] ^ column.prev;
+                break;
+        }
+        column.prev = values[i];
+        if (value == 0) {
+            ++column.zeros;
+            continue;
+        }
+        if (column.zeros > 0) {
+            PutVarint((static_cast<uint64_t>(column.zeros) << 1) | 1, &column.bytes);
+            column.zeros = 0;
+        }
+        PutVarint(ZigZag(value) << 1, &column.bytes);
+    }
+    ++block.count;
+    block.min_time = std::min(block.min_time, point.timestamp);
+    block.max_time = std::max(block.max_time, point.timestamp);
+    if (block.count >= options_.block_points && Seal(phone_num, &block) < 0)
+        ret = -1;
+    return ret;
+}
+
+int TrackStore::Flush(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return -1;
+    int ret = 0;
+    for (auto& item : active_) {
+        if (Seal(item.first, &item.second) < 0)
+            ret = -1;
+    }
+    // Terminals gone quiet hold no memory until they report again.
+    active_.clear();
+    opened_.clear();
+    for (auto& item : segments_) {
+        auto& segment = *item.second;
+        if (segment.dirty && fflush(segment.file) != 0)
+            ret = -1;
+        segment.dirty = false;
+    }
+    return ret;
+}
+
+int TrackStore::FlushAged(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return -1;
+    int           ret = 0;
+    int64_t const now = SteadyClockMs();
+    while (!opened_.empty() && now - opened_.front().first >= options_.max_block_age_ms) {
+        auto block = active_.find(opened_.front().second);
+        // Blocks written since have their terminals start another one, or none.
+        if (block != active_.end() && block->second.count > 0 && block->second.opened_ms == opened_.front().first) {
+            if (Seal(block->first, &block->second) < 0)
+                ret = -1;
+            active_.erase(block);
+        }
+        opened_.pop_front();
+    }
+    for (auto& item : segments_) {
+        auto& segment = *item.second;
+        if (segment.dirty && fflush(segment.file) != 0)
+            ret = -1;
+        segment.dirty = false;
+    }
+    return ret;
+}
+
+int TrackStore::Query(std::string const& phone_num, int64_t const& from_s, int64_t const& to_s,
+                      std::vector<TrackPoint>* points) {
+    if (points == nullptr)
+        return -1;
+    points->clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return -1;
+    for (auto& item : segments_) {
+        auto& segment = *item.second;
+        if (segment.min_time >= to_s || segment.max_time < from_s)
+            continue;
+        auto blocks = segment.blocks.find(phone_num);
+        if (blocks == segment.blocks.end())
+            continue;
+        uint8_t const* map = nullptr;
+        for (auto const& block : blocks->second) {
+            if (block.min_time >= to_s || block.max_time < from_s)
+                continue;
+            if (map == nullptr && (map = MapSegment(&segment)) == nullptr)
+                return -1;
+            DecodeBlock(map + block.offset, block.size, from_s, to_s, points);
+        }
+    }
+    auto active = active_.find(phone_num);
+    if (active != active_.end() && active->second.count > 0 && active->second.min_time < to_s &&
+        active->second.max_time >= from_s) {
+        scratch_.clear();
+        EncodeBlock(phone_num, active->second, &scratch_);
+        DecodeBlock(scratch_.data(), scratch_.size(), from_s, to_s, points);
+    }
+    // Blocks are in write order, a terminal may report locations of a blind area late (0x0704).
+    auto const earlier = [](TrackPoint const& a, TrackPoint const& b) { return a.timestamp < b.timestamp; };
+    if (!std::is_sorted(points->begin(), points->end(), earlier))
+        std::stable_sort(points->begin(), points->end(), earlier);
+    return 0;
+}
+
+uint64_t TrackStore::disk_bytes(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t                    bytes = 0;
+    for (auto const& item : segments_)
+        bytes += item.second->bytes;
+    return bytes;
+}
+
+void TrackStore::EncodeBlock(std::string const& phone_num, ActiveBlock const& block, std::vector<uint8_t>* out) {
+    // Runs of zeros at the end of the columns are not encoded yet.
+    uint8_t pending[kColumns][10];
+    size_t  pending_size[kColumns];
+    for (size_t i = 0; i < kColumns; ++i) {
+        uint32_t const zeros = block.columns[i].zeros;
+        pending_size[i]      = zeros > 0 ? EncodeVarint((static_cast<uint64_t>(zeros) << 1) | 1, pending[i]) : 0;
+    }
+    out->push_back(static_cast<uint8_t>(phone_num.size()));
+    out->insert(out->end(), phone_num.begin(), phone_num.end());
+    PutBigEndian(block.count, 4, out);
+    PutBigEndian(static_cast<uint64_t>(block.min_time), 8, out);
+    PutBigEndian(static_cast<uint64_t>(block.max_time), 8, out);
+    for (size_t i = 0; i < kColumns; ++i)
+        PutBigEndian(block.columns[i].bytes.size() + pending_size[i], 4, out);
+    for (size_t i = 0; i < kColumns; ++i) {
+        out->insert(out->end(), block.columns[i].bytes.begin(), block.columns[i].bytes.end());
+        out->insert(out->end(), pending[i], pending[i] + pending_size[i]);
+    }
+}
+
+int TrackStore::LoadSegment(std::string const& path) {
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    // Created by a crash before its header was written.
+    if (static_cast<size_t>(st.st_size) < kHeaderSize) {
+        close(fd);
+        return remove(path.c_str());
+    }
+    size_t const size = static_cast<size_t>(st.st_size);
+    void*        map  = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    uint8_t const* data = static_cast<uint8_t const*>(map);
+    if (memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        munmap(map, size);
+        return -1;
+    }
+    int64_t const start = static_cast<int64_t>(GetBigEndian(data + sizeof(kMagic), 8));
+    if (segments_.count(start) != 0) {
+        munmap(map, size);
+        return -1;
+    }
+    std::unique_ptr<Segment> segment(new Segment);
+    segment->path  = path;
+    segment->start = start;
+    size_t pos     = kHeaderSize;
+    while (size - pos >= kRecordOverhead) {
+        uint32_t const payload_size = GetBigEndian(data + pos, 4);
+        if (payload_size < kPayloadOverhead || size - pos - kRecordOverhead < payload_size)
+            break;
+        uint8_t const* payload = data + pos + 4;
+        if (GetBigEndian(payload + payload_size, 4) != Fnv1a(payload, payload_size) ||
+            payload_size - kPayloadOverhead < payload[0])
+            break;
+        uint8_t const* p = payload + 1 + payload[0];
+        BlockRef       block;
+        block.offset   = pos + 4;
+        block.size     = payload_size;
+        block.min_time = static_cast<int64_t>(GetBigEndian(p + 4, 8));
+        block.max_time = static_cast<int64_t>(GetBigEndian(p + 12, 8));
+        segment->blocks[std::string(reinterpret_cast<char const*>(payload + 1), payload[0])].push_back(block);
+        segment->min_time = std::min(segment->min_time, block.min_time);
+        segment->max_time = std::max(segment->max_time, block.max_time);
+        pos += payload_size + kRecordOverhead;
+    }
+    munmap(map, size);
+    // A torn block at the end would hide the blocks appended next.
+    if (pos < size && truncate(path.c_str(), static_cast<off_t>(pos)) < 0)
+        return -1;
+    segment->bytes = pos;
+    segments_[start] = std::move(segment);
+    return 0;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+TrackStore::Segment* TrackStore::GetSegment(int64_t const& start) {
+    auto& segment = segments_[start];
+    if (segment == nullptr) {
+        segment.reset(new Segment);
+        segment->path  = dir_ + "/track_" + std::to_string(start) + ".seg";
+        segment->start = start;
+    }
+    return segment.get();
+}
+
+int TrackStore::Seal(std::string const& phone_num, ActiveBlock* block) {
+    if (block->count == 0)
+        return 0;
+    scratch_.clear();
+    PutBigEndian(0, 4, &scratch_); // Payload size, set below.
+    EncodeBlock(phone_num, *block, &scratch_);
+    uint32_t const payload_size = static_cast<uint32_t>(scratch_.size() - 4);
+    for (int i = 0; i < 4; ++i)
+        scratch_[i] = static_cast<uint8_t>(payload_size >> (24 - 8 * i));
+    PutBigEndian(Fnv1a(scratch_.data() + 4, payload_size), 4, &scratch_);
+    BlockRef ref;
+    ref.size     = payload_size;
+    ref.min_time = block->min_time;
+    ref.max_time = block->max_time;
+    Segment* segment = GetSegment(block->partition);
+    // The columns keep their capacity for the next block of the terminal.
+    for (auto& column : block->columns) {
+        column.bytes.clear();
+        column.prev       = 0;
+        column.prev_delta = 0;
+        column.zeros      = 0;
+    }
+    block->count = 0;
+    if (segment->file == nullptr) {
+        segment->file = fopen(segment->path.c_str(), "ab");
+        if (segment->file == nullptr)
+            return -1;
+        if (segment->bytes == 0) {
+            std::vector<uint8_t> header(kMagic, kMagic + sizeof(kMagic));
+            PutBigEndian(static_cast<uint64_t>(segment->start), 8, &header);
+            if (fwrite(header.data(), 1, header.size(), segment->file) != header.size()) {
+                fclose(segment->file);
+                segment->file = nullptr;
+                remove(segment->path.c_str());
+                return -1;
+            }
+            segment->bytes = header.size();
+        }
+    }
+    if (fwrite(scratch_.data(), 1, scratch_.size(), segment->file) != scratch_.size()) {
+        // Cut off the part written, the blocks appended next would be hidden behind it.
+        fclose(segment->file);
+        segment->file = nullptr;
+#if defined(__linux__)
+        truncate(segment->path.c_str(), static_cast<off_t>(segment->bytes));
+#endif
+        return -1;
+    }
+    ref.offset = segment->bytes + 4;
+    segment->bytes += scratch_.size();
+    segment->dirty = true;
+    segment->blocks[phone_num].push_back(ref);
+    segment->min_time = std::min(segment->min_time, ref.min_time);
+    segment->max_time = std::max(segment->max_time, ref.max_time);
+    return 0;
+}
+
+uint8_t const* TrackStore::MapSegment(Segment* segment) {
+#if defined(__linux__)
+    if (segment->dirty) {
+        if (fflush(segment->file) != 0)
+            return nullptr;
+        segment->dirty = false;
+    }
+    if (segment->map != nullptr && segment->map_size == segment->bytes)
+        return segment->map;
+    if (segment->map != nullptr) {
+        munmap(segment->map, segment->map_size);
+        segment->map      = nullptr;
+        segment->map_size = 0;
+    }
+    int fd = open(segment->path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    void* map = mmap(nullptr, segment->bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return nullptr;
+    segment->map      = static_cast<uint8_t*>(map);
+    segment->map_size = segment->bytes;
+    return segment->map;
+#else
+    (void)segment;
+    return nullptr;
+#endif
+}
+
+void TrackStore::CloseLocked(void) {
+    if (open_) {
+        for (auto& item : active_)
+            Seal(item.first, &item.second);
+    }
+    active_.clear();
+    for (auto& item : segments_) {
+        auto& segment = *item.second;
+        if (segment.file != nullptr)
+            fclose(segment.file);
+#if defined(__linux__)
+        if (segment.map != nullptr)
+            munmap(segment.map, segment.map_size);
+#endif
+    }
+    segments_.clear();
+    opened_.clear();
+#if defined(__linux__)
+    if (lock_fd_ >= 0)
+        close(lock_fd_);
+#endif
+    lock_fd_ = -1;
+    open_    = false;
+}
+
+} // namespace libjt808
@@ -69,6 +69,33 @@ int ReverseEscape(InputBuffer in, std::vector<uint8_t> &out) {
   return 0;
 }
 
+// 大端写入.
+void PutBigEndian(uint64_t const& value, size_t const& size,
+                  std::vector<uint8_t>* out) {
+  for (size_t i = size; i > 0; --i) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+  }
+}
+
+// 大端读取.
+uint64_t GetBigEndian(uint8_t const* data, size_t const& size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+// FNV-1a哈希.
+uint32_t Fnv1a(uint8_t const* data, size_t const& size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
 // 奇偶校验.
 uint8_t BccCheckSum(const uint8_t *src, const size_t &len) {
   uint8_t checksum = 0;
@@ -78,4 +105,26 @@ uint8_t BccCheckSum(const uint8_t *src, const size_t &len) {
   return checksum;
 }
 
+// 查找完整帧.
+int FindFrame(const uint8_t *data, const size_t &len,
+              size_t *begin, size_t *end) {
+  size_t pos = 0;
+  while (pos < len && data[pos] != PROTOCOL_SIGN) ++pos;
+  while (pos < len) {
+    size_t next = pos + 1;
+    while (next < len && data[next] != PROTOCOL_SIGN) ++next;
+    if (next >= len) break;
+    if (next == pos + 1) {  // 相邻标识位, 后一个才是帧起始.
+      pos = next;
+      continue;
+    }
+    *begin = pos;
+    *end = next + 1;
+    return 0;
+  }
+  *begin = pos;
+  *end = len;
+  return -1;
+}
+
 }  // namespace libjt808